@@ -17,7 +17,7 @@
 #include "access/table.h"
 #include "access/tableam.h"
 #include "access/toast_internals.h"
-#include "common/pg_lzcompress.h"
+#include "pgstat.h"
 #include "utils/expandeddatum.h"
 #include "utils/rel.h"
 
@@ -225,14 +225,18 @@ detoast_attr_slice(struct varlena *attr,
 		 */
 		if (slicelength > 0 && sliceoffset >= 0)
 		{
+			const CompressionRoutine *routine;
 			int32		max_size;
 
 			/*
-			 * Determine maximum amount of compressed data needed for a prefix
-			 * of a given length (after decompression).
+			 * Ask the compression method for the maximum amount of compressed
+			 * data needed for a prefix of a given length (after
+			 * decompression).
 			 */
-			max_size = pglz_maximum_compressed_size(sliceoffset + slicelength,
-													toast_pointer.va_extsize);
+			routine = GetCompressionRoutineById(VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer));
+			max_size = routine->compressed_slice_size(sliceoffset + slicelength,
+													  toast_pointer.va_rawsize - VARHDRSZ,
+													  VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer));
 
 			/*
 			 * Fetch enough compressed slices (compressed marker will get set
@@ -333,7 +337,7 @@ toast_fetch_datum(struct varlena *attr)
 	/* Must copy to access aligned fields */
 	VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
 
-	attrsize = toast_pointer.va_extsize;
+	attrsize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
 
 	result = (struct varlena *) palloc(attrsize + VARHDRSZ);
 
@@ -394,7 +398,7 @@ toast_fetch_datum_slice(struct varlena *attr, int32 sliceoffset,
 	 */
 	Assert(!VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer) || 0 == sliceoffset);
 
-	attrsize = toast_pointer.va_extsize;
+	attrsize = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
 
 	if (sliceoffset >= attrsize)
 	{
@@ -445,19 +449,26 @@ toast_fetch_datum_slice(struct varlena *attr, int32 sliceoffset,
 static struct varlena *
 toast_decompress_datum(struct varlena *attr)
 {
+	const CompressionRoutine *routine;
 	struct varlena *result;
+	instr_time	start;
 
 	Assert(VARATT_IS_COMPRESSED(attr));
 
-	result = (struct varlena *)
-		palloc(TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
-	SET_VARSIZE(result, TOAST_COMPRESS_RAWSIZE(attr) + VARHDRSZ);
+	/*
+	 * Fetch the compression method id stored in the compression header and
+	 * decompress the data using the appropriate decompression routine.
+	 */
+	routine = GetCompressionRoutineById(TOAST_COMPRESS_METHOD(attr));
+
+	if (pgstat_track_toast)
+		INSTR_TIME_SET_CURRENT(start);
 
-	if (pglz_decompress(TOAST_COMPRESS_RAWDATA(attr),
-						TOAST_COMPRESS_SIZE(attr),
-						VARDATA(result),
-						TOAST_COMPRESS_RAWSIZE(attr), true) < 0)
-		elog(ERROR, "compressed data is corrupted");
+	result = routine->decompress(attr);
+
+	if (pgstat_track_toast)
+		pgstat_count_toast_decompression(TOAST_COMPRESS_METHOD(attr),
+										 VARSIZE(result) - VARHDRSZ, start);
 
 	return result;
 }
@@ -473,21 +484,34 @@ toast_decompress_datum(struct varlena *attr)
 static struct varlena *
 toast_decompress_datum_slice(struct varlena *attr, int32 slicelength)
 {
+	const CompressionRoutine *routine;
 	struct varlena *result;
-	int32		rawsize;
+	instr_time	start;
 
 	Assert(VARATT_IS_COMPRESSED(attr));
 
-	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+	/*
+	 * Some callers may pass a slicelength that's more than the actual
+	 * decompressed size.  If so, just decompress normally.  This avoids
+	 * possibly allocating a larger-than-necessary result object, and may be
+	 * faster and/or more robust as well.  Notably, some versions of liblz4
+	 * have been seen to give wrong results if passed an output size that is
+	 * more than the data's true decompressed size.
+	 */
+	if ((uint32) slicelength >= TOAST_COMPRESS_EXTSIZE(attr))
+		return toast_decompress_datum(attr);
+
+	routine = GetCompressionRoutineById(TOAST_COMPRESS_METHOD(attr));
+
+	if (pgstat_track_toast)
+		INSTR_TIME_SET_CURRENT(start);
+
+	result = routine->decompress_slice(attr, slicelength);
 
-	rawsize = pglz_decompress(TOAST_COMPRESS_RAWDATA(attr),
-							  VARSIZE(attr) - TOAST_COMPRESS_HDRSZ,
-							  VARDATA(result),
-							  slicelength, false);
-	if (rawsize < 0)
-		elog(ERROR, "compressed data is corrupted");
+	if (pgstat_track_toast)
+		pgstat_count_toast_decompression(TOAST_COMPRESS_METHOD(attr),
+										 VARSIZE(result) - VARHDRSZ, start);
 
-	SET_VARSIZE(result, rawsize + VARHDRSZ);
 	return result;
 }
 
@@ -530,7 +554,7 @@ toast_raw_datum_size(Datum value)
 	else if (VARATT_IS_COMPRESSED(attr))
 	{
 		/* here, va_rawsize is just the payload size */
-		result = VARRAWSIZE_4B_C(attr) + VARHDRSZ;
+		result = VARDATA_COMPRESSED_GET_EXTSIZE(attr) + VARHDRSZ;
 	}
 	else if (VARATT_IS_SHORT(attr))
 	{
@@ -570,7 +594,7 @@ toast_datum_size(Datum value)
 		struct varatt_external toast_pointer;
 
 		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
-		result = toast_pointer.va_extsize;
+		result = VARATT_EXTERNAL_GET_EXTSIZE(toast_pointer);
 	}
 	else if (VARATT_IS_EXTERNAL_INDIRECT(attr))
 	{
@@ -91,6 +91,11 @@
  * is only used during VACUUM, which uses a ShareUpdateExclusiveLock,
  * so the VACUUM will not be affected by in-flight changes. Changing its
  * value has no effect until the next VACUUM, so no need for stronger lock.
+ * The same goes for page_compression.
+ *
+ * columnar_cache only decides whether scans load the table's pages into
+ * the columnar cache, and pages cached before it was changed remain valid,
+ * so ShareUpdateExclusiveLock is plenty.
  */
 
 static relopt_bool boolRelOpts[] =
@@ -158,6 +163,24 @@ static relopt_bool boolRelOpts[] =
 		},
 		true
 	},
+	{
+		{
+			"page_compression",
+			"Enables storing all-frozen pages of this table compressed on disk",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		false
+	},
+	{
+		{
+			"columnar_cache",
+			"Enables caching the attribute offsets of all-visible pages of this table in the columnar cache",
+			RELOPT_KIND_HEAP,
+			ShareUpdateExclusiveLock
+		},
+		false
+	},
 	{
 		{
 			"deduplicate_items",
@@ -1859,7 +1882,11 @@ default_reloptions(Datum reloptions, bool validate, relopt_kind kind)
 		{"vacuum_index_cleanup", RELOPT_TYPE_BOOL,
 		offsetof(StdRdOptions, vacuum_index_cleanup)},
 		{"vacuum_truncate", RELOPT_TYPE_BOOL,
-		offsetof(StdRdOptions, vacuum_truncate)}
+		offsetof(StdRdOptions, vacuum_truncate)},
+		{"page_compression", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, page_compression)},
+		{"columnar_cache", RELOPT_TYPE_BOOL,
+		offsetof(StdRdOptions, columnar_cache)}
 	};
 
 	return (bytea *) build_reloptions(reloptions, validate, kind,
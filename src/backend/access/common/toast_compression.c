@@ -0,0 +1,745 @@
+/*-------------------------------------------------------------------------
+ *
+ * toast_compression.c
+ *	  Functions for toast compression.
+ *
+ * Copyright (c) 2020, PostgreSQL Global Development Group
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/common/toast_compression.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
+#include "access/detoast.h"
+#include "access/toast_compression.h"
+#include "access/toast_internals.h"
+#include "catalog/pg_zstd_dictionary.h"
+#include "common/pg_lzcompress.h"
+#include "fmgr.h"
+#include "utils/builtins.h"
+#include "utils/hsearch.h"
+
+/* GUC */
+int			default_toast_compression = TOAST_PGLZ_COMPRESSION;
+
+#define NO_LZ4_SUPPORT() \
+	ereport(ERROR, \
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED), \
+			 errmsg("compression method lz4 not supported"), \
+			 errdetail("This functionality requires the server to be built with lz4 support."), \
+			 errhint("You need to rebuild PostgreSQL using %s.", "--with-lz4")))
+
+#define NO_ZSTD_SUPPORT() \
+	ereport(ERROR, \
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED), \
+			 errmsg("compression method zstd not supported"), \
+			 errdetail("This functionality requires the server to be built with zstd support."), \
+			 errhint("You need to rebuild PostgreSQL using %s.", "--with-zstd")))
+
+/*
+ * zstd-compressed datums store the OID of the pg_zstd_dictionary entry they
+ * were compressed with (InvalidOid if none) between the toast compression
+ * header and the zstd frame.  The frame itself omits the dictionary ID,
+ * content size and checksum, all of which are redundant here.
+ */
+#define ZSTD_HDRSZ		(TOAST_COMPRESS_HDRSZ + sizeof(Oid))
+
+/*
+ * Limits set by the zstd frame format (RFC 8878), which zstd.h only exposes
+ * to statically linked users.
+ */
+#define ZSTD_FRAME_HEADER_MAXSZ		18
+#define ZSTD_BLOCK_MAXSZ			(128 * 1024)
+
+#ifdef USE_ZSTD
+/*
+ * Dictionaries are immutable once created, so the digested forms zstd works
+ * with can be cached for the life of the backend, keyed by dictionary OID.
+ */
+typedef struct ZstdDictCacheEntry
+{
+	Oid			dictid;			/* hash key --- must be first */
+	ZSTD_CDict *cdict;
+	ZSTD_DDict *ddict;
+} ZstdDictCacheEntry;
+
+static HTAB *zstd_dict_cache = NULL;
+static ZSTD_CCtx *zstd_cctx = NULL;
+static ZSTD_DCtx *zstd_dctx = NULL;
+
+static ZstdDictCacheEntry *zstd_get_dictionary(Oid dictid);
+static ZSTD_DCtx *zstd_get_dctx(void);
+#endif
+
+/*
+ * Table of built-in compression methods, indexed by ToastCompressionId.
+ */
+static const CompressionRoutine compression_methods[] = {
+	{
+		TOAST_PGLZ_COMPRESSION, TOAST_PGLZ_COMPRESSION_ID, "pglz",
+		pglz_compress_datum,
+		pglz_decompress_datum,
+		pglz_decompress_datum_slice,
+		pglz_compressed_slice_size
+	},
+	{
+		TOAST_LZ4_COMPRESSION, TOAST_LZ4_COMPRESSION_ID, "lz4",
+		lz4_compress_datum,
+		lz4_decompress_datum,
+		lz4_decompress_datum_slice,
+		lz4_compressed_slice_size
+	},
+	{
+		TOAST_ZSTD_COMPRESSION, TOAST_ZSTD_COMPRESSION_ID, "zstd",
+		zstd_compress_datum,
+		zstd_decompress_datum,
+		zstd_decompress_datum_slice,
+		zstd_compressed_slice_size
+	}
+};
+
+StaticAssertDecl(lengthof(compression_methods) == TOAST_INVALID_COMPRESSION_ID,
+				 "compression_methods[] must match ToastCompressionId");
+
+/*
+ * Compress a varlena using PGLZ.
+ *
+ * Returns the compressed varlena, or NULL if compression fails.
+ */
+struct varlena *
+pglz_compress_datum(const struct varlena *value, Oid dictid)
+{
+	int32		valsize,
+				len;
+	struct varlena *tmp = NULL;
+
+	valsize = VARSIZE_ANY_EXHDR(value);
+
+	/*
+	 * No point in wasting a palloc cycle if value size is outside the allowed
+	 * range for compression.
+	 */
+	if (valsize < PGLZ_strategy_default->min_input_size ||
+		valsize > PGLZ_strategy_default->max_input_size)
+		return NULL;
+
+	/*
+	 * Figure out the maximum possible size of the pglz output, add the bytes
+	 * that will be needed for varlena overhead, and allocate that amount.
+	 */
+	tmp = (struct varlena *) palloc(PGLZ_MAX_OUTPUT(valsize) +
+									TOAST_COMPRESS_HDRSZ);
+
+	len = pglz_compress(VARDATA_ANY(value),
+						valsize,
+						(char *) tmp + TOAST_COMPRESS_HDRSZ,
+						NULL);
+	if (len < 0)
+	{
+		pfree(tmp);
+		return NULL;
+	}
+
+	SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+
+	return tmp;
+}
+
+/*
+ * Decompress a varlena that was compressed using PGLZ.
+ */
+struct varlena *
+pglz_decompress_datum(const struct varlena *value)
+{
+	struct varlena *result;
+	int32		rawsize;
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(VARDATA_COMPRESSED_GET_EXTSIZE(value) + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = pglz_decompress((char *) value + TOAST_COMPRESS_HDRSZ,
+							  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+							  VARDATA(result),
+							  VARDATA_COMPRESSED_GET_EXTSIZE(value), true);
+	if (rawsize < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed pglz data is corrupt")));
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+}
+
+/*
+ * Decompress part of a varlena that was compressed using PGLZ.
+ */
+struct varlena *
+pglz_decompress_datum_slice(const struct varlena *value,
+							int32 slicelength)
+{
+	struct varlena *result;
+	int32		rawsize;
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = pglz_decompress((char *) value + TOAST_COMPRESS_HDRSZ,
+							  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+							  VARDATA(result),
+							  slicelength, false);
+	if (rawsize < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed pglz data is corrupt")));
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+}
+
+/*
+ * Amount of PGLZ-compressed data needed to decompress a slice.
+ */
+int32
+pglz_compressed_slice_size(int32 slicelength, int32 rawsize,
+						   int32 compressed_size)
+{
+	return pglz_maximum_compressed_size(slicelength, compressed_size);
+}
+
+/*
+ * Compress a varlena using LZ4.
+ *
+ * Returns the compressed varlena, or NULL if compression fails.
+ */
+struct varlena *
+lz4_compress_datum(const struct varlena *value, Oid dictid)
+{
+#ifndef USE_LZ4
+	NO_LZ4_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize;
+	int32		len;
+	int32		max_size;
+	struct varlena *tmp = NULL;
+
+	valsize = VARSIZE_ANY_EXHDR(value);
+
+	/*
+	 * Figure out the maximum possible size of the LZ4 output, add the bytes
+	 * that will be needed for varlena overhead, and allocate that amount.
+	 */
+	max_size = LZ4_compressBound(valsize);
+	tmp = (struct varlena *) palloc(max_size + TOAST_COMPRESS_HDRSZ);
+
+	len = LZ4_compress_default(VARDATA_ANY(value),
+							   (char *) tmp + TOAST_COMPRESS_HDRSZ,
+							   valsize, max_size);
+	if (len <= 0)
+		elog(ERROR, "lz4 compression failed");
+
+	/* data is incompressible so just free the memory and return NULL */
+	if (len > valsize)
+	{
+		pfree(tmp);
+		return NULL;
+	}
+
+	SET_VARSIZE_COMPRESSED(tmp, len + TOAST_COMPRESS_HDRSZ);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using LZ4.
+ */
+struct varlena *
+lz4_decompress_datum(const struct varlena *value)
+{
+#ifndef USE_LZ4
+	NO_LZ4_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		rawsize;
+	struct varlena *result;
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(VARDATA_COMPRESSED_GET_EXTSIZE(value) + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = LZ4_decompress_safe((char *) value + TOAST_COMPRESS_HDRSZ,
+								  VARDATA(result),
+								  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+								  VARDATA_COMPRESSED_GET_EXTSIZE(value));
+	if (rawsize < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed lz4 data is corrupt")));
+
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Decompress part of a varlena that was compressed using LZ4.
+ */
+struct varlena *
+lz4_decompress_datum_slice(const struct varlena *value, int32 slicelength)
+{
+#ifndef USE_LZ4
+	NO_LZ4_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		rawsize;
+	struct varlena *result;
+
+	/* slice decompression not supported prior to 1.8.3 */
+	if (LZ4_versionNumber() < 10803)
+		return lz4_decompress_datum(value);
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+
+	/* decompress the data */
+	rawsize = LZ4_decompress_safe_partial((char *) value + TOAST_COMPRESS_HDRSZ,
+										  VARDATA(result),
+										  VARSIZE(value) - TOAST_COMPRESS_HDRSZ,
+										  slicelength,
+										  slicelength);
+	if (rawsize < 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed lz4 data is corrupt")));
+
+	SET_VARSIZE(result, rawsize + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Amount of LZ4-compressed data needed to decompress a slice.
+ *
+ * A sequence in an LZ4 block costs at most one byte per literal, plus a
+ * token, a 2-byte offset and one length byte per 255 bytes of literal or
+ * match length, and a match produces at least 4 bytes.  So the sequences
+ * up to and including the one that produces byte slicelength take no more
+ * than the compression bound of slicelength, except that the last of them
+ * may encode a match running far beyond the slice, with a length byte per
+ * 255 bytes of it.
+ */
+int32
+lz4_compressed_slice_size(int32 slicelength, int32 rawsize,
+						  int32 compressed_size)
+{
+#ifndef USE_LZ4
+	NO_LZ4_SUPPORT();
+	return 0;					/* keep compiler quiet */
+#else
+	int64		max_size;
+
+	/* releases before 1.9.4 can't be trusted with truncated input */
+	if (LZ4_versionNumber() < 10904)
+		return compressed_size;
+
+	max_size = (int64) LZ4_COMPRESSBOUND(slicelength) + rawsize / 255 + 1;
+
+	return (int32) Min(max_size, compressed_size);
+#endif
+}
+
+#ifdef USE_ZSTD
+/*
+ * Look up a dictionary in the backend-local cache, loading it from
+ * pg_zstd_dictionary if needed.
+ */
+static ZstdDictCacheEntry *
+zstd_get_dictionary(Oid dictid)
+{
+	ZstdDictCacheEntry *entry;
+	bytea	   *dict;
+	ZSTD_CDict *cdict;
+	ZSTD_DDict *ddict;
+
+	if (zstd_dict_cache == NULL)
+	{
+		HASHCTL		ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(Oid);
+		ctl.entrysize = sizeof(ZstdDictCacheEntry);
+		zstd_dict_cache = hash_create("zstd dictionary cache", 16, &ctl,
+									  HASH_ELEM | HASH_BLOBS);
+	}
+
+	entry = (ZstdDictCacheEntry *) hash_search(zstd_dict_cache, &dictid,
+											   HASH_FIND, NULL);
+	if (entry != NULL)
+		return entry;
+
+	dict = ZstdDictionaryGetData(dictid);
+	if (dict == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("zstd dictionary %u does not exist", dictid)));
+
+	/* both digest their own copy of the buffer */
+	cdict = ZSTD_createCDict(VARDATA(dict), VARSIZE(dict) - VARHDRSZ,
+							 ZSTD_CLEVEL_DEFAULT);
+	ddict = ZSTD_createDDict(VARDATA(dict), VARSIZE(dict) - VARHDRSZ);
+	pfree(dict);
+	if (cdict == NULL || ddict == NULL)
+	{
+		ZSTD_freeCDict(cdict);
+		ZSTD_freeDDict(ddict);
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory")));
+	}
+
+	entry = (ZstdDictCacheEntry *) hash_search(zstd_dict_cache, &dictid,
+											   HASH_ENTER, NULL);
+	entry->cdict = cdict;
+	entry->ddict = ddict;
+
+	return entry;
+}
+
+/*
+ * Return the backend's decompression context, creating it if needed.  It is
+ * reset first, since a dictionary referenced by an earlier call would
+ * otherwise stick to it.
+ */
+static ZSTD_DCtx *
+zstd_get_dctx(void)
+{
+	if (zstd_dctx == NULL)
+	{
+		zstd_dctx = ZSTD_createDCtx();
+		if (zstd_dctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+	else
+		ZSTD_DCtx_reset(zstd_dctx, ZSTD_reset_session_and_parameters);
+
+	return zstd_dctx;
+}
+#endif
+
+/*
+ * Compress a varlena using ZSTD, with the given dictionary if valid.
+ *
+ * Returns the compressed varlena, or NULL if compression fails.
+ */
+struct varlena *
+zstd_compress_datum(const struct varlena *value, Oid dictid)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		valsize;
+	size_t		max_size;
+	size_t		len;
+	struct varlena *tmp;
+
+	valsize = VARSIZE_ANY_EXHDR(value);
+
+	if (zstd_cctx == NULL)
+	{
+		zstd_cctx = ZSTD_createCCtx();
+		if (zstd_cctx == NULL)
+			ereport(ERROR,
+					(errcode(ERRCODE_OUT_OF_MEMORY),
+					 errmsg("out of memory")));
+	}
+
+	ZSTD_CCtx_reset(zstd_cctx, ZSTD_reset_session_and_parameters);
+	ZSTD_CCtx_setParameter(zstd_cctx, ZSTD_c_compressionLevel,
+						   ZSTD_CLEVEL_DEFAULT);
+	ZSTD_CCtx_setParameter(zstd_cctx, ZSTD_c_contentSizeFlag, 0);
+	ZSTD_CCtx_setParameter(zstd_cctx, ZSTD_c_checksumFlag, 0);
+	ZSTD_CCtx_setParameter(zstd_cctx, ZSTD_c_dictIDFlag, 0);
+	if (OidIsValid(dictid))
+		ZSTD_CCtx_refCDict(zstd_cctx, zstd_get_dictionary(dictid)->cdict);
+
+	/*
+	 * Figure out the maximum possible size of the ZSTD output, add the bytes
+	 * that will be needed for our headers, and allocate that amount.
+	 */
+	max_size = ZSTD_compressBound(valsize);
+	tmp = (struct varlena *) palloc(max_size + ZSTD_HDRSZ);
+
+	len = ZSTD_compress2(zstd_cctx, (char *) tmp + ZSTD_HDRSZ, max_size,
+						 VARDATA_ANY(value), valsize);
+	if (ZSTD_isError(len))
+		elog(ERROR, "zstd compression failed: %s", ZSTD_getErrorName(len));
+
+	/* data is incompressible so just free the memory and return NULL */
+	if (len > valsize)
+	{
+		pfree(tmp);
+		return NULL;
+	}
+
+	memcpy((char *) tmp + TOAST_COMPRESS_HDRSZ, &dictid, sizeof(Oid));
+	SET_VARSIZE_COMPRESSED(tmp, len + ZSTD_HDRSZ);
+
+	return tmp;
+#endif
+}
+
+/*
+ * Decompress a varlena that was compressed using ZSTD.
+ */
+struct varlena *
+zstd_decompress_datum(const struct varlena *value)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	int32		rawsize = VARDATA_COMPRESSED_GET_EXTSIZE(value);
+	Oid			dictid;
+	ZSTD_DCtx  *dctx = zstd_get_dctx();
+	size_t		len;
+	struct varlena *result;
+
+	memcpy(&dictid, (const char *) value + TOAST_COMPRESS_HDRSZ, sizeof(Oid));
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(rawsize + VARHDRSZ);
+
+	/* decompress the data */
+	if (OidIsValid(dictid))
+		len = ZSTD_decompress_usingDDict(dctx, VARDATA(result), rawsize,
+										 (const char *) value + ZSTD_HDRSZ,
+										 VARSIZE(value) - ZSTD_HDRSZ,
+										 zstd_get_dictionary(dictid)->ddict);
+	else
+		len = ZSTD_decompressDCtx(dctx, VARDATA(result), rawsize,
+								  (const char *) value + ZSTD_HDRSZ,
+								  VARSIZE(value) - ZSTD_HDRSZ);
+	if (ZSTD_isError(len) || len != rawsize)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed zstd data is corrupt")));
+
+	SET_VARSIZE(result, len + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Decompress part of a varlena that was compressed using ZSTD.
+ *
+ * The streaming API lets us stop as soon as the requested prefix has been
+ * produced, and copes with being given only part of the compressed data.
+ */
+struct varlena *
+zstd_decompress_datum_slice(const struct varlena *value, int32 slicelength)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return NULL;				/* keep compiler quiet */
+#else
+	Oid			dictid;
+	ZSTD_DCtx  *dctx = zstd_get_dctx();
+	ZSTD_inBuffer in;
+	ZSTD_outBuffer out;
+	size_t		ret = 1;
+	struct varlena *result;
+
+	memcpy(&dictid, (const char *) value + TOAST_COMPRESS_HDRSZ, sizeof(Oid));
+
+	if (OidIsValid(dictid))
+		ZSTD_DCtx_refDDict(dctx, zstd_get_dictionary(dictid)->ddict);
+
+	/* allocate memory for the uncompressed data */
+	result = (struct varlena *) palloc(slicelength + VARHDRSZ);
+
+	in.src = (const char *) value + ZSTD_HDRSZ;
+	in.size = VARSIZE(value) - ZSTD_HDRSZ;
+	in.pos = 0;
+	out.dst = VARDATA(result);
+	out.size = slicelength;
+	out.pos = 0;
+
+	while (out.pos < out.size && ret != 0)
+	{
+		size_t		prevpos = out.pos;
+
+		ret = ZSTD_decompressStream(dctx, &out, &in);
+		if (ZSTD_isError(ret))
+			ereport(ERROR,
+					(errcode(ERRCODE_DATA_CORRUPTED),
+					 errmsg_internal("compressed zstd data is corrupt")));
+
+		/* stop when out of input, once nothing buffered is left either */
+		if (in.pos >= in.size && out.pos == prevpos)
+			break;
+	}
+
+	/*
+	 * Running out of input before the end of the frame with the slice
+	 * incomplete means the caller fetched too little of the value.
+	 */
+	if (out.pos < out.size && ret != 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("compressed zstd data is truncated")));
+
+	SET_VARSIZE(result, out.pos + VARHDRSZ);
+
+	return result;
+#endif
+}
+
+/*
+ * Amount of ZSTD-compressed data needed to decompress a slice.
+ *
+ * zstd needs a whole block to decompress any of it.  A block stands for at
+ * most ZSTD_BLOCK_MAXSZ bytes and, since zstd stores a block raw when
+ * compressing it doesn't pay, takes at most 3 bytes more than it stands
+ * for.  The blocks up to and including the one that produces byte
+ * slicelength therefore take no more than the slice plus one more block,
+ * plus the frame and block headers.  We allow for blocks as small as 1kB,
+ * although our frames consist of full-size blocks, except the last.
+ */
+int32
+zstd_compressed_slice_size(int32 slicelength, int32 rawsize,
+						   int32 compressed_size)
+{
+#ifndef USE_ZSTD
+	NO_ZSTD_SUPPORT();
+	return 0;					/* keep compiler quiet */
+#else
+	int64		max_size;
+
+	max_size = (int64) sizeof(Oid) + ZSTD_FRAME_HEADER_MAXSZ +
+		slicelength + ZSTD_BLOCK_MAXSZ + 3 * (slicelength / 1024 + 2);
+
+	return (int32) Min(max_size, compressed_size);
+#endif
+}
+
+/*
+ * Look up the routine for the given attcompression value, which must be
+ * valid.
+ */
+const CompressionRoutine *
+GetCompressionRoutine(char cmethod)
+{
+	for (int i = 0; i < lengthof(compression_methods); i++)
+	{
+		if (compression_methods[i].cmethod == cmethod)
+			return &compression_methods[i];
+	}
+
+	elog(ERROR, "invalid compression method %c", cmethod);
+	return NULL;				/* keep compiler quiet */
+}
+
+/*
+ * Look up the routine for the compression method ID found in a compressed
+ * datum.
+ */
+const CompressionRoutine *
+GetCompressionRoutineById(ToastCompressionId cmid)
+{
+	if ((int) cmid < 0 || cmid >= lengthof(compression_methods))
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg_internal("invalid compression method id %d", cmid)));
+
+	return &compression_methods[cmid];
+}
+
+/*
+ * Extract compression ID from a varlena.
+ *
+ * Returns TOAST_INVALID_COMPRESSION_ID if the varlena is not compressed.
+ */
+ToastCompressionId
+toast_get_compression_id(struct varlena *attr)
+{
+	ToastCompressionId cmid = TOAST_INVALID_COMPRESSION_ID;
+
+	/*
+	 * If it is stored externally then fetch the compression method id from
+	 * the external toast pointer.  If compressed inline, fetch it from the
+	 * toast compression header.
+	 */
+	if (VARATT_IS_EXTERNAL_ONDISK(attr))
+	{
+		struct varatt_external toast_pointer;
+
+		VARATT_EXTERNAL_GET_POINTER(toast_pointer, attr);
+
+		if (VARATT_EXTERNAL_IS_COMPRESSED(toast_pointer))
+			cmid = VARATT_EXTERNAL_GET_COMPRESS_METHOD(toast_pointer);
+	}
+	else if (VARATT_IS_COMPRESSED(attr))
+		cmid = VARDATA_COMPRESSED_GET_COMPRESS_METHOD(attr);
+
+	return cmid;
+}
+
+/*
+ * CompressionNameToMethod - Get compression method from compression name
+ *
+ * Search in the available built-in methods.  If the compression not found
+ * in the built-in methods then return InvalidCompressionMethod.
+ */
+char
+CompressionNameToMethod(const char *compression)
+{
+	if (strcmp(compression, "pglz") == 0)
+		return TOAST_PGLZ_COMPRESSION;
+	else if (strcmp(compression, "lz4") == 0)
+	{
+#ifndef USE_LZ4
+		NO_LZ4_SUPPORT();
+#endif
+		return TOAST_LZ4_COMPRESSION;
+	}
+	else if (strcmp(compression, "zstd") == 0)
+	{
+#ifndef USE_ZSTD
+		NO_ZSTD_SUPPORT();
+#endif
+		return TOAST_ZSTD_COMPRESSION;
+	}
+
+	return InvalidCompressionMethod;
+}
+
+/*
+ * GetCompressionMethodName - Get compression method name
+ */
+const char *
+GetCompressionMethodName(char method)
+{
+	return GetCompressionRoutine(method)->cmname;
+}
@@ -0,0 +1,472 @@
+/*-------------------------------------------------------------------------
+ *
+ * colcache.c
+ *	  Columnar cache of the attribute offsets on all-visible heap pages.
+ *
+ * Deforming a heap tuple has to walk its attributes from the first one,
+ * because the offset of an attribute depends on the lengths of all the
+ * variable-width and null attributes before it; attcacheoff only helps up to
+ * the first of those.  For tables that are scanned over and over, this cache
+ * remembers where each attribute of each tuple starts, column by column, so
+ * that a scan can fetch the attributes it needs directly, and fetch a column
+ * of a batch of rows without deforming the rows at all.
+ *
+ * The cache lives in shared memory, columnar_cache_size in total, and holds
+ * pages of tables that have the columnar_cache storage parameter set.  A
+ * sequential scan loads the entry of each all-visible page it reads,
+ * building it from the page if no other backend has done so yet.  Since
+ * only the page's share lock is held while the page is examined, the entry
+ * is copied into backend-local memory, so that tuples can be deformed from
+ * it without any locking; the local copies are looked up by buffer.
+ *
+ * An entry is tagged with the page's LSN, and only used if the page still
+ * has the same LSN: the tuples on a pinned page never move, and any change
+ * that could move or replace them, such as pruning, is WAL-logged, so that
+ * suffices to tell whether the entry still describes the page.  That is
+ * why only WAL-logged relations are cached.  Entries of pages that are no
+ * longer all-visible are removed from the shared cache when their
+ * visibility map bit is cleared, to make room for other pages, but stale
+ * entries are harmless otherwise.
+ *
+ * Replacement uses a simple clock sweep.  ColumnarCacheLock protects the
+ * lookup table and the slots.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/heap/colcache.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/colcache.h"
+#include "access/htup_details.h"
+#include "access/tupmacs.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/lwlock.h"
+#include "storage/shmem.h"
+#include "utils/hsearch.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+
+/* GUC variable */
+int			columnar_cache_size = 0;
+
+bool		ColumnarCacheInUse = false;
+
+/* size of a slot; entries that don't fit cache fewer attributes */
+#define COLCACHE_SLOT_SIZE		(BLCKSZ / 2)
+
+/* number of entries copied into backend-local memory */
+#define COLCACHE_LOCAL_PAGES	64
+
+#define ColumnarPageSize(maxoff, natts) \
+	(offsetof(ColumnarPage, data) + \
+	 sizeof(uint16) * (maxoff) * ((natts) + 1))
+
+typedef struct ColumnarCacheTag
+{
+	RelFileNode rnode;
+	BlockNumber blkno;
+} ColumnarCacheTag;
+
+/* entry of the lookup table */
+typedef struct ColumnarCacheEnt
+{
+	ColumnarCacheTag tag;		/* hash key, must be first */
+	int			slot;			/* slot holding the page's entry */
+} ColumnarCacheEnt;
+
+typedef struct ColumnarCacheSlot
+{
+	ColumnarCacheTag tag;
+	bool		valid;			/* does the slot hold an entry? */
+	bool		referenced;		/* used since the clock hand last passed? */
+} ColumnarCacheSlot;
+
+typedef struct ColumnarCacheCtlData
+{
+	int			nslots;
+	int			nextVictim;		/* clock hand */
+	ColumnarCacheSlot slots[FLEXIBLE_ARRAY_MEMBER];
+} ColumnarCacheCtlData;
+
+static ColumnarCacheCtlData *ColumnarCacheCtl = NULL;
+static HTAB *ColumnarCacheHash = NULL;
+static char *ColumnarCacheData = NULL;
+
+#define ColumnarCacheSlotPage(slot) \
+	((ColumnarPage *) (ColumnarCacheData + (Size) (slot) * COLCACHE_SLOT_SIZE))
+
+/* backend-local copies of entries, indexed by buffer */
+static Buffer LocalBuffers[COLCACHE_LOCAL_PAGES];
+static ColumnarPage *LocalPages[COLCACHE_LOCAL_PAGES];
+
+static int	ColumnarCacheNSlots(void);
+static bool columnar_page_build(TupleDesc tupdesc, Page page,
+								ColumnarPage *cpage);
+static void columnar_cache_insert(ColumnarCacheTag *tag, ColumnarPage *cpage);
+
+
+static int
+ColumnarCacheNSlots(void)
+{
+	return (int) (((int64) columnar_cache_size * 1024) / COLCACHE_SLOT_SIZE);
+}
+
+/*
+ * ColumnarCacheShmemSize --- report amount of shared memory space needed
+ */
+Size
+ColumnarCacheShmemSize(void)
+{
+	int			nslots = ColumnarCacheNSlots();
+	Size		size;
+
+	if (nslots == 0)
+		return 0;
+
+	size = MAXALIGN(add_size(offsetof(ColumnarCacheCtlData, slots),
+							 mul_size(nslots, sizeof(ColumnarCacheSlot))));
+	size = add_size(size, mul_size(nslots, COLCACHE_SLOT_SIZE));
+	size = add_size(size, hash_estimate_size(nslots, sizeof(ColumnarCacheEnt)));
+
+	return size;
+}
+
+/*
+ * ColumnarCacheShmemInit --- initialize this module's shared memory
+ */
+void
+ColumnarCacheShmemInit(void)
+{
+	int			nslots = ColumnarCacheNSlots();
+	Size		ctlsize;
+	HASHCTL		info;
+	bool		found;
+
+	if (nslots == 0)
+		return;
+
+	ctlsize = MAXALIGN(offsetof(ColumnarCacheCtlData, slots) +
+					   nslots * sizeof(ColumnarCacheSlot));
+	ColumnarCacheCtl = (ColumnarCacheCtlData *)
+		ShmemInitStruct("Columnar Cache",
+						ctlsize + (Size) nslots * COLCACHE_SLOT_SIZE,
+						&found);
+	ColumnarCacheData = (char *) ColumnarCacheCtl + ctlsize;
+
+	info.keysize = sizeof(ColumnarCacheTag);
+	info.entrysize = sizeof(ColumnarCacheEnt);
+	ColumnarCacheHash = ShmemInitHash("Columnar Cache Lookup Table",
+									  nslots, nslots,
+									  &info,
+									  HASH_ELEM | HASH_BLOBS);
+
+	if (!IsUnderPostmaster)
+	{
+		Assert(!found);
+
+		ColumnarCacheCtl->nslots = nslots;
+		ColumnarCacheCtl->nextVictim = 0;
+		memset(ColumnarCacheCtl->slots, 0, nslots * sizeof(ColumnarCacheSlot));
+	}
+	else
+		Assert(found);
+}
+
+/*
+ * ColumnarCacheEnabled
+ *		Should scans of the relation load its pages into the cache?
+ */
+bool
+ColumnarCacheEnabled(Relation rel)
+{
+	return ColumnarCacheCtl != NULL &&
+		RelationUsesColumnarCache(rel) &&
+		RelationNeedsWAL(rel);
+}
+
+/*
+ * ColumnarCacheLoad
+ *		Make the cache entry of an all-visible page available to
+ *		ColumnarCacheLookup.
+ *
+ * The caller must hold a pin and a share lock on the buffer.  The entry is
+ * taken from the shared cache if it's there, and built and added to it
+ * otherwise.
+ */
+void
+ColumnarCacheLoad(Relation rel, Buffer buffer)
+{
+	Page		page = BufferGetPage(buffer);
+	XLogRecPtr	lsn = PageGetLSN(page);
+	int			i = (uint32) buffer % COLCACHE_LOCAL_PAGES;
+	ColumnarCacheTag tag;
+	ColumnarCacheEnt *ent;
+	ColumnarPage *cpage;
+
+	Assert(PageIsAllVisible(page));
+
+	/* a page that was never WAL-logged can't be told apart by its LSN */
+	if (XLogRecPtrIsInvalid(lsn))
+		return;
+
+	tag.rnode = rel->rd_node;
+	tag.blkno = BufferGetBlockNumber(buffer);
+
+	if (LocalPages[i] == NULL)
+		LocalPages[i] = MemoryContextAlloc(TopMemoryContext,
+										   COLCACHE_SLOT_SIZE);
+	cpage = LocalPages[i];
+	ColumnarCacheInUse = true;
+
+	/* Do we have it already? */
+	if (LocalBuffers[i] == buffer &&
+		RelFileNodeEquals(cpage->rnode, tag.rnode) &&
+		cpage->blkno == tag.blkno && cpage->lsn == lsn)
+		return;
+
+	LocalBuffers[i] = InvalidBuffer;
+
+	LWLockAcquire(ColumnarCacheLock, LW_SHARED);
+	ent = (ColumnarCacheEnt *) hash_search(ColumnarCacheHash, &tag,
+										   HASH_FIND, NULL);
+	if (ent != NULL)
+	{
+		ColumnarPage *spage = ColumnarCacheSlotPage(ent->slot);
+
+		if (spage->lsn == lsn)
+		{
+			memcpy(cpage, spage, ColumnarPageSize(spage->maxoff, spage->natts));
+			/* a racy update, but it's only a hint for the clock sweep */
+			ColumnarCacheCtl->slots[ent->slot].referenced = true;
+			LWLockRelease(ColumnarCacheLock);
+
+			LocalBuffers[i] = buffer;
+			return;
+		}
+	}
+	LWLockRelease(ColumnarCacheLock);
+
+	cpage->rnode = tag.rnode;
+	cpage->blkno = tag.blkno;
+	cpage->lsn = lsn;
+	if (!columnar_page_build(RelationGetDescr(rel), page, cpage))
+		return;
+
+	LocalBuffers[i] = buffer;
+	columnar_cache_insert(&tag, cpage);
+}
+
+/*
+ * ColumnarCacheLookup
+ *		Return the loaded cache entry of the page holding a tuple, or NULL if
+ *		there's none that is valid.
+ *
+ * The tuple must be on the page in the buffer, which the caller has pinned.
+ */
+ColumnarPage *
+ColumnarCacheLookup(Buffer buffer, HeapTuple tuple)
+{
+	int			i = (uint32) buffer % COLCACHE_LOCAL_PAGES;
+	ColumnarPage *cpage;
+	Page		page;
+	OffsetNumber offnum;
+	RelFileNode rnode;
+	ForkNumber	forknum;
+	BlockNumber blkno;
+
+	if (LocalBuffers[i] != buffer)
+		return NULL;
+
+	cpage = LocalPages[i];
+	page = BufferGetPage(buffer);
+	if (cpage->lsn != PageGetLSN(page))
+		return NULL;
+
+	BufferGetTag(buffer, &rnode, &forknum, &blkno);
+	if (!RelFileNodeEquals(cpage->rnode, rnode) || cpage->blkno != blkno)
+		return NULL;
+
+	/* check that it's really the tuple on the page, not a copy */
+	offnum = ItemPointerGetOffsetNumber(&tuple->t_self);
+	if (offnum < FirstOffsetNumber || offnum > cpage->maxoff ||
+		(char *) tuple->t_data !=
+		(char *) page + ColumnarPageOffset(cpage, 0, offnum))
+		return NULL;
+
+	return cpage;
+}
+
+/*
+ * ColumnarCacheInvalidate
+ *		Remove the entry of a page that's no longer all-visible.
+ *
+ * This is called from visibilitymap_clear(), possibly in a critical section.
+ */
+void
+ColumnarCacheInvalidate(Relation rel, BlockNumber blkno)
+{
+	ColumnarCacheTag tag;
+	ColumnarCacheEnt *ent;
+
+	if (ColumnarCacheCtl == NULL || !RelationUsesColumnarCache(rel))
+		return;
+
+	tag.rnode = rel->rd_node;
+	tag.blkno = blkno;
+
+	LWLockAcquire(ColumnarCacheLock, LW_EXCLUSIVE);
+	ent = (ColumnarCacheEnt *) hash_search(ColumnarCacheHash, &tag,
+										   HASH_FIND, NULL);
+	if (ent != NULL)
+	{
+		ColumnarCacheCtl->slots[ent->slot].valid = false;
+		hash_search(ColumnarCacheHash, &tag, HASH_REMOVE, NULL);
+	}
+	LWLockRelease(ColumnarCacheLock);
+}
+
+/*
+ * Build the cache entry of a page into *cpage, whose tag the caller has
+ * filled in.  Returns false if the page can't be cached.
+ */
+static bool
+columnar_page_build(TupleDesc tupdesc, Page page, ColumnarPage *cpage)
+{
+	OffsetNumber maxoff = PageGetMaxOffsetNumber(page);
+	OffsetNumber offnum;
+	int			natts;
+
+	if (maxoff == InvalidOffsetNumber)
+		return false;
+
+	/* cache as many attributes as fit in a slot */
+	natts = (COLCACHE_SLOT_SIZE - offsetof(ColumnarPage, data)) /
+		(sizeof(uint16) * maxoff) - 1;
+	natts = Min(natts, tupdesc->natts);
+	if (natts <= 0)
+		return false;
+
+	cpage->maxoff = maxoff;
+	cpage->natts = natts;
+
+	for (offnum = FirstOffsetNumber; offnum <= maxoff; offnum++)
+	{
+		ItemId		lp = PageGetItemId(page, offnum);
+		HeapTupleHeader tup;
+		bits8	   *bp;
+		bool		hasnulls;
+		char	   *tp;
+		uint32		off = 0;
+		int			tupnatts;
+		int			attnum;
+
+		if (!ItemIdIsNormal(lp))
+		{
+			for (attnum = 0; attnum <= natts; attnum++)
+				ColumnarPageOffset(cpage, attnum, offnum) = 0;
+			continue;
+		}
+
+		tup = (HeapTupleHeader) PageGetItem(page, lp);
+		bp = tup->t_bits;
+		hasnulls = (tup->t_infomask & HEAP_HASNULL) != 0;
+		tp = (char *) tup + tup->t_hoff;
+		tupnatts = Min(HeapTupleHeaderGetNatts(tup), natts);
+
+		ColumnarPageOffset(cpage, 0, offnum) = ItemIdGetOffset(lp);
+
+		/* this walk mirrors slot_deform_heap_tuple() */
+		for (attnum = 0; attnum < tupnatts; attnum++)
+		{
+			Form_pg_attribute thisatt = TupleDescAttr(tupdesc, attnum);
+
+			if (hasnulls && att_isnull(attnum, bp))
+			{
+				ColumnarPageOffset(cpage, attnum + 1, offnum) = 0;
+				continue;
+			}
+
+			if (thisatt->attlen == -1)
+				off = att_align_pointer(off, thisatt->attalign, -1,
+										tp + off);
+			else
+				off = att_align_nominal(off, thisatt->attalign);
+
+			ColumnarPageOffset(cpage, attnum + 1, offnum) =
+				(tp + off) - (char *) page;
+
+			off = att_addlength_pointer(off, thisatt->attlen, tp + off);
+		}
+		for (; attnum < natts; attnum++)
+			ColumnarPageOffset(cpage, attnum + 1, offnum) = 0;
+	}
+
+	return true;
+}
+
+/*
+ * Add a page's entry to the shared cache, evicting another one if needed.
+ */
+static void
+columnar_cache_insert(ColumnarCacheTag *tag, ColumnarPage *cpage)
+{
+	ColumnarCacheEnt *ent;
+	ColumnarCacheSlot *slot;
+	int			victim;
+	bool		found;
+
+	LWLockAcquire(ColumnarCacheLock, LW_EXCLUSIVE);
+
+	ent = (ColumnarCacheEnt *) hash_search(ColumnarCacheHash, tag,
+										   HASH_FIND, NULL);
+	if (ent != NULL)
+		victim = ent->slot;
+	else
+	{
+		/* run the clock sweep until we find a slot that wasn't used */
+		for (;;)
+		{
+			victim = ColumnarCacheCtl->nextVictim;
+			if (++ColumnarCacheCtl->nextVictim >= ColumnarCacheCtl->nslots)
+				ColumnarCacheCtl->nextVictim = 0;
+
+			slot = &ColumnarCacheCtl->slots[victim];
+			if (!slot->valid)
+				break;
+			if (!slot->referenced)
+			{
+				hash_search(ColumnarCacheHash, &slot->tag, HASH_REMOVE, NULL);
+				slot->valid = false;
+				break;
+			}
+			slot->referenced = false;
+		}
+
+		ent = (ColumnarCacheEnt *) hash_search(ColumnarCacheHash, tag,
+											   HASH_ENTER_NULL, &found);
+		if (ent == NULL)
+		{
+			/* can't happen, since there's an entry per slot at most */
+			LWLockRelease(ColumnarCacheLock);
+			return;
+		}
+		Assert(!found);
+		ent->slot = victim;
+	}
+
+	slot = &ColumnarCacheCtl->slots[victim];
+	slot->tag = *tag;
+	slot->valid = true;
+	slot->referenced = true;
+	memcpy(ColumnarCacheSlotPage(victim), cpage,
+		   ColumnarPageSize(cpage->maxoff, cpage->natts));
+
+	LWLockRelease(ColumnarCacheLock);
+}
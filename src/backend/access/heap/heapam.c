@@ -32,6 +32,7 @@
 #include "postgres.h"
 
 #include "access/bufmask.h"
+#include "access/colcache.h"
 #include "access/genam.h"
 #include "access/heapam.h"
 #include "access/heapam_xlog.h"
@@ -302,6 +303,8 @@ initscan(HeapScanDesc scan, ScanKey key, bool keep_startblock)
 	ItemPointerSetInvalid(&scan->rs_ctup.t_self);
 	scan->rs_cbuf = InvalidBuffer;
 	scan->rs_cblock = InvalidBlockNumber;
+	scan->rs_nreadahead = 0;
+	scan->rs_ranext = 0;
 
 	/* page-at-a-time fields are always invalid when not rs_inited */
 
@@ -342,6 +345,65 @@ heap_setscanlimits(TableScanDesc sscan, BlockNumber startBlk, BlockNumber numBlk
 	scan->rs_numblocks = numBlks;
 }
 
+/*
+ * heap_release_readahead - unpin any buffers read ahead but not yet used
+ */
+static void
+heap_release_readahead(HeapScanDesc scan)
+{
+	while (scan->rs_ranext < scan->rs_nreadahead)
+		ReleaseBuffer(scan->rs_readahead[scan->rs_ranext++]);
+	scan->rs_nreadahead = scan->rs_ranext = 0;
+}
+
+/*
+ * heap_getbuffer - pin the given page of the relation for heapgetpage
+ *
+ * A plain, serial sequential scan using a bulk-read strategy reads the
+ * following pages along with the requested one, so that runs of pages not
+ * in shared buffers are read with one system call (see ReadBuffersRange).
+ * The extra pages stay pinned until the scan gets to them.
+ */
+static Buffer
+heap_getbuffer(HeapScanDesc scan, BlockNumber page, BlockNumber prevpage)
+{
+	BlockNumber end;
+	int			nblocks;
+
+	/* Use a buffer read ahead earlier, if we have the right one */
+	if (scan->rs_ranext < scan->rs_nreadahead &&
+		scan->rs_rablock + scan->rs_ranext == page)
+		return scan->rs_readahead[scan->rs_ranext++];
+
+	/* The scan went elsewhere, so forget them */
+	heap_release_readahead(scan);
+
+	/*
+	 * Read ahead only in the forward direction, up to the end of the range
+	 * this scan covers: for a synchronized scan that started in the middle
+	 * of the relation and wrapped around, that is the starting block.
+	 */
+	if (scan->rs_strategy == NULL ||
+		scan->rs_base.rs_parallel != NULL ||
+		!(scan->rs_base.rs_flags & SO_TYPE_SEQSCAN) ||
+		scan->rs_numblocks != InvalidBlockNumber ||
+		(prevpage != InvalidBlockNumber && prevpage + 1 != page &&
+		 !(page == 0 && prevpage == scan->rs_nblocks - 1)))
+		return ReadBufferExtended(scan->rs_base.rs_rd, MAIN_FORKNUM, page,
+								  RBM_NORMAL, scan->rs_strategy);
+
+	end = page >= scan->rs_startblock ? scan->rs_nblocks : scan->rs_startblock;
+	nblocks = Min(end - page, MAX_BUFFERS_PER_READ);
+
+	scan->rs_nreadahead = ReadBuffersRange(scan->rs_base.rs_rd, MAIN_FORKNUM,
+										   page, nblocks, scan->rs_strategy,
+										   scan->rs_readahead);
+	scan->rs_rablock = page;
+	scan->rs_ranext = 1;
+
+	return scan->rs_readahead[0];
+}
+
 /*
  * heapgetpage - subroutine for heapgettup()
  *
@@ -379,8 +441,7 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 	CHECK_FOR_INTERRUPTS();
 
 	/* read page using selected strategy */
-	scan->rs_cbuf = ReadBufferExtended(scan->rs_base.rs_rd, MAIN_FORKNUM, page,
-									   RBM_NORMAL, scan->rs_strategy);
+	scan->rs_cbuf = heap_getbuffer(scan, page, scan->rs_cblock);
 	scan->rs_cblock = page;
 
 	if (!(scan->rs_base.rs_flags & SO_ALLOW_PAGEMODE))
@@ -455,6 +516,13 @@ heapgetpage(TableScanDesc sscan, BlockNumber page)
 		}
 	}
 
+	/*
+	 * Load the page's entry in the columnar cache while we still hold the
+	 * lock, so that the tuples we return can be deformed using it.
+	 */
+	if (all_visible && scan->rs_colcache)
+		ColumnarCacheLoad(scan->rs_base.rs_rd, buffer);
+
 	LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
 
 	Assert(ntup <= MaxHeapTuplesPerPage);
@@ -1198,6 +1266,10 @@ heap_beginscan(Relation relation, Snapshot snapshot,
 		PredicateLockRelation(relation, snapshot);
 	}
 
+	/* only sequential scans use the columnar cache */
+	scan->rs_colcache = (scan->rs_base.rs_flags & SO_TYPE_SEQSCAN) &&
+		ColumnarCacheEnabled(relation);
+
 	/* we only need to set this up once */
 	scan->rs_ctup.t_tableOid = RelationGetRelid(relation);
 
@@ -1245,6 +1317,7 @@ heap_rescan(TableScanDesc sscan, ScanKey key, bool set_params,
 	 */
 	if (BufferIsValid(scan->rs_cbuf))
 		ReleaseBuffer(scan->rs_cbuf);
+	heap_release_readahead(scan);
 
 	/*
 	 * reinitialize scan descriptor
@@ -1264,6 +1337,7 @@ heap_endscan(TableScanDesc sscan)
 	 */
 	if (BufferIsValid(scan->rs_cbuf))
 		ReleaseBuffer(scan->rs_cbuf);
+	heap_release_readahead(scan);
 
 	/*
 	 * decrement relation reference count and free scan descriptor storage
@@ -319,6 +319,19 @@ typedef struct LVRelStats
 	VacErrPhase phase;
 } LVRelStats;
 
+/*
+ * Heap pages lazy_scan_heap has read ahead and still holds pins on.  They
+ * are blocks first .. first + nbuffers - 1, of which the ones from index
+ * next on have not been processed yet.
+ */
+typedef struct LVReadAhead
+{
+	Buffer		buffers[MAX_BUFFERS_PER_READ];
+	BlockNumber first;
+	int			nbuffers;
+	int			next;
+} LVReadAhead;
+
 /* Struct for saving and restoring vacuum error information. */
 typedef struct LVSavedErrInfo
 {
@@ -365,6 +378,13 @@ static bool lazy_tid_reaped(ItemPointer itemptr, void *state);
 static int	vac_cmp_itemptr(const void *left, const void *right);
 static bool heap_page_is_all_visible(Relation rel, Buffer buf,
 									 TransactionId *visibility_cutoff_xid, bool *all_frozen);
+static bool lazy_mark_compressible(Relation onerel, Page page);
+static Buffer lazy_read_page(Relation onerel, VacuumParams *params,
+							 BlockNumber blkno, BlockNumber nblocks,
+							 BlockNumber next_unskippable_block,
+							 bool skipping_blocks, bool aggressive,
+							 Buffer *vmbuffer, LVReadAhead *readahead);
+static void lazy_release_readahead(LVReadAhead *readahead);
 static void lazy_parallel_vacuum_indexes(Relation *Irel, IndexBulkDeleteResult **stats,
 										 LVRelStats *vacrelstats, LVParallelState *lps,
 										 int nindexes);
@@ -780,6 +800,7 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 	Buffer		vmbuffer = InvalidBuffer;
 	BlockNumber next_unskippable_block;
 	bool		skipping_blocks;
+	LVReadAhead readahead;
 	xl_heap_freeze_tuple *frozen;
 	StringInfoData buf;
 	const int	initprog_index[] = {
@@ -804,6 +825,8 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 
 	empty_pages = vacuumed_pages = 0;
 	next_fsm_block_to_vacuum = (BlockNumber) 0;
+	readahead.first = 0;
+	readahead.nbuffers = readahead.next = 0;
 	num_tuples = live_tuples = tups_vacuumed = nkeep = nunused = 0;
 
 	indstats = (IndexBulkDeleteResult **)
@@ -1052,6 +1075,7 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 				ReleaseBuffer(vmbuffer);
 				vmbuffer = InvalidBuffer;
 			}
+			lazy_release_readahead(&readahead);
 
 			/* Work on all the indexes, then the heap */
 			lazy_vacuum_all_indexes(onerel, Irel, indstats,
@@ -1079,20 +1103,21 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 										 PROGRESS_VACUUM_PHASE_SCAN_HEAP);
 		}
 
+		buf = lazy_read_page(onerel, params, blkno, nblocks,
+							 next_unskippable_block, skipping_blocks,
+							 aggressive, &vmbuffer, &readahead);
+
 		/*
 		 * Pin the visibility map page in case we need to mark the page
 		 * all-visible.  In most cases this will be very cheap, because we'll
 		 * already have the correct page pinned anyway.  However, it's
-		 * possible that (a) next_unskippable_block is covered by a different
-		 * VM page than the current block or (b) we released our pin and did a
-		 * cycle of index vacuuming.
+		 * possible that (a) next_unskippable_block or a page read ahead is
+		 * covered by a different VM page than the current block or (b) we
+		 * released our pin and did a cycle of index vacuuming.
 		 *
 		 */
 		visibilitymap_pin(onerel, blkno, &vmbuffer);
 
-		buf = ReadBufferExtended(onerel, MAIN_FORKNUM, blkno,
-								 RBM_NORMAL, vac_strategy);
-
 		/* We need buffer cleanup lock so that we can prune HOT chains. */
 		if (!ConditionalLockBufferForCleanup(buf))
 		{
@@ -1223,6 +1248,7 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 					log_newpage_buffer(buf, true);
 
 				PageSetAllVisible(page);
+				lazy_mark_compressible(onerel, page);
 				visibilitymap_set(onerel, blkno, buf, InvalidXLogRecPtr,
 								  vmbuffer, InvalidTransactionId,
 								  VISIBILITYMAP_ALL_VISIBLE | VISIBILITYMAP_ALL_FROZEN);
@@ -1558,7 +1584,10 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 			uint8		flags = VISIBILITYMAP_ALL_VISIBLE;
 
 			if (all_frozen)
+			{
 				flags |= VISIBILITYMAP_ALL_FROZEN;
+				lazy_mark_compressible(onerel, page);
+			}
 
 			/*
 			 * It should never be the case that the visibility map page is set
@@ -1631,6 +1660,8 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 			 * because setting the all-frozen bit doesn't cause recovery
 			 * conflicts.
 			 */
+			if (lazy_mark_compressible(onerel, page))
+				MarkBufferDirty(buf);
 			visibilitymap_set(onerel, blkno, buf, InvalidXLogRecPtr,
 							  vmbuffer, InvalidTransactionId,
 							  VISIBILITYMAP_ALL_FROZEN);
@@ -1653,6 +1684,8 @@ lazy_scan_heap(Relation onerel, VacuumParams *params, LVRelStats *vacrelstats,
 			RecordPageWithFreeSpace(onerel, blkno, freespace);
 	}
 
+	lazy_release_readahead(&readahead);
+
 	/* report that everything is scanned and vacuumed */
 	pgstat_progress_update_param(PROGRESS_VACUUM_HEAP_BLKS_SCANNED, blkno);
 
@@ -1986,6 +2019,8 @@ lazy_vacuum_page(Relation onerel, BlockNumber blkno, Buffer buffer,
 			flags |= VISIBILITYMAP_ALL_VISIBLE;
 		if ((vm_status & VISIBILITYMAP_ALL_FROZEN) == 0 && all_frozen)
 			flags |= VISIBILITYMAP_ALL_FROZEN;
+		if (all_frozen)
+			lazy_mark_compressible(onerel, page);
 
 		Assert(BufferIsValid(*vmbuffer));
 		if (flags != 0)
@@ -3056,6 +3091,92 @@ heap_page_is_all_visible(Relation rel, Buffer buf,
 	return all_visible;
 }
 
+/*
+ * lazy_read_page() -- pin a heap page for lazy_scan_heap.
+ *
+ * Along with the requested page, reads the following pages we know the scan
+ * will process, so that runs of them that are not in shared buffers are
+ * read with a single system call: all pages up to next_unskippable_block,
+ * unless we're skipping them, and after that any that the visibility map
+ * doesn't allow us to skip.  The extra pages stay pinned in *readahead until
+ * the scan gets to them.
+ */
+static Buffer
+lazy_read_page(Relation onerel, VacuumParams *params, BlockNumber blkno,
+			   BlockNumber nblocks, BlockNumber next_unskippable_block,
+			   bool skipping_blocks, bool aggressive, Buffer *vmbuffer,
+			   LVReadAhead *readahead)
+{
+	BlockNumber end;
+	BlockNumber ablkno;
+
+	/* Use a page read ahead earlier, releasing any we skipped over */
+	if (blkno >= readahead->first &&
+		blkno < readahead->first + readahead->nbuffers &&
+		blkno - readahead->first >= readahead->next)
+	{
+		while (readahead->first + readahead->next < blkno)
+			ReleaseBuffer(readahead->buffers[readahead->next++]);
+		return readahead->buffers[readahead->next++];
+	}
+	lazy_release_readahead(readahead);
+
+	end = Min(nblocks, blkno + MAX_BUFFERS_PER_READ);
+	for (ablkno = blkno + 1; ablkno < end; ablkno++)
+	{
+		if (ablkno < next_unskippable_block)
+		{
+			if (skipping_blocks)
+				break;
+		}
+		else if (ablkno > next_unskippable_block &&
+				 (params->options & VACOPT_DISABLE_PAGE_SKIPPING) == 0)
+		{
+			uint8		vmstatus;
+
+			vmstatus = visibilitymap_get_status(onerel, ablkno, vmbuffer);
+			if (aggressive ? (vmstatus & VISIBILITYMAP_ALL_FROZEN) != 0 :
+				(vmstatus & VISIBILITYMAP_ALL_VISIBLE) != 0)
+				break;
+		}
+	}
+
+	readahead->nbuffers = ReadBuffersRange(onerel, MAIN_FORKNUM, blkno,
+										   ablkno - blkno, vac_strategy,
+										   readahead->buffers);
+	readahead->first = blkno;
+	readahead->next = 1;
+
+	return readahead->buffers[0];
+}
+
+/*
+ * lazy_release_readahead() -- unpin the pages read ahead by lazy_read_page
+ * that lazy_scan_heap hasn't processed.
+ */
+static void
+lazy_release_readahead(LVReadAhead *readahead)
+{
+	while (readahead->next < readahead->nbuffers)
+		ReleaseBuffer(readahead->buffers[readahead->next++]);
+	readahead->nbuffers = readahead->next = 0;
+}
+
+/*
+ * If the relation has page_compression set, mark an all-frozen page as one
+ * that may be stored compressed on disk.  The caller must make sure that the
+ * buffer gets dirtied.  Returns true if the page wasn't marked already.
+ */
+static bool
+lazy_mark_compressible(Relation onerel, Page page)
+{
+	if (!RelationUsesPageCompression(onerel) || PageIsCompressible(page))
+		return false;
+
+	PageSetCompressible(page);
+	return true;
+}
+
 /*
  * Compute the number of parallel worker processes to request.  Both index
  * vacuum and index cleanup can be executed with parallel workers.  The index
@@ -86,6 +86,7 @@
  */
 #include "postgres.h"
 
+#include "access/colcache.h"
 #include "access/heapam_xlog.h"
 #include "access/visibilitymap.h"
 #include "access/xlog.h"
@@ -167,6 +168,10 @@ visibilitymap_clear(Relation rel, BlockNumber heapBlk, Buffer buf, uint8 flags)
 
 	LockBuffer(buf, BUFFER_LOCK_UNLOCK);
 
+	/* the page's columnar cache entry is of no further use */
+	if (cleared && (flags & VISIBILITYMAP_ALL_VISIBLE))
+		ColumnarCacheInvalidate(rel, heapBlk);
+
 	return cleared;
 }
 
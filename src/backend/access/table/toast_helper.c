@@ -19,6 +19,8 @@
 #include "access/toast_helper.h"
 #include "access/toast_internals.h"
 #include "catalog/pg_type_d.h"
+#include "catalog/pg_zstd_dictionary.h"
+#include "pgstat.h"
 
 
 /*
@@ -54,6 +56,7 @@ toast_tuple_init(ToastTupleContext *ttc)
 
 		ttc->ttc_attr[i].tai_colflags = 0;
 		ttc->ttc_attr[i].tai_oldexternal = NULL;
+		ttc->ttc_attr[i].tai_compression = att->attcompression;
 
 		if (ttc->ttc_oldvalues != NULL)
 		{
@@ -226,8 +229,31 @@ void
 toast_tuple_try_compression(ToastTupleContext *ttc, int attribute)
 {
 	Datum	   *value = &ttc->ttc_values[attribute];
-	Datum		new_value = toast_compress_datum(*value);
+	Datum		new_value;
 	ToastAttrInfo *attr = &ttc->ttc_attr[attribute];
+	char		cmethod = attr->tai_compression;
+	Oid			dictid = InvalidOid;
+	int32		rawsize = VARSIZE_ANY_EXHDR(DatumGetPointer(*value));
+	instr_time	start;
+
+	/* zstd uses the column's current dictionary, if one has been trained */
+	if (!CompressionMethodIsValid(cmethod))
+		cmethod = default_toast_compression;
+	if (cmethod == TOAST_ZSTD_COMPRESSION)
+		dictid = GetColumnZstdDictionary(RelationGetRelid(ttc->ttc_rel),
+										 attribute + 1);
+
+	if (pgstat_track_toast)
+		INSTR_TIME_SET_CURRENT(start);
+
+	new_value = toast_compress_datum(*value, cmethod, dictid);
+
+	if (pgstat_track_toast)
+		pgstat_count_toast_compression(RelationGetRelid(ttc->ttc_rel),
+									   attribute + 1, rawsize,
+									   DatumGetPointer(new_value) != NULL ?
+									   VARSIZE(DatumGetPointer(new_value)) : -1,
+									   start);
 
 	if (DatumGetPointer(new_value) != NULL)
 	{
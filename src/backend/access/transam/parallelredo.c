@@ -0,0 +1,780 @@
+/*-------------------------------------------------------------------------
+ *
+ * parallelredo.c
+ *	  Replay of WAL records by parallel redo workers.
+ *
+ * When recovery_parallel_workers > 0, the startup process launches that
+ * many redo workers (dynamic background workers) when redo starts, and
+ * hands them the records that modify exactly one block of a relation's main
+ * fork and whose redo routine needs nothing but that block: heap inserts,
+ * deletes, same-page updates and locks, btree leaf inserts, and full-page
+ * images.  The worker is chosen by the block, so the records for any one
+ * block are replayed in WAL order, by the same worker.  Each worker has a
+ * shm_mq in the main shared memory segment, through which the startup
+ * process sends it the records, and decodes and replays them itself.
+ *
+ * All other records, those that touch several blocks or non-relation state
+ * such as transaction status, the relation files themselves, or hot
+ * standby's knowledge of running transactions, are a barrier: the startup
+ * process waits until the workers have replayed everything sent to them,
+ * and then replays the record itself as usual.  So the state hot standby
+ * queries see at a commit or abort record, or at any other consistency
+ * point, is the same as in serial replay; only the changes to different
+ * blocks between two barriers may be applied in a different order.
+ * Records that need a recovery conflict to be resolved are never handed to
+ * workers.
+ *
+ * Before reaching a consistent state, references to missing pages are
+ * remembered until the relation is dropped or truncated, or consistency is
+ * reached; a worker passes those it finds on to the startup process, which
+ * collects them whenever it waits for the workers.  Concurrent extension of
+ * a relation by several workers is serialized with RecoveryExtensionLock in
+ * XLogReadBufferExtended().
+ *
+ * A worker that fails exits, like a background worker does; the startup
+ * process notices and fails too, as if it had failed to replay the record
+ * itself.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/parallelredo.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/heapam_xlog.h"
+#include "access/nbtxlog.h"
+#include "access/parallelredo.h"
+#include "access/xact.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogutils.h"
+#include "catalog/pg_control.h"
+#include "common/hashfn.h"
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/startup.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shm_mq.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/spin.h"
+#include "utils/memutils.h"
+#include "utils/resowner.h"
+
+/* GUC variable */
+int			recovery_parallel_workers = 0;
+
+/* size of the queue of each worker */
+#define PARALLEL_REDO_QUEUE_SIZE	(512 * 1024)
+
+/*
+ * Shared state of a worker.  applied counts the messages the worker has
+ * processed, and is compared with the number the startup process has sent
+ * it to know when it has caught up.
+ */
+typedef struct ParallelRedoWorkerSlot
+{
+	pg_atomic_uint64 applied;
+	bool		exited;			/* the worker has exited */
+} ParallelRedoWorkerSlot;
+
+/* A reference to an invalid page found by a worker; see log_invalid_page() */
+typedef struct ParallelRedoInvalidPage
+{
+	RelFileNode node;
+	ForkNumber	forkno;
+	BlockNumber blkno;
+	bool		present;
+} ParallelRedoInvalidPage;
+
+#define MAX_INVALID_PAGE_REPORTS	64
+
+typedef struct ParallelRedoCtlData
+{
+	Latch	   *startup_latch;	/* set when a worker catches up or exits */
+	ParallelRedoWorkerSlot workers[MAX_PARALLEL_REDO_WORKERS];
+
+	/* invalid pages not yet collected by the startup process */
+	slock_t		mutex;			/* protects ninvalid and invalid */
+	int			ninvalid;
+	ParallelRedoInvalidPage invalid[MAX_INVALID_PAGE_REPORTS];
+} ParallelRedoCtlData;
+
+static ParallelRedoCtlData *ParallelRedoCtl = NULL;
+static char *ParallelRedoQueues = NULL;
+
+#define ParallelRedoQueue(id) \
+	((shm_mq *) (ParallelRedoQueues + (Size) (id) * PARALLEL_REDO_QUEUE_SIZE))
+
+/*
+ * A message to a worker: this header, followed by the record.  A header
+ * alone asks the worker to close its relation files, as some of them might
+ * have been dropped or truncated.
+ */
+typedef struct ParallelRedoMessage
+{
+	XLogRecPtr	ReadRecPtr;
+	XLogRecPtr	EndRecPtr;
+	bool		consistent;		/* reachedConsistency of the startup process */
+} ParallelRedoMessage;
+
+/* Startup process state: the workers that are running */
+typedef struct RedoWorker
+{
+	int			id;				/* slot and queue number */
+	shm_mq_handle *mqh;
+	uint64		sent;			/* number of messages sent */
+} RedoWorker;
+
+static RedoWorker redo_workers[MAX_PARALLEL_REDO_WORKERS];
+static int	nredo_workers = 0;
+
+/* the workers must close their files before their next record */
+static bool redo_files_changed = false;
+
+/* Worker state */
+static shm_mq_handle *redo_worker_mqh = NULL;
+
+static bool ParallelRedoGetBlock(XLogReaderState *record, RelFileNode *rnode,
+								 BlockNumber *blkno);
+static bool ParallelRedoDropsFiles(XLogReaderState *record);
+static void ParallelRedoSend(RedoWorker *worker, ParallelRedoMessage *msg,
+							 XLogRecord *record);
+static void ParallelRedoCollectInvalidPages(void);
+static void ParallelRedoStartupExit(int code, Datum arg);
+static void ParallelRedoWorkerExit(int code, Datum arg);
+static void parallel_redo_error_callback(void *arg);
+
+/*
+ * ParallelRedoShmemSize
+ *		Compute space needed for the workers' shared state and queues
+ */
+Size
+ParallelRedoShmemSize(void)
+{
+	Size		size;
+
+	if (recovery_parallel_workers == 0)
+		return 0;
+
+	size = sizeof(ParallelRedoCtlData);
+	size = add_size(size, mul_size(recovery_parallel_workers,
+								   PARALLEL_REDO_QUEUE_SIZE));
+
+	return size;
+}
+
+/*
+ * ParallelRedoShmemInit
+ *		Allocate the workers' shared state and queues
+ */
+void
+ParallelRedoShmemInit(void)
+{
+	bool		found;
+
+	if (recovery_parallel_workers == 0)
+		return;
+
+	ParallelRedoCtl = (ParallelRedoCtlData *)
+		ShmemInitStruct("Parallel Redo Control",
+						sizeof(ParallelRedoCtlData), &found);
+	ParallelRedoQueues = (char *)
+		ShmemInitStruct("Parallel Redo Queues",
+						mul_size(recovery_parallel_workers,
+								 PARALLEL_REDO_QUEUE_SIZE),
+						&found);
+
+	if (!found)
+	{
+		ParallelRedoCtl->startup_latch = NULL;
+		SpinLockInit(&ParallelRedoCtl->mutex);
+		ParallelRedoCtl->ninvalid = 0;
+	}
+}
+
+/*
+ * ParallelRedoStart
+ *		Launch the redo workers, if recovery_parallel_workers calls for them.
+ *
+ * Called by the startup process when redo starts.  If fewer workers can be
+ * started, those that could are used; if none, records are replayed
+ * serially.
+ */
+void
+ParallelRedoStart(void)
+{
+	BackgroundWorkerHandle *handles[MAX_PARALLEL_REDO_WORKERS];
+	int			nregistered;
+	int			i;
+
+	if (recovery_parallel_workers == 0 || !IsUnderPostmaster)
+		return;
+
+	ParallelRedoCtl->startup_latch = MyLatch;
+
+	for (nregistered = 0; nregistered < recovery_parallel_workers; nregistered++)
+	{
+		ParallelRedoWorkerSlot *slot = &ParallelRedoCtl->workers[nregistered];
+		shm_mq	   *mq;
+		BackgroundWorker bgw;
+
+		pg_atomic_init_u64(&slot->applied, 0);
+		slot->exited = false;
+
+		mq = shm_mq_create(ParallelRedoQueue(nregistered),
+						   PARALLEL_REDO_QUEUE_SIZE);
+		shm_mq_set_sender(mq, MyProc);
+
+		memset(&bgw, 0, sizeof(bgw));
+		bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		bgw.bgw_start_time = BgWorkerStart_PostmasterStart;
+		snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(bgw.bgw_function_name, BGW_MAXLEN, "ParallelRedoWorkerMain");
+		snprintf(bgw.bgw_name, BGW_MAXLEN, "parallel redo worker %d",
+				 nregistered);
+		snprintf(bgw.bgw_type, BGW_MAXLEN, "parallel redo worker");
+		bgw.bgw_restart_time = BGW_NEVER_RESTART;
+		bgw.bgw_notify_pid = 0;
+		bgw.bgw_main_arg = Int32GetDatum(nregistered);
+
+		if (!RegisterDynamicBackgroundWorker(&bgw, &handles[nregistered]))
+			break;
+	}
+
+	if (nregistered < recovery_parallel_workers)
+		ereport(LOG,
+				(errmsg("could only start %d of %d parallel redo workers",
+						nregistered, recovery_parallel_workers),
+				 errhint("You might need to increase max_worker_processes.")));
+
+	/*
+	 * The postmaster doesn't tell the startup process when its workers start,
+	 * so poll until each one has attached to its queue, or failed to start.
+	 */
+	for (i = 0; i < nregistered; i++)
+	{
+		shm_mq	   *mq = ParallelRedoQueue(i);
+
+		for (;;)
+		{
+			BgwHandleStatus status;
+			pid_t		pid;
+
+			if (shm_mq_get_receiver(mq) != NULL)
+			{
+				RedoWorker *worker = &redo_workers[nredo_workers++];
+
+				worker->id = i;
+				worker->mqh = shm_mq_attach(mq, NULL, NULL);
+				worker->sent = 0;
+				break;
+			}
+
+			status = GetBackgroundWorkerPid(handles[i], &pid);
+			if (status == BGWH_STOPPED)
+				break;
+
+			(void) WaitLatch(MyLatch,
+							 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+							 10L, WAIT_EVENT_BGWORKER_STARTUP);
+			ResetLatch(MyLatch);
+			HandleStartupProcInterrupts();
+		}
+		pfree(handles[i]);
+	}
+
+	if (nredo_workers > 0)
+		before_shmem_exit(ParallelRedoStartupExit, (Datum) 0);
+}
+
+/*
+ * ParallelRedoDispatch
+ *		Hand a record to a worker, if it can be replayed by one.
+ *
+ * Returns true if the record was handed to a worker, false if the caller
+ * must replay it, after calling ParallelRedoBarrier().
+ */
+bool
+ParallelRedoDispatch(XLogReaderState *record)
+{
+	ParallelRedoMessage msg;
+	RelFileNode rnode;
+	BlockNumber blkno;
+	uint32		hash;
+	int			i;
+
+	if (nredo_workers == 0 || !ParallelRedoGetBlock(record, &rnode, &blkno))
+		return false;
+
+	memset(&msg, 0, sizeof(ParallelRedoMessage));
+
+	if (redo_files_changed)
+	{
+		for (i = 0; i < nredo_workers; i++)
+			ParallelRedoSend(&redo_workers[i], &msg, NULL);
+		redo_files_changed = false;
+	}
+
+	hash = hash_bytes((const unsigned char *) &rnode, sizeof(RelFileNode));
+	hash = hash_combine(hash, hash_uint32(blkno));
+
+	msg.ReadRecPtr = record->ReadRecPtr;
+	msg.EndRecPtr = record->EndRecPtr;
+	msg.consistent = reachedConsistency;
+	ParallelRedoSend(&redo_workers[hash % nredo_workers], &msg,
+					 record->decoded_record);
+
+	return true;
+}
+
+/*
+ * ParallelRedoBarrier
+ *		Wait for the workers to replay everything handed to them, before the
+ *		startup process replays a record itself.
+ */
+void
+ParallelRedoBarrier(XLogReaderState *record)
+{
+	ParallelRedoWait();
+
+	/*
+	 * Relation sizes cached by smgr are only right as long as no other
+	 * process changes them; the workers extend relations, and we are about
+	 * to drop or truncate some.  So forget our own cached sizes, and have
+	 * the workers forget theirs.
+	 */
+	if (nredo_workers > 0 && ParallelRedoDropsFiles(record))
+	{
+		smgrcloseall();
+		redo_files_changed = true;
+	}
+}
+
+/*
+ * ParallelRedoFinish
+ *		Wait for the workers to replay everything, and let them exit.
+ *
+ * Called by the startup process at the end of redo.
+ */
+void
+ParallelRedoFinish(void)
+{
+	int			i;
+
+	if (nredo_workers == 0)
+		return;
+
+	ParallelRedoWait();
+
+	for (i = 0; i < nredo_workers; i++)
+		shm_mq_detach(redo_workers[i].mqh);
+	nredo_workers = 0;
+}
+
+/*
+ * Can this record be replayed by a worker?  If so, return the block it
+ * modifies.
+ */
+static bool
+ParallelRedoGetBlock(XLogReaderState *record, RelFileNode *rnode,
+					 BlockNumber *blkno)
+{
+	uint8		info = XLogRecGetInfo(record) & ~XLR_INFO_MASK;
+	ForkNumber	forknum;
+
+	/* Consistency checks are done by the startup process after redo */
+	if (record->max_block_id != 0 ||
+		(XLogRecGetInfo(record) & XLR_CHECK_CONSISTENCY) != 0)
+		return false;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_XLOG_ID:
+			if (info != XLOG_FPI && info != XLOG_FPI_FOR_HINT)
+				return false;
+			break;
+
+		case RM_HEAP_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP_INSERT:
+				case XLOG_HEAP_DELETE:
+				case XLOG_HEAP_UPDATE:
+				case XLOG_HEAP_HOT_UPDATE:
+				case XLOG_HEAP_CONFIRM:
+				case XLOG_HEAP_LOCK:
+					break;
+				default:
+					return false;
+			}
+			break;
+
+		case RM_HEAP2_ID:
+			switch (info & XLOG_HEAP_OPMASK)
+			{
+				case XLOG_HEAP2_MULTI_INSERT:
+				case XLOG_HEAP2_LOCK_UPDATED:
+					break;
+				default:
+					return false;
+			}
+			break;
+
+		case RM_BTREE_ID:
+			if (info != XLOG_BTREE_INSERT_LEAF)
+				return false;
+			break;
+
+		default:
+			return false;
+	}
+
+	if (!XLogRecGetBlockTag(record, 0, rnode, &forknum, blkno))
+		return false;
+
+	return forknum == MAIN_FORKNUM;
+}
+
+/*
+ * Might replaying this record drop or truncate relation files, which the
+ * workers would then have to close?
+ */
+static bool
+ParallelRedoDropsFiles(XLogReaderState *record)
+{
+	uint8		info = XLogRecGetInfo(record) & XLOG_XACT_OPMASK;
+
+	switch (XLogRecGetRmid(record))
+	{
+		case RM_SMGR_ID:
+		case RM_DBASE_ID:
+		case RM_TBLSPC_ID:
+			return true;
+
+		case RM_XACT_ID:
+			if (info == XLOG_XACT_COMMIT || info == XLOG_XACT_COMMIT_PREPARED)
+			{
+				xl_xact_parsed_commit parsed;
+
+				ParseCommitRecord(XLogRecGetInfo(record),
+								  (xl_xact_commit *) XLogRecGetData(record),
+								  &parsed);
+				return parsed.nrels > 0;
+			}
+			if (info == XLOG_XACT_ABORT || info == XLOG_XACT_ABORT_PREPARED)
+			{
+				xl_xact_parsed_abort parsed;
+
+				ParseAbortRecord(XLogRecGetInfo(record),
+								 (xl_xact_abort *) XLogRecGetData(record),
+								 &parsed);
+				return parsed.nrels > 0;
+			}
+			return false;
+
+		default:
+			return false;
+	}
+}
+
+/*
+ * Send a message to a worker, waiting for room in its queue if need be.
+ */
+static void
+ParallelRedoSend(RedoWorker *worker, ParallelRedoMessage *msg,
+				 XLogRecord *record)
+{
+	shm_mq_iovec iov[2];
+	shm_mq_result res;
+
+	iov[0].data = (const char *) msg;
+	iov[0].len = sizeof(ParallelRedoMessage);
+	if (record != NULL)
+	{
+		iov[1].data = (const char *) record;
+		iov[1].len = record->xl_tot_len;
+	}
+
+	/*
+	 * Don't block in shm_mq_sendv(): the worker might itself be waiting for
+	 * us to collect the invalid pages it has found.
+	 */
+	for (;;)
+	{
+		res = shm_mq_sendv(worker->mqh, iov, record != NULL ? 2 : 1, true);
+		if (res == SHM_MQ_SUCCESS)
+			break;
+		if (res == SHM_MQ_DETACHED)
+			ereport(FATAL,
+					(errmsg("parallel redo worker %d exited unexpectedly",
+							worker->id)));
+
+		(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, -1L,
+						 WAIT_EVENT_MQ_SEND);
+		ResetLatch(MyLatch);
+		HandleStartupProcInterrupts();
+		ParallelRedoCollectInvalidPages();
+	}
+
+	worker->sent++;
+}
+
+/*
+ * ParallelRedoWait
+ *		Wait until every worker has processed all the messages sent to it,
+ *		and collect the invalid pages they found.
+ */
+void
+ParallelRedoWait(void)
+{
+	int			i;
+
+	if (nredo_workers == 0)
+		return;
+
+	for (i = 0; i < nredo_workers; i++)
+	{
+		RedoWorker *worker = &redo_workers[i];
+		ParallelRedoWorkerSlot *slot = &ParallelRedoCtl->workers[worker->id];
+
+		while (pg_atomic_read_u64(&slot->applied) < worker->sent)
+		{
+			if (((volatile ParallelRedoWorkerSlot *) slot)->exited)
+				ereport(FATAL,
+						(errmsg("parallel redo worker %d exited unexpectedly",
+								worker->id)));
+
+			(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, -1L,
+							 WAIT_EVENT_PARALLEL_REDO_WORKERS);
+			ResetLatch(MyLatch);
+			HandleStartupProcInterrupts();
+			ParallelRedoCollectInvalidPages();
+		}
+	}
+
+	/* Make sure we see the workers' changes */
+	pg_memory_barrier();
+
+	ParallelRedoCollectInvalidPages();
+}
+
+/*
+ * Remember the invalid pages the workers have found, as if the startup
+ * process had found them itself.
+ */
+static void
+ParallelRedoCollectInvalidPages(void)
+{
+	ParallelRedoInvalidPage pages[MAX_INVALID_PAGE_REPORTS];
+	int			n;
+	int			i;
+
+	SpinLockAcquire(&ParallelRedoCtl->mutex);
+	n = ParallelRedoCtl->ninvalid;
+	memcpy(pages, ParallelRedoCtl->invalid, n * sizeof(ParallelRedoInvalidPage));
+	ParallelRedoCtl->ninvalid = 0;
+	SpinLockRelease(&ParallelRedoCtl->mutex);
+
+	for (i = 0; i < n; i++)
+		log_invalid_page(pages[i].node, pages[i].forkno, pages[i].blkno,
+						 pages[i].present);
+}
+
+/*
+ * Detach from the queues if the startup process exits during redo, so that
+ * the workers exit too.
+ */
+static void
+ParallelRedoStartupExit(int code, Datum arg)
+{
+	int			i;
+
+	for (i = 0; i < nredo_workers; i++)
+		shm_mq_detach(redo_workers[i].mqh);
+	nredo_workers = 0;
+}
+
+/*
+ * Main entry point for a parallel redo worker process
+ */
+void
+ParallelRedoWorkerMain(Datum main_arg)
+{
+	int			id = DatumGetInt32(main_arg);
+	ParallelRedoWorkerSlot *slot = &ParallelRedoCtl->workers[id];
+	shm_mq	   *mq = ParallelRedoQueue(id);
+	XLogReaderState *reader;
+	MemoryContext redo_context;
+	int			rmid;
+
+	BackgroundWorkerUnblockSignals();
+	CreateAuxProcessResourceOwner();
+
+	/* The redo routines expect to run in the startup process */
+	InRecovery = true;
+
+	on_shmem_exit(ParallelRedoWorkerExit, Int32GetDatum(id));
+
+	shm_mq_set_receiver(mq, MyProc);
+	redo_worker_mqh = shm_mq_attach(mq, NULL, NULL);
+
+	reader = XLogReaderAllocate(wal_segment_size, NULL,
+								XL_ROUTINE(.page_read = NULL), NULL);
+	if (!reader)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	for (rmid = 0; rmid <= RM_MAX_ID; rmid++)
+	{
+		if (RmgrTable[rmid].rm_startup != NULL)
+			RmgrTable[rmid].rm_startup();
+	}
+
+	redo_context = AllocSetContextCreate(TopMemoryContext,
+										 "parallel redo worker",
+										 ALLOCSET_DEFAULT_SIZES);
+
+	for (;;)
+	{
+		ParallelRedoMessage msg;
+		shm_mq_result res;
+		Size		nbytes;
+		void	   *data;
+
+		res = shm_mq_receive(redo_worker_mqh, &nbytes, &data, true);
+		if (res == SHM_MQ_WOULD_BLOCK)
+		{
+			/* Caught up; the startup process may be waiting for that */
+			SetLatch(ParallelRedoCtl->startup_latch);
+			res = shm_mq_receive(redo_worker_mqh, &nbytes, &data, false);
+		}
+
+		/* The startup process detaches at the end of redo */
+		if (res != SHM_MQ_SUCCESS)
+			break;
+
+		memcpy(&msg, data, sizeof(ParallelRedoMessage));
+
+		if (nbytes == sizeof(ParallelRedoMessage))
+			smgrcloseall();
+		else
+		{
+			XLogRecord *record;
+			ErrorContextCallback errcallback;
+			MemoryContext oldcontext;
+			char	   *errormsg;
+
+			record = (XLogRecord *) ((char *) data + sizeof(ParallelRedoMessage));
+			reachedConsistency = msg.consistent;
+			reader->ReadRecPtr = msg.ReadRecPtr;
+			reader->EndRecPtr = msg.EndRecPtr;
+			if (!DecodeXLogRecord(reader, record, &errormsg))
+				elog(ERROR, "could not decode WAL record at %X/%X: %s",
+					 (uint32) (msg.ReadRecPtr >> 32), (uint32) msg.ReadRecPtr,
+					 errormsg);
+
+			errcallback.callback = parallel_redo_error_callback;
+			errcallback.arg = (void *) reader;
+			errcallback.previous = error_context_stack;
+			error_context_stack = &errcallback;
+
+			oldcontext = MemoryContextSwitchTo(redo_context);
+			RmgrTable[record->xl_rmid].rm_redo(reader);
+			MemoryContextSwitchTo(oldcontext);
+			MemoryContextReset(redo_context);
+
+			error_context_stack = errcallback.previous;
+		}
+
+		pg_atomic_fetch_add_u64(&slot->applied, 1);
+	}
+
+	proc_exit(0);
+}
+
+/*
+ * ParallelRedoReportInvalidPage
+ *		In a worker, pass a reference to an invalid page on to the startup
+ *		process.  Returns false in any other process.
+ */
+bool
+ParallelRedoReportInvalidPage(RelFileNode node, ForkNumber forkno,
+							  BlockNumber blkno, bool present)
+{
+	if (redo_worker_mqh == NULL)
+		return false;
+
+	for (;;)
+	{
+		SpinLockAcquire(&ParallelRedoCtl->mutex);
+		if (ParallelRedoCtl->ninvalid < MAX_INVALID_PAGE_REPORTS)
+		{
+			ParallelRedoInvalidPage *page;
+
+			page = &ParallelRedoCtl->invalid[ParallelRedoCtl->ninvalid++];
+			page->node = node;
+			page->forkno = forkno;
+			page->blkno = blkno;
+			page->present = present;
+			SpinLockRelease(&ParallelRedoCtl->mutex);
+			return true;
+		}
+		SpinLockRelease(&ParallelRedoCtl->mutex);
+
+		/* Full; wait for the startup process to collect them */
+		SetLatch(ParallelRedoCtl->startup_latch);
+		pg_usleep(10000L);
+		CHECK_FOR_INTERRUPTS();
+	}
+}
+
+/*
+ * Let the startup process know that a worker has exited
+ */
+static void
+ParallelRedoWorkerExit(int code, Datum arg)
+{
+	int			id = DatumGetInt32(arg);
+
+	if (redo_worker_mqh != NULL)
+	{
+		shm_mq_detach(redo_worker_mqh);
+		redo_worker_mqh = NULL;
+	}
+
+	ParallelRedoCtl->workers[id].exited = true;
+	if (ParallelRedoCtl->startup_latch != NULL)
+		SetLatch(ParallelRedoCtl->startup_latch);
+}
+
+/*
+ * Error context callback for errors while replaying a record in a worker
+ */
+static void
+parallel_redo_error_callback(void *arg)
+{
+	XLogReaderState *record = (XLogReaderState *) arg;
+	RmgrId		rmid = XLogRecGetRmid(record);
+	const char *id;
+
+	id = RmgrTable[rmid].rm_identify(XLogRecGetInfo(record));
+
+	/* translator: first %s is a resource manager name, second a record type */
+	errcontext("WAL redo at %X/%X for %s/%s",
+			   (uint32) (record->ReadRecPtr >> 32),
+			   (uint32) record->ReadRecPtr,
+			   RmgrTable[rmid].rm_name,
+			   id != NULL ? id : "UNKNOWN");
+}
@@ -26,6 +26,7 @@
 #include "access/commit_ts.h"
 #include "access/heaptoast.h"
 #include "access/multixact.h"
+#include "access/parallelredo.h"
 #include "access/rewriteheap.h"
 #include "access/subtrans.h"
 #include "access/timeline.h"
@@ -35,6 +36,7 @@
 #include "access/xlog_internal.h"
 #include "access/xlogarchive.h"
 #include "access/xloginsert.h"
+#include "access/xlogprefetch.h"
 #include "access/xlogreader.h"
 #include "access/xlogutils.h"
 #include "catalog/catversion.h"
@@ -96,11 +98,12 @@ char	   *XLogArchiveCommand = NULL;
 bool		EnableHotStandby = false;
 bool		fullPageWrites = true;
 bool		wal_log_hints = false;
-bool		wal_compression = false;
+int			wal_compression = WAL_COMPRESSION_NONE;
 char	   *wal_consistency_checking_string = NULL;
 bool	   *wal_consistency_checking = NULL;
 bool		wal_init_zero = true;
 bool		wal_recycle = true;
+bool		wal_group_commit = true;
 bool		log_checkpoints = false;
 int			sync_method = DEFAULT_SYNC_METHOD;
 int			wal_level = WAL_LEVEL_MINIMAL;
@@ -116,11 +119,12 @@ bool		XLOG_DEBUG = false;
 int			wal_segment_size = DEFAULT_XLOG_SEG_SIZE;
 
 /*
- * Number of WAL insertion locks to use. A higher value allows more insertions
- * to happen concurrently, but adds some CPU overhead to flushing the WAL,
- * which needs to iterate all the locks.
+ * Number of WAL insertion locks to use (wal_insert_locks). A higher value
+ * allows more insertions to happen concurrently, but adds some CPU overhead
+ * to flushing the WAL, which needs to iterate all the locks.  -1 selects a
+ * number based on max_connections, see XLOGChooseNumInsertLocks().
  */
-#define NUM_XLOGINSERT_LOCKS  8
+int			NumXLogInsertLocks = -1;
 
 /*
  * Max distance from last checkpoint, before triggering a new xlog-based
@@ -615,6 +619,15 @@ typedef struct XLogCtlData
 	pg_time_t	lastSegSwitchTime;
 	XLogRecPtr	lastSegSwitchLSN;
 
+	/*
+	 * Group flushing: the list of processes waiting for a group leader to
+	 * flush WAL for them, and what the leaders observed.  The latter are
+	 * updated only while holding WALWriteLock, and read without it.
+	 */
+	pg_atomic_uint32 flushGroupFirst;
+	pg_atomic_uint64 flushGroupTimeAvg; /* recent time to flush, in usec */
+	pg_atomic_uint32 flushGroupSize;	/* members in the last group */
+
 	/*
 	 * Protected by info_lck and WALWriteLock (you must hold either lock to
 	 * read it, but both to update)
@@ -903,6 +916,8 @@ static XLogRecPtr XLogGetReplicationSlotMinimumLSN(void);
 static void AdvanceXLInsertBuffer(XLogRecPtr upto, bool opportunistic);
 static bool XLogCheckpointNeeded(XLogSegNo new_segno);
 static void XLogWrite(XLogwrtRqst WriteRqst, bool flexible);
+static void XLogFlushSingle(XLogRecPtr record);
+static void XLogFlushGroup(XLogRecPtr record);
 static bool InstallXLogFileSegment(XLogSegNo *segno, char *tmppath,
 								   bool find_free, XLogSegNo max_segno,
 								   bool use_lock);
@@ -1036,7 +1051,7 @@ XLogInsertRecord(XLogRecData *rdata,
 	 * inserter acquires an insertion lock. In addition to just indicating that
 	 * an insertion is in progress, the lock tells others how far the inserter
 	 * has progressed. There is a small fixed number of insertion locks,
-	 * determined by NUM_XLOGINSERT_LOCKS. When an inserter crosses a page
+	 * determined by wal_insert_locks. When an inserter crosses a page
 	 * boundary, it updates the value stored in the lock to the how far it has
 	 * inserted, to allow the previous buffer to be flushed.
 	 *
@@ -1667,7 +1682,7 @@ WALInsertLockAcquire(void)
 	static int	lockToTry = -1;
 
 	if (lockToTry == -1)
-		lockToTry = MyProc->pgprocno % NUM_XLOGINSERT_LOCKS;
+		lockToTry = MyProc->pgprocno % NumXLogInsertLocks;
 	MyLockNo = lockToTry;
 
 	/*
@@ -1685,7 +1700,7 @@ WALInsertLockAcquire(void)
 		 * than locks, it still helps to distribute the inserters evenly
 		 * across the locks.
 		 */
-		lockToTry = (lockToTry + 1) % NUM_XLOGINSERT_LOCKS;
+		lockToTry = (lockToTry + 1) % NumXLogInsertLocks;
 	}
 }
 
@@ -1703,7 +1718,7 @@ WALInsertLockAcquireExclusive(void)
 	 * indicator is set to 0xFFFFFFFFFFFFFFFF, which is higher than any real
 	 * XLogRecPtr value, to make sure that no-one blocks waiting on those.
 	 */
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS - 1; i++)
+	for (i = 0; i < NumXLogInsertLocks - 1; i++)
 	{
 		LWLockAcquire(&WALInsertLocks[i].l.lock, LW_EXCLUSIVE);
 		LWLockUpdateVar(&WALInsertLocks[i].l.lock,
@@ -1729,7 +1744,7 @@ WALInsertLockRelease(void)
 	{
 		int			i;
 
-		for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+		for (i = 0; i < NumXLogInsertLocks; i++)
 			LWLockReleaseClearVar(&WALInsertLocks[i].l.lock,
 								  &WALInsertLocks[i].l.insertingAt,
 								  0);
@@ -1757,8 +1772,8 @@ WALInsertLockUpdateInsertingAt(XLogRecPtr insertingAt)
 		 * We use the last lock to mark our actual position, see comments in
 		 * WALInsertLockAcquireExclusive.
 		 */
-		LWLockUpdateVar(&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.lock,
-						&WALInsertLocks[NUM_XLOGINSERT_LOCKS - 1].l.insertingAt,
+		LWLockUpdateVar(&WALInsertLocks[NumXLogInsertLocks - 1].l.lock,
+						&WALInsertLocks[NumXLogInsertLocks - 1].l.insertingAt,
 						insertingAt);
 	}
 	else
@@ -1825,7 +1840,7 @@ WaitXLogInsertionsToFinish(XLogRecPtr upto)
 	 * out for any insertion that's still in progress.
 	 */
 	finishedUpto = reservedUpto;
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		XLogRecPtr	insertingat = InvalidXLogRecPtr;
 
@@ -2843,9 +2858,6 @@ UpdateMinRecoveryPoint(XLogRecPtr lsn, bool force)
 void
 XLogFlush(XLogRecPtr record)
 {
-	XLogRecPtr	WriteRqstPtr;
-	XLogwrtRqst WriteRqst;
-
 	/*
 	 * During REDO, we are reading not writing WAL.  Therefore, instead of
 	 * trying to flush the WAL, we should update minRecoveryPoint instead. We
@@ -2873,6 +2885,56 @@ XLogFlush(XLogRecPtr record)
 
 	START_CRIT_SECTION();
 
+	if (wal_group_commit && MyProc != NULL)
+		XLogFlushGroup(record);
+	else
+		XLogFlushSingle(record);
+
+	END_CRIT_SECTION();
+
+	/* wake up walsenders now that we've released heavily contended locks */
+	WalSndWakeupProcessRequests();
+
+	/*
+	 * If we still haven't flushed to the request point then we have a
+	 * problem; most likely, the requested flush point is past end of XLOG.
+	 * This has been seen to occur when a disk page has a corrupted LSN.
+	 *
+	 * Formerly we treated this as a PANIC condition, but that hurts the
+	 * system's robustness rather than helping it: we do not want to take down
+	 * the whole system due to corruption on one data page.  In particular, if
+	 * the bad page is encountered again during recovery then we would be
+	 * unable to restart the database at all!  (This scenario actually
+	 * happened in the field several times with 7.1 releases.)	As of 8.4, bad
+	 * LSNs encountered during recovery are UpdateMinRecoveryPoint's problem;
+	 * the only time we can reach here during recovery is while flushing the
+	 * end-of-recovery checkpoint record, and we don't expect that to have a
+	 * bad LSN.
+	 *
+	 * Note that for calls from xact.c, the ERROR will be promoted to PANIC
+	 * since xact.c calls this routine inside a critical section.  However,
+	 * calls from bufmgr.c are not within critical sections and so we will not
+	 * force a restart for a bad LSN on a data page.
+	 */
+	if (LogwrtResult.Flush < record)
+		elog(ERROR,
+			 "xlog flush request %X/%X is not satisfied --- flushed only to %X/%X",
+			 (uint32) (record >> 32), (uint32) record,
+			 (uint32) (LogwrtResult.Flush >> 32), (uint32) LogwrtResult.Flush);
+}
+
+/*
+ * Flush xlog up to 'record' on our own, sharing the flush only with those
+ * who happen to wait for WALWriteLock at the same time.
+ *
+ * Subroutine of XLogFlush; must be called in a critical section.
+ */
+static void
+XLogFlushSingle(XLogRecPtr record)
+{
+	XLogRecPtr	WriteRqstPtr;
+	XLogwrtRqst WriteRqst;
+
 	/*
 	 * Since fsync is usually a horribly expensive operation, we try to
 	 * piggyback as much data as we can on each fsync: if we see any more data
@@ -2971,38 +3033,194 @@ XLogFlush(XLogRecPtr record)
 		/* done */
 		break;
 	}
+}
 
-	END_CRIT_SECTION();
+/*
+ * Flush xlog up to 'record' as a member of a flush group.
+ *
+ * Processes that need to flush at the same time add themselves to a
+ * lock-free list.  The first one to do so becomes the group leader: it
+ * flushes up to the furthest position requested by any member, and then
+ * wakes up the others, much like ProcArrayGroupClearXid() does for XID
+ * clearing.  Processes that arrive while the leader is flushing form the
+ * next group, whose leader waits for the flush in progress to finish before
+ * it closes the group.
+ *
+ * When no flush was in progress, the leader may sleep to let more members
+ * join before it closes the group: for commit_delay, if that is set and
+ * there are at least commit_siblings active transactions, or otherwise, if
+ * the previous group had more than one member, for half of the time that
+ * flushes have taken recently.  So a lone committer never sleeps, and under
+ * concurrency the wait adapts to the speed of the storage.
+ *
+ * Subroutine of XLogFlush; must be called in a critical section.
+ */
+static void
+XLogFlushGroup(XLogRecPtr record)
+{
+	PGPROC	   *proc = MyProc;
+	PGPROC	   *allProcs = ProcGlobal->allProcs;
+	uint32		nextidx;
+	uint32		wakeidx;
+	XLogRecPtr	GroupRqstPtr;
+	XLogRecPtr	WriteRqstPtr;
+	uint32		nmembers;
 
-	/* wake up walsenders now that we've released heavily contended locks */
-	WalSndWakeupProcessRequests();
+	/* Add ourselves to the list of processes needing a flush. */
+	proc->walFlushGroupMember = true;
+	proc->walFlushGroupMemberLsn = record;
+	nextidx = pg_atomic_read_u32(&XLogCtl->flushGroupFirst);
+	while (true)
+	{
+		pg_atomic_write_u32(&proc->walFlushGroupNext, nextidx);
+
+		if (pg_atomic_compare_exchange_u32(&XLogCtl->flushGroupFirst,
+										   &nextidx,
+										   (uint32) proc->pgprocno))
+			break;
+	}
 
 	/*
-	 * If we still haven't flushed to the request point then we have a
-	 * problem; most likely, the requested flush point is past end of XLOG.
-	 * This has been seen to occur when a disk page has a corrupted LSN.
-	 *
-	 * Formerly we treated this as a PANIC condition, but that hurts the
-	 * system's robustness rather than helping it: we do not want to take down
-	 * the whole system due to corruption on one data page.  In particular, if
-	 * the bad page is encountered again during recovery then we would be
-	 * unable to restart the database at all!  (This scenario actually
-	 * happened in the field several times with 7.1 releases.)	As of 8.4, bad
-	 * LSNs encountered during recovery are UpdateMinRecoveryPoint's problem;
-	 * the only time we can reach here during recovery is while flushing the
-	 * end-of-recovery checkpoint record, and we don't expect that to have a
-	 * bad LSN.
-	 *
-	 * Note that for calls from xact.c, the ERROR will be promoted to PANIC
-	 * since xact.c calls this routine inside a critical section.  However,
-	 * calls from bufmgr.c are not within critical sections and so we will not
-	 * force a restart for a bad LSN on a data page.
+	 * If the list was not empty, the leader will flush for us.  It is
+	 * impossible to have followers without a leader because the first process
+	 * that has added itself to the list will always have nextidx as
+	 * INVALID_PGPROCNO.
 	 */
-	if (LogwrtResult.Flush < record)
-		elog(ERROR,
-			 "xlog flush request %X/%X is not satisfied --- flushed only to %X/%X",
-			 (uint32) (record >> 32), (uint32) record,
-			 (uint32) (LogwrtResult.Flush >> 32), (uint32) LogwrtResult.Flush);
+	if (nextidx != INVALID_PGPROCNO)
+	{
+		int			extraWaits = 0;
+
+		/* Sleep until the leader has flushed. */
+		pgstat_report_wait_start(WAIT_EVENT_WAL_GROUP_FLUSH);
+		for (;;)
+		{
+			/* acts as a read barrier */
+			PGSemaphoreLock(proc->sem);
+			if (!proc->walFlushGroupMember)
+				break;
+			extraWaits++;
+		}
+		pgstat_report_wait_end();
+
+		Assert(pg_atomic_read_u32(&proc->walFlushGroupNext) == INVALID_PGPROCNO);
+
+		/* Fix semaphore count for any absorbed wakeups */
+		while (extraWaits-- > 0)
+			PGSemaphoreUnlock(proc->sem);
+
+		SpinLockAcquire(&XLogCtl->info_lck);
+		LogwrtResult = XLogCtl->LogwrtResult;
+		SpinLockRelease(&XLogCtl->info_lck);
+		return;
+	}
+
+	/*
+	 * We are the leader.  Wait for any flush in progress to finish, while
+	 * more members join.  If there was none, consider sleeping instead.
+	 */
+	if (LWLockAcquireOrWait(WALWriteLock, LW_EXCLUSIVE))
+	{
+		LWLockRelease(WALWriteLock);
+
+		if (enableFsync)
+		{
+			if (CommitDelay > 0)
+			{
+				if (MinimumActiveBackends(CommitSiblings))
+					pg_usleep(CommitDelay);
+			}
+			else if (pg_atomic_read_u32(&XLogCtl->flushGroupSize) > 1)
+			{
+				uint64		delay;
+
+				delay = pg_atomic_read_u64(&XLogCtl->flushGroupTimeAvg) / 2;
+				pg_usleep((long) Min(delay, 100000));
+			}
+		}
+	}
+
+	/*
+	 * Close the group, and find out how far we need to flush.  Trying to pop
+	 * elements one at a time could lead to an ABA problem.
+	 */
+	nextidx = pg_atomic_exchange_u32(&XLogCtl->flushGroupFirst,
+									 INVALID_PGPROCNO);
+	wakeidx = nextidx;
+
+	GroupRqstPtr = record;
+	nmembers = 0;
+	while (nextidx != INVALID_PGPROCNO)
+	{
+		PGPROC	   *member = &allProcs[nextidx];
+
+		if (GroupRqstPtr < member->walFlushGroupMemberLsn)
+			GroupRqstPtr = member->walFlushGroupMemberLsn;
+		nmembers++;
+
+		nextidx = pg_atomic_read_u32(&member->walFlushGroupNext);
+	}
+
+	/* Like XLogFlushSingle, flush any later additions too */
+	WriteRqstPtr = GroupRqstPtr;
+	SpinLockAcquire(&XLogCtl->info_lck);
+	if (WriteRqstPtr < XLogCtl->LogwrtRqst.Write)
+		WriteRqstPtr = XLogCtl->LogwrtRqst.Write;
+	LogwrtResult = XLogCtl->LogwrtResult;
+	SpinLockRelease(&XLogCtl->info_lck);
+
+	if (LogwrtResult.Flush < GroupRqstPtr)
+	{
+		XLogRecPtr	insertpos;
+		XLogwrtRqst WriteRqst;
+
+		/* As in XLogFlushSingle, wait for insertions before the lock */
+		insertpos = WaitXLogInsertionsToFinish(WriteRqstPtr);
+
+		LWLockAcquire(WALWriteLock, LW_EXCLUSIVE);
+		LogwrtResult = XLogCtl->LogwrtResult;
+		if (LogwrtResult.Flush < GroupRqstPtr)
+		{
+			instr_time	start;
+			instr_time	duration;
+			int64		avg;
+
+			WriteRqst.Write = insertpos;
+			WriteRqst.Flush = insertpos;
+
+			INSTR_TIME_SET_CURRENT(start);
+			XLogWrite(WriteRqst, false);
+			INSTR_TIME_SET_CURRENT(duration);
+			INSTR_TIME_SUBTRACT(duration, start);
+
+			/* Keep a moving average of the time a flush takes */
+			avg = (int64) pg_atomic_read_u64(&XLogCtl->flushGroupTimeAvg);
+			avg += ((int64) INSTR_TIME_GET_MICROSEC(duration) - avg) / 8;
+			pg_atomic_write_u64(&XLogCtl->flushGroupTimeAvg, (uint64) avg);
+			pg_atomic_write_u32(&XLogCtl->flushGroupSize, nmembers);
+		}
+		LWLockRelease(WALWriteLock);
+	}
+
+	/*
+	 * Now that we've released the lock, go back and wake everybody up.  Their
+	 * requests are all flushed, unless one of them was past the end of WAL,
+	 * which XLogFlush reports.
+	 */
+	while (wakeidx != INVALID_PGPROCNO)
+	{
+		PGPROC	   *member = &allProcs[wakeidx];
+
+		wakeidx = pg_atomic_read_u32(&member->walFlushGroupNext);
+		pg_atomic_write_u32(&member->walFlushGroupNext, INVALID_PGPROCNO);
+
+		/* ensure all previous writes are visible before follower continues. */
+		pg_write_barrier();
+
+		member->walFlushGroupMember = false;
+
+		if (member != MyProc)
+			PGSemaphoreUnlock(member->sem);
+	}
 }
 
 /*
@@ -4979,6 +5197,43 @@ XLOGChooseNumBuffers(void)
 	return xbuffers;
 }
 
+/*
+ * Auto-tune the number of WAL insertion locks.
+ *
+ * The locks only help as long as there are concurrent inserters to use them,
+ * and each one adds to the work of every WAL flush, so scale them with the
+ * number of connections: the default max_connections gets the traditional 8,
+ * and a thousand connections get 62.
+ */
+static int
+XLOGChooseNumInsertLocks(void)
+{
+	return Max(8, Min(64, MaxConnections / 16));
+}
+
+/*
+ * GUC check_hook for wal_insert_locks
+ */
+bool
+check_wal_insert_locks(int *newval, void **extra, GucSource source)
+{
+	/*
+	 * -1 indicates a request for auto-tune.  As with wal_buffers, the boot
+	 * value is left alone until XLOGShmemSize is called.
+	 */
+	if (*newval == -1 && NumXLogInsertLocks != -1)
+		*newval = XLOGChooseNumInsertLocks();
+
+	/* the minimum of -1 lets 0 through, but we need at least one lock */
+	if (*newval == 0)
+	{
+		GUC_check_errdetail("\"wal_insert_locks\" must be -1 or between 1 and 128.");
+		return false;
+	}
+
+	return true;
+}
+
 /*
  * GUC check_hook for wal_buffers
  */
@@ -5057,11 +5312,22 @@ XLOGShmemSize(void)
 	}
 	Assert(XLOGbuffers > 0);
 
+	/* Likewise for wal_insert_locks, which depends on max_connections */
+	if (NumXLogInsertLocks == -1)
+	{
+		char		buf[32];
+
+		snprintf(buf, sizeof(buf), "%d", XLOGChooseNumInsertLocks());
+		SetConfigOption("wal_insert_locks", buf, PGC_POSTMASTER,
+						PGC_S_OVERRIDE);
+	}
+	Assert(NumXLogInsertLocks > 0);
+
 	/* XLogCtl */
 	size = sizeof(XLogCtlData);
 
 	/* WAL insertion locks, plus alignment */
-	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NUM_XLOGINSERT_LOCKS + 1));
+	size = add_size(size, mul_size(sizeof(WALInsertLockPadded), NumXLogInsertLocks + 1));
 	/* xlblocks array */
 	size = add_size(size, mul_size(sizeof(XLogRecPtr), XLOGbuffers));
 	/* extra alignment padding for XLOG I/O buffers */
@@ -5151,9 +5417,9 @@ XLOGShmemInit(void)
 		((uintptr_t) allocptr) % sizeof(WALInsertLockPadded);
 	WALInsertLocks = XLogCtl->Insert.WALInsertLocks =
 		(WALInsertLockPadded *) allocptr;
-	allocptr += sizeof(WALInsertLockPadded) * NUM_XLOGINSERT_LOCKS;
+	allocptr += sizeof(WALInsertLockPadded) * NumXLogInsertLocks;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		LWLockInitialize(&WALInsertLocks[i].l.lock, LWTRANCHE_WAL_INSERT);
 		WALInsertLocks[i].l.insertingAt = InvalidXLogRecPtr;
@@ -5179,6 +5445,10 @@ XLOGShmemInit(void)
 	XLogCtl->SharedPromoteIsTriggered = false;
 	XLogCtl->WalWriterSleeping = false;
 
+	pg_atomic_init_u32(&XLogCtl->flushGroupFirst, INVALID_PGPROCNO);
+	pg_atomic_init_u64(&XLogCtl->flushGroupTimeAvg, 0);
+	pg_atomic_init_u32(&XLogCtl->flushGroupSize, 0);
+
 	SpinLockInit(&XLogCtl->Insert.insertpos_lck);
 	SpinLockInit(&XLogCtl->info_lck);
 	SpinLockInit(&XLogCtl->ulsn_lck);
@@ -7176,6 +7446,9 @@ StartupXLOG(void)
 					(errmsg("redo starts at %X/%X",
 							(uint32) (ReadRecPtr >> 32), (uint32) ReadRecPtr)));
 
+			/* Launch the parallel redo workers, if any */
+			ParallelRedoStart();
+
 			/*
 			 * main redo apply loop
 			 */
@@ -7205,6 +7478,9 @@ StartupXLOG(void)
 				/* Handle interrupt signals of startup process */
 				HandleStartupProcInterrupts();
 
+				/* Prefetch the blocks that the following records will read */
+				XLogPrefetch(ReadRecPtr);
+
 				/*
 				 * Pause WAL replay, if requested by a hot-standby session via
 				 * SetRecoveryPause().
@@ -7319,8 +7595,16 @@ StartupXLOG(void)
 					TransactionIdIsValid(record->xl_xid))
 					RecordKnownAssignedTransactionIds(record->xl_xid);
 
-				/* Now apply the WAL record itself */
-				RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				/*
+				 * Now apply the WAL record itself, or hand it to a parallel
+				 * redo worker.  Records that a worker can't replay wait for
+				 * the workers to replay everything handed to them first.
+				 */
+				if (!ParallelRedoDispatch(xlogreader))
+				{
+					ParallelRedoBarrier(xlogreader);
+					RmgrTable[record->xl_rmid].rm_redo(xlogreader);
+				}
 
 				/*
 				 * After redo, check whether the backup pages associated with
@@ -7393,6 +7677,9 @@ StartupXLOG(void)
 			 * end of main redo apply loop
 			 */
 
+			ParallelRedoFinish();
+			XLogPrefetchEnd();
+
 			if (reachedRecoveryTarget)
 			{
 				if (!reachedConsistency)
@@ -8025,8 +8312,10 @@ CheckRecoveryConsistency(void)
 	{
 		/*
 		 * Check to see if the XLOG sequence contained any unresolved
-		 * references to uninitialized pages.
+		 * references to uninitialized pages, including those found by the
+		 * parallel redo workers.
 		 */
+		ParallelRedoWait();
 		XLogCheckInvalidPages();
 
 		reachedConsistency = true;
@@ -8441,7 +8730,7 @@ GetLastImportantRecPtr(void)
 	XLogRecPtr	res = InvalidXLogRecPtr;
 	int			i;
 
-	for (i = 0; i < NUM_XLOGINSERT_LOCKS; i++)
+	for (i = 0; i < NumXLogInsertLocks; i++)
 	{
 		XLogRecPtr	last_important;
 
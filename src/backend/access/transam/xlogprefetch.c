@@ -0,0 +1,510 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.c
+ *	  Prefetching of the blocks referenced by WAL records during recovery.
+ *
+ * Redo routines read the blocks they modify synchronously, so without help
+ * recovery waits for one random read at a time.  When recovery_prefetch is
+ * on, the startup process reads ahead in the WAL with an XLogReaderState of
+ * its own, up to recovery_prefetch_distance bytes beyond the record being
+ * replayed, and tells the kernel about the blocks that the decoded records
+ * will need, with PrefetchSharedBuffer().  Blocks that replay won't read are
+ * skipped: those restored from a full-page image, those the record
+ * initializes, those that don't exist yet, and those that a record just
+ * before referenced too.  At most maintenance_io_concurrency prefetches are
+ * in flight at any time; a prefetch is considered complete when replay has
+ * reached the record it was issued for.
+ *
+ * The read-ahead reads the WAL files in pg_wal of the timeline being
+ * replayed.  While streaming, it stops at the position the WAL receiver has
+ * flushed; segments restored with restore_command are not in pg_wal under
+ * their own name, so archive recovery gets no prefetching from this.  When
+ * the read-ahead can't read or decode the next record, it tries again once
+ * replay has caught up with it, or more WAL has been streamed.
+ *
+ * Counters of what was done with each block reference, and the current
+ * distance ahead of replay, are kept in shared memory and shown in the
+ * pg_stat_recovery_prefetch view.  Only the startup process updates them;
+ * a reset is requested through a counter that it notices.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/access/transam/xlogprefetch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "access/htup_details.h"
+#include "access/xlog.h"
+#include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
+#include "access/xlogreader.h"
+#include "access/xlogrecord.h"
+#include "access/xlogutils.h"
+#include "catalog/pg_type.h"
+#include "funcapi.h"
+#include "pgstat.h"
+#include "port/atomics.h"
+#include "replication/walreceiver.h"
+#include "storage/bufmgr.h"
+#include "storage/fd.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "utils/builtins.h"
+#include "utils/timestamp.h"
+
+/* GUC parameters */
+bool		recovery_prefetch = false;
+int			recovery_prefetch_distance = 256 * 1024;
+
+/* number of recently examined blocks that are not prefetched again */
+#define XLOGPREFETCH_RECENT_BLOCKS	16
+
+/*
+ * Statistics, in shared memory.  Only the startup process writes them.
+ */
+typedef struct XLogPrefetchStats
+{
+	pg_atomic_uint64 reset_time;	/* TimestampTz of the last reset */
+	pg_atomic_uint32 reset_request; /* incremented to request a reset */
+
+	pg_atomic_uint64 prefetch;	/* prefetches initiated */
+	pg_atomic_uint64 hit;		/* blocks already in shared buffers */
+	pg_atomic_uint64 skip_init; /* blocks the record initializes */
+	pg_atomic_uint64 skip_new;	/* blocks that don't exist yet */
+	pg_atomic_uint64 skip_fpw;	/* blocks restored from full-page images */
+	pg_atomic_uint64 skip_rep;	/* blocks referenced again soon after */
+
+	pg_atomic_uint32 wal_distance;	/* bytes of WAL read ahead of replay */
+	pg_atomic_uint32 io_depth;	/* prefetches in flight */
+} XLogPrefetchStats;
+
+static XLogPrefetchStats *PrefetchStats = NULL;
+
+/*
+ * State of the read-ahead, private to the startup process.
+ */
+typedef struct XLogPrefetcher
+{
+	XLogReaderState *reader;
+	TimeLineID	tli;			/* timeline of the WAL files read */
+
+	/* reading failed at this position, or InvalidXLogRecPtr */
+	XLogRecPtr	failed_at;
+
+	/* the reader holds a record whose blocks are not all examined yet */
+	bool		have_record;
+	int			next_block_id;
+
+	/* record LSNs of the prefetches in flight, a ring buffer */
+	XLogRecPtr	inflight[MAX_IO_CONCURRENCY + 1];
+	int			inflight_head;	/* next slot to fill */
+	int			inflight_tail;	/* oldest prefetch in flight */
+
+	/* recently examined blocks, filled round-robin */
+	RelFileNode recent_rnode[XLOGPREFETCH_RECENT_BLOCKS];
+	BlockNumber recent_block[XLOGPREFETCH_RECENT_BLOCKS];
+	int			recent_next;
+} XLogPrefetcher;
+
+static XLogPrefetcher *prefetcher = NULL;
+
+/* statistics reset requests that the startup process has handled */
+static uint32 reset_handled = 0;
+
+static void XLogPrefetchBegin(XLogRecPtr replaying_lsn);
+static void XLogPrefetchBlock(XLogRecPtr lsn, DecodedBkpBlock *block);
+static int	XLogPrefetchPageRead(XLogReaderState *reader,
+								 XLogRecPtr targetPagePtr, int reqLen,
+								 XLogRecPtr targetRecPtr, char *readBuf);
+static void XLogPrefetchResetStats(void);
+
+/*
+ * Increment a statistics counter.  There is only one writer, so there is no
+ * need for an atomic read-modify-write.
+ */
+static inline void
+XLogPrefetchCount(pg_atomic_uint64 *counter)
+{
+	pg_atomic_write_u64(counter, pg_atomic_read_u64(counter) + 1);
+}
+
+/*
+ * Number of prefetches in flight.
+ */
+static inline int
+XLogPrefetchInflight(void)
+{
+	return (prefetcher->inflight_head - prefetcher->inflight_tail +
+			lengthof(prefetcher->inflight)) % lengthof(prefetcher->inflight);
+}
+
+/*
+ * Report shared memory space needed by XLogPrefetchShmemInit.
+ */
+Size
+XLogPrefetchShmemSize(void)
+{
+	return sizeof(XLogPrefetchStats);
+}
+
+/*
+ * Allocate and initialize the shared statistics.
+ */
+void
+XLogPrefetchShmemInit(void)
+{
+	bool		found;
+
+	PrefetchStats = (XLogPrefetchStats *)
+		ShmemInitStruct("XLog Prefetch Stats", sizeof(XLogPrefetchStats),
+						&found);
+	if (!found)
+	{
+		pg_atomic_init_u64(&PrefetchStats->reset_time, GetCurrentTimestamp());
+		pg_atomic_init_u32(&PrefetchStats->reset_request, 0);
+		pg_atomic_init_u64(&PrefetchStats->prefetch, 0);
+		pg_atomic_init_u64(&PrefetchStats->hit, 0);
+		pg_atomic_init_u64(&PrefetchStats->skip_init, 0);
+		pg_atomic_init_u64(&PrefetchStats->skip_new, 0);
+		pg_atomic_init_u64(&PrefetchStats->skip_fpw, 0);
+		pg_atomic_init_u64(&PrefetchStats->skip_rep, 0);
+		pg_atomic_init_u32(&PrefetchStats->wal_distance, 0);
+		pg_atomic_init_u32(&PrefetchStats->io_depth, 0);
+	}
+}
+
+/*
+ * Request that the statistics be reset.
+ *
+ * During recovery, the startup process does it the next time it replays a
+ * record.  Otherwise nobody else writes them, so reset them directly.
+ */
+void
+XLogPrefetchRequestResetStats(void)
+{
+	if (RecoveryInProgress())
+		pg_atomic_fetch_add_u32(&PrefetchStats->reset_request, 1);
+	else
+		XLogPrefetchResetStats();
+}
+
+static void
+XLogPrefetchResetStats(void)
+{
+	pg_atomic_write_u64(&PrefetchStats->prefetch, 0);
+	pg_atomic_write_u64(&PrefetchStats->hit, 0);
+	pg_atomic_write_u64(&PrefetchStats->skip_init, 0);
+	pg_atomic_write_u64(&PrefetchStats->skip_new, 0);
+	pg_atomic_write_u64(&PrefetchStats->skip_fpw, 0);
+	pg_atomic_write_u64(&PrefetchStats->skip_rep, 0);
+	pg_atomic_write_u64(&PrefetchStats->reset_time, GetCurrentTimestamp());
+}
+
+/*
+ * Called by the startup process before it replays the record starting at
+ * replaying_lsn.  Reads ahead in the WAL and prefetches the blocks that the
+ * records there will read.
+ */
+void
+XLogPrefetch(XLogRecPtr replaying_lsn)
+{
+	XLogReaderState *reader;
+	uint32		reset_request;
+
+	reset_request = pg_atomic_read_u32(&PrefetchStats->reset_request);
+	if (reset_request != reset_handled)
+	{
+		XLogPrefetchResetStats();
+		reset_handled = reset_request;
+	}
+
+	if (!recovery_prefetch)
+	{
+		if (prefetcher != NULL)
+			XLogPrefetchEnd();
+		return;
+	}
+
+	if (prefetcher == NULL)
+		XLogPrefetchBegin(replaying_lsn);
+	reader = prefetcher->reader;
+
+	/* Forget the prefetches for records that replay has reached */
+	while (prefetcher->inflight_tail != prefetcher->inflight_head &&
+		   prefetcher->inflight[prefetcher->inflight_tail] <= replaying_lsn)
+		prefetcher->inflight_tail =
+			(prefetcher->inflight_tail + 1) % lengthof(prefetcher->inflight);
+
+	/*
+	 * If the last read failed, wait until replay has caught up with it, or
+	 * the WAL receiver has flushed more.
+	 */
+	if (!XLogRecPtrIsInvalid(prefetcher->failed_at) &&
+		replaying_lsn < prefetcher->failed_at &&
+		!(WalRcvStreaming() &&
+		  GetWalRcvFlushRecPtr(NULL, NULL) > prefetcher->failed_at))
+		return;
+
+	/*
+	 * Start over at the record being replayed if the read-ahead has fallen
+	 * behind it, or replay has moved on to another timeline.
+	 */
+	if (reader->EndRecPtr <= replaying_lsn || prefetcher->tli != ThisTimeLineID)
+	{
+		if (reader->seg.ws_file >= 0)
+			wal_segment_close(reader);
+		XLogBeginRead(reader, replaying_lsn);
+		prefetcher->tli = ThisTimeLineID;
+		prefetcher->have_record = false;
+	}
+	prefetcher->failed_at = InvalidXLogRecPtr;
+
+	for (;;)
+	{
+		if (!prefetcher->have_record)
+		{
+			char	   *errormsg;
+
+			if (reader->EndRecPtr - replaying_lsn >=
+				(uint64) recovery_prefetch_distance)
+				break;
+
+			if (XLogReadRecord(reader, &errormsg) == NULL)
+			{
+				prefetcher->failed_at = reader->EndRecPtr;
+				break;
+			}
+
+			/* The record being replayed reads its blocks right away */
+			if (reader->ReadRecPtr <= replaying_lsn)
+				continue;
+
+			prefetcher->have_record = true;
+			prefetcher->next_block_id = 0;
+		}
+
+		while (prefetcher->next_block_id <= reader->max_block_id)
+		{
+			DecodedBkpBlock *block = &reader->blocks[prefetcher->next_block_id];
+
+			if (!block->in_use)
+				;
+			else if (block->apply_image)
+				XLogPrefetchCount(&PrefetchStats->skip_fpw);
+			else if (block->flags & BKPBLOCK_WILL_INIT)
+				XLogPrefetchCount(&PrefetchStats->skip_init);
+			else
+			{
+				/* Stop here until there's room for another prefetch */
+				if (XLogPrefetchInflight() >= maintenance_io_concurrency)
+					goto done;
+				XLogPrefetchBlock(reader->ReadRecPtr, block);
+			}
+
+			prefetcher->next_block_id++;
+		}
+		prefetcher->have_record = false;
+	}
+
+done:
+	pg_atomic_write_u32(&PrefetchStats->wal_distance,
+						reader->EndRecPtr > replaying_lsn ?
+						(uint32) (reader->EndRecPtr - replaying_lsn) : 0);
+	pg_atomic_write_u32(&PrefetchStats->io_depth, XLogPrefetchInflight());
+}
+
+/*
+ * Stop reading ahead, at the end of recovery or when recovery_prefetch is
+ * turned off.
+ */
+void
+XLogPrefetchEnd(void)
+{
+	if (prefetcher == NULL)
+		return;
+
+	XLogReaderFree(prefetcher->reader);
+	pfree(prefetcher);
+	prefetcher = NULL;
+
+	pg_atomic_write_u32(&PrefetchStats->wal_distance, 0);
+	pg_atomic_write_u32(&PrefetchStats->io_depth, 0);
+}
+
+/*
+ * Set up the read-ahead, starting at the record being replayed.
+ */
+static void
+XLogPrefetchBegin(XLogRecPtr replaying_lsn)
+{
+	XLogPrefetcher *p;
+	int			i;
+
+	p = MemoryContextAllocZero(TopMemoryContext, sizeof(XLogPrefetcher));
+	p->reader = XLogReaderAllocate(wal_segment_size, NULL,
+								   XL_ROUTINE(.page_read = XLogPrefetchPageRead,
+											  .segment_open = NULL,
+											  .segment_close = wal_segment_close),
+								   p);
+	if (p->reader == NULL)
+		ereport(ERROR,
+				(errcode(ERRCODE_OUT_OF_MEMORY),
+				 errmsg("out of memory"),
+				 errdetail("Failed while allocating a WAL reading processor.")));
+
+	XLogBeginRead(p->reader, replaying_lsn);
+	p->tli = ThisTimeLineID;
+	p->failed_at = InvalidXLogRecPtr;
+	for (i = 0; i < XLOGPREFETCH_RECENT_BLOCKS; i++)
+		p->recent_block[i] = InvalidBlockNumber;
+
+	prefetcher = p;
+}
+
+/*
+ * Prefetch a block referenced by the record at lsn, unless there's no need
+ * to.
+ */
+static void
+XLogPrefetchBlock(XLogRecPtr lsn, DecodedBkpBlock *block)
+{
+	SMgrRelation reln;
+	PrefetchBufferResult result;
+	int			i;
+
+	/* Skip blocks that a record just before referenced */
+	for (i = 0; i < XLOGPREFETCH_RECENT_BLOCKS; i++)
+	{
+		if (prefetcher->recent_block[i] == block->blkno &&
+			RelFileNodeEquals(prefetcher->recent_rnode[i], block->rnode))
+		{
+			XLogPrefetchCount(&PrefetchStats->skip_rep);
+			return;
+		}
+	}
+	prefetcher->recent_rnode[prefetcher->recent_next] = block->rnode;
+	prefetcher->recent_block[prefetcher->recent_next] = block->blkno;
+	prefetcher->recent_next =
+		(prefetcher->recent_next + 1) % XLOGPREFETCH_RECENT_BLOCKS;
+
+	/*
+	 * Skip blocks beyond the end of the relation, and relations that don't
+	 * exist, as far as we know now.  Replay will create them, or a later
+	 * record drops them.  The size that smgrnblocks() caches in recovery is
+	 * good enough for this.
+	 */
+	reln = smgropen(block->rnode, InvalidBackendId);
+	if ((reln->smgr_cached_nblocks[block->forknum] == InvalidBlockNumber &&
+		 !smgrexists(reln, block->forknum)) ||
+		block->blkno >= smgrnblocks(reln, block->forknum))
+	{
+		XLogPrefetchCount(&PrefetchStats->skip_new);
+		return;
+	}
+
+	result = PrefetchSharedBuffer(reln, block->forknum, block->blkno);
+	if (BufferIsValid(result.recent_buffer))
+		XLogPrefetchCount(&PrefetchStats->hit);
+	else if (result.initiated_io)
+	{
+		XLogPrefetchCount(&PrefetchStats->prefetch);
+		prefetcher->inflight[prefetcher->inflight_head] = lsn;
+		prefetcher->inflight_head =
+			(prefetcher->inflight_head + 1) % lengthof(prefetcher->inflight);
+	}
+	else
+	{
+		/* the file is gone */
+		XLogPrefetchCount(&PrefetchStats->skip_new);
+	}
+}
+
+/*
+ * XLogReaderRoutine->page_read callback of the read-ahead.  Reads from the
+ * WAL files in pg_wal, and fails rather than waits when the page isn't
+ * there (yet).
+ */
+static int
+XLogPrefetchPageRead(XLogReaderState *reader, XLogRecPtr targetPagePtr,
+					 int reqLen, XLogRecPtr targetRecPtr, char *readBuf)
+{
+	XLogPrefetcher *p = (XLogPrefetcher *) reader->private_data;
+	XLogSegNo	segno;
+	int			count = XLOG_BLCKSZ;
+	int			nread;
+
+	/* Don't read beyond what the WAL receiver has flushed */
+	if (WalRcvStreaming())
+	{
+		XLogRecPtr	flushed = GetWalRcvFlushRecPtr(NULL, NULL);
+
+		if (targetPagePtr + reqLen > flushed)
+			return -1;
+		if (targetPagePtr + XLOG_BLCKSZ > flushed)
+			count = (int) (flushed - targetPagePtr);
+	}
+
+	XLByteToSeg(targetPagePtr, segno, wal_segment_size);
+	if (reader->seg.ws_file < 0 || reader->seg.ws_segno != segno ||
+		reader->seg.ws_tli != p->tli)
+	{
+		char		path[MAXPGPATH];
+
+		if (reader->seg.ws_file >= 0)
+			wal_segment_close(reader);
+
+		XLogFilePath(path, p->tli, segno, wal_segment_size);
+		reader->seg.ws_file = BasicOpenFile(path, O_RDONLY | PG_BINARY);
+		if (reader->seg.ws_file < 0)
+			return -1;
+		reader->seg.ws_segno = segno;
+		reader->seg.ws_tli = p->tli;
+	}
+
+	pgstat_report_wait_start(WAIT_EVENT_WAL_READ);
+	nread = pg_pread(reader->seg.ws_file, readBuf, count,
+					 (off_t) XLogSegmentOffset(targetPagePtr, wal_segment_size));
+	pgstat_report_wait_end();
+
+	if (nread < reqLen)
+		return -1;
+	return nread;
+}
+
+/*
+ * Returns the recovery prefetch statistics.
+ */
+Datum
+pg_stat_get_recovery_prefetch(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_RECOVERY_PREFETCH_COLS	9
+	TupleDesc	tupdesc;
+	Datum		values[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
+	bool		nulls[PG_STAT_GET_RECOVERY_PREFETCH_COLS];
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	MemSet(nulls, 0, sizeof(nulls));
+
+	values[0] = TimestampTzGetDatum(pg_atomic_read_u64(&PrefetchStats->reset_time));
+	values[1] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->prefetch));
+	values[2] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->hit));
+	values[3] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->skip_init));
+	values[4] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->skip_new));
+	values[5] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->skip_fpw));
+	values[6] = Int64GetDatum(pg_atomic_read_u64(&PrefetchStats->skip_rep));
+	values[7] = Int32GetDatum(pg_atomic_read_u32(&PrefetchStats->wal_distance));
+	values[8] = Int32GetDatum(pg_atomic_read_u32(&PrefetchStats->io_depth));
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
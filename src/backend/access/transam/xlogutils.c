@@ -19,6 +19,7 @@
 
 #include <unistd.h>
 
+#include "access/parallelredo.h"
 #include "access/timeline.h"
 #include "access/xlog.h"
 #include "access/xlog_internal.h"
@@ -77,7 +78,7 @@ report_invalid_page(int elevel, RelFileNode node, ForkNumber forkno,
 }
 
 /* Log a reference to an invalid page */
-static void
+void
 log_invalid_page(RelFileNode node, ForkNumber forkno, BlockNumber blkno,
 				 bool present)
 {
@@ -108,6 +109,10 @@ log_invalid_page(RelFileNode node, ForkNumber forkno, BlockNumber blkno,
 	if (log_min_messages <= DEBUG1 || client_min_messages <= DEBUG1)
 		report_invalid_page(DEBUG1, node, forkno, blkno, present);
 
+	/* A parallel redo worker leaves it to the startup process to remember */
+	if (ParallelRedoReportInvalidPage(node, forkno, blkno, present))
+		return;
+
 	if (invalid_page_tab == NULL)
 	{
 		/* create hash table when first needed */
@@ -463,6 +468,17 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 
 	lastblock = smgrnblocks(smgr, forknum);
 
+	/*
+	 * With parallel redo, another process may have extended the relation
+	 * since its size was cached, so ask the kernel before deciding that the
+	 * page doesn't exist.
+	 */
+	if (blkno >= lastblock && recovery_parallel_workers > 0)
+	{
+		smgr->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+		lastblock = smgrnblocks(smgr, forknum);
+	}
+
 	if (blkno < lastblock)
 	{
 		/* page exists in file */
@@ -480,10 +496,39 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 		if (mode == RBM_NORMAL_NO_LOG)
 			return InvalidBuffer;
 		/* OK to extend the file */
-		/* we do this in recovery only - no rel-extension lock needed */
 		Assert(InRecovery);
+
+		/*
+		 * We do this in recovery only, so no rel-extension lock is needed;
+		 * but parallel redo workers can extend the same relation at the same
+		 * time, so they take turns, and recheck the size once it's theirs.
+		 */
+		LWLockAcquire(RecoveryExtensionLock, LW_EXCLUSIVE);
 		buffer = InvalidBuffer;
-		do
+		if (recovery_parallel_workers > 0)
+			smgr->smgr_cached_nblocks[forknum] = InvalidBlockNumber;
+		if (blkno >= smgrnblocks(smgr, forknum))
+		{
+			do
+			{
+				if (buffer != InvalidBuffer)
+				{
+					if (mode == RBM_ZERO_AND_LOCK || mode == RBM_ZERO_AND_CLEANUP_LOCK)
+						LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
+					ReleaseBuffer(buffer);
+				}
+				buffer = ReadBufferWithoutRelcache(rnode, forknum,
+												   P_NEW, mode, NULL);
+			}
+			while (BufferGetBlockNumber(buffer) < blkno);
+		}
+		LWLockRelease(RecoveryExtensionLock);
+
+		/*
+		 * Handle the corner case that P_NEW returns non-consecutive pages,
+		 * and the case that another worker extended the relation already
+		 */
+		if (buffer == InvalidBuffer || BufferGetBlockNumber(buffer) != blkno)
 		{
 			if (buffer != InvalidBuffer)
 			{
@@ -491,16 +536,6 @@ XLogReadBufferExtended(RelFileNode rnode, ForkNumber forknum,
 					LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
 				ReleaseBuffer(buffer);
 			}
-			buffer = ReadBufferWithoutRelcache(rnode, forknum,
-											   P_NEW, mode, NULL);
-		}
-		while (BufferGetBlockNumber(buffer) < blkno);
-		/* Handle the corner case that P_NEW returns non-consecutive pages */
-		if (BufferGetBlockNumber(buffer) != blkno)
-		{
-			if (mode == RBM_ZERO_AND_LOCK || mode == RBM_ZERO_AND_CLEANUP_LOCK)
-				LockBuffer(buffer, BUFFER_LOCK_UNLOCK);
-			ReleaseBuffer(buffer);
 			buffer = ReadBufferWithoutRelcache(rnode, forknum, blkno,
 											   mode, NULL);
 		}
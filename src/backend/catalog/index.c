@@ -343,6 +343,7 @@ ConstructTupleDescriptor(Relation heapRelation,
 			to->atttypmod = from->atttypmod;
 			to->attbyval = from->attbyval;
 			to->attstorage = from->attstorage;
+			to->attcompression = from->attcompression;
 			to->attalign = from->attalign;
 		}
 		else
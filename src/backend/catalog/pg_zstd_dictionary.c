@@ -0,0 +1,336 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_zstd_dictionary.c
+ *	  routines to support manipulation of the pg_zstd_dictionary relation
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/catalog/pg_zstd_dictionary.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/genam.h"
+#include "access/htup_details.h"
+#include "access/table.h"
+#include "catalog/catalog.h"
+#include "catalog/indexing.h"
+#include "catalog/pg_zstd_dictionary.h"
+#include "miscadmin.h"
+#include "utils/builtins.h"
+#include "utils/fmgroids.h"
+#include "utils/hsearch.h"
+#include "utils/inval.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+
+/*
+ * Backend-local cache mapping a column to its current dictionary, so that
+ * toasting a tuple doesn't have to scan the catalog.  A cached InvalidOid
+ * means the column has no dictionary.  Entries are discarded on relcache
+ * invalidation of the relation, which ZstdDictionaryCreate() sends.
+ */
+typedef struct ColumnDictionaryKey
+{
+	Oid			relid;
+	AttrNumber	attnum;
+} ColumnDictionaryKey;
+
+typedef struct ColumnDictionaryEntry
+{
+	ColumnDictionaryKey key;	/* hash key --- must be first */
+	Oid			dictid;
+} ColumnDictionaryEntry;
+
+static HTAB *ColumnDictionaryCache = NULL;
+
+static void ZstdDictionaryInsert(Relation rel, Oid dictid, Oid relid,
+								 AttrNumber attnum, bool current, bytea *dict);
+static void InvalidateColumnDictionaryCache(Datum arg, Oid relid);
+
+
+/*
+ * ZstdDictionaryCreate
+ *		Store a newly trained dictionary for the given column and make it
+ *		the one used to compress new values.
+ *
+ * Any previous dictionaries of the column are kept, since existing datums
+ * may still refer to them, but are no longer current.
+ */
+Oid
+ZstdDictionaryCreate(Oid relid, AttrNumber attnum, bytea *dict)
+{
+	Relation	rel;
+	ScanKeyData key[2];
+	SysScanDesc scan;
+	HeapTuple	tup;
+	Oid			dictid;
+
+	rel = table_open(ZstdDictionaryRelationId, RowExclusiveLock);
+
+	/* Retire the column's current dictionary, if any */
+	ScanKeyInit(&key[0],
+				Anum_pg_zstd_dictionary_zdrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+	ScanKeyInit(&key[1],
+				Anum_pg_zstd_dictionary_zdattnum,
+				BTEqualStrategyNumber, F_INT2EQ,
+				Int16GetDatum(attnum));
+
+	scan = systable_beginscan(rel, ZstdDictionaryRelidAttnumIndexId, true,
+							  NULL, 2, key);
+
+	while (HeapTupleIsValid(tup = systable_getnext(scan)))
+	{
+		Form_pg_zstd_dictionary form = (Form_pg_zstd_dictionary) GETSTRUCT(tup);
+
+		if (form->zdcurrent)
+		{
+			HeapTuple	newtup = heap_copytuple(tup);
+
+			((Form_pg_zstd_dictionary) GETSTRUCT(newtup))->zdcurrent = false;
+			CatalogTupleUpdate(rel, &newtup->t_self, newtup);
+			heap_freetuple(newtup);
+		}
+	}
+
+	systable_endscan(scan);
+
+	/* Insert the new one */
+	dictid = GetNewOidWithIndex(rel, ZstdDictionaryOidIndexId,
+								Anum_pg_zstd_dictionary_oid);
+	ZstdDictionaryInsert(rel, dictid, relid, attnum, true, dict);
+
+	table_close(rel, RowExclusiveLock);
+
+	/* Make other backends pick up the new dictionary for this column */
+	CacheInvalidateRelcacheByRelid(relid);
+
+	return dictid;
+}
+
+/*
+ * ZstdDictionaryRestore
+ *		Store a dictionary carried over from the old cluster by pg_upgrade.
+ *
+ * Compressed datums refer to their dictionary by OID, so it must keep the
+ * OID it had.
+ */
+void
+ZstdDictionaryRestore(Oid dictid, Oid relid, AttrNumber attnum,
+					  bool current, bytea *dict)
+{
+	Relation	rel;
+
+	Assert(IsBinaryUpgrade);
+
+	rel = table_open(ZstdDictionaryRelationId, RowExclusiveLock);
+	ZstdDictionaryInsert(rel, dictid, relid, attnum, current, dict);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * ZstdDictionaryRetire
+ *		Detach the dictionaries of a relation that is being dropped.
+ *
+ * The rows themselves are kept, since values copied into other tables may
+ * still refer to them, but they no longer point at the relation, so that a
+ * new relation that happens to get the same OID doesn't inherit them.
+ */
+void
+ZstdDictionaryRetire(Oid relid)
+{
+	Relation	rel;
+	ScanKeyData key;
+	SysScanDesc scan;
+	HeapTuple	tup;
+
+	rel = table_open(ZstdDictionaryRelationId, RowExclusiveLock);
+
+	ScanKeyInit(&key,
+				Anum_pg_zstd_dictionary_zdrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+
+	scan = systable_beginscan(rel, ZstdDictionaryRelidAttnumIndexId, true,
+							  NULL, 1, &key);
+
+	while (HeapTupleIsValid(tup = systable_getnext(scan)))
+	{
+		HeapTuple	newtup = heap_copytuple(tup);
+		Form_pg_zstd_dictionary form;
+
+		form = (Form_pg_zstd_dictionary) GETSTRUCT(newtup);
+		form->zdrelid = InvalidOid;
+		form->zdcurrent = false;
+		CatalogTupleUpdate(rel, &newtup->t_self, newtup);
+		heap_freetuple(newtup);
+	}
+
+	systable_endscan(scan);
+	table_close(rel, RowExclusiveLock);
+}
+
+/*
+ * Insert a row into pg_zstd_dictionary.
+ */
+static void
+ZstdDictionaryInsert(Relation rel, Oid dictid, Oid relid, AttrNumber attnum,
+					 bool current, bytea *dict)
+{
+	HeapTuple	tup;
+	Datum		values[Natts_pg_zstd_dictionary];
+	bool		nulls[Natts_pg_zstd_dictionary];
+
+	memset(nulls, false, sizeof(nulls));
+	values[Anum_pg_zstd_dictionary_oid - 1] = ObjectIdGetDatum(dictid);
+	values[Anum_pg_zstd_dictionary_zdrelid - 1] = ObjectIdGetDatum(relid);
+	values[Anum_pg_zstd_dictionary_zdattnum - 1] = Int16GetDatum(attnum);
+	values[Anum_pg_zstd_dictionary_zdcurrent - 1] = BoolGetDatum(current);
+	values[Anum_pg_zstd_dictionary_zddict - 1] = PointerGetDatum(dict);
+
+	tup = heap_form_tuple(RelationGetDescr(rel), values, nulls);
+	CatalogTupleInsert(rel, tup);
+	heap_freetuple(tup);
+}
+
+/*
+ * ZstdDictionaryGetData
+ *		Return a palloc'd, detoasted copy of a dictionary's contents, or
+ *		NULL if there is no such dictionary.
+ */
+bytea *
+ZstdDictionaryGetData(Oid dictid)
+{
+	Relation	rel;
+	ScanKeyData key;
+	SysScanDesc scan;
+	HeapTuple	tup;
+	bytea	   *result = NULL;
+
+	rel = table_open(ZstdDictionaryRelationId, AccessShareLock);
+
+	ScanKeyInit(&key,
+				Anum_pg_zstd_dictionary_oid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(dictid));
+
+	scan = systable_beginscan(rel, ZstdDictionaryOidIndexId, true,
+							  NULL, 1, &key);
+
+	tup = systable_getnext(scan);
+	if (HeapTupleIsValid(tup))
+	{
+		Datum		datum;
+		bool		isnull;
+
+		datum = heap_getattr(tup, Anum_pg_zstd_dictionary_zddict,
+							 RelationGetDescr(rel), &isnull);
+		Assert(!isnull);
+		result = DatumGetByteaPCopy(datum);
+	}
+
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	return result;
+}
+
+/*
+ * GetColumnZstdDictionary
+ *		Return the OID of the dictionary new values of the column should be
+ *		compressed with, or InvalidOid if the column has none.
+ */
+Oid
+GetColumnZstdDictionary(Oid relid, AttrNumber attnum)
+{
+	ColumnDictionaryKey hkey;
+	ColumnDictionaryEntry *entry;
+	Relation	rel;
+	ScanKeyData key[2];
+	SysScanDesc scan;
+	HeapTuple	tup;
+	Oid			dictid = InvalidOid;
+
+	if (ColumnDictionaryCache == NULL)
+	{
+		HASHCTL		ctl;
+
+		MemSet(&ctl, 0, sizeof(ctl));
+		ctl.keysize = sizeof(ColumnDictionaryKey);
+		ctl.entrysize = sizeof(ColumnDictionaryEntry);
+		ColumnDictionaryCache = hash_create("zstd column dictionary cache",
+											64, &ctl,
+											HASH_ELEM | HASH_BLOBS);
+		CacheRegisterRelcacheCallback(InvalidateColumnDictionaryCache,
+									  (Datum) 0);
+	}
+
+	MemSet(&hkey, 0, sizeof(hkey));
+	hkey.relid = relid;
+	hkey.attnum = attnum;
+
+	entry = (ColumnDictionaryEntry *) hash_search(ColumnDictionaryCache,
+												  &hkey, HASH_FIND, NULL);
+	if (entry != NULL)
+		return entry->dictid;
+
+	rel = table_open(ZstdDictionaryRelationId, AccessShareLock);
+
+	ScanKeyInit(&key[0],
+				Anum_pg_zstd_dictionary_zdrelid,
+				BTEqualStrategyNumber, F_OIDEQ,
+				ObjectIdGetDatum(relid));
+	ScanKeyInit(&key[1],
+				Anum_pg_zstd_dictionary_zdattnum,
+				BTEqualStrategyNumber, F_INT2EQ,
+				Int16GetDatum(attnum));
+
+	scan = systable_beginscan(rel, ZstdDictionaryRelidAttnumIndexId, true,
+							  NULL, 2, key);
+
+	while (HeapTupleIsValid(tup = systable_getnext(scan)))
+	{
+		Form_pg_zstd_dictionary form = (Form_pg_zstd_dictionary) GETSTRUCT(tup);
+
+		if (form->zdcurrent)
+		{
+			dictid = form->oid;
+			break;
+		}
+	}
+
+	systable_endscan(scan);
+	table_close(rel, AccessShareLock);
+
+	/* Enter the result only now, as the scan may process invalidations */
+	entry = (ColumnDictionaryEntry *) hash_search(ColumnDictionaryCache,
+												  &hkey, HASH_ENTER, NULL);
+	entry->dictid = dictid;
+
+	return dictid;
+}
+
+/*
+ * Relcache invalidation callback: forget the cached dictionaries of the
+ * relation, or of all relations if relid is InvalidOid.
+ */
+static void
+InvalidateColumnDictionaryCache(Datum arg, Oid relid)
+{
+	HASH_SEQ_STATUS status;
+	ColumnDictionaryEntry *entry;
+
+	hash_seq_init(&status, ColumnDictionaryCache);
+	while ((entry = (ColumnDictionaryEntry *) hash_seq_search(&status)) != NULL)
+	{
+		if (!OidIsValid(relid) || entry->key.relid == relid)
+			hash_search(ColumnDictionaryCache, &entry->key,
+						HASH_REMOVE, NULL);
+	}
+}
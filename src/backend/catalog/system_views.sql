@@ -293,6 +293,9 @@ CREATE VIEW pg_stats_ext WITH (security_barrier) AS
 -- unprivileged users may read pg_statistic_ext but not pg_statistic_ext_data
 REVOKE ALL on pg_statistic_ext_data FROM public;
 
+-- dictionaries are built from samples of table data
+REVOKE ALL on pg_zstd_dictionary FROM public;
+
 CREATE VIEW pg_publication_tables AS
     SELECT
         P.pubname AS pubname,
@@ -554,6 +557,12 @@ CREATE VIEW pg_shmem_allocations AS
 REVOKE ALL ON pg_shmem_allocations FROM PUBLIC;
 REVOKE EXECUTE ON FUNCTION pg_get_shmem_allocations() FROM PUBLIC;
 
+CREATE VIEW pg_shmem_allocations_numa AS
+    SELECT * FROM pg_get_shmem_allocations_numa();
+
+REVOKE ALL ON pg_shmem_allocations_numa FROM PUBLIC;
+REVOKE EXECUTE ON FUNCTION pg_get_shmem_allocations_numa() FROM PUBLIC;
+
 -- Statistics views
 
 CREATE VIEW pg_stat_all_tables AS
@@ -803,6 +812,33 @@ CREATE VIEW pg_stat_slru AS
             s.stats_reset
     FROM pg_stat_get_slru() s;
 
+CREATE VIEW pg_stat_toast AS
+    SELECT
+            S.relid,
+            N.nspname AS schemaname,
+            C.relname,
+            S.attnum,
+            A.attname,
+            S.compressed,
+            S.compress_failures,
+            S.raw_bytes,
+            S.compressed_bytes,
+            S.compress_time
+    FROM pg_stat_get_toast_columns() S
+         JOIN pg_class C ON (C.oid = S.relid)
+         JOIN pg_attribute A ON (A.attrelid = S.relid AND A.attnum = S.attnum)
+         LEFT JOIN pg_namespace N ON (N.oid = C.relnamespace)
+    WHERE NOT A.attisdropped;
+
+CREATE VIEW pg_stat_toast_decompression AS
+    SELECT
+            s.method,
+            s.decompressed,
+            s.decompressed_bytes,
+            s.decompress_time,
+            s.stats_reset
+    FROM pg_stat_get_toast_decompression() s;
+
 CREATE VIEW pg_stat_wal_receiver AS
     SELECT
             s.pid,
@@ -823,6 +859,19 @@ CREATE VIEW pg_stat_wal_receiver AS
     FROM pg_stat_get_wal_receiver() s
     WHERE s.pid IS NOT NULL;
 
+CREATE VIEW pg_stat_recovery_prefetch AS
+    SELECT
+        s.stats_reset,
+        s.prefetch,
+        s.hit,
+        s.skip_init,
+        s.skip_new,
+        s.skip_fpw,
+        s.skip_rep,
+        s.wal_distance,
+        s.io_depth
+    FROM pg_stat_get_recovery_prefetch() s;
+
 CREATE VIEW pg_stat_subscription AS
     SELECT
             su.oid AS subid,
@@ -1415,6 +1464,15 @@ LANGUAGE internal
 STRICT IMMUTABLE PARALLEL SAFE
 AS 'unicode_is_normalized';
 
+CREATE OR REPLACE FUNCTION
+  pg_zstd_train_dictionary(rel regclass, attname name,
+                           sample_rows integer DEFAULT 1000,
+                           dict_size integer DEFAULT 65536)
+RETURNS oid
+LANGUAGE INTERNAL
+STRICT VOLATILE PARALLEL UNSAFE
+AS 'pg_zstd_train_dictionary';
+
 --
 -- The default permissions for functions mean that anyone can execute them.
 -- A number of functions shouldn't be executable by just anyone, but rather
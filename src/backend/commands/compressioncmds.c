@@ -0,0 +1,233 @@
+/*-------------------------------------------------------------------------
+ *
+ * compressioncmds.c
+ *	  Routines for SQL commands that manipulate TOAST compression
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/commands/compressioncmds.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_ZSTD
+#include <zdict.h>
+#endif
+
+#include "access/detoast.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "catalog/catalog.h"
+#include "catalog/pg_zstd_dictionary.h"
+#include "miscadmin.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/lsyscache.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/sampling.h"
+#include "utils/snapmgr.h"
+
+/*
+ * Longer values contribute only their first ZSTD_TRAIN_MAX_SAMPLE_SIZE bytes
+ * to training; the trainer gains little from huge samples.
+ */
+#define ZSTD_TRAIN_MAX_SAMPLE_SIZE	(128 * 1024)
+
+/* Limits on the size of a trained dictionary */
+#define ZSTD_MIN_DICT_SIZE			256
+#define ZSTD_MAX_DICT_SIZE			(16 * 1024 * 1024)
+
+/*
+ * pg_zstd_train_dictionary: train a zstd dictionary from a random sample of
+ * a column's values, and make it the one used to compress new values of
+ * that column.  Returns the OID of the new pg_zstd_dictionary entry.
+ */
+Datum
+pg_zstd_train_dictionary(PG_FUNCTION_ARGS)
+{
+#ifndef USE_ZSTD
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("compression method zstd not supported"),
+			 errdetail("This functionality requires the server to be built with zstd support."),
+			 errhint("You need to rebuild PostgreSQL using %s.", "--with-zstd")));
+	PG_RETURN_NULL();			/* keep compiler quiet */
+#else
+	Oid			relid = PG_GETARG_OID(0);
+	char	   *attname = NameStr(*PG_GETARG_NAME(1));
+	int32		nsamples = PG_GETARG_INT32(2);
+	int32		dictsize = PG_GETARG_INT32(3);
+	Relation	rel;
+	AttrNumber	attnum;
+	Form_pg_attribute attr;
+	MemoryContext traincxt;
+	MemoryContext oldcxt;
+	TableScanDesc scan;
+	TupleTableSlot *slot;
+	SamplerRandomState randstate;
+	struct varlena **samples;
+	int			nkept = 0;
+	double		nseen = 0;
+	size_t		maxbytes;
+	size_t		totalbytes = 0;
+	size_t	   *sizes;
+	char	   *samplebuf;
+	char	   *ptr;
+	bytea	   *dict;
+	size_t		len;
+	Oid			dictid;
+
+	if (nsamples < 1)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("number of sample rows must be greater than zero")));
+	if (dictsize < ZSTD_MIN_DICT_SIZE || dictsize > ZSTD_MAX_DICT_SIZE)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("dictionary size must be between %d and %d bytes",
+						ZSTD_MIN_DICT_SIZE, ZSTD_MAX_DICT_SIZE)));
+
+	/* Conflicts with itself, so that trainings of a table are serialized */
+	rel = table_open(relid, ShareUpdateExclusiveLock);
+
+	if (rel->rd_rel->relkind != RELKIND_RELATION &&
+		rel->rd_rel->relkind != RELKIND_MATVIEW)
+		ereport(ERROR,
+				(errcode(ERRCODE_WRONG_OBJECT_TYPE),
+				 errmsg("\"%s\" is not a table or materialized view",
+						RelationGetRelationName(rel))));
+
+	if (!pg_class_ownercheck(relid, GetUserId()))
+		aclcheck_error(ACLCHECK_NOT_OWNER,
+					   get_relkind_objtype(rel->rd_rel->relkind),
+					   RelationGetRelationName(rel));
+
+	/*
+	 * Detoasting catalog values must not depend on scanning
+	 * pg_zstd_dictionary.
+	 */
+	if (IsCatalogRelation(rel))
+		ereport(ERROR,
+				(errcode(ERRCODE_INSUFFICIENT_PRIVILEGE),
+				 errmsg("permission denied: \"%s\" is a system catalog",
+						RelationGetRelationName(rel))));
+
+	attnum = get_attnum(relid, attname);
+	if (attnum <= 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_UNDEFINED_COLUMN),
+				 errmsg("column \"%s\" of relation \"%s\" does not exist",
+						attname, RelationGetRelationName(rel))));
+
+	attr = TupleDescAttr(RelationGetDescr(rel), attnum - 1);
+	if (attr->attlen != -1)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("column data type %s does not support compression",
+						format_type_be(attr->atttypid))));
+
+	traincxt = AllocSetContextCreate(CurrentMemoryContext,
+									 "zstd dictionary training",
+									 ALLOCSET_DEFAULT_SIZES);
+	oldcxt = MemoryContextSwitchTo(traincxt);
+
+	/*
+	 * Collect a uniform random sample of the column's non-null values with
+	 * the classic reservoir algorithm: the k'th value seen replaces a random
+	 * slot with probability nsamples/k once the reservoir is full.
+	 */
+	samples = (struct varlena **)
+		MemoryContextAllocHuge(traincxt, nsamples * sizeof(struct varlena *));
+	sampler_random_init_state(random(), randstate);
+
+	slot = table_slot_create(rel, NULL);
+	scan = table_beginscan(rel, GetActiveSnapshot(), 0, NULL);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, slot))
+	{
+		Datum		value;
+		bool		isnull;
+		int			pos;
+
+		CHECK_FOR_INTERRUPTS();
+
+		value = slot_getattr(slot, attnum, &isnull);
+		if (isnull)
+			continue;
+
+		nseen += 1;
+		if (nkept < nsamples)
+			pos = nkept++;
+		else
+		{
+			pos = (int) (sampler_random_fract(randstate) * nseen);
+			if (pos >= nsamples)
+				continue;
+			pfree(samples[pos]);
+		}
+
+		samples[pos] = detoast_attr_slice((struct varlena *) DatumGetPointer(value),
+										  0, ZSTD_TRAIN_MAX_SAMPLE_SIZE);
+	}
+
+	table_endscan(scan);
+	ExecDropSingleTupleTableSlot(slot);
+
+	if (nkept == 0)
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("column \"%s\" of relation \"%s\" contains no values to train a dictionary from",
+						attname, RelationGetRelationName(rel))));
+
+	/*
+	 * The trainer wants the samples concatenated.  Use as many as fit in
+	 * maintenance_work_mem; the sample is random, so any subset will do.
+	 */
+	maxbytes = (size_t) maintenance_work_mem * 1024;
+	sizes = (size_t *) MemoryContextAllocHuge(traincxt, nkept * sizeof(size_t));
+	for (int i = 0; i < nkept; i++)
+	{
+		sizes[i] = VARSIZE_ANY_EXHDR(samples[i]);
+		if (i > 0 && totalbytes + sizes[i] > maxbytes)
+		{
+			nkept = i;
+			break;
+		}
+		totalbytes += sizes[i];
+	}
+
+	samplebuf = ptr = (char *) MemoryContextAllocHuge(traincxt,
+													  Max(totalbytes, 1));
+	for (int i = 0; i < nkept; i++)
+	{
+		memcpy(ptr, VARDATA_ANY(samples[i]), sizes[i]);
+		ptr += sizes[i];
+	}
+
+	dict = (bytea *) palloc(VARHDRSZ + dictsize);
+	len = ZDICT_trainFromBuffer(VARDATA(dict), dictsize,
+								samplebuf, sizes, nkept);
+	if (ZDICT_isError(len))
+		ereport(ERROR,
+				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
+				 errmsg("could not train zstd dictionary for column \"%s\" of relation \"%s\": %s",
+						attname, RelationGetRelationName(rel),
+						ZDICT_getErrorName(len)),
+				 errhint("Training needs a larger or more varied sample of values.")));
+	SET_VARSIZE(dict, VARHDRSZ + len);
+
+	dictid = ZstdDictionaryCreate(relid, attnum, dict);
+
+	MemoryContextSwitchTo(oldcxt);
+	MemoryContextDelete(traincxt);
+
+	table_close(rel, NoLock);
+
+	PG_RETURN_OID(dictid);
+#endif
+}
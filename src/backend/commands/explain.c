@@ -1748,12 +1748,20 @@ ExplainNode(PlanState *planstate, List *ancestors,
 			if (es->analyze)
 				show_tidbitmap_info((BitmapHeapScanState *) planstate, es);
 			break;
+		case T_SeqScan:
+			show_scan_qual(plan->qual, "Filter", planstate, ancestors, es);
+			if (plan->qual)
+				show_instrumentation_count("Rows Removed by Filter", 1,
+										   planstate, es);
+			if (((SeqScan *) plan)->filterkeys)
+				show_instrumentation_count("Rows Removed by Hash Join Filter", 2,
+										   planstate, es);
+			break;
 		case T_SampleScan:
 			show_tablesample(((SampleScan *) plan)->tablesample,
 							 planstate, ancestors, es);
 			/* fall through to print additional fields the same as SeqScan */
 			/* FALLTHROUGH */
-		case T_SeqScan:
 		case T_ValuesScan:
 		case T_CteScan:
 		case T_NamedTuplestoreScan:
@@ -3000,6 +3008,8 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 											  worker_hi->nbatch_original);
 			hinstrument.space_peak = Max(hinstrument.space_peak,
 										 worker_hi->space_peak);
+			hinstrument.npartitions = Max(hinstrument.npartitions,
+										  worker_hi->npartitions);
 		}
 	}
 
@@ -3019,6 +3029,8 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 								   hinstrument.nbatch_original, es);
 			ExplainPropertyInteger("Peak Memory Usage", "kB",
 								   spacePeakKb, es);
+			ExplainPropertyInteger("Radix Partitions", NULL,
+								   hinstrument.npartitions, es);
 		}
 		else if (hinstrument.nbatch_original != hinstrument.nbatch ||
 				 hinstrument.nbuckets_original != hinstrument.nbuckets)
@@ -3040,6 +3052,13 @@ show_hash_info(HashState *hashstate, ExplainState *es)
 							 hinstrument.nbuckets, hinstrument.nbatch,
 							 spacePeakKb);
 		}
+
+		if (es->format == EXPLAIN_FORMAT_TEXT && hinstrument.npartitions > 1)
+		{
+			ExplainIndentText(es);
+			appendStringInfo(es->str, "Radix Partitions: %d\n",
+							 hinstrument.npartitions);
+		}
 	}
 }
 
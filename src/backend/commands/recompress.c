@@ -0,0 +1,381 @@
+/*-------------------------------------------------------------------------
+ *
+ * recompress.c
+ *	  Convert a table's compressed values to the columns' current
+ *	  compression methods, for VACUUM (RECOMPRESS).
+ *
+ * ALTER TABLE ... SET COMPRESSION only affects values compressed after the
+ * change.  Rewriting the table would convert the rest, but needs an
+ * AccessExclusiveLock for the whole rewrite.  Instead, we walk the heap a
+ * few pages at a time and update each row that has a value compressed with
+ * some other method, replacing the value with its decompressed form so that
+ * the toaster compresses it anew.  Each batch of pages is processed in its
+ * own transaction, and we only hold a ShareUpdateExclusiveLock across them,
+ * so concurrent reads and writes of the table go on undisturbed; vacuum
+ * cost-based delay throttles the work.  VACUUM then removes the old row
+ * versions.
+ *
+ * These updates don't change any column's value, so neither triggers nor
+ * constraints are checked, much as for the tuple movement done by CLUSTER.
+ * They are real updates otherwise: the new row versions get a new xmin, and
+ * logical decoding replicates them as UPDATEs, so a table that publishes
+ * updates needs a replica identity, as for any other update.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/commands/recompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/detoast.h"
+#include "access/heapam.h"
+#include "access/table.h"
+#include "access/tableam.h"
+#include "access/toast_compression.h"
+#include "access/xact.h"
+#include "catalog/pg_am.h"
+#include "commands/vacuum.h"
+#include "executor/executor.h"
+#include "miscadmin.h"
+#include "storage/bufmgr.h"
+#include "storage/lmgr.h"
+#include "utils/acl.h"
+#include "utils/builtins.h"
+#include "utils/memutils.h"
+#include "utils/rel.h"
+#include "utils/snapmgr.h"
+
+/* Number of heap pages whose rows are recompressed in one transaction */
+#define RECOMPRESS_PAGES_PER_XACT	128
+
+static int	recompress_columns(Relation onerel, AttrNumber *attnums,
+							   ToastCompressionId *cmids);
+static void recompress_batch(Oid relid, BlockNumber startblk,
+							 BlockNumber nblocks, AttrNumber *attnums,
+							 ToastCompressionId *cmids, int ncolumns,
+							 double *num_rows, double *num_skipped);
+
+
+/*
+ *	recompress_rel() -- recompress the values of one relation
+ *
+ * This is called by vacuum() for each relation before vacuum_rel(), with no
+ * transaction active.  Relations that vacuum_rel() will skip are skipped
+ * here silently, leaving it to vacuum_rel() to complain.
+ */
+void
+recompress_rel(Oid relid, VacuumParams *params)
+{
+	Relation	onerel;
+	LockRelId	onerelid;
+	Oid			relowner;
+	NameData	relname;
+	AttrNumber	attnums[MaxHeapAttributeNumber];
+	ToastCompressionId cmids[MaxHeapAttributeNumber];
+	int			ncolumns;
+	BlockNumber nblocks;
+	BlockNumber blkno;
+	Oid			save_userid;
+	int			save_sec_context;
+	int			elevel;
+	double		num_rows = 0;
+	double		num_skipped = 0;
+
+	Assert(params->options & VACOPT_RECOMPRESS);
+
+	if (params->options & VACOPT_VERBOSE)
+		elevel = INFO;
+	else
+		elevel = DEBUG2;
+
+	StartTransactionCommand();
+
+	onerel = vacuum_open_relation(relid, NULL, params->options, false,
+								  ShareUpdateExclusiveLock);
+	if (!onerel)
+	{
+		CommitTransactionCommand();
+		return;
+	}
+
+	/* same test as vacuum_is_relation_owner(), without the WARNING */
+	if (onerel->rd_rel->relkind != RELKIND_RELATION ||
+		RELATION_IS_OTHER_TEMP(onerel) ||
+		!(pg_class_ownercheck(relid, GetUserId()) ||
+		  (pg_database_ownercheck(MyDatabaseId, GetUserId()) &&
+		   !onerel->rd_rel->relisshared)))
+	{
+		relation_close(onerel, ShareUpdateExclusiveLock);
+		CommitTransactionCommand();
+		return;
+	}
+
+	/* we walk the heap block by block */
+	if (onerel->rd_rel->relam != HEAP_TABLE_AM_OID)
+	{
+		ereport(WARNING,
+				(errmsg("skipping recompression of \"%s\" --- only heap tables can be recompressed",
+						RelationGetRelationName(onerel))));
+		relation_close(onerel, ShareUpdateExclusiveLock);
+		CommitTransactionCommand();
+		return;
+	}
+
+	ncolumns = recompress_columns(onerel, attnums, cmids);
+	if (ncolumns == 0)
+	{
+		relation_close(onerel, ShareUpdateExclusiveLock);
+		CommitTransactionCommand();
+		return;
+	}
+
+	/*
+	 * Only look at the pages there are now.  Our own updates may move rows
+	 * beyond them, but those have been recompressed already.  Rows that
+	 * others add there are not necessarily compressed with the current
+	 * methods, as a value that is already compressed, say by INSERT ...
+	 * SELECT from another table, is stored as it is; like rows that are
+	 * concurrently updated, they are left for a later run.
+	 */
+	nblocks = RelationGetNumberOfBlocks(onerel);
+
+	/* the owner cannot change under our lock */
+	relowner = onerel->rd_rel->relowner;
+	namestrcpy(&relname, RelationGetRelationName(onerel));
+
+	/*
+	 * Get a session-level lock, which keeps the relation from being
+	 * altered, rewritten or dropped between our transactions.
+	 */
+	onerelid = onerel->rd_lockInfo.lockRelId;
+	LockRelationIdForSession(&onerelid, ShareUpdateExclusiveLock);
+
+	relation_close(onerel, NoLock);
+	CommitTransactionCommand();
+
+	/* run index functions as the table owner, as vacuum_rel() does */
+	GetUserIdAndSecContext(&save_userid, &save_sec_context);
+	SetUserIdAndSecContext(relowner,
+						   save_sec_context | SECURITY_RESTRICTED_OPERATION);
+
+	for (blkno = 0; blkno < nblocks; blkno += RECOMPRESS_PAGES_PER_XACT)
+	{
+		recompress_batch(relid, blkno,
+						 Min(RECOMPRESS_PAGES_PER_XACT, nblocks - blkno),
+						 attnums, cmids, ncolumns,
+						 &num_rows, &num_skipped);
+	}
+
+	SetUserIdAndSecContext(save_userid, save_sec_context);
+
+	UnlockRelationIdForSession(&onerelid, ShareUpdateExclusiveLock);
+
+	ereport(elevel,
+			(errmsg("\"%s\": recompressed %.0f rows in %u pages",
+					NameStr(relname), num_rows, nblocks),
+			 num_skipped > 0 ?
+			 errdetail("%.0f rows were skipped because they were concurrently updated or deleted.",
+					   num_skipped) : 0));
+}
+
+/*
+ * Find the columns of the relation whose values the toaster compresses, and
+ * the compression method it uses for each.  Returns the number of columns
+ * found; their numbers and methods are stored into the arrays.
+ */
+static int
+recompress_columns(Relation onerel, AttrNumber *attnums,
+				   ToastCompressionId *cmids)
+{
+	TupleDesc	tupdesc = RelationGetDescr(onerel);
+	int			ncolumns = 0;
+
+	for (int i = 0; i < tupdesc->natts; i++)
+	{
+		Form_pg_attribute att = TupleDescAttr(tupdesc, i);
+		char		cmethod;
+
+		if (att->attisdropped || att->attlen != -1)
+			continue;
+
+		/* STORAGE PLAIN and EXTERNAL columns are never compressed */
+		if (att->attstorage != TYPSTORAGE_EXTENDED &&
+			att->attstorage != TYPSTORAGE_MAIN)
+			continue;
+
+		/* must match toast_tuple_try_compression() */
+		cmethod = att->attcompression;
+		if (!CompressionMethodIsValid(cmethod))
+			cmethod = default_toast_compression;
+
+		attnums[ncolumns] = att->attnum;
+		cmids[ncolumns] = GetCompressionRoutine(cmethod)->cmid;
+		ncolumns++;
+	}
+
+	return ncolumns;
+}
+
+/*
+ * Recompress the rows of nblocks pages starting at startblk, in a
+ * transaction of its own.  The numbers of rows updated and of rows that
+ * could not be updated are added to *num_rows and *num_skipped.
+ */
+static void
+recompress_batch(Oid relid, BlockNumber startblk, BlockNumber nblocks,
+				 AttrNumber *attnums, ToastCompressionId *cmids, int ncolumns,
+				 double *num_rows, double *num_skipped)
+{
+	Relation	onerel;
+	Snapshot	snapshot;
+	EState	   *estate;
+	ResultRelInfo *resultRelInfo;
+	TableScanDesc scan;
+	TupleTableSlot *oldslot;
+	TupleTableSlot *newslot;
+	MemoryContext tuplecxt;
+	MemoryContext oldcxt;
+
+	StartTransactionCommand();
+	snapshot = RegisterSnapshot(GetTransactionSnapshot());
+	PushActiveSnapshot(snapshot);
+
+	onerel = table_open(relid, RowExclusiveLock);
+
+	/* set up the little executor state that index insertion needs */
+	estate = CreateExecutorState();
+	resultRelInfo = makeNode(ResultRelInfo);
+	InitResultRelInfo(resultRelInfo, onerel, 1, NULL, 0);
+	estate->es_result_relations = resultRelInfo;
+	estate->es_num_result_relations = 1;
+	estate->es_result_relation_info = resultRelInfo;
+	estate->es_output_cid = GetCurrentCommandId(true);
+	estate->es_snapshot = snapshot;
+	ExecOpenIndices(resultRelInfo, false);
+
+	oldslot = table_slot_create(onerel, NULL);
+	newslot = table_slot_create(onerel, NULL);
+
+	tuplecxt = AllocSetContextCreate(CurrentMemoryContext,
+									 "recompress tuple",
+									 ALLOCSET_DEFAULT_SIZES);
+
+	/* no synchronized scan, so that the limits below are honored */
+	scan = table_beginscan_strat(onerel, snapshot, 0, NULL, true, false);
+	heap_setscanlimits(scan, startblk, nblocks);
+
+	while (table_scan_getnextslot(scan, ForwardScanDirection, oldslot))
+	{
+		bool		needed = false;
+		TM_Result	result;
+		TM_FailureData tmfd;
+		LockTupleMode lockmode;
+		bool		update_indexes;
+
+		vacuum_delay_point();
+
+		for (int i = 0; i < ncolumns; i++)
+		{
+			Datum		value;
+			bool		isnull;
+			ToastCompressionId cmid;
+
+			value = slot_getattr(oldslot, attnums[i], &isnull);
+			if (isnull)
+				continue;
+
+			cmid = toast_get_compression_id((struct varlena *) DatumGetPointer(value));
+			if (cmid != TOAST_INVALID_COMPRESSION_ID && cmid != cmids[i])
+			{
+				needed = true;
+				break;
+			}
+		}
+
+		if (!needed)
+			continue;
+
+		oldcxt = MemoryContextSwitchTo(tuplecxt);
+
+		/*
+		 * Form the new row from decompressed copies of the values to
+		 * convert; the toaster compresses those again with the column's
+		 * method, and leaves the other values alone.
+		 */
+		ExecClearTuple(newslot);
+		slot_getallattrs(oldslot);
+		memcpy(newslot->tts_values, oldslot->tts_values,
+			   oldslot->tts_nvalid * sizeof(Datum));
+		memcpy(newslot->tts_isnull, oldslot->tts_isnull,
+			   oldslot->tts_nvalid * sizeof(bool));
+
+		for (int i = 0; i < ncolumns; i++)
+		{
+			int			off = attnums[i] - 1;
+			struct varlena *attr;
+			ToastCompressionId cmid;
+
+			if (newslot->tts_isnull[off])
+				continue;
+
+			attr = (struct varlena *) DatumGetPointer(newslot->tts_values[off]);
+			cmid = toast_get_compression_id(attr);
+			if (cmid != TOAST_INVALID_COMPRESSION_ID && cmid != cmids[i])
+				newslot->tts_values[off] = PointerGetDatum(detoast_attr(attr));
+		}
+		ExecStoreVirtualTuple(newslot);
+
+		CheckCmdReplicaIdentity(onerel, CMD_UPDATE);
+
+		result = table_tuple_update(onerel, &oldslot->tts_tid, newslot,
+									estate->es_output_cid,
+									snapshot, InvalidSnapshot,
+									true /* wait for commit */ ,
+									&tmfd, &lockmode, &update_indexes);
+
+		switch (result)
+		{
+			case TM_Ok:
+				if (resultRelInfo->ri_NumIndices > 0 && update_indexes)
+					list_free(ExecInsertIndexTuples(newslot, estate, false,
+													NULL, NIL));
+				*num_rows += 1;
+				break;
+
+			case TM_Updated:
+			case TM_Deleted:
+				/* leave it for another run */
+				*num_skipped += 1;
+				break;
+
+			default:
+				elog(ERROR, "unrecognized table_tuple_update status: %u",
+					 result);
+				break;
+		}
+
+		MemoryContextSwitchTo(oldcxt);
+		ExecClearTuple(newslot);
+		MemoryContextReset(tuplecxt);
+		ResetPerTupleExprContext(estate);
+	}
+
+	table_endscan(scan);
+
+	ExecDropSingleTupleTableSlot(oldslot);
+	ExecDropSingleTupleTableSlot(newslot);
+	MemoryContextDelete(tuplecxt);
+	ExecCloseIndices(resultRelInfo);
+	FreeExecutorState(estate);
+
+	table_close(onerel, NoLock);
+
+	PopActiveSnapshot();
+	UnregisterSnapshot(snapshot);
+	CommitTransactionCommand();
+}
@@ -0,0 +1,736 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.c
+ *	  Batch execution of scans, quals and aggregates.
+ *
+ * A TupleBatch holds up to EXEC_BATCH_SIZE rows read by a sequential scan.
+ * The columns referenced by batch-aware steps are extracted from the rows
+ * into one array per column, so that those steps can be run as tight loops
+ * over a column instead of going through the expression evaluation
+ * machinery once per row.
+ *
+ * Only a few, very common, operations are supported: comparisons of an
+ * integer, float or date column with a constant, and the transition
+ * functions of count, sum, min and max over such columns.  Each of them
+ * must behave exactly like the function it replaces, including its error
+ * behavior; anything else is left to the regular per-row code.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/executor/execBatch.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/colcache.h"
+#include "access/htup_details.h"
+#include "catalog/pg_type.h"
+#include "common/int.h"
+#include "executor/execBatch.h"
+#include "executor/executor.h"
+#include "nodes/nodeFuncs.h"
+#include "storage/bufmgr.h"
+#include "utils/date.h"
+#include "utils/float.h"
+#include "utils/fmgroids.h"
+
+/* GUC parameter */
+bool		enable_batch_execution = false;
+
+/*
+ * Comparison functions that can be evaluated over a column, with the types
+ * of their arguments.
+ */
+typedef struct BatchCompareFunc
+{
+	Oid			funcid;
+	Oid			lefttype;
+	Oid			righttype;
+	BatchCompare cmp;
+} BatchCompareFunc;
+
+#define BATCH_COMPARE_FUNCS(prefix, lefttype, righttype) \
+	{F_##prefix##LT, lefttype, righttype, BATCH_LT}, \
+	{F_##prefix##LE, lefttype, righttype, BATCH_LE}, \
+	{F_##prefix##EQ, lefttype, righttype, BATCH_EQ}, \
+	{F_##prefix##NE, lefttype, righttype, BATCH_NE}, \
+	{F_##prefix##GE, lefttype, righttype, BATCH_GE}, \
+	{F_##prefix##GT, lefttype, righttype, BATCH_GT}
+
+static const BatchCompareFunc batch_compare_funcs[] = {
+	BATCH_COMPARE_FUNCS(INT2, INT2OID, INT2OID),
+	BATCH_COMPARE_FUNCS(INT4, INT4OID, INT4OID),
+	BATCH_COMPARE_FUNCS(INT8, INT8OID, INT8OID),
+	BATCH_COMPARE_FUNCS(INT24, INT2OID, INT4OID),
+	BATCH_COMPARE_FUNCS(INT42, INT4OID, INT2OID),
+	BATCH_COMPARE_FUNCS(INT28, INT2OID, INT8OID),
+	BATCH_COMPARE_FUNCS(INT82, INT8OID, INT2OID),
+	BATCH_COMPARE_FUNCS(INT48, INT4OID, INT8OID),
+	BATCH_COMPARE_FUNCS(INT84, INT8OID, INT4OID),
+	BATCH_COMPARE_FUNCS(FLOAT4, FLOAT4OID, FLOAT4OID),
+	BATCH_COMPARE_FUNCS(FLOAT8, FLOAT8OID, FLOAT8OID),
+	BATCH_COMPARE_FUNCS(FLOAT48, FLOAT4OID, FLOAT8OID),
+	BATCH_COMPARE_FUNCS(FLOAT84, FLOAT8OID, FLOAT4OID),
+	BATCH_COMPARE_FUNCS(DATE_, DATEOID, DATEOID)
+};
+
+/*
+ * Aggregate transition functions that can be advanced over a column, with
+ * the type of their input.  count(any) accepts any input.
+ */
+typedef struct BatchAggFunc
+{
+	Oid			transfn;
+	Oid			inputtype;
+	BatchAggKind kind;
+} BatchAggFunc;
+
+static const BatchAggFunc batch_agg_funcs[] = {
+	{F_INT8INC, InvalidOid, BATCH_AGG_COUNT_STAR},
+	{F_INT8INC_ANY, InvalidOid, BATCH_AGG_COUNT},
+	{F_INT2_SUM, INT2OID, BATCH_AGG_SUM_INT},
+	{F_INT4_SUM, INT4OID, BATCH_AGG_SUM_INT},
+	{F_FLOAT4PL, FLOAT4OID, BATCH_AGG_SUM_FLOAT},
+	{F_FLOAT8PL, FLOAT8OID, BATCH_AGG_SUM_FLOAT},
+	{F_INT2SMALLER, INT2OID, BATCH_AGG_MIN},
+	{F_INT4SMALLER, INT4OID, BATCH_AGG_MIN},
+	{F_INT8SMALLER, INT8OID, BATCH_AGG_MIN},
+	{F_FLOAT4SMALLER, FLOAT4OID, BATCH_AGG_MIN},
+	{F_FLOAT8SMALLER, FLOAT8OID, BATCH_AGG_MIN},
+	{F_DATE_SMALLER, DATEOID, BATCH_AGG_MIN},
+	{F_INT2LARGER, INT2OID, BATCH_AGG_MAX},
+	{F_INT4LARGER, INT4OID, BATCH_AGG_MAX},
+	{F_INT8LARGER, INT8OID, BATCH_AGG_MAX},
+	{F_FLOAT4LARGER, FLOAT4OID, BATCH_AGG_MAX},
+	{F_FLOAT8LARGER, FLOAT8OID, BATCH_AGG_MAX},
+	{F_DATE_LARGER, DATEOID, BATCH_AGG_MAX}
+};
+
+static inline bool
+batch_type_is_float(Oid type)
+{
+	return type == FLOAT4OID || type == FLOAT8OID;
+}
+
+/* Convert an integer or date datum of the given type to int64 */
+static inline int64
+batch_datum_get_int64(Datum value, Oid type)
+{
+	switch (type)
+	{
+		case INT2OID:
+			return DatumGetInt16(value);
+		case INT4OID:
+			return DatumGetInt32(value);
+		case INT8OID:
+			return DatumGetInt64(value);
+		case DATEOID:
+			return DatumGetDateADT(value);
+	}
+	elog(ERROR, "unexpected type %u in batch", type);
+	return 0;					/* keep compiler quiet */
+}
+
+/*
+ * Convert a float datum of the given type to float8.  Every float4 value
+ * converts exactly, so comparing as float8 gives the same results as the
+ * float4 functions do.
+ */
+static inline float8
+batch_datum_get_float8(Datum value, Oid type)
+{
+	if (type == FLOAT4OID)
+		return DatumGetFloat4(value);
+	return DatumGetFloat8(value);
+}
+
+/*
+ * ExecCreateBatch
+ *
+ * Create an empty batch for rows of the given descriptor, stored in slots
+ * of the given kind.  Columns are added with ExecBatchAddColumn.
+ */
+TupleBatch *
+ExecCreateBatch(EState *estate, TupleDesc tupdesc,
+				const TupleTableSlotOps *tts_ops)
+{
+	TupleBatch *batch;
+	int			i;
+
+	batch = palloc0(sizeof(TupleBatch));
+	batch->selected = palloc(sizeof(uint16) * EXEC_BATCH_SIZE);
+	batch->slots = palloc(sizeof(TupleTableSlot *) * EXEC_BATCH_SIZE);
+	for (i = 0; i < EXEC_BATCH_SIZE; i++)
+		batch->slots[i] = ExecAllocTableSlot(&estate->es_tupleTable,
+											 tupdesc, tts_ops);
+
+	batch->maxcolumns = 4;
+	batch->attnums = palloc(sizeof(AttrNumber) * batch->maxcolumns);
+	batch->values = palloc(sizeof(Datum *) * batch->maxcolumns);
+	batch->isnull = palloc(sizeof(bool *) * batch->maxcolumns);
+
+	return batch;
+}
+
+/*
+ * ExecBatchAddColumn
+ *
+ * Arrange for the given attribute to be extracted into a column of the
+ * batch, and return the index of that column.
+ */
+int
+ExecBatchAddColumn(TupleBatch *batch, AttrNumber attnum)
+{
+	int			i;
+
+	Assert(attnum > 0);
+
+	for (i = 0; i < batch->ncolumns; i++)
+	{
+		if (batch->attnums[i] == attnum)
+			return i;
+	}
+
+	if (batch->ncolumns == batch->maxcolumns)
+	{
+		batch->maxcolumns *= 2;
+		batch->attnums = repalloc(batch->attnums,
+								  sizeof(AttrNumber) * batch->maxcolumns);
+		batch->values = repalloc(batch->values,
+								 sizeof(Datum *) * batch->maxcolumns);
+		batch->isnull = repalloc(batch->isnull,
+								 sizeof(bool *) * batch->maxcolumns);
+	}
+
+	batch->attnums[i] = attnum;
+	batch->values[i] = palloc(sizeof(Datum) * EXEC_BATCH_SIZE);
+	batch->isnull[i] = palloc(sizeof(bool) * EXEC_BATCH_SIZE);
+	batch->maxattr = Max(batch->maxattr, attnum);
+
+	return batch->ncolumns++;
+}
+
+/*
+ * ExecBatchReset
+ *
+ * Empty the batch, releasing the buffer pins held by its rows.
+ */
+void
+ExecBatchReset(TupleBatch *batch)
+{
+	int			i;
+
+	for (i = 0; i < batch->nrows; i++)
+		ExecClearTuple(batch->slots[i]);
+
+	batch->nrows = 0;
+	batch->nselected = 0;
+	batch->next = 0;
+}
+
+/*
+ * Fetch the columns of a row directly from the columnar cache entry of its
+ * page, without deforming it.  Returns false if the page has no valid entry,
+ * or the entry doesn't cover all the columns.
+ */
+static bool
+batch_fetch_cached_row(TupleBatch *batch, int row)
+{
+	TupleTableSlot *slot = batch->slots[row];
+	BufferHeapTupleTableSlot *bslot = (BufferHeapTupleTableSlot *) slot;
+	TupleDesc	tupdesc = slot->tts_tupleDescriptor;
+	ColumnarPage *cpage;
+	OffsetNumber offnum;
+	char	   *page;
+	int			col;
+
+	if (!TTS_IS_BUFFERTUPLE(slot) || !BufferIsValid(bslot->buffer))
+		return false;
+
+	cpage = ColumnarCacheLookup(bslot->buffer, bslot->base.tuple);
+	if (cpage == NULL || batch->maxattr > cpage->natts ||
+		batch->maxattr > HeapTupleHeaderGetNatts(bslot->base.tuple->t_data))
+		return false;
+
+	page = (char *) BufferGetPage(bslot->buffer);
+	offnum = ItemPointerGetOffsetNumber(&bslot->base.tuple->t_self);
+
+	for (col = 0; col < batch->ncolumns; col++)
+	{
+		AttrNumber	attnum = batch->attnums[col];
+		uint16		attoff = ColumnarPageOffset(cpage, attnum, offnum);
+
+		if (attoff == 0)
+		{
+			batch->values[col][row] = (Datum) 0;
+			batch->isnull[col][row] = true;
+		}
+		else
+		{
+			batch->values[col][row] =
+				fetchatt(TupleDescAttr(tupdesc, attnum - 1), page + attoff);
+			batch->isnull[col][row] = false;
+		}
+	}
+
+	return true;
+}
+
+/*
+ * ExecBatchExtractColumns
+ *
+ * Extract the columns of the batch from its rows, and select all rows.
+ * Rows on pages that are in the columnar cache only have the columns
+ * fetched, rather than being deformed up to the last one.
+ */
+void
+ExecBatchExtractColumns(TupleBatch *batch)
+{
+	int			row;
+	int			col;
+
+	for (row = 0; row < batch->nrows; row++)
+	{
+		TupleTableSlot *slot = batch->slots[row];
+
+		batch->selected[row] = row;
+
+		if (ColumnarCacheInUse && batch_fetch_cached_row(batch, row))
+			continue;
+
+		slot_getsomeattrs(slot, batch->maxattr);
+
+		for (col = 0; col < batch->ncolumns; col++)
+		{
+			int			attoff = batch->attnums[col] - 1;
+
+			batch->values[col][row] = slot->tts_values[attoff];
+			batch->isnull[col][row] = slot->tts_isnull[attoff];
+		}
+	}
+
+	batch->nselected = batch->nrows;
+	batch->next = 0;
+}
+
+/*
+ * ExecBatchMakePredicate
+ *
+ * If the clause is a comparison of a column of the batch's rows with a
+ * constant that can be evaluated over a column, fill in *pred, adding the
+ * column to the batch, and return true.  Otherwise return false.
+ */
+bool
+ExecBatchMakePredicate(Expr *clause, TupleBatch *batch, BatchPredicate *pred)
+{
+	OpExpr	   *opexpr;
+	Node	   *leftop;
+	Node	   *rightop;
+	Var		   *var;
+	Const	   *con;
+	bool		commuted;
+	int			i;
+
+	if (!IsA(clause, OpExpr))
+		return false;
+	opexpr = (OpExpr *) clause;
+	if (list_length(opexpr->args) != 2)
+		return false;
+	set_opfuncid(opexpr);
+
+	leftop = (Node *) linitial(opexpr->args);
+	rightop = (Node *) lsecond(opexpr->args);
+
+	if (IsA(leftop, Var) && IsA(rightop, Const))
+	{
+		var = (Var *) leftop;
+		con = (Const *) rightop;
+		commuted = false;
+	}
+	else if (IsA(leftop, Const) && IsA(rightop, Var))
+	{
+		var = (Var *) rightop;
+		con = (Const *) leftop;
+		commuted = true;
+	}
+	else
+		return false;
+
+	/* a null constant makes the comparison null for every row */
+	if (var->varattno <= 0 || var->varlevelsup != 0 || con->constisnull)
+		return false;
+
+	for (i = 0; i < lengthof(batch_compare_funcs); i++)
+	{
+		const BatchCompareFunc *func = &batch_compare_funcs[i];
+
+		if (func->funcid != opexpr->opfuncid)
+			continue;
+
+		if (exprType(leftop) != func->lefttype ||
+			exprType(rightop) != func->righttype)
+			return false;
+
+		pred->column = ExecBatchAddColumn(batch, var->varattno);
+		pred->coltype = var->vartype;
+		pred->cmp = func->cmp;
+
+		/* express "const op column" as "column op' const" */
+		if (commuted)
+		{
+			switch (func->cmp)
+			{
+				case BATCH_LT:
+					pred->cmp = BATCH_GT;
+					break;
+				case BATCH_LE:
+					pred->cmp = BATCH_GE;
+					break;
+				case BATCH_GE:
+					pred->cmp = BATCH_LE;
+					break;
+				case BATCH_GT:
+					pred->cmp = BATCH_LT;
+					break;
+				default:
+					break;
+			}
+		}
+
+		if (batch_type_is_float(con->consttype))
+		{
+			pred->fvalue = batch_datum_get_float8(con->constvalue,
+												  con->consttype);
+			pred->ivalue = 0;
+		}
+		else
+		{
+			pred->ivalue = batch_datum_get_int64(con->constvalue,
+												 con->consttype);
+			pred->fvalue = 0;
+		}
+		return true;
+	}
+
+	return false;
+}
+
+/*
+ * Keep the selected rows of the batch for which "test" is true.  Rows where
+ * the column is null are dropped, as a strict comparison yields null for
+ * them.
+ */
+#define BATCH_FILTER_LOOP(getvalue, test) \
+	do { \
+		for (i = 0; i < batch->nselected; i++) \
+		{ \
+			int			row = batch->selected[i]; \
+			\
+			if (!isnull[row]) \
+			{ \
+				value = getvalue(values[row]); \
+				if (test) \
+					batch->selected[nselected++] = row; \
+			} \
+		} \
+	} while (0)
+
+#define BATCH_FILTER_CMP(getvalue, constval, lt, le, eq, ne, ge, gt) \
+	do { \
+		switch (pred->cmp) \
+		{ \
+			case BATCH_LT: \
+				BATCH_FILTER_LOOP(getvalue, lt(value, constval)); \
+				break; \
+			case BATCH_LE: \
+				BATCH_FILTER_LOOP(getvalue, le(value, constval)); \
+				break; \
+			case BATCH_EQ: \
+				BATCH_FILTER_LOOP(getvalue, eq(value, constval)); \
+				break; \
+			case BATCH_NE: \
+				BATCH_FILTER_LOOP(getvalue, ne(value, constval)); \
+				break; \
+			case BATCH_GE: \
+				BATCH_FILTER_LOOP(getvalue, ge(value, constval)); \
+				break; \
+			case BATCH_GT: \
+				BATCH_FILTER_LOOP(getvalue, gt(value, constval)); \
+				break; \
+		} \
+	} while (0)
+
+#define INT_LT(a, b) ((a) < (b))
+#define INT_LE(a, b) ((a) <= (b))
+#define INT_EQ(a, b) ((a) == (b))
+#define INT_NE(a, b) ((a) != (b))
+#define INT_GE(a, b) ((a) >= (b))
+#define INT_GT(a, b) ((a) > (b))
+
+/*
+ * ExecBatchFilter
+ *
+ * Remove the rows that do not satisfy the predicate from the selection.
+ */
+void
+ExecBatchFilter(TupleBatch *batch, BatchPredicate *pred)
+{
+	Datum	   *values = batch->values[pred->column];
+	bool	   *isnull = batch->isnull[pred->column];
+	int			nselected = 0;
+	int			i;
+
+	switch (pred->coltype)
+	{
+		case INT2OID:
+			{
+				int64		value;
+
+				BATCH_FILTER_CMP(DatumGetInt16, pred->ivalue,
+								 INT_LT, INT_LE, INT_EQ, INT_NE, INT_GE, INT_GT);
+				break;
+			}
+		case INT4OID:
+			{
+				int64		value;
+
+				BATCH_FILTER_CMP(DatumGetInt32, pred->ivalue,
+								 INT_LT, INT_LE, INT_EQ, INT_NE, INT_GE, INT_GT);
+				break;
+			}
+		case INT8OID:
+			{
+				int64		value;
+
+				BATCH_FILTER_CMP(DatumGetInt64, pred->ivalue,
+								 INT_LT, INT_LE, INT_EQ, INT_NE, INT_GE, INT_GT);
+				break;
+			}
+		case DATEOID:
+			{
+				int64		value;
+
+				BATCH_FILTER_CMP(DatumGetDateADT, pred->ivalue,
+								 INT_LT, INT_LE, INT_EQ, INT_NE, INT_GE, INT_GT);
+				break;
+			}
+		case FLOAT4OID:
+			{
+				float8		value;
+
+				BATCH_FILTER_CMP(DatumGetFloat4, pred->fvalue,
+								 float8_lt, float8_le, float8_eq, float8_ne,
+								 float8_ge, float8_gt);
+				break;
+			}
+		case FLOAT8OID:
+			{
+				float8		value;
+
+				BATCH_FILTER_CMP(DatumGetFloat8, pred->fvalue,
+								 float8_lt, float8_le, float8_eq, float8_ne,
+								 float8_ge, float8_gt);
+				break;
+			}
+		default:
+			elog(ERROR, "unexpected type %u in batch", pred->coltype);
+	}
+
+	batch->nselected = nselected;
+}
+
+/*
+ * ExecBatchAggSupported
+ *
+ * Can an aggregate with the given transition function, input type and
+ * initial value be advanced over a column of a batch?  If so, return its
+ * kind in *kind.
+ */
+bool
+ExecBatchAggSupported(Oid transfn_oid, Oid inputtype, bool initValueIsNull,
+					  BatchAggKind *kind)
+{
+	int			i;
+
+	for (i = 0; i < lengthof(batch_agg_funcs); i++)
+	{
+		const BatchAggFunc *func = &batch_agg_funcs[i];
+
+		if (func->transfn != transfn_oid)
+			continue;
+		if (OidIsValid(func->inputtype) && func->inputtype != inputtype)
+			return false;
+
+		/*
+		 * count() starts from zero.  An aggregate that uses its transition
+		 * functions without an initial value starts from its first input
+		 * instead, as they are strict, which batch_count doesn't do.
+		 */
+		if ((func->kind == BATCH_AGG_COUNT_STAR ||
+			 func->kind == BATCH_AGG_COUNT) && initValueIsNull)
+			return false;
+
+		*kind = func->kind;
+		return true;
+	}
+
+	return false;
+}
+
+static void
+batch_count(Datum *transValue, bool *transValueIsNull, int64 n)
+{
+	int64		result;
+
+	/* int8inc and int8inc_any are strict */
+	if (*transValueIsNull)
+		return;
+
+	if (unlikely(pg_add_s64_overflow(DatumGetInt64(*transValue), n, &result)))
+		ereport(ERROR,
+				(errcode(ERRCODE_NUMERIC_VALUE_OUT_OF_RANGE),
+				 errmsg("bigint out of range")));
+
+	*transValue = Int64GetDatum(result);
+}
+
+/*
+ * ExecBatchAdvanceAggregate
+ *
+ * Advance the transition state of an aggregate with all the selected rows
+ * of the batch.  'column' is the aggregate's argument, unused for count(*),
+ * and 'type' its type.  The state is passed the way nodeAgg.c keeps it.
+ *
+ * All of the transition values handled here are pass-by-value.
+ */
+void
+ExecBatchAdvanceAggregate(BatchAggKind kind, Oid type,
+						  TupleBatch *batch, int column,
+						  Datum *transValue, bool *transValueIsNull,
+						  bool *noTransValue)
+{
+	Datum	   *values;
+	bool	   *isnull;
+	int			i;
+
+	if (kind == BATCH_AGG_COUNT_STAR)
+	{
+		batch_count(transValue, transValueIsNull, batch->nselected);
+		return;
+	}
+
+	values = batch->values[column];
+	isnull = batch->isnull[column];
+
+	switch (kind)
+	{
+		case BATCH_AGG_COUNT:
+			{
+				int64		n = 0;
+
+				for (i = 0; i < batch->nselected; i++)
+				{
+					if (!isnull[batch->selected[i]])
+						n++;
+				}
+				batch_count(transValue, transValueIsNull, n);
+				break;
+			}
+
+		case BATCH_AGG_SUM_INT:
+			{
+				/*
+				 * int2_sum and int4_sum are not strict: they ignore null
+				 * inputs, and start from the first non-null one.
+				 */
+				int64		sum = 0;
+				bool		found = false;
+
+				for (i = 0; i < batch->nselected; i++)
+				{
+					int			row = batch->selected[i];
+
+					if (isnull[row])
+						continue;
+					if (type == INT2OID)
+						sum += DatumGetInt16(values[row]);
+					else
+						sum += DatumGetInt32(values[row]);
+					found = true;
+				}
+
+				if (!found)
+					break;
+				if (*transValueIsNull)
+					*transValue = Int64GetDatum(sum);
+				else
+					*transValue = Int64GetDatum(DatumGetInt64(*transValue) + sum);
+				*transValueIsNull = false;
+				break;
+			}
+
+		case BATCH_AGG_SUM_FLOAT:
+		case BATCH_AGG_MIN:
+		case BATCH_AGG_MAX:
+			{
+				/*
+				 * These transition functions are strict and have no initial
+				 * value: the first non-null input becomes the state.
+				 */
+				for (i = 0; i < batch->nselected; i++)
+				{
+					int			row = batch->selected[i];
+					Datum		value = values[row];
+
+					if (isnull[row])
+						continue;
+
+					if (*noTransValue)
+					{
+						*transValue = value;
+						*transValueIsNull = false;
+						*noTransValue = false;
+						continue;
+					}
+					if (*transValueIsNull)
+						break;
+
+					if (kind == BATCH_AGG_SUM_FLOAT)
+					{
+						if (type == FLOAT4OID)
+							*transValue = Float4GetDatum(float4_pl(DatumGetFloat4(*transValue),
+																   DatumGetFloat4(value)));
+						else
+							*transValue = Float8GetDatum(float8_pl(DatumGetFloat8(*transValue),
+																   DatumGetFloat8(value)));
+					}
+					else if (batch_type_is_float(type))
+					{
+						float8		state = batch_datum_get_float8(*transValue, type);
+						float8		input = batch_datum_get_float8(value, type);
+
+						if (kind == BATCH_AGG_MIN ? !float8_lt(state, input) :
+							!float8_gt(state, input))
+							*transValue = value;
+					}
+					else
+					{
+						int64		state = batch_datum_get_int64(*transValue, type);
+						int64		input = batch_datum_get_int64(value, type);
+
+						if (kind == BATCH_AGG_MIN ? input < state : input > state)
+							*transValue = value;
+					}
+				}
+				break;
+			}
+
+		case BATCH_AGG_COUNT_STAR:
+			Assert(false);
+			break;
+	}
+}
@@ -133,31 +133,17 @@ ExecScanFetch(ScanState *node,
 	return (*accessMtd) (node);
 }
 
-/* ----------------------------------------------------------------
- *		ExecScan
- *
- *		Scans the relation using the 'access method' indicated and
- *		returns the next qualifying tuple.
- *		The access method returns the next tuple and ExecScan() is
- *		responsible for checking the tuple returned against the qual-clause.
- *
- *		A 'recheck method' must also be provided that can check an
- *		arbitrary tuple of the relation against any qual conditions
- *		that are implemented internal to the access method.
- *
- *		Conditions:
- *		  -- the "cursor" maintained by the AMI is positioned at the tuple
- *			 returned previously.
+/*
+ * ExecScanExtended -- workhorse of ExecScan and ExecScanFiltered
  *
- *		Initial States:
- *		  -- the relation indicated is opened for scanning so that the
- *			 "cursor" is positioned before the first qualifying tuple.
- * ----------------------------------------------------------------
+ * filterMtd may be NULL.  As this is inlined into both, ExecScan pays
+ * nothing for the filter method it doesn't have.
  */
-TupleTableSlot *
-ExecScan(ScanState *node,
-		 ExecScanAccessMtd accessMtd,	/* function returning a tuple */
-		 ExecScanRecheckMtd recheckMtd)
+static inline TupleTableSlot *
+ExecScanExtended(ScanState *node,
+				 ExecScanAccessMtd accessMtd,	/* function returning a tuple */
+				 ExecScanRecheckMtd recheckMtd,
+				 ExecScanFilterMtd filterMtd)
 {
 	ExprContext *econtext;
 	ExprState  *qual;
@@ -176,7 +162,7 @@ ExecScan(ScanState *node,
 	 * If we have neither a qual to check nor a projection to do, just skip
 	 * all the overhead and return the raw scan tuple.
 	 */
-	if (!qual && !projInfo)
+	if (!qual && !projInfo && !filterMtd)
 	{
 		ResetExprContext(econtext);
 		return ExecScanFetch(node, accessMtd, recheckMtd);
@@ -226,6 +212,16 @@ ExecScan(ScanState *node,
 		 */
 		if (qual == NULL || ExecQual(qual, econtext))
 		{
+			/*
+			 * Skip the tuple if the filter method rejects it.  It counts the
+			 * tuples it rejects itself, if it wants to.
+			 */
+			if (filterMtd != NULL && !(*filterMtd) (node, slot))
+			{
+				ResetExprContext(econtext);
+				continue;
+			}
+
 			/*
 			 * Found a satisfactory scan tuple.
 			 */
@@ -255,6 +251,55 @@ ExecScan(ScanState *node,
 	}
 }
 
+/* ----------------------------------------------------------------
+ *		ExecScan
+ *
+ *		Scans the relation using the 'access method' indicated and
+ *		returns the next qualifying tuple.
+ *		The access method returns the next tuple and ExecScan() is
+ *		responsible for checking the tuple returned against the qual-clause.
+ *
+ *		A 'recheck method' must also be provided that can check an
+ *		arbitrary tuple of the relation against any qual conditions
+ *		that are implemented internal to the access method.
+ *
+ *		Conditions:
+ *		  -- the "cursor" maintained by the AMI is positioned at the tuple
+ *			 returned previously.
+ *
+ *		Initial States:
+ *		  -- the relation indicated is opened for scanning so that the
+ *			 "cursor" is positioned before the first qualifying tuple.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecScan(ScanState *node,
+		 ExecScanAccessMtd accessMtd,	/* function returning a tuple */
+		 ExecScanRecheckMtd recheckMtd)
+{
+	return ExecScanExtended(node, accessMtd, recheckMtd, NULL);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecScanFiltered
+ *
+ *		Like ExecScan, but also checks each tuple that satisfies the
+ *		qual-clause with the given 'filter method', just before it is
+ *		projected.  The filter method returns false to skip the tuple.
+ *		As it only sees the tuples that passed the qual-clause, which
+ *		includes any security barrier quals, it can't leak the values
+ *		of other tuples, nor fail on them.
+ * ----------------------------------------------------------------
+ */
+TupleTableSlot *
+ExecScanFiltered(ScanState *node,
+				 ExecScanAccessMtd accessMtd,
+				 ExecScanRecheckMtd recheckMtd,
+				 ExecScanFilterMtd filterMtd)
+{
+	return ExecScanExtended(node, accessMtd, recheckMtd, filterMtd);
+}
+
 /*
  * ExecAssignScanProjectionInfo
  *		Set up projection info for a scan node, if necessary.
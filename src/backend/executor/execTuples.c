@@ -57,6 +57,7 @@
  */
 #include "postgres.h"
 
+#include "access/colcache.h"
 #include "access/heaptoast.h"
 #include "access/htup_details.h"
 #include "access/tupdesc_details.h"
@@ -73,6 +74,9 @@ static TupleDesc ExecTypeFromTLInternal(List *targetList,
 										bool skipjunk);
 static pg_attribute_always_inline void slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 															  int natts);
+static void slot_deform_cached_heap_tuple(TupleTableSlot *slot,
+										  HeapTuple tuple, Buffer buffer,
+										  uint32 *offp, int natts);
 static inline void tts_buffer_heap_store_tuple(TupleTableSlot *slot,
 											   HeapTuple tuple,
 											   Buffer buffer,
@@ -671,6 +675,10 @@ tts_buffer_heap_getsomeattrs(TupleTableSlot *slot, int natts)
 
 	Assert(!TTS_EMPTY(slot));
 
+	if (ColumnarCacheInUse && BufferIsValid(bslot->buffer))
+		slot_deform_cached_heap_tuple(slot, bslot->base.tuple, bslot->buffer,
+									  &bslot->base.off, natts);
+
 	slot_deform_heap_tuple(slot, bslot->base.tuple, &bslot->base.off, natts);
 }
 
@@ -991,6 +999,71 @@ slot_deform_heap_tuple(TupleTableSlot *slot, HeapTuple tuple, uint32 *offp,
 		slot->tts_flags &= ~TTS_FLAG_SLOW;
 }
 
+/*
+ * slot_deform_cached_heap_tuple
+ *		Like slot_deform_heap_tuple, but using the offsets of the attributes
+ *		in the columnar cache, if the tuple's page has a valid entry there.
+ *
+ * Attributes not in the cache entry are left for slot_deform_heap_tuple to
+ * extract, so the state we leave behind must be what it would have left.
+ */
+static void
+slot_deform_cached_heap_tuple(TupleTableSlot *slot, HeapTuple tuple,
+							  Buffer buffer, uint32 *offp, int natts)
+{
+	TupleDesc	tupleDesc = slot->tts_tupleDescriptor;
+	Datum	   *values = slot->tts_values;
+	bool	   *isnull = slot->tts_isnull;
+	ColumnarPage *cpage;
+	OffsetNumber offnum;
+	char	   *page;
+	char	   *tp;
+	int			attnum;
+	uint32		off;
+
+	attnum = slot->tts_nvalid;
+	if (attnum >= natts)
+		return;
+
+	cpage = ColumnarCacheLookup(buffer, tuple);
+	if (cpage == NULL)
+		return;
+
+	natts = Min(natts, cpage->natts);
+	natts = Min(HeapTupleHeaderGetNatts(tuple->t_data), natts);
+	if (attnum >= natts)
+		return;
+
+	page = (char *) BufferGetPage(buffer);
+	offnum = ItemPointerGetOffsetNumber(&tuple->t_self);
+	tp = (char *) tuple->t_data + tuple->t_data->t_hoff;
+	off = (attnum == 0) ? 0 : *offp;
+
+	for (; attnum < natts; attnum++)
+	{
+		Form_pg_attribute thisatt = TupleDescAttr(tupleDesc, attnum);
+		uint16		attoff = ColumnarPageOffset(cpage, attnum + 1, offnum);
+
+		if (attoff == 0)
+		{
+			values[attnum] = (Datum) 0;
+			isnull[attnum] = true;
+			continue;
+		}
+
+		values[attnum] = fetchatt(thisatt, page + attoff);
+		isnull[attnum] = false;
+
+		off = att_addlength_pointer((page + attoff) - tp, thisatt->attlen,
+									page + attoff);
+	}
+
+	/* the offsets of the remaining attributes can't be cached */
+	slot->tts_nvalid = attnum;
+	*offp = off;
+	slot->tts_flags |= TTS_FLAG_SLOW;
+}
+
 
 const TupleTableSlotOps TTSOpsVirtual = {
 	.base_slot_size = sizeof(VirtualTupleTableSlot),
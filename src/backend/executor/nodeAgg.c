@@ -249,6 +249,7 @@
 #include "executor/execExpr.h"
 #include "executor/executor.h"
 #include "executor/nodeAgg.h"
+#include "executor/nodeSeqscan.h"
 #include "lib/hyperloglog.h"
 #include "miscadmin.h"
 #include "nodes/makefuncs.h"
@@ -432,6 +433,8 @@ static void initialize_hash_entry(AggState *aggstate,
 								  TupleHashEntry entry);
 static void lookup_hash_entries(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_direct(AggState *aggstate);
+static void agg_setup_batch(AggState *aggstate);
+static TupleTableSlot *agg_retrieve_batch(AggState *aggstate);
 static void agg_fill_hash_table(AggState *aggstate);
 static bool agg_refill_hash_table(AggState *aggstate);
 static TupleTableSlot *agg_retrieve_hash_table(AggState *aggstate);
@@ -2167,6 +2170,12 @@ ExecAgg(PlanState *pstate)
 				result = agg_retrieve_hash_table(node);
 				break;
 			case AGG_PLAIN:
+				if (node->batch_input)
+				{
+					result = agg_retrieve_batch(node);
+					break;
+				}
+				/* FALLTHROUGH */
 			case AGG_SORTED:
 				result = agg_retrieve_direct(node);
 				break;
@@ -2525,6 +2534,137 @@ agg_retrieve_direct(AggState *aggstate)
 	return NULL;
 }
 
+/*
+ * Decide whether a plain aggregate can read its input a batch at a time,
+ * and if so set up the per-transition batch information.
+ *
+ * That's possible if the input is a sequential scan doing batch execution
+ * without a projection, and every aggregate is a simple one whose transition
+ * function execBatch.c can run directly over a column of the scanned rows.
+ */
+static void
+agg_setup_batch(AggState *aggstate)
+{
+	Agg		   *node = (Agg *) aggstate->ss.ps.plan;
+	PlanState  *outerstate = outerPlanState(aggstate);
+	SeqScanState *scanstate;
+	AggStatePerBatch perbatch;
+	AttrNumber *attnums;
+	int			transno;
+
+	if (aggstate->aggstrategy != AGG_PLAIN ||
+		node->groupingSets != NIL ||
+		DO_AGGSPLIT_COMBINE(aggstate->aggsplit) ||
+		aggstate->numtrans == 0)
+		return;
+
+	if (!IsA(outerstate, SeqScanState))
+		return;
+	scanstate = (SeqScanState *) outerstate;
+	if (scanstate->batch == NULL || scanstate->ss.ps.ps_ProjInfo != NULL)
+		return;
+
+	perbatch = palloc(sizeof(AggStatePerBatchData) * aggstate->numtrans);
+	attnums = palloc(sizeof(AttrNumber) * aggstate->numtrans);
+
+	for (transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		AggStatePerTrans pertrans = &aggstate->pertrans[transno];
+		Aggref	   *aggref = pertrans->aggref;
+		Oid			inputtype = InvalidOid;
+
+		if (aggref->aggkind != AGGKIND_NORMAL ||
+			aggref->aggfilter != NULL ||
+			pertrans->numSortCols > 0 ||
+			pertrans->numTransInputs > 1 ||
+			!pertrans->transtypeByVal)
+			return;
+
+		attnums[transno] = InvalidAttrNumber;
+		if (pertrans->numTransInputs == 1)
+		{
+			TargetEntry *tle = linitial_node(TargetEntry, aggref->args);
+			Var		   *var = (Var *) tle->expr;
+
+			/* without a projection, the scan's output is the scanned row */
+			if (!IsA(var, Var) || var->varno != OUTER_VAR ||
+				var->varattno <= 0)
+				return;
+			attnums[transno] = var->varattno;
+			inputtype = var->vartype;
+		}
+
+		if (!ExecBatchAggSupported(pertrans->transfn_oid, inputtype,
+								   pertrans->initValueIsNull,
+								   &perbatch[transno].kind))
+			return;
+		perbatch[transno].type = inputtype;
+	}
+
+	for (transno = 0; transno < aggstate->numtrans; transno++)
+	{
+		if (attnums[transno] != InvalidAttrNumber)
+			perbatch[transno].column =
+				ExecBatchAddColumn(scanstate->batch, attnums[transno]);
+		else
+			perbatch[transno].column = -1;
+	}
+	pfree(attnums);
+
+	aggstate->batch_input = scanstate;
+	aggstate->perbatch = perbatch;
+}
+
+/*
+ * ExecAgg for a plain aggregate reading its input a batch at a time
+ *
+ * This does what agg_retrieve_direct does for the single group of a plain
+ * aggregate, but advances each transition state over the selected rows of
+ * a batch at once, instead of running the transition expression per row.
+ */
+static TupleTableSlot *
+agg_retrieve_batch(AggState *aggstate)
+{
+	ExprContext *econtext = aggstate->ss.ps.ps_ExprContext;
+	AggStatePerGroup pergroup;
+	TupleBatch *batch;
+	int			transno;
+
+	ReScanExprContext(econtext);
+	ReScanExprContext(aggstate->aggcontexts[0]);
+
+	initialize_aggregates(aggstate, aggstate->pergroups, 1);
+	pergroup = aggstate->pergroups[0];
+
+	while ((batch = ExecSeqScanNextBatch(aggstate->batch_input)) != NULL)
+	{
+		for (transno = 0; transno < aggstate->numtrans; transno++)
+		{
+			AggStatePerBatch perbatch = &aggstate->perbatch[transno];
+			AggStatePerGroup pergroupstate = &pergroup[transno];
+
+			ExecBatchAdvanceAggregate(perbatch->kind, perbatch->type,
+									  batch, perbatch->column,
+									  &pergroupstate->transValue,
+									  &pergroupstate->transValueIsNull,
+									  &pergroupstate->noTransValue);
+		}
+	}
+
+	aggstate->agg_done = true;
+
+	/* there are no references to input columns; see agg_retrieve_direct */
+	econtext->ecxt_outertuple = aggstate->ss.ss_ScanTupleSlot;
+
+	prepare_projection_slot(aggstate, econtext->ecxt_outertuple, 0);
+
+	select_current_set(aggstate, 0, false);
+
+	finalize_aggregates(aggstate, aggstate->peragg, pergroup);
+
+	return project_aggregates(aggstate);
+}
+
 /*
  * ExecAgg for hashed case: read input and build hash table
  */
@@ -4077,6 +4217,9 @@ ExecInitAgg(Agg *node, EState *estate, int eflags)
 		phase->evaltrans_cache[0][0] = phase->evaltrans;
 	}
 
+	/* Read the input a batch at a time, if possible */
+	agg_setup_batch(aggstate);
+
 	return aggstate;
 }
 
@@ -44,6 +44,21 @@
 #include "utils/memutils.h"
 #include "utils/syscache.h"
 
+/* GUC parameter */
+int			cpu_cache_size = 4096;
+
+/*
+ * Number of tuples Parallel Hash collects before linking them into the
+ * shared buckets in partition order; enough for a chunk of small tuples.
+ */
+#define HASH_RADIX_DEFER_TUPLES		1024
+
+/*
+ * The planner only asks for radix partitioning when a batch is expected to
+ * be at least this many times cpu_cache_size.
+ */
+#define HASH_RADIX_MIN_CACHES		4
+
 static void ExecHashIncreaseNumBatches(HashJoinTable hashtable);
 static void ExecHashIncreaseNumBuckets(HashJoinTable hashtable);
 static void ExecParallelHashIncreaseNumBatches(HashJoinTable hashtable);
@@ -57,6 +72,9 @@ static void ExecHashSkewTableInsert(HashJoinTable hashtable,
 static void ExecHashRemoveNextSkewBucket(HashJoinTable hashtable);
 
 static void *dense_alloc(HashJoinTable hashtable, Size size);
+static int64 ExecHashFilterElems(Hash *node);
+static void ExecParallelHashDeferTuple(HashJoinTable hashtable,
+									   dsa_pointer shared);
 static HashJoinTuple ExecParallelHashTupleAlloc(HashJoinTable hashtable,
 												size_t size,
 												dsa_pointer *shared);
@@ -174,6 +192,11 @@ MultiExecPrivateHash(HashState *node)
 		{
 			int			bucketNumber;
 
+			if (hashtable->filter)
+				bloom_add_element(hashtable->filter,
+								  (unsigned char *) &hashvalue,
+								  sizeof(hashvalue));
+
 			bucketNumber = ExecHashGetSkewBucket(hashtable, hashvalue);
 			if (bucketNumber != INVALID_SKEW_BUCKET_NO)
 			{
@@ -191,12 +214,18 @@ MultiExecPrivateHash(HashState *node)
 		}
 	}
 
-	/* resize the hash table if needed (NTUP_PER_BUCKET exceeded) */
-	if (hashtable->nbuckets != hashtable->nbuckets_optimal)
+	/*
+	 * If the tuples are to be linked into the buckets a radix partition at a
+	 * time, do that now; otherwise resize the hash table if needed
+	 * (NTUP_PER_BUCKET exceeded).
+	 */
+	if (hashtable->log2_npartitions_max > 0)
+		ExecHashBuildPartitions(hashtable);
+	else if (hashtable->nbuckets != hashtable->nbuckets_optimal)
 		ExecHashIncreaseNumBuckets(hashtable);
 
 	/* Account for the buckets in spaceUsed (reported in EXPLAIN ANALYZE) */
-	hashtable->spaceUsed += hashtable->nbuckets * sizeof(HashJoinTuple);
+	hashtable->spaceUsed += hashtable->nbuckets * HJ_BUCKET_SIZE;
 	if (hashtable->spaceUsed > hashtable->spacePeak)
 		hashtable->spacePeak = hashtable->spaceUsed;
 
@@ -290,6 +319,8 @@ MultiExecParallelHash(HashState *node)
 					ExecParallelHashTableInsert(hashtable, slot, hashvalue);
 				hashtable->partialTuples++;
 			}
+			if (hashtable->ndeferred > 0)
+				ExecParallelHashFlushTuples(hashtable);
 
 			/*
 			 * Make sure that any tuples we wrote to disk are visible to
@@ -486,6 +517,15 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 	hashtable->log2_nbuckets = log2_nbuckets;
 	hashtable->log2_nbuckets_optimal = log2_nbuckets;
 	hashtable->buckets.unshared = NULL;
+	hashtable->bucketTags = NULL;
+	hashtable->log2_npartitions = 0;
+	hashtable->log2_npartitions_max = 0;
+	if (node->radix_partitions > 1)
+		hashtable->log2_npartitions_max =
+			my_log2(Min(node->radix_partitions, HASH_RADIX_MAX_PARTITIONS));
+	hashtable->deferred = NULL;
+	hashtable->ndeferred = 0;
+	hashtable->filter = NULL;
 	hashtable->keepNulls = keepNulls;
 	hashtable->skewEnabled = false;
 	hashtable->skewBucket = NULL;
@@ -578,6 +618,20 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 		PrepareTempTablespaces();
 	}
 
+	/*
+	 * Parallel Hash partitions every batch as planned, since the
+	 * participants can't easily agree on anything else.
+	 */
+	if (hashtable->parallel_state && hashtable->log2_npartitions_max > 0)
+	{
+		hashtable->log2_npartitions = hashtable->log2_npartitions_max;
+		hashtable->deferred = (dsa_pointer *)
+			palloc(HASH_RADIX_DEFER_TUPLES * sizeof(dsa_pointer));
+	}
+
+	if (state->build_filter)
+		hashtable->filter = bloom_create(ExecHashFilterElems(node), work_mem, 0);
+
 	MemoryContextSwitchTo(oldcxt);
 
 	if (hashtable->parallel_state)
@@ -638,6 +692,7 @@ ExecHashTableCreate(HashState *state, List *hashOperators, List *hashCollations,
 
 		hashtable->buckets.unshared = (HashJoinTuple *)
 			palloc0(nbuckets * sizeof(HashJoinTuple));
+		hashtable->bucketTags = (uint8 *) palloc0(nbuckets * sizeof(uint8));
 
 		/*
 		 * Set up for skew optimization, if possible and there's a need for
@@ -843,6 +898,81 @@ ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 	*numbatches = nbatch;
 }
 
+/*
+ * Choose the number of radix partitions for each batch of a hash table of
+ * the given dimensions (see ExecChooseHashTableSize).  This is 1 unless a
+ * batch is expected to be much larger than cpu_cache_size, in which case we
+ * want enough partitions for each to fit in that.
+ *
+ * This is exported so that the planner's costsize.c can use it.  The
+ * executor adapts the number to the actual size of each batch, but never
+ * exceeds what was planned.
+ */
+int
+ExecChooseHashPartitions(double ntuples, int tupwidth, int nbuckets,
+						 int nbatch)
+{
+	double		cache_bytes = (double) cpu_cache_size * 1024.0;
+	double		batch_bytes;
+	int			tupsize;
+	int			npartitions;
+
+	/* Force a plausible relation size if no info */
+	if (ntuples <= 0.0)
+		ntuples = 1000.0;
+
+	/* Estimate the size of a batch as ExecChooseHashTableSize does */
+	tupsize = HJTUPLE_OVERHEAD +
+		MAXALIGN(SizeofMinimalTupleHeader) +
+		MAXALIGN(tupwidth);
+	batch_bytes = ntuples / nbatch * tupsize +
+		(double) nbuckets * HJ_BUCKET_SIZE;
+
+	if (batch_bytes < HASH_RADIX_MIN_CACHES * cache_bytes)
+		return 1;
+
+	npartitions = 2;
+	while (npartitions < HASH_RADIX_MAX_PARTITIONS &&
+		   batch_bytes / npartitions > cache_bytes)
+		npartitions *= 2;
+	Assert(npartitions <= nbuckets);
+
+	return npartitions;
+}
+
+
+/*
+ * ExecHashFilterElems
+ *		Expected number of elements in the Bloom filter of a hash table
+ *
+ * The filter is created before any inner tuples have been read, so it's
+ * sized from the planner's estimate.  The filter doesn't need to be exact;
+ * fewer elements than estimated just leave more bits unset, and a few times
+ * more only raise the false positive rate.
+ */
+static int64
+ExecHashFilterElems(Hash *node)
+{
+	return (int64) Max(outerPlan(node)->plan_rows, 1.0);
+}
+
+/*
+ * ExecHashFilterSize
+ *		Size of the Bloom filter that a Hash node will build
+ *
+ * If build_filter is set, ExecHashTableCreate creates a Bloom filter in the
+ * hash table, which MultiExecPrivateHash fills with the hash value of every
+ * inner tuple, including the tuples of later batches and of skew buckets.
+ * Callers that need to make room for a copy of the filter ahead of time,
+ * such as a parallel scan that shares it with workers, can find its size
+ * here.
+ */
+Size
+ExecHashFilterSize(HashState *node)
+{
+	return bloom_estimate(ExecHashFilterElems((Hash *) node->ps.plan),
+						  work_mem);
+}
 
 /* ----------------------------------------------------------------
  *		ExecHashTableDestroy
@@ -957,6 +1087,9 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 		hashtable->buckets.unshared =
 			repalloc(hashtable->buckets.unshared,
 					 sizeof(HashJoinTuple) * hashtable->nbuckets);
+		hashtable->bucketTags =
+			repalloc(hashtable->bucketTags,
+					 sizeof(uint8) * hashtable->nbuckets);
 	}
 
 	/*
@@ -966,6 +1099,7 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 	 */
 	memset(hashtable->buckets.unshared, 0,
 		   sizeof(HashJoinTuple) * hashtable->nbuckets);
+	memset(hashtable->bucketTags, 0, sizeof(uint8) * hashtable->nbuckets);
 	oldchunks = hashtable->chunks;
 	hashtable->chunks = NULL;
 
@@ -1001,6 +1135,8 @@ ExecHashIncreaseNumBatches(HashJoinTable hashtable)
 				/* and add it back to the appropriate bucket */
 				copyTuple->next.unshared = hashtable->buckets.unshared[bucketno];
 				hashtable->buckets.unshared[bucketno] = copyTuple;
+				hashtable->bucketTags[bucketno] |=
+					HJ_BUCKET_TAG(hashTuple->hashvalue);
 			}
 			else
 			{
@@ -1460,9 +1596,13 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 	hashtable->buckets.unshared =
 		(HashJoinTuple *) repalloc(hashtable->buckets.unshared,
 								   hashtable->nbuckets * sizeof(HashJoinTuple));
+	hashtable->bucketTags =
+		(uint8 *) repalloc(hashtable->bucketTags,
+						   hashtable->nbuckets * sizeof(uint8));
 
 	memset(hashtable->buckets.unshared, 0,
 		   hashtable->nbuckets * sizeof(HashJoinTuple));
+	memset(hashtable->bucketTags, 0, hashtable->nbuckets * sizeof(uint8));
 
 	/* scan through all tuples in all chunks to rebuild the hash table */
 	for (chunk = hashtable->chunks; chunk != NULL; chunk = chunk->next.unshared)
@@ -1482,6 +1622,8 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 			/* add the tuple to the proper bucket */
 			hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
 			hashtable->buckets.unshared[bucketno] = hashTuple;
+			hashtable->bucketTags[bucketno] |=
+				HJ_BUCKET_TAG(hashTuple->hashvalue);
 
 			/* advance index past the tuple */
 			idx += MAXALIGN(HJTUPLE_OVERHEAD +
@@ -1493,6 +1635,155 @@ ExecHashIncreaseNumBuckets(HashJoinTable hashtable)
 	}
 }
 
+/*
+ * ExecHashBuildPartitions
+ *		link the tuples of the current batch into the buckets, one radix
+ *		partition at a time
+ *
+ * When the plan allows radix partitioning, ExecHashTableInsert only stores
+ * the tuples, and this is called once the whole batch has been loaded.  We
+ * choose enough partitions for each to fit in cpu_cache_size, copy every
+ * tuple into the chunks of its partition, and then link each partition's
+ * tuples into its range of buckets in turn, so that both the tuples read
+ * and the buckets written stay in cache.  The probes are grouped by
+ * partition in the same way; see ExecHashJoinPrefetchOuter.
+ */
+void
+ExecHashBuildPartitions(HashJoinTable hashtable)
+{
+	Size		cache_size = (Size) cpu_cache_size * 1024;
+	Size		batch_size;
+	HashMemoryChunk *partchunks;
+	HashMemoryChunk chunk;
+	int			log2_npartitions;
+	int			npartitions;
+	int			i;
+
+	Assert(hashtable->log2_npartitions_max > 0);
+
+	/* The number of buckets is final now, so allocate them at that size */
+	if (hashtable->nbuckets != hashtable->nbuckets_optimal)
+	{
+		hashtable->nbuckets = hashtable->nbuckets_optimal;
+		hashtable->log2_nbuckets = hashtable->log2_nbuckets_optimal;
+		hashtable->buckets.unshared =
+			(HashJoinTuple *) repalloc(hashtable->buckets.unshared,
+									   hashtable->nbuckets * sizeof(HashJoinTuple));
+		hashtable->bucketTags =
+			(uint8 *) repalloc(hashtable->bucketTags,
+							   hashtable->nbuckets * sizeof(uint8));
+	}
+	memset(hashtable->buckets.unshared, 0,
+		   hashtable->nbuckets * sizeof(HashJoinTuple));
+	memset(hashtable->bucketTags, 0, hashtable->nbuckets * sizeof(uint8));
+
+	/* Choose the number of partitions from the batch's actual size */
+	batch_size = hashtable->spaceUsed + hashtable->nbuckets * HJ_BUCKET_SIZE;
+	log2_npartitions = 0;
+	while (log2_npartitions < hashtable->log2_npartitions_max &&
+		   (batch_size >> log2_npartitions) > cache_size)
+		log2_npartitions++;
+	hashtable->log2_npartitions = log2_npartitions;
+	npartitions = 1 << log2_npartitions;
+
+	partchunks = (HashMemoryChunk *)
+		MemoryContextAllocZero(hashtable->batchCxt,
+							   npartitions * sizeof(HashMemoryChunk));
+
+	if (npartitions == 1)
+	{
+		/* the tuples are already where they need to be */
+		partchunks[0] = hashtable->chunks;
+	}
+	else
+	{
+		HashMemoryChunk oldchunks = hashtable->chunks;
+
+		/*
+		 * Copy each tuple into its partition's list of chunks, freeing the
+		 * old chunks as we go.  dense_alloc allocates from the list in
+		 * hashtable->chunks, so point that at the right partition's list.
+		 */
+		while (oldchunks != NULL)
+		{
+			HashMemoryChunk nextchunk = oldchunks->next.unshared;
+			size_t		idx = 0;
+
+			while (idx < oldchunks->used)
+			{
+				HashJoinTuple hashTuple = (HashJoinTuple) (HASH_CHUNK_DATA(oldchunks) + idx);
+				MinimalTuple tuple = HJTUPLE_MINTUPLE(hashTuple);
+				int			hashTupleSize = (HJTUPLE_OVERHEAD + tuple->t_len);
+				HashJoinTuple copyTuple;
+				int			partno;
+				int			bucketno;
+				int			batchno;
+
+				ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+										  &bucketno, &batchno);
+				Assert(batchno == hashtable->curbatch);
+				partno = HJ_RADIX_PARTITION(hashtable, bucketno);
+
+				hashtable->chunks = partchunks[partno];
+				copyTuple = (HashJoinTuple) dense_alloc(hashtable, hashTupleSize);
+				partchunks[partno] = hashtable->chunks;
+				memcpy(copyTuple, hashTuple, hashTupleSize);
+
+				idx += MAXALIGN(hashTupleSize);
+			}
+
+			pfree(oldchunks);
+			oldchunks = nextchunk;
+
+			/* allow this loop to be cancellable */
+			CHECK_FOR_INTERRUPTS();
+		}
+	}
+
+	/* Now link each partition's tuples into its buckets */
+	hashtable->chunks = NULL;
+	for (i = 0; i < npartitions; i++)
+	{
+		HashMemoryChunk last = NULL;
+
+		for (chunk = partchunks[i]; chunk != NULL; chunk = chunk->next.unshared)
+		{
+			size_t		idx = 0;
+
+			while (idx < chunk->used)
+			{
+				HashJoinTuple hashTuple = (HashJoinTuple) (HASH_CHUNK_DATA(chunk) + idx);
+				int			bucketno;
+				int			batchno;
+
+				ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+										  &bucketno, &batchno);
+
+				hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
+				hashtable->buckets.unshared[bucketno] = hashTuple;
+				hashtable->bucketTags[bucketno] |=
+					HJ_BUCKET_TAG(hashTuple->hashvalue);
+
+				idx += MAXALIGN(HJTUPLE_OVERHEAD +
+								HJTUPLE_MINTUPLE(hashTuple)->t_len);
+			}
+			last = chunk;
+
+			/* allow this loop to be cancellable */
+			CHECK_FOR_INTERRUPTS();
+		}
+
+		/* keep all the chunks on the batch's list */
+		if (last != NULL)
+		{
+			last->next.unshared = hashtable->chunks;
+			hashtable->chunks = partchunks[i];
+		}
+	}
+
+	pfree(partchunks);
+}
+
 static void
 ExecParallelHashIncreaseNumBuckets(HashJoinTable hashtable)
 {
@@ -1632,9 +1923,16 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		 */
 		HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
 
-		/* Push it onto the front of the bucket's list */
-		hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
-		hashtable->buckets.unshared[bucketno] = hashTuple;
+		/*
+		 * Push it onto the front of the bucket's list, unless that's left to
+		 * ExecHashBuildPartitions.
+		 */
+		if (hashtable->log2_npartitions_max == 0)
+		{
+			hashTuple->next.unshared = hashtable->buckets.unshared[bucketno];
+			hashtable->buckets.unshared[bucketno] = hashTuple;
+			hashtable->bucketTags[bucketno] |= HJ_BUCKET_TAG(hashvalue);
+		}
 
 		/*
 		 * Increase the (optimal) number of buckets if we just exceeded the
@@ -1658,7 +1956,7 @@ ExecHashTableInsert(HashJoinTable hashtable,
 		if (hashtable->spaceUsed > hashtable->spacePeak)
 			hashtable->spacePeak = hashtable->spaceUsed;
 		if (hashtable->spaceUsed +
-			hashtable->nbuckets_optimal * sizeof(HashJoinTuple)
+			hashtable->nbuckets_optimal * HJ_BUCKET_SIZE
 			> hashtable->spaceAllowed)
 			ExecHashIncreaseNumBatches(hashtable);
 	}
@@ -1712,9 +2010,15 @@ retry:
 		hashTuple->hashvalue = hashvalue;
 		memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
 
-		/* Push it onto the front of the bucket's list */
-		ExecParallelHashPushTuple(&hashtable->buckets.shared[bucketno],
-								  hashTuple, shared);
+		/*
+		 * Push it onto the front of the bucket's list, or leave that to
+		 * ExecParallelHashFlushTuples.
+		 */
+		if (hashtable->log2_npartitions_max > 0)
+			ExecParallelHashDeferTuple(hashtable, shared);
+		else
+			ExecParallelHashPushTuple(&hashtable->buckets.shared[bucketno],
+									  hashTuple, shared);
 	}
 	else
 	{
@@ -1766,13 +2070,87 @@ ExecParallelHashTableInsertCurrentBatch(HashJoinTable hashtable,
 	hashTuple->hashvalue = hashvalue;
 	memcpy(HJTUPLE_MINTUPLE(hashTuple), tuple, tuple->t_len);
 	HeapTupleHeaderClearMatch(HJTUPLE_MINTUPLE(hashTuple));
-	ExecParallelHashPushTuple(&hashtable->buckets.shared[bucketno],
-							  hashTuple, shared);
+	if (hashtable->log2_npartitions_max > 0)
+		ExecParallelHashDeferTuple(hashtable, shared);
+	else
+		ExecParallelHashPushTuple(&hashtable->buckets.shared[bucketno],
+								  hashTuple, shared);
 
 	if (shouldFree)
 		heap_free_minimal_tuple(tuple);
 }
 
+/*
+ * Remember a tuple stored by ExecParallelHashTableInsert or
+ * ExecParallelHashTableInsertCurrentBatch, to be linked into its bucket by
+ * ExecParallelHashFlushTuples.
+ */
+static void
+ExecParallelHashDeferTuple(HashJoinTable hashtable, dsa_pointer shared)
+{
+	if (hashtable->ndeferred == HASH_RADIX_DEFER_TUPLES)
+		ExecParallelHashFlushTuples(hashtable);
+	hashtable->deferred[hashtable->ndeferred++] = shared;
+}
+
+/*
+ * ExecParallelHashFlushTuples
+ *		link the tuples this backend has stored since the last flush into
+ *		the shared buckets, sorted by radix partition
+ *
+ * A shared hash table can't be partitioned the way a private one is, as
+ * its chunks are filled by all participants at once, but we can at least
+ * sort our writes to the bucket array so that those to the same partition
+ * happen together.  Growing the number of batches or buckets relinks all
+ * the tuples in the table, so we flush whenever we might help to do that,
+ * that is, whenever ExecParallelHashTupleAlloc or
+ * ExecParallelHashTuplePrealloc takes the lock.  The callers flush again at
+ * the end of each load.
+ */
+void
+ExecParallelHashFlushTuples(HashJoinTable hashtable)
+{
+	int			npartitions = 1 << hashtable->log2_npartitions;
+	int			ndeferred = hashtable->ndeferred;
+	int			counts[HASH_RADIX_MAX_PARTITIONS + 1];
+	int			bucketnos[HASH_RADIX_DEFER_TUPLES];
+	int			order[HASH_RADIX_DEFER_TUPLES];
+	int			i;
+
+	/* Count the tuples in each partition ... */
+	memset(counts, 0, (npartitions + 1) * sizeof(int));
+	for (i = 0; i < ndeferred; i++)
+	{
+		HashJoinTuple hashTuple;
+		int			batchno;
+
+		hashTuple = (HashJoinTuple) dsa_get_address(hashtable->area,
+													hashtable->deferred[i]);
+		ExecHashGetBucketAndBatch(hashtable, hashTuple->hashvalue,
+								  &bucketnos[i], &batchno);
+		counts[HJ_RADIX_PARTITION(hashtable, bucketnos[i]) + 1]++;
+	}
+
+	/* ... sort them by partition ... */
+	for (i = 1; i < npartitions; i++)
+		counts[i] += counts[i - 1];
+	for (i = 0; i < ndeferred; i++)
+		order[counts[HJ_RADIX_PARTITION(hashtable, bucketnos[i])]++] = i;
+
+	/* ... and push them onto their buckets' lists in that order */
+	for (i = 0; i < ndeferred; i++)
+	{
+		dsa_pointer shared = hashtable->deferred[order[i]];
+
+		ExecParallelHashPushTuple(&hashtable->buckets.shared[bucketnos[order[i]]],
+								  (HashJoinTuple) dsa_get_address(hashtable->area,
+																  shared),
+								  shared);
+	}
+
+	hashtable->ndeferred = 0;
+}
+
 /*
  * ExecHashGetHashValue
  *		Compute the hash value for a tuple
@@ -1950,8 +2328,11 @@ ExecScanHashBucket(HashJoinState *hjstate,
 		hashTuple = hashTuple->next.unshared;
 	else if (hjstate->hj_CurSkewBucketNo != INVALID_SKEW_BUCKET_NO)
 		hashTuple = hashtable->skewBucket[hjstate->hj_CurSkewBucketNo]->tuples;
-	else
+	else if (hashtable->bucketTags[hjstate->hj_CurBucketNo] &
+			 HJ_BUCKET_TAG(hashvalue))
 		hashTuple = hashtable->buckets.unshared[hjstate->hj_CurBucketNo];
+	else
+		return false;			/* no tuple in the bucket has this hash value */
 
 	while (hashTuple != NULL)
 	{
@@ -2153,6 +2534,8 @@ ExecHashTableReset(HashJoinTable hashtable)
 	/* Reallocate and reinitialize the hash bucket headers. */
 	hashtable->buckets.unshared = (HashJoinTuple *)
 		palloc0(nbuckets * sizeof(HashJoinTuple));
+	hashtable->bucketTags = (uint8 *) palloc0(nbuckets * sizeof(uint8));
+	hashtable->log2_npartitions = 0;
 
 	hashtable->spaceUsed = 0;
 
@@ -2512,6 +2895,7 @@ ExecHashRemoveNextSkewBucket(HashJoinTable hashtable)
 
 			copyTuple->next.unshared = hashtable->buckets.unshared[bucketno];
 			hashtable->buckets.unshared[bucketno] = copyTuple;
+			hashtable->bucketTags[bucketno] |= HJ_BUCKET_TAG(hashvalue);
 
 			/* We have reduced skew space, but overall space doesn't change */
 			hashtable->spaceUsedSkew -= tupleSize;
@@ -2701,6 +3085,8 @@ ExecHashAccumInstrumentation(HashInstrumentation *instrument,
 									  hashtable->nbatch_original);
 	instrument->space_peak = Max(instrument->space_peak,
 								 hashtable->spacePeak);
+	instrument->npartitions = Max(instrument->npartitions,
+								  1 << hashtable->log2_npartitions);
 }
 
 /*
@@ -2821,7 +3207,12 @@ ExecParallelHashTupleAlloc(HashJoinTable hashtable, size_t size,
 		return result;
 	}
 
-	/* Slow path: try to allocate a new chunk. */
+	/*
+	 * Slow path: try to allocate a new chunk.  We might be about to help grow
+	 * the table, so link any tuples we've held back into the buckets first.
+	 */
+	if (hashtable->ndeferred > 0)
+		ExecParallelHashFlushTuples(hashtable);
 	LWLockAcquire(&pstate->lock, LW_EXCLUSIVE);
 
 	/*
@@ -3330,6 +3721,9 @@ ExecParallelHashTuplePrealloc(HashJoinTable hashtable, int batchno, size_t size)
 	Assert(batchno < hashtable->nbatch);
 	Assert(size == MAXALIGN(size));
 
+	/* As in ExecParallelHashTupleAlloc */
+	if (hashtable->ndeferred > 0)
+		ExecParallelHashFlushTuples(hashtable);
 	LWLockAcquire(&pstate->lock, LW_EXCLUSIVE);
 
 	/* Has another participant commanded us to help grow? */
@@ -112,6 +112,7 @@
 #include "executor/hashjoin.h"
 #include "executor/nodeHash.h"
 #include "executor/nodeHashjoin.h"
+#include "executor/nodeSeqscan.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "utils/memutils.h"
@@ -133,9 +134,24 @@
 /* Returns true if doing null-fill on inner relation */
 #define HJ_FILL_INNER(hjstate)	((hjstate)->hj_NullOuterTupleSlot != NULL)
 
+/*
+ * Number of outer tuples to read ahead; see ExecHashJoinPrefetchOuter.  When
+ * the hash table is radix partitioned, we read ahead that many per partition
+ * instead, so that they can be probed a partition at a time.
+ */
+#define HJ_PREFETCH_TUPLES		16
+#define HJ_PREFETCH_MAX_TUPLES	(HJ_PREFETCH_TUPLES * HASH_RADIX_MAX_PARTITIONS)
+
 static TupleTableSlot *ExecHashJoinOuterGetTuple(PlanState *outerNode,
 												 HashJoinState *hjstate,
 												 uint32 *hashvalue);
+static TupleTableSlot *ExecHashJoinOuterNextTuple(PlanState *outerNode,
+												  HashJoinState *hjstate,
+												  uint32 *hashvalue);
+static void ExecHashJoinPrefetchOuter(PlanState *outerNode,
+									  HashJoinState *hjstate);
+static inline void ExecHashJoinPrefetchBucket(HashJoinTable hashtable,
+											  uint32 hashvalue);
 static TupleTableSlot *ExecParallelHashJoinOuterGetTuple(PlanState *outerNode,
 														 HashJoinState *hjstate,
 														 uint32 *hashvalue);
@@ -298,6 +314,11 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 				if (hashtable->totalTuples == 0 && !HJ_FILL_OUTER(node))
 					return NULL;
 
+				/* Let the outer scan skip the rows that can't match */
+				if (hashtable->filter)
+					ExecSeqScanSetFilter(node->hj_FilterScan,
+										 hashtable->filter);
+
 				/*
 				 * need to remember whether nbatch has increased since we
 				 * began scanning the outer relation
@@ -338,7 +359,20 @@ ExecHashJoinImpl(PlanState *pstate, bool parallel)
 					continue;
 				}
 				else
+				{
+					/*
+					 * If the hash table is too big to stay in the CPU caches,
+					 * read outer tuples ahead so that we can prefetch the
+					 * buckets they hash to.
+					 */
+					node->hj_Prefetch =
+						(hashtable->spacePeak >= (Size) cpu_cache_size * 1024);
+					node->hj_PrefetchCount = 0;
+					node->hj_PrefetchNext = 0;
+					node->hj_PrefetchEnd = false;
+
 					node->hj_JoinState = HJ_NEED_NEW_OUTER;
+				}
 
 				/* FALL THRU */
 
@@ -663,6 +697,35 @@ ExecInitHashJoin(HashJoin *node, EState *estate, int eflags)
 	innerPlanState(hjstate) = ExecInitNode((Plan *) hashNode, estate, eflags);
 	innerDesc = ExecGetResultType(innerPlanState(hjstate));
 
+	/*
+	 * If the planner pushed a filter down to the outer scan, have the Hash
+	 * node build it.  If there's a Gather in between, the scan runs in
+	 * parallel workers too, and they need room for a copy of the filter in
+	 * shared memory.
+	 */
+	{
+		PlanState  *scanstate = outerPlanState(hjstate);
+		bool		below_gather = false;
+
+		if (IsA(scanstate, GatherState))
+		{
+			scanstate = outerPlanState(scanstate);
+			below_gather = true;
+		}
+		if (IsA(scanstate, SeqScanState) &&
+			((SeqScan *) scanstate->plan)->filterkeys != NIL)
+		{
+			HashState  *hashstate = (HashState *) innerPlanState(hjstate);
+
+			Assert(!hashNode->plan.parallel_aware);
+			hashstate->build_filter = true;
+			hjstate->hj_FilterScan = (SeqScanState *) scanstate;
+			if (below_gather)
+				ExecSeqScanShareFilter(hjstate->hj_FilterScan,
+									   ExecHashFilterSize(hashstate));
+		}
+	}
+
 	/*
 	 * Initialize result slot, type and projection.
 	 */
@@ -795,7 +858,214 @@ ExecEndHashJoin(HashJoinState *node)
 /*
  * ExecHashJoinOuterGetTuple
  *
- *		get the next outer tuple for a parallel oblivious hashjoin: either by
+ *		get the next outer tuple for a parallel oblivious hashjoin, either
+ *		directly with ExecHashJoinOuterNextTuple or from the tuples read
+ *		ahead by ExecHashJoinPrefetchOuter.
+ *
+ * Returns a null slot if no more outer tuples (within the current batch).
+ *
+ * On success, the tuple's hash value is stored at *hashvalue.
+ */
+static TupleTableSlot *
+ExecHashJoinOuterGetTuple(PlanState *outerNode,
+						  HashJoinState *hjstate,
+						  uint32 *hashvalue)
+{
+	int			next;
+
+	if (!hjstate->hj_Prefetch)
+		return ExecHashJoinOuterNextTuple(outerNode, hjstate, hashvalue);
+
+	if (hjstate->hj_PrefetchNext >= hjstate->hj_PrefetchCount)
+	{
+		/* don't read past the end of the batch again */
+		if (!hjstate->hj_PrefetchEnd)
+			ExecHashJoinPrefetchOuter(outerNode, hjstate);
+		if (hjstate->hj_PrefetchNext >= hjstate->hj_PrefetchCount)
+		{
+			hjstate->hj_PrefetchEnd = false;
+			return NULL;
+		}
+	}
+
+	next = hjstate->hj_PrefetchOrder[hjstate->hj_PrefetchNext++];
+
+	/*
+	 * When probing a partition at a time, prefetch the bucket of the tuple
+	 * HJ_PREFETCH_TUPLES places further on as we go.
+	 */
+	if (hjstate->hj_HashTable->log2_npartitions > 0)
+	{
+		int			ahead = hjstate->hj_PrefetchNext + HJ_PREFETCH_TUPLES - 1;
+
+		if (ahead < hjstate->hj_PrefetchCount)
+			ExecHashJoinPrefetchBucket(hjstate->hj_HashTable,
+									   hjstate->hj_PrefetchHashValues[hjstate->hj_PrefetchOrder[ahead]]);
+	}
+
+	*hashvalue = hjstate->hj_PrefetchHashValues[next];
+	return hjstate->hj_PrefetchSlots[next];
+}
+
+/*
+ * Prefetch the tag and the header of the bucket an outer tuple hashes to, if
+ * it belongs to the current batch.
+ */
+static inline void
+ExecHashJoinPrefetchBucket(HashJoinTable hashtable, uint32 hashvalue)
+{
+	int			bucketno;
+	int			batchno;
+
+	ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+	if (batchno == hashtable->curbatch)
+	{
+		pg_prefetch_mem(&hashtable->bucketTags[bucketno]);
+		pg_prefetch_mem(&hashtable->buckets.unshared[bucketno]);
+	}
+}
+
+/*
+ * ExecHashJoinPrefetchOuter
+ *
+ *		read a group of outer tuples ahead, and prefetch the parts of the
+ *		hash table that probing them will need.
+ *
+ * When the hash table is much larger than the CPU caches, probing it one
+ * outer tuple at a time means waiting for a cache miss on the bucket
+ * header, and another on the first tuple in the bucket, for every outer
+ * tuple.  Instead, we compute the hash values of HJ_PREFETCH_TUPLES outer
+ * tuples and prefetch their buckets' tags and headers all at once, then
+ * prefetch the first tuple of each bucket whose tag says it may hold a
+ * match, so that the memory accesses of the whole group overlap.  By the
+ * time the tuples are returned to ExecHashJoinImpl, most of what it needs
+ * should be in cache.
+ *
+ * If the hash table has been built in radix partitions, we read
+ * HJ_PREFETCH_TUPLES per partition and return them sorted by partition, so
+ * that each partition is probed by many tuples while it's in cache; the
+ * buckets are then prefetched a fixed distance ahead as the tuples are
+ * returned.  Hash joins don't promise any output order, so this is fine.
+ *
+ * The tuples are copied into slots of their own, as the outer plan only
+ * keeps its last tuple valid.  Those are minimal tuple slots: a copy into
+ * a slot of the outer plan's kind could keep a pin on its tuple's buffer,
+ * and we may read thousands of tuples ahead.
+ */
+static void
+ExecHashJoinPrefetchOuter(PlanState *outerNode, HashJoinState *hjstate)
+{
+	HashJoinTable hashtable = hjstate->hj_HashTable;
+	EState	   *estate = hjstate->js.ps.state;
+	int			log2_npartitions = hashtable->log2_npartitions;
+	int			ntuples = HJ_PREFETCH_TUPLES << log2_npartitions;
+	int			count = 0;
+	int			i;
+
+	if (hjstate->hj_PrefetchSlots == NULL)
+	{
+		MemoryContext oldcxt;
+
+		oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+		hjstate->hj_PrefetchSlots =
+			palloc0(sizeof(TupleTableSlot *) * HJ_PREFETCH_MAX_TUPLES);
+		hjstate->hj_PrefetchHashValues =
+			palloc(sizeof(uint32) * HJ_PREFETCH_MAX_TUPLES);
+		hjstate->hj_PrefetchOrder =
+			palloc(sizeof(int) * HJ_PREFETCH_MAX_TUPLES);
+		MemoryContextSwitchTo(oldcxt);
+	}
+
+	while (count < ntuples)
+	{
+		TupleTableSlot *slot;
+		uint32		hashvalue;
+
+		slot = ExecHashJoinOuterNextTuple(outerNode, hjstate, &hashvalue);
+		if (TupIsNull(slot))
+		{
+			hjstate->hj_PrefetchEnd = true;
+			break;
+		}
+
+		/* the slots are only made as they're needed */
+		if (hjstate->hj_PrefetchSlots[count] == NULL)
+		{
+			MemoryContext oldcxt;
+
+			oldcxt = MemoryContextSwitchTo(estate->es_query_cxt);
+			hjstate->hj_PrefetchSlots[count] =
+				ExecInitExtraTupleSlot(estate, ExecGetResultType(outerNode),
+									   &TTSOpsMinimalTuple);
+			MemoryContextSwitchTo(oldcxt);
+		}
+
+		ExecCopySlot(hjstate->hj_PrefetchSlots[count], slot);
+		hjstate->hj_PrefetchHashValues[count] = hashvalue;
+		count++;
+
+		if (log2_npartitions == 0)
+			ExecHashJoinPrefetchBucket(hashtable, hashvalue);
+	}
+
+	if (log2_npartitions == 0)
+	{
+		/* Return the tuples in the order read */
+		for (i = 0; i < count; i++)
+		{
+			uint32		hashvalue = hjstate->hj_PrefetchHashValues[i];
+			int			bucketno;
+			int			batchno;
+
+			hjstate->hj_PrefetchOrder[i] = i;
+
+			ExecHashGetBucketAndBatch(hashtable, hashvalue, &bucketno, &batchno);
+			if (batchno == hashtable->curbatch &&
+				(hashtable->bucketTags[bucketno] & HJ_BUCKET_TAG(hashvalue)))
+				pg_prefetch_mem(hashtable->buckets.unshared[bucketno]);
+		}
+	}
+	else
+	{
+		int			npartitions = 1 << log2_npartitions;
+		int			counts[HASH_RADIX_MAX_PARTITIONS + 1];
+		uint8		partnos[HJ_PREFETCH_MAX_TUPLES];
+
+		/*
+		 * Sort the tuples by partition.  Tuples that belong to later batches
+		 * won't be probed at all, so it doesn't matter where they go.
+		 */
+		memset(counts, 0, (npartitions + 1) * sizeof(int));
+		for (i = 0; i < count; i++)
+		{
+			int			bucketno;
+			int			batchno;
+
+			ExecHashGetBucketAndBatch(hashtable,
+									  hjstate->hj_PrefetchHashValues[i],
+									  &bucketno, &batchno);
+			partnos[i] = HJ_RADIX_PARTITION(hashtable, bucketno);
+			counts[partnos[i] + 1]++;
+		}
+		for (i = 1; i < npartitions; i++)
+			counts[i] += counts[i - 1];
+		for (i = 0; i < count; i++)
+			hjstate->hj_PrefetchOrder[counts[partnos[i]]++] = i;
+
+		/* ExecHashJoinOuterGetTuple prefetches the rest as it goes */
+		for (i = 0; i < Min(count, HJ_PREFETCH_TUPLES); i++)
+			ExecHashJoinPrefetchBucket(hashtable,
+									   hjstate->hj_PrefetchHashValues[hjstate->hj_PrefetchOrder[i]]);
+	}
+
+	hjstate->hj_PrefetchCount = count;
+	hjstate->hj_PrefetchNext = 0;
+}
+
+/*
+ * ExecHashJoinOuterNextTuple
+ *
+ *		read the next outer tuple for a parallel oblivious hashjoin: either by
  *		executing the outer plan node in the first pass, or from the temp
  *		files for the hashjoin batches.
  *
@@ -805,9 +1075,9 @@ ExecEndHashJoin(HashJoinState *node)
  * either originally computed, or re-read from the temp file.
  */
 static TupleTableSlot *
-ExecHashJoinOuterGetTuple(PlanState *outerNode,
-						  HashJoinState *hjstate,
-						  uint32 *hashvalue)
+ExecHashJoinOuterNextTuple(PlanState *outerNode,
+						   HashJoinState *hjstate,
+						   uint32 *hashvalue)
 {
 	HashJoinTable hashtable = hjstate->hj_HashTable;
 	int			curbatch = hashtable->curbatch;
@@ -1065,6 +1335,10 @@ ExecHashJoinNewBatch(HashJoinState *hjstate)
 		hashtable->innerBatchFile[curbatch] = NULL;
 	}
 
+	/* Link the tuples into the buckets, if ExecHashTableInsert didn't */
+	if (hashtable->log2_npartitions_max > 0)
+		ExecHashBuildPartitions(hashtable);
+
 	/*
 	 * Rewind outer batch file (if present), so that we can start reading it.
 	 */
@@ -1160,6 +1434,8 @@ ExecParallelHashJoinNewBatch(HashJoinState *hjstate)
 						ExecParallelHashTableInsertCurrentBatch(hashtable, slot,
 																hashvalue);
 					}
+					if (hashtable->ndeferred > 0)
+						ExecParallelHashFlushTuples(hashtable);
 					sts_end_parallel_scan(inner_tuples);
 					BarrierArriveAndWait(batch_barrier,
 										 WAIT_EVENT_HASH_BATCH_LOAD);
@@ -1223,7 +1499,7 @@ ExecHashJoinSaveTuple(MinimalTuple tuple, uint32 hashvalue,
 	if (file == NULL)
 	{
 		/* First write to this batch file, so open it. */
-		file = BufFileCreateTemp(false);
+		file = BufFileCreateCompressedTemp(false);
 		*fileptr = file;
 	}
 
@@ -1342,6 +1618,10 @@ ExecReScanHashJoin(HashJoinState *node)
 			/* for safety, be sure to clear child plan node's pointer too */
 			hashNode->hashtable = NULL;
 
+			/* the outer scan must not use the old table's filter either */
+			if (node->hj_FilterScan)
+				ExecSeqScanSetFilter(node->hj_FilterScan, NULL);
+
 			ExecHashTableDestroy(node->hj_HashTable);
 			node->hj_HashTable = NULL;
 			node->hj_JoinState = HJ_BUILD_HASHTABLE;
@@ -1363,6 +1643,9 @@ ExecReScanHashJoin(HashJoinState *node)
 
 	node->hj_MatchedOuter = false;
 	node->hj_FirstOuterTupleSlot = NULL;
+	node->hj_PrefetchCount = 0;
+	node->hj_PrefetchNext = 0;
+	node->hj_PrefetchEnd = false;
 
 	/*
 	 * if chgParam of subnode is not null then plan will be re-scanned by
@@ -19,6 +19,9 @@
  *		ExecInitSeqScan			creates and initializes a seqscan node.
  *		ExecEndSeqScan			releases any storage allocated.
  *		ExecReScanSeqScan		rescans the relation
+ *		ExecSeqScanNextBatch	retrieve next batch of qualifying tuples
+ *		ExecSeqScanSetFilter	install a filter built by a hash join
+ *		ExecSeqScanShareFilter	make room for the filter in parallel DSM
  *
  *		ExecSeqScanEstimate		estimates DSM space needed for parallel scan
  *		ExecSeqScanInitializeDSM initialize DSM for parallel scan
@@ -31,9 +34,39 @@
 #include "access/tableam.h"
 #include "executor/execdebug.h"
 #include "executor/nodeSeqscan.h"
+#include "miscadmin.h"
+#include "port/atomics.h"
+#include "storage/bufmgr.h"
+#include "utils/lsyscache.h"
 #include "utils/rel.h"
 
+/*
+ * Copy of a hash join filter in the DSM segment of a parallel query.  The
+ * leader copies the filter in once the hash join has built it; until then,
+ * the workers scan without it.  The filter follows the header.
+ */
+typedef struct SeqScanSharedFilter
+{
+	pg_atomic_uint32 ready;		/* has the filter been copied in? */
+	Size		size;			/* space for the filter */
+} SeqScanSharedFilter;
+
+#define SharedFilterData(shared) \
+	((bloom_filter *) ((char *) (shared) + MAXALIGN(sizeof(SeqScanSharedFilter))))
+
+/*
+ * DSM key of the shared filter.  The plan node ID is the key of the parallel
+ * scan descriptor already, so set a high bit that plan node IDs never use.
+ */
+#define PARALLEL_KEY_SEQSCAN_FILTER(plan_node_id) \
+	(UINT64CONST(0xD000000000000000) | (uint64) (plan_node_id))
+
 static TupleTableSlot *SeqNext(SeqScanState *node);
+static TupleBatch *SeqNextBatch(SeqScanState *node);
+static void SeqInitFilter(SeqScanState *node, SeqScan *plan);
+static bool SeqFilterRejects(SeqScanState *node, TupleTableSlot *slot);
+static bool SeqFilter(SeqScanState *node, TupleTableSlot *slot);
+static void SeqShareFilter(SeqScanState *node);
 
 /* ----------------------------------------------------------------
  *						Scan Support
@@ -82,6 +115,247 @@ SeqNext(SeqScanState *node)
 	return NULL;
 }
 
+/* ----------------------------------------------------------------
+ *		SeqNextBatch
+ *
+ *		Reads the next batch of tuples that satisfy the quals, or
+ *		returns NULL at the end of the scan.  This is the workhorse
+ *		for ExecSeqScanBatch and ExecSeqScanNextBatch.
+ * ----------------------------------------------------------------
+ */
+static TupleBatch *
+SeqNextBatch(SeqScanState *node)
+{
+	TableScanDesc scandesc;
+	EState	   *estate;
+	ScanDirection direction;
+	TupleBatch *batch;
+	ExprState  *qual;
+	ExprContext *econtext;
+
+	scandesc = node->ss.ss_currentScanDesc;
+	estate = node->ss.ps.state;
+	direction = estate->es_direction;
+	batch = node->batch;
+	qual = node->ss.ps.qual;
+	econtext = node->ss.ps.ps_ExprContext;
+
+	if (scandesc == NULL)
+	{
+		/* see SeqNext */
+		scandesc = table_beginscan(node->ss.ss_currentRelation,
+								   estate->es_snapshot,
+								   0, NULL);
+		node->ss.ss_currentScanDesc = scandesc;
+	}
+
+	do
+	{
+		int			i;
+		int			nselected;
+		int			nbuffers = 0;
+		Buffer		lastbuf = InvalidBuffer;
+
+		CHECK_FOR_INTERRUPTS();
+
+		ExecBatchReset(batch);
+
+		/*
+		 * Each row's slot keeps its buffer pinned until the batch is reset,
+		 * so end the batch once its rows come from EXEC_BATCH_MAX_BUFFERS
+		 * different buffers.  Otherwise a table with few rows per page would
+		 * pin more buffers than the scan's buffer ring has.
+		 */
+		while (batch->nrows < EXEC_BATCH_SIZE &&
+			   table_scan_getnextslot(scandesc, direction,
+									  batch->slots[batch->nrows]))
+		{
+			TupleTableSlot *slot = batch->slots[batch->nrows++];
+
+			if (TTS_IS_BUFFERTUPLE(slot))
+			{
+				Buffer		buffer = ((BufferHeapTupleTableSlot *) slot)->buffer;
+
+				if (BufferIsValid(buffer) && buffer != lastbuf)
+				{
+					lastbuf = buffer;
+					if (++nbuffers >= EXEC_BATCH_MAX_BUFFERS)
+						break;
+				}
+			}
+		}
+
+		if (batch->nrows == 0)
+			return NULL;
+
+		/* evaluate the quals that can be, a column at a time */
+		ExecBatchExtractColumns(batch);
+		for (i = 0; i < node->nbatchpreds; i++)
+			ExecBatchFilter(batch, &node->batchpreds[i]);
+
+		/* and the rest a row at a time */
+		if (qual != NULL)
+		{
+			nselected = 0;
+			for (i = 0; i < batch->nselected; i++)
+			{
+				int			row = batch->selected[i];
+
+				econtext->ecxt_scantuple = batch->slots[row];
+				if (ExecQual(qual, econtext))
+					batch->selected[nselected++] = row;
+				ResetExprContext(econtext);
+			}
+			batch->nselected = nselected;
+		}
+
+		InstrCountFiltered1(node, batch->nrows - batch->nselected);
+
+		/*
+		 * Last, skip the rows that the hash join above has no match for.
+		 * This must come after the quals, see SeqFilter.
+		 */
+		if (node->filterkeys != NIL)
+		{
+			nselected = 0;
+			for (i = 0; i < batch->nselected; i++)
+			{
+				int			row = batch->selected[i];
+
+				if (!SeqFilterRejects(node, batch->slots[row]))
+					batch->selected[nselected++] = row;
+			}
+			InstrCountFiltered2(node, batch->nselected - nselected);
+			batch->nselected = nselected;
+		}
+	} while (batch->nselected == 0);
+
+	return batch;
+}
+
+/* ----------------------------------------------------------------
+ *		SeqInitFilter
+ *
+ *		Prepares to check the scanned rows against a hash join filter.
+ * ----------------------------------------------------------------
+ */
+static void
+SeqInitFilter(SeqScanState *node, SeqScan *plan)
+{
+	int			nkeys = list_length(plan->filterkeys);
+	ListCell   *lo;
+	ListCell   *lc;
+	int			i = 0;
+
+	node->filterkeys = ExecInitExprList(plan->filterkeys, &node->ss.ps);
+	node->filterhashfunctions = palloc(nkeys * sizeof(FmgrInfo));
+	node->filtercollations = palloc(nkeys * sizeof(Oid));
+	node->filterstrict = palloc(nkeys * sizeof(bool));
+
+	forboth(lo, plan->filteroperators, lc, plan->filtercollations)
+	{
+		Oid			hashop = lfirst_oid(lo);
+		Oid			left_hashfn;
+		Oid			right_hashfn;
+
+		/* the scan is the join's outer side, see ExecHashTableCreate */
+		if (!get_op_hash_functions(hashop, &left_hashfn, &right_hashfn))
+			elog(ERROR, "could not find hash function for hash operator %u",
+				 hashop);
+		fmgr_info(left_hashfn, &node->filterhashfunctions[i]);
+		node->filtercollations[i] = lfirst_oid(lc);
+		node->filterstrict[i] = op_strict(hashop);
+		i++;
+	}
+}
+
+/* ----------------------------------------------------------------
+ *		SeqFilterRejects
+ *
+ *		Returns true if the hash join filter shows that the join has
+ *		no match for the row in the slot.  The hash value is computed
+ *		exactly like ExecHashGetHashValue computes it for the join's
+ *		outer rows.  Until the filter is available, every row passes.
+ * ----------------------------------------------------------------
+ */
+static bool
+SeqFilterRejects(SeqScanState *node, TupleTableSlot *slot)
+{
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	MemoryContext oldContext;
+	uint32		hashkey = 0;
+	ListCell   *lc;
+	int			i = 0;
+
+	/*
+	 * A parallel worker gets the filter once the leader has copied it to
+	 * shared memory.
+	 */
+	if (node->filter == NULL)
+	{
+		if (node->sharedfilter == NULL || !IsParallelWorker() ||
+			pg_atomic_read_u32(&node->sharedfilter->ready) == 0)
+			return false;
+		pg_read_barrier();
+		node->filter = SharedFilterData(node->sharedfilter);
+	}
+
+	ResetExprContext(econtext);
+	econtext->ecxt_scantuple = slot;
+	oldContext = MemoryContextSwitchTo(econtext->ecxt_per_tuple_memory);
+
+	foreach(lc, node->filterkeys)
+	{
+		ExprState  *keyexpr = (ExprState *) lfirst(lc);
+		Datum		keyval;
+		bool		isNull;
+
+		/* rotate hashkey left 1 bit at each step */
+		hashkey = (hashkey << 1) | ((hashkey & 0x80000000) ? 1 : 0);
+
+		keyval = ExecEvalExpr(keyexpr, econtext, &isNull);
+
+		if (isNull)
+		{
+			/* the join can't match a NULL with a strict operator either */
+			if (node->filterstrict[i])
+			{
+				MemoryContextSwitchTo(oldContext);
+				return true;
+			}
+		}
+		else
+			hashkey ^= DatumGetUInt32(FunctionCall1Coll(&node->filterhashfunctions[i],
+														node->filtercollations[i],
+														keyval));
+		i++;
+	}
+
+	MemoryContextSwitchTo(oldContext);
+
+	return bloom_lacks_element(node->filter, (unsigned char *) &hashkey,
+							   sizeof(hashkey));
+}
+
+/*
+ * SeqFilter -- filter method of ExecScanFiltered
+ *
+ * The hash keys are only computed for the rows that passed the quals, as the
+ * hash join would compute them, so that a key expression can't fail on, or
+ * leak the values of, rows that the quals (security barrier quals included)
+ * exclude.
+ */
+static bool
+SeqFilter(SeqScanState *node, TupleTableSlot *slot)
+{
+	if (SeqFilterRejects(node, slot))
+	{
+		InstrCountFiltered2(node, 1);
+		return false;
+	}
+	return true;
+}
+
 /*
  * SeqRecheck -- access method routine to recheck a tuple in EvalPlanQual
  */
@@ -109,11 +383,90 @@ ExecSeqScan(PlanState *pstate)
 {
 	SeqScanState *node = castNode(SeqScanState, pstate);
 
+	if (node->filterkeys != NIL)
+		return ExecScanFiltered(&node->ss,
+								(ExecScanAccessMtd) SeqNext,
+								(ExecScanRecheckMtd) SeqRecheck,
+								(ExecScanFilterMtd) SeqFilter);
+
 	return ExecScan(&node->ss,
 					(ExecScanAccessMtd) SeqNext,
 					(ExecScanRecheckMtd) SeqRecheck);
 }
 
+/* ----------------------------------------------------------------
+ *		ExecSeqScanBatch(node)
+ *
+ *		Returns the next qualifying tuple, like ExecSeqScan, but reads
+ *		and filters the tuples in batches.  The quals have been applied
+ *		by SeqNextBatch, so only projection is left to do here.  The
+ *		tuple is still stored in the scan tuple slot, as WHERE CURRENT OF
+ *		looks for it there; for a heap tuple that only takes another pin
+ *		on its buffer.
+ * ----------------------------------------------------------------
+ */
+static TupleTableSlot *
+ExecSeqScanBatch(PlanState *pstate)
+{
+	SeqScanState *node = castNode(SeqScanState, pstate);
+	TupleBatch *batch = node->batch;
+	ProjectionInfo *projInfo = node->ss.ps.ps_ProjInfo;
+	ExprContext *econtext = node->ss.ps.ps_ExprContext;
+	TupleTableSlot *src;
+	TupleTableSlot *slot;
+
+	if (batch->next >= batch->nselected)
+	{
+		if (SeqNextBatch(node) == NULL)
+		{
+			if (projInfo)
+				return ExecClearTuple(projInfo->pi_state.resultslot);
+			return ExecClearTuple(node->ss.ss_ScanTupleSlot);
+		}
+	}
+
+	src = batch->slots[batch->selected[batch->next++]];
+	slot = ExecCopySlot(node->ss.ss_ScanTupleSlot, src);
+
+	/* Copying the tuple doesn't copy the table OID, for tableoid */
+	slot->tts_tableOid = src->tts_tableOid;
+
+	if (projInfo == NULL)
+		return slot;
+
+	ResetExprContext(econtext);
+	econtext->ecxt_scantuple = slot;
+	return ExecProject(projInfo);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanNextBatch(node)
+ *
+ *		Returns the next batch of qualifying tuples, or NULL at the end
+ *		of the scan.  This lets a parent node that can process batches
+ *		bypass ExecProcNode; it's only allowed if the node was set up
+ *		for batch execution and has no projection to do.
+ * ----------------------------------------------------------------
+ */
+TupleBatch *
+ExecSeqScanNextBatch(SeqScanState *node)
+{
+	Instrumentation *instr = node->ss.ps.instrument;
+	TupleBatch *batch;
+
+	Assert(node->batch != NULL && node->ss.ps.ps_ProjInfo == NULL);
+
+	if (instr)
+		InstrStartNode(instr);
+
+	batch = SeqNextBatch(node);
+
+	if (instr)
+		InstrStopNode(instr, batch ? batch->nselected : 0);
+
+	return batch;
+}
+
 
 /* ----------------------------------------------------------------
  *		ExecInitSeqScan
@@ -151,7 +504,7 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	 */
 	scanstate->ss.ss_currentRelation =
 		ExecOpenScanRelation(estate,
-							 node->scanrelid,
+							 node->scan.scanrelid,
 							 eflags);
 
 	/* and create slot with the appropriate rowtype */
@@ -165,11 +518,55 @@ ExecInitSeqScan(SeqScan *node, EState *estate, int eflags)
 	ExecInitResultTypeTL(&scanstate->ss.ps);
 	ExecAssignScanProjectionInfo(&scanstate->ss);
 
+	/*
+	 * Prepare for a hash join filter, if the planner pushed one down.  The
+	 * filter itself is supplied by the hash join once it has built its hash
+	 * table, see ExecSeqScanSetFilter.
+	 */
+	if (node->filterkeys != NIL)
+		SeqInitFilter(scanstate, node);
+
+	/*
+	 * Use batch execution if enabled.  Only forward scans are supported,
+	 * and EvalPlanQual rechecks need a single tuple at a time anyway.
+	 */
+	if (enable_batch_execution &&
+		!(eflags & EXEC_FLAG_BACKWARD) &&
+		estate->es_epq_active == NULL)
+	{
+		Relation	rel = scanstate->ss.ss_currentRelation;
+		List	   *quals = NIL;
+		ListCell   *lc;
+
+		scanstate->batch = ExecCreateBatch(estate, RelationGetDescr(rel),
+										   table_slot_callbacks(rel));
+		scanstate->batchpreds = palloc(sizeof(BatchPredicate) *
+									   Max(list_length(node->scan.plan.qual), 1));
+
+		/* split off the quals that can be evaluated over a column */
+		foreach(lc, node->scan.plan.qual)
+		{
+			Expr	   *clause = (Expr *) lfirst(lc);
+
+			if (ExecBatchMakePredicate(clause, scanstate->batch,
+									   &scanstate->batchpreds[scanstate->nbatchpreds]))
+				scanstate->nbatchpreds++;
+			else
+				quals = lappend(quals, clause);
+		}
+
+		scanstate->ss.ps.qual =
+			ExecInitQual(quals, (PlanState *) scanstate);
+		scanstate->ss.ps.ExecProcNode = ExecSeqScanBatch;
+
+		return scanstate;
+	}
+
 	/*
 	 * initialize child expressions
 	 */
 	scanstate->ss.ps.qual =
-		ExecInitQual(node->plan.qual, (PlanState *) scanstate);
+		ExecInitQual(node->scan.plan.qual, (PlanState *) scanstate);
 
 	return scanstate;
 }
@@ -201,6 +598,8 @@ ExecEndSeqScan(SeqScanState *node)
 	if (node->ss.ps.ps_ResultTupleSlot)
 		ExecClearTuple(node->ss.ps.ps_ResultTupleSlot);
 	ExecClearTuple(node->ss.ss_ScanTupleSlot);
+	if (node->batch)
+		ExecBatchReset(node->batch);
 
 	/*
 	 * close heap scan
@@ -227,6 +626,9 @@ ExecReScanSeqScan(SeqScanState *node)
 
 	scan = node->ss.ss_currentScanDesc;
 
+	if (node->batch)
+		ExecBatchReset(node->batch);
+
 	if (scan != NULL)
 		table_rescan(scan,		/* scan desc */
 					 NULL);		/* new scan keys */
@@ -234,6 +636,76 @@ ExecReScanSeqScan(SeqScanState *node)
 	ExecScanReScan((ScanState *) node);
 }
 
+/* ----------------------------------------------------------------
+ *						Hash Join Filter Support
+ * ----------------------------------------------------------------
+ */
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanSetFilter
+ *
+ *		Installs the Bloom filter that the hash join above the scan
+ *		has built over the hash values of its inner rows, or removes it
+ *		if filter is NULL.  The scan skips the rows that the filter
+ *		lacks from then on.  If the scan runs in parallel workers too,
+ *		they get a copy of the filter in shared memory.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSeqScanSetFilter(SeqScanState *node, bloom_filter *filter)
+{
+	Assert(node->filterkeys != NIL);
+
+	node->filter = filter;
+
+	/*
+	 * If the workers have been launched already, share the filter now.  If
+	 * it was shared before, by a previous scan, they'll get the filter when
+	 * they're launched again; see ExecSeqScanReInitializeDSM.
+	 */
+	if (filter != NULL && node->sharedfilter != NULL &&
+		pg_atomic_read_u32(&node->sharedfilter->ready) == 0)
+		SeqShareFilter(node);
+}
+
+/* ----------------------------------------------------------------
+ *		ExecSeqScanShareFilter
+ *
+ *		Asks for room for a hash join filter of the given size in the
+ *		DSM segment of a parallel scan.  The hash join calls this if
+ *		there's a Gather between it and the scan, before the parallel
+ *		query is set up.
+ * ----------------------------------------------------------------
+ */
+void
+ExecSeqScanShareFilter(SeqScanState *node, Size size)
+{
+	Assert(node->filterkeys != NIL);
+
+	node->sharedfilter_len = size;
+}
+
+/* ----------------------------------------------------------------
+ *		SeqShareFilter
+ *
+ *		Copies the filter to shared memory, for parallel workers.
+ * ----------------------------------------------------------------
+ */
+static void
+SeqShareFilter(SeqScanState *node)
+{
+	SeqScanSharedFilter *shared = node->sharedfilter;
+	Size		size = bloom_size(node->filter);
+
+	/* can't happen, unless work_mem has changed since we made room */
+	if (size > shared->size)
+		return;
+
+	memcpy(SharedFilterData(shared), node->filter, size);
+	pg_write_barrier();
+	pg_atomic_write_u32(&shared->ready, 1);
+}
+
 /* ----------------------------------------------------------------
  *						Parallel Scan Support
  * ----------------------------------------------------------------
@@ -256,6 +728,14 @@ ExecSeqScanEstimate(SeqScanState *node,
 												  estate->es_snapshot);
 	shm_toc_estimate_chunk(&pcxt->estimator, node->pscan_len);
 	shm_toc_estimate_keys(&pcxt->estimator, 1);
+
+	if (node->sharedfilter_len > 0)
+	{
+		shm_toc_estimate_chunk(&pcxt->estimator,
+							   MAXALIGN(sizeof(SeqScanSharedFilter)) +
+							   node->sharedfilter_len);
+		shm_toc_estimate_keys(&pcxt->estimator, 1);
+	}
 }
 
 /* ----------------------------------------------------------------
@@ -278,6 +758,25 @@ ExecSeqScanInitializeDSM(SeqScanState *node,
 	shm_toc_insert(pcxt->toc, node->ss.ps.plan->plan_node_id, pscan);
 	node->ss.ss_currentScanDesc =
 		table_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+
+	if (node->sharedfilter_len > 0)
+	{
+		SeqScanSharedFilter *shared;
+
+		shared = shm_toc_allocate(pcxt->toc,
+								  MAXALIGN(sizeof(SeqScanSharedFilter)) +
+								  node->sharedfilter_len);
+		pg_atomic_init_u32(&shared->ready, 0);
+		shared->size = node->sharedfilter_len;
+		shm_toc_insert(pcxt->toc,
+					   PARALLEL_KEY_SEQSCAN_FILTER(node->ss.ps.plan->plan_node_id),
+					   shared);
+		node->sharedfilter = shared;
+
+		/* the hash join may have built the filter already */
+		if (node->filter != NULL)
+			SeqShareFilter(node);
+	}
 }
 
 /* ----------------------------------------------------------------
@@ -294,6 +793,14 @@ ExecSeqScanReInitializeDSM(SeqScanState *node,
 
 	pscan = node->ss.ss_currentScanDesc->rs_parallel;
 	table_parallelscan_reinitialize(node->ss.ss_currentRelation, pscan);
+
+	/* the new workers get the filter of the new scan */
+	if (node->sharedfilter != NULL)
+	{
+		pg_atomic_write_u32(&node->sharedfilter->ready, 0);
+		if (node->filter != NULL)
+			SeqShareFilter(node);
+	}
 }
 
 /* ----------------------------------------------------------------
@@ -311,4 +818,11 @@ ExecSeqScanInitializeWorker(SeqScanState *node,
 	pscan = shm_toc_lookup(pwcxt->toc, node->ss.ps.plan->plan_node_id, false);
 	node->ss.ss_currentScanDesc =
 		table_beginscan_parallel(node->ss.ss_currentRelation, pscan);
+
+	/* the leader shares a hash join filter, if there's one above the Gather */
+	if (node->filterkeys != NIL)
+		node->sharedfilter =
+			shm_toc_lookup(pwcxt->toc,
+						   PARALLEL_KEY_SEQSCAN_FILTER(node->ss.ps.plan->plan_node_id),
+						   true);
 }
@@ -51,6 +51,7 @@ struct bloom_filter
 	unsigned char bitset[FLEXIBLE_ARRAY_MEMBER];
 };
 
+static uint64 bloom_bitset_bits(int64 total_elems, int bloom_work_mem);
 static int	my_bloom_power(uint64 target_bitset_bits);
 static int	optimal_k(uint64 bitset_bits, int64 total_elems);
 static void k_hashes(bloom_filter *filter, uint32 *hashes, unsigned char *elem,
@@ -88,26 +89,10 @@ bloom_filter *
 bloom_create(int64 total_elems, int bloom_work_mem, uint64 seed)
 {
 	bloom_filter *filter;
-	int			bloom_power;
 	uint64		bitset_bytes;
 	uint64		bitset_bits;
 
-	/*
-	 * Aim for two bytes per element; this is sufficient to get a false
-	 * positive rate below 1%, independent of the size of the bitset or total
-	 * number of elements.  Also, if rounding down the size of the bitset to
-	 * the next lowest power of two turns out to be a significant drop, the
-	 * false positive rate still won't exceed 2% in almost all cases.
-	 */
-	bitset_bytes = Min(bloom_work_mem * UINT64CONST(1024), total_elems * 2);
-	bitset_bytes = Max(1024 * 1024, bitset_bytes);
-
-	/*
-	 * Size in bits should be the highest power of two <= target.  bitset_bits
-	 * is uint64 because PG_UINT32_MAX is 2^32 - 1, not 2^32
-	 */
-	bloom_power = my_bloom_power(bitset_bytes * BITS_PER_BYTE);
-	bitset_bits = UINT64CONST(1) << bloom_power;
+	bitset_bits = bloom_bitset_bits(total_elems, bloom_work_mem);
 	bitset_bytes = bitset_bits / BITS_PER_BYTE;
 
 	/* Allocate bloom filter with unset bitset */
@@ -120,6 +105,30 @@ bloom_create(int64 total_elems, int bloom_work_mem, uint64 seed)
 	return filter;
 }
 
+/*
+ * Size of the Bloom filter that bloom_create() would create for the same
+ * arguments, bookkeeping fields included.
+ */
+Size
+bloom_estimate(int64 total_elems, int bloom_work_mem)
+{
+	return offsetof(bloom_filter, bitset) +
+		bloom_bitset_bits(total_elems, bloom_work_mem) / BITS_PER_BYTE;
+}
+
+/*
+ * Size of a Bloom filter, bookkeeping fields included.
+ *
+ * A Bloom filter is a single chunk of memory without any pointers, so a
+ * caller can copy that many bytes to another place, such as shared memory,
+ * and test elements against the copy.
+ */
+Size
+bloom_size(bloom_filter *filter)
+{
+	return offsetof(bloom_filter, bitset) + filter->m / BITS_PER_BYTE;
+}
+
 /*
  * Free Bloom filter
  */
@@ -193,6 +202,34 @@ bloom_prop_bits_set(bloom_filter *filter)
 	return bits_set / (double) filter->m;
 }
 
+/*
+ * Size of the bitset, in bits, for bloom_create()'s arguments
+ */
+static uint64
+bloom_bitset_bits(int64 total_elems, int bloom_work_mem)
+{
+	int			bloom_power;
+	uint64		bitset_bytes;
+
+	/*
+	 * Aim for two bytes per element; this is sufficient to get a false
+	 * positive rate below 1%, independent of the size of the bitset or total
+	 * number of elements.  Also, if rounding down the size of the bitset to
+	 * the next lowest power of two turns out to be a significant drop, the
+	 * false positive rate still won't exceed 2% in almost all cases.
+	 */
+	bitset_bytes = Min(bloom_work_mem * UINT64CONST(1024), total_elems * 2);
+	bitset_bytes = Max(1024 * 1024, bitset_bytes);
+
+	/*
+	 * Size in bits should be the highest power of two <= target.  bitset_bits
+	 * is uint64 because PG_UINT32_MAX is 2^32 - 1, not 2^32
+	 */
+	bloom_power = my_bloom_power(bitset_bytes * BITS_PER_BYTE);
+
+	return UINT64CONST(1) << bloom_power;
+}
+
 /*
  * Which element in the sequence of powers of two is less than or equal to
  * target_bitset_bits?
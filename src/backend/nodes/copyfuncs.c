@@ -446,6 +446,13 @@ _copySeqScan(const SeqScan *from)
 	 */
 	CopyScanFields((const Scan *) from, (Scan *) newnode);
 
+	/*
+	 * copy remainder of node
+	 */
+	COPY_NODE_FIELD(filterkeys);
+	COPY_NODE_FIELD(filteroperators);
+	COPY_NODE_FIELD(filtercollations);
+
 	return newnode;
 }
 
@@ -1112,6 +1119,7 @@ _copyHash(const Hash *from)
 	COPY_SCALAR_FIELD(skewColumn);
 	COPY_SCALAR_FIELD(skewInherit);
 	COPY_SCALAR_FIELD(rows_total);
+	COPY_SCALAR_FIELD(radix_partitions);
 
 	return newnode;
 }
@@ -2935,6 +2943,7 @@ _copyColumnDef(const ColumnDef *from)
 	COPY_SCALAR_FIELD(is_not_null);
 	COPY_SCALAR_FIELD(is_from_type);
 	COPY_SCALAR_FIELD(storage);
+	COPY_STRING_FIELD(compression);
 	COPY_NODE_FIELD(raw_default);
 	COPY_NODE_FIELD(cooked_default);
 	COPY_SCALAR_FIELD(identity);
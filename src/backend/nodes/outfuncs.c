@@ -536,6 +536,10 @@ _outSeqScan(StringInfo str, const SeqScan *node)
 	WRITE_NODE_TYPE("SEQSCAN");
 
 	_outScanInfo(str, (const Scan *) node);
+
+	WRITE_NODE_FIELD(filterkeys);
+	WRITE_NODE_FIELD(filteroperators);
+	WRITE_NODE_FIELD(filtercollations);
 }
 
 static void
@@ -891,6 +895,7 @@ _outHash(StringInfo str, const Hash *node)
 	WRITE_INT_FIELD(skewColumn);
 	WRITE_BOOL_FIELD(skewInherit);
 	WRITE_FLOAT_FIELD(rows_total, "%.0f");
+	WRITE_INT_FIELD(radix_partitions);
 }
 
 static void
@@ -2181,6 +2186,7 @@ _outHashPath(StringInfo str, const HashPath *node)
 	WRITE_NODE_FIELD(path_hashclauses);
 	WRITE_INT_FIELD(num_batches);
 	WRITE_FLOAT_FIELD(inner_rows_total, "%.0f");
+	WRITE_INT_FIELD(num_radix_partitions);
 }
 
 static void
@@ -2839,6 +2845,7 @@ _outColumnDef(StringInfo str, const ColumnDef *node)
 	WRITE_BOOL_FIELD(is_not_null);
 	WRITE_BOOL_FIELD(is_from_type);
 	WRITE_CHAR_FIELD(storage);
+	WRITE_STRING_FIELD(compression);
 	WRITE_NODE_FIELD(raw_default);
 	WRITE_NODE_FIELD(cooked_default);
 	WRITE_CHAR_FIELD(identity);
@@ -1782,9 +1782,13 @@ _readScan(void)
 static SeqScan *
 _readSeqScan(void)
 {
-	READ_LOCALS_NO_FIELDS(SeqScan);
+	READ_LOCALS(SeqScan);
 
-	ReadCommonScan(local_node);
+	ReadCommonScan(&local_node->scan);
+
+	READ_NODE_FIELD(filterkeys);
+	READ_NODE_FIELD(filteroperators);
+	READ_NODE_FIELD(filtercollations);
 
 	READ_DONE();
 }
@@ -2344,6 +2348,7 @@ _readHash(void)
 	READ_INT_FIELD(skewColumn);
 	READ_BOOL_FIELD(skewInherit);
 	READ_FLOAT_FIELD(rows_total);
+	READ_INT_FIELD(radix_partitions);
 
 	READ_DONE();
 }
@@ -134,6 +134,7 @@ bool		enable_nestloop = true;
 bool		enable_material = true;
 bool		enable_mergejoin = true;
 bool		enable_hashjoin = true;
+bool		enable_hashjoin_filter = true;
 bool		enable_gathermerge = true;
 bool		enable_partitionwise_join = false;
 bool		enable_partitionwise_aggregate = false;
@@ -3636,6 +3637,17 @@ final_cost_hashjoin(PlannerInfo *root, HashPath *path,
 	/* store the total number of tuples (sum of partial row estimates) */
 	path->inner_rows_total = inner_path_rows_total;
 
+	/*
+	 * If a batch of the hash table will be much larger than the CPU caches,
+	 * have it built and probed in radix partitions that fit in them.  We
+	 * assume that the extra pass over the inner tuples pays for itself in
+	 * cache misses saved, so we don't charge for it.
+	 */
+	path->num_radix_partitions =
+		ExecChooseHashPartitions(inner_path_rows_total,
+								 inner_path->pathtarget->width,
+								 numbuckets, numbatches);
+
 	/* and compute the number of "virtual" buckets in the whole join */
 	virtualbuckets = (double) numbuckets * (double) numbatches;
 
@@ -154,6 +154,9 @@ static CustomScan *create_customscan_plan(PlannerInfo *root,
 static NestLoop *create_nestloop_plan(PlannerInfo *root, NestPath *best_path);
 static MergeJoin *create_mergejoin_plan(PlannerInfo *root, MergePath *best_path);
 static HashJoin *create_hashjoin_plan(PlannerInfo *root, HashPath *best_path);
+static void push_hashjoin_filter(PlannerInfo *root, HashPath *best_path,
+								 Plan *outer_plan, List *outer_hashkeys,
+								 List *hashoperators, List *hashcollations);
 static Node *replace_nestloop_params(PlannerInfo *root, Node *expr);
 static Node *replace_nestloop_params_mutator(Node *node, PlannerInfo *root);
 static void fix_indexqual_references(PlannerInfo *root, IndexPath *index_path,
@@ -2776,7 +2779,7 @@ create_seqscan_plan(PlannerInfo *root, Path *best_path,
 							 scan_clauses,
 							 scan_relid);
 
-	copy_generic_path_info(&scan_plan->plan, best_path);
+	copy_generic_path_info(&scan_plan->scan.plan, best_path);
 
 	return scan_plan;
 }
@@ -4582,6 +4585,10 @@ create_hashjoin_plan(PlannerInfo *root,
 		inner_hashkeys = lappend(inner_hashkeys, lsecond(hclause->args));
 	}
 
+	/* Let the outer scan skip rows without a match, if that's worthwhile */
+	push_hashjoin_filter(root, best_path, outer_plan, outer_hashkeys,
+						 hashoperators, hashcollations);
+
 	/*
 	 * Build the hash node and hash join node.
 	 */
@@ -4598,6 +4605,9 @@ create_hashjoin_plan(PlannerInfo *root,
 	copy_plan_costsize(&hash_plan->plan, inner_plan);
 	hash_plan->plan.startup_cost = hash_plan->plan.total_cost;
 
+	/* The executor builds each batch in at most this many partitions */
+	hash_plan->radix_partitions = best_path->num_radix_partitions;
+
 	/*
 	 * If parallel-aware, the executor will also need an estimate of the total
 	 * number of rows expected from all participants so that it can size the
@@ -4626,6 +4636,101 @@ create_hashjoin_plan(PlannerInfo *root,
 	return join_plan;
 }
 
+/*
+ * A hash join filter is only pushed down if the join is expected to emit at
+ * most this fraction of the outer rows, and if there are enough outer rows
+ * to make up for clearing the filter (at least 1MB, see bloom_create).
+ */
+#define HASHJOIN_FILTER_MAX_FRACTION	0.5
+#define HASHJOIN_FILTER_MIN_OUTER_ROWS	10000
+
+/*
+ * push_hashjoin_filter
+ *	  Ask the executor to filter the outer scan of a hash join
+ *
+ * If the outer plan is a sequential scan, directly or below a Gather, and the
+ * join emits only the outer rows that have a match, the scan can skip the
+ * rows whose hash value is missing from a Bloom filter over the hash values
+ * of the inner rows.  The executor builds the filter along with the hash
+ * table; here we just copy the outer hash keys to the scan.  Computing the
+ * hash values twice for the rows that pass isn't free, so we only do this if
+ * the join is expected to discard a good share of the outer rows.
+ *
+ * The scan checks the filter after its quals, so the keys are computed for
+ * the same rows as by the join itself.
+ */
+static void
+push_hashjoin_filter(PlannerInfo *root, HashPath *best_path,
+					 Plan *outer_plan, List *outer_hashkeys,
+					 List *hashoperators, List *hashcollations)
+{
+	double		outer_rows = best_path->jpath.outerjoinpath->rows;
+	bool		below_gather = false;
+	SeqScan    *scan;
+	List	   *vars;
+	ListCell   *lc;
+
+	if (!enable_hashjoin_filter)
+		return;
+
+	/* Unmatched outer rows must not be needed */
+	if (best_path->jpath.jointype != JOIN_INNER &&
+		best_path->jpath.jointype != JOIN_SEMI &&
+		best_path->jpath.jointype != JOIN_RIGHT)
+		return;
+
+	/*
+	 * Each participant of a parallel-aware hash join inserts only some of the
+	 * inner rows, so none of them could build a complete filter.
+	 */
+	if (best_path->jpath.path.parallel_aware)
+		return;
+
+	if (outer_rows < HASHJOIN_FILTER_MIN_OUTER_ROWS ||
+		best_path->jpath.path.rows > outer_rows * HASHJOIN_FILTER_MAX_FRACTION)
+		return;
+
+	if (IsA(outer_plan, Gather))
+	{
+		outer_plan = outer_plan->lefttree;
+		below_gather = true;
+	}
+	if (!IsA(outer_plan, SeqScan))
+		return;
+	scan = (SeqScan *) outer_plan;
+
+	/* The scan must be able to compute the keys from the scanned row alone */
+	if (contain_volatile_functions((Node *) outer_hashkeys) ||
+		contain_subplans((Node *) outer_hashkeys))
+		return;
+	vars = pull_var_clause((Node *) outer_hashkeys, PVC_INCLUDE_PLACEHOLDERS);
+	foreach(lc, vars)
+	{
+		Var		   *var = (Var *) lfirst(lc);
+
+		if (!IsA(var, Var) || var->varno != scan->scan.scanrelid)
+			return;
+	}
+
+	/* and in parallel workers, if the scan runs there */
+	if (below_gather && !is_parallel_safe(root, (Node *) outer_hashkeys))
+		return;
+
+	/*
+	 * The scan computes the keys only for the rows that pass its quals, like
+	 * the join would.  Still, if the query has security barrier quals, don't
+	 * risk running functions that might leak the values of the rows they
+	 * hide.
+	 */
+	if (root->qual_security_level > 0 &&
+		contain_leaked_vars((Node *) outer_hashkeys))
+		return;
+
+	scan->filterkeys = copyObject(outer_hashkeys);
+	scan->filteroperators = list_copy(hashoperators);
+	scan->filtercollations = list_copy(hashcollations);
+}
+
 
 /*****************************************************************************
  *
@@ -5225,13 +5330,13 @@ make_seqscan(List *qptlist,
 			 Index scanrelid)
 {
 	SeqScan    *node = makeNode(SeqScan);
-	Plan	   *plan = &node->plan;
+	Plan	   *plan = &node->scan.plan;
 
 	plan->targetlist = qptlist;
 	plan->qual = qpqual;
 	plan->lefttree = NULL;
 	plan->righttree = NULL;
-	node->scanrelid = scanrelid;
+	node->scan.scanrelid = scanrelid;
 
 	return node;
 }
@@ -2247,6 +2247,8 @@ finalize_plan(PlannerInfo *root, Plan *plan,
 			break;
 
 		case T_SeqScan:
+			finalize_primnode((Node *) ((SeqScan *) plan)->filterkeys,
+							  &context);
 			context.paramids = bms_add_members(context.paramids, scan_params);
 			break;
 
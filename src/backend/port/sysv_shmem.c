@@ -552,15 +552,18 @@ GetHugePageSize(Size *hugepagesize, int *mmap_flags)
  *
  * Pass the requested size in *size.  This function will modify *size to the
  * actual size of the allocation, if it ends up allocating a segment that is
- * larger than requested.
+ * larger than requested.  The size of the memory pages used is returned in
+ * *pagesize.
  */
 static void *
-CreateAnonymousSegment(Size *size)
+CreateAnonymousSegment(Size *size, Size *pagesize)
 {
 	Size		allocsize = *size;
 	void	   *ptr = MAP_FAILED;
 	int			mmap_errno = 0;
 
+	*pagesize = (Size) sysconf(_SC_PAGESIZE);
+
 #ifndef MAP_HUGETLB
 	/* PGSharedMemoryCreate should have dealt with this case */
 	Assert(huge_pages != HUGE_PAGES_ON);
@@ -584,6 +587,8 @@ CreateAnonymousSegment(Size *size)
 		if (huge_pages == HUGE_PAGES_TRY && ptr == MAP_FAILED)
 			elog(DEBUG1, "mmap(%zu) with MAP_HUGETLB failed, huge pages disabled: %m",
 				 allocsize);
+		if (ptr != MAP_FAILED)
+			*pagesize = hugepagesize;
 	}
 #endif
 
@@ -656,6 +661,7 @@ PGSharedMemoryCreate(Size size,
 	PGShmemHeader *hdr;
 	struct stat statbuf;
 	Size		sysvsize;
+	Size		pagesize;
 
 	/*
 	 * We use the data directory's ID info (inode and device numbers) to
@@ -681,7 +687,7 @@ PGSharedMemoryCreate(Size size,
 
 	if (shared_memory_type == SHMEM_TYPE_MMAP)
 	{
-		AnonymousShmem = CreateAnonymousSegment(&size);
+		AnonymousShmem = CreateAnonymousSegment(&size, &pagesize);
 		AnonymousShmemSize = size;
 
 		/* Register on-exit routine to unmap the anonymous segment */
@@ -691,7 +697,10 @@ PGSharedMemoryCreate(Size size,
 		sysvsize = sizeof(PGShmemHeader);
 	}
 	else
+	{
 		sysvsize = size;
+		pagesize = (Size) sysconf(_SC_PAGESIZE);
+	}
 
 	/*
 	 * Loop till we find a free IPC key.  Trust CreateDataDirLockFile() to
@@ -793,6 +802,8 @@ PGSharedMemoryCreate(Size size,
 	 */
 	hdr->totalsize = size;
 	hdr->freeoffset = MAXALIGN(sizeof(PGShmemHeader));
+	hdr->pagesize = pagesize;
+	hdr->numa_nodes = 0;
 	*shim = hdr;
 
 	/* Save info for possible future use */
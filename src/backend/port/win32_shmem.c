@@ -373,6 +373,16 @@ retry:
 	hdr->totalsize = size;
 	hdr->freeoffset = MAXALIGN(sizeof(PGShmemHeader));
 	hdr->dsm_control = 0;
+	if ((flProtect & SEC_LARGE_PAGES) != 0)
+		hdr->pagesize = largePageSize;
+	else
+	{
+		SYSTEM_INFO sysinfo;
+
+		GetSystemInfo(&sysinfo);
+		hdr->pagesize = sysinfo.dwPageSize;
+	}
+	hdr->numa_nodes = 0;
 
 	/* Save info for possible future use */
 	UsedShmemSegAddr = memAddress;
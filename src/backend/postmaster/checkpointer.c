@@ -47,6 +47,7 @@
 #include "postmaster/bgwriter.h"
 #include "postmaster/interrupt.h"
 #include "replication/syncrep.h"
+#include "storage/aio.h"
 #include "storage/bufmgr.h"
 #include "storage/condition_variable.h"
 #include "storage/fd.h"
@@ -707,7 +708,11 @@ CheckpointWriteDelay(int flags, double progress)
 		 * That resulted in more frequent wakeups if not much work to do.
 		 * Checkpointer and bgwriter are no longer related so take the Big
 		 * Sleep.
+		 *
+		 * Don't leave writes in flight while we sleep; they hold pins and
+		 * I/O locks on their buffers.
 		 */
+		pgaio_wait_all();
 		pg_usleep(100000L);
 	}
 	else if (--absorb_counter <= 0)
@@ -38,6 +38,7 @@
 #include "access/transam.h"
 #include "access/twophase_rmgr.h"
 #include "access/xact.h"
+#include "access/xlogprefetch.h"
 #include "catalog/pg_database.h"
 #include "catalog/pg_proc.h"
 #include "common/ip.h"
@@ -103,6 +104,7 @@
 #define PGSTAT_DB_HASH_SIZE		16
 #define PGSTAT_TAB_HASH_SIZE	512
 #define PGSTAT_FUNCTION_HASH_SIZE	512
+#define PGSTAT_TOAST_HASH_SIZE	512
 
 
 /* ----------
@@ -124,6 +126,7 @@
 bool		pgstat_track_activities = false;
 bool		pgstat_track_counts = false;
 int			pgstat_track_functions = TRACK_FUNC_OFF;
+bool		pgstat_track_toast = false;
 int			pgstat_track_activity_query_size = 1024;
 
 /* ----------
@@ -227,6 +230,23 @@ static HTAB *pgStatFunctions = NULL;
  */
 static bool have_function_stats = false;
 
+/*
+ * Backends store per-column TOAST compression info that's waiting to be sent
+ * to the collector in this hash table (indexed by relation OID and column
+ * number), and decompression info in these arrays, indexed by compression
+ * method ID.
+ */
+static HTAB *pgStatToastColumns = NULL;
+static PgStat_Counter pgStatDecompressed[TOAST_INVALID_COMPRESSION_ID];
+static PgStat_Counter pgStatDecompressedBytes[TOAST_INVALID_COMPRESSION_ID];
+static instr_time pgStatDecompressTime[TOAST_INVALID_COMPRESSION_ID];
+
+/*
+ * Indicates if backend has some TOAST stats that it hasn't yet
+ * sent to the collector.
+ */
+static bool have_toast_stats = false;
+
 /*
  * Tuple insertion/deletion counts for an open transaction can't be propagated
  * into PgStat_TableStatus counters until we know if it is going to commit
@@ -282,6 +302,7 @@ static int	localNumBackends = 0;
 static PgStat_ArchiverStats archiverStats;
 static PgStat_GlobalStats globalStats;
 static PgStat_SLRUStats slruStats[SLRU_NUM_ELEMENTS];
+static PgStat_DecompressionStats decompressionStats[TOAST_INVALID_COMPRESSION_ID];
 
 /*
  * List of OIDs of databases we need to write out.  If an entry is InvalidOid,
@@ -315,7 +336,8 @@ static PgStat_StatTabEntry *pgstat_get_tab_entry(PgStat_StatDBEntry *dbentry,
 static void pgstat_write_statsfiles(bool permanent, bool allDbs);
 static void pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent);
 static HTAB *pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep);
-static void pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash, bool permanent);
+static void pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
+									 HTAB *toasthash, bool permanent);
 static void backend_read_statsfile(void);
 static void pgstat_read_current_status(void);
 
@@ -324,6 +346,7 @@ static bool pgstat_db_requested(Oid databaseid);
 
 static void pgstat_send_tabstat(PgStat_MsgTabstat *tsmsg);
 static void pgstat_send_funcstats(void);
+static void pgstat_send_toaststats(void);
 static void pgstat_send_slru(void);
 static HTAB *pgstat_collect_oids(Oid catalogid, AttrNumber anum_oid);
 
@@ -356,6 +379,10 @@ static void pgstat_recv_bgwriter(PgStat_MsgBgWriter *msg, int len);
 static void pgstat_recv_slru(PgStat_MsgSLRU *msg, int len);
 static void pgstat_recv_funcstat(PgStat_MsgFuncstat *msg, int len);
 static void pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len);
+static void pgstat_recv_toaststat(PgStat_MsgToaststat *msg, int len);
+static void pgstat_recv_decompression(PgStat_MsgDecompression *msg, int len);
+static void pgstat_purge_toast_entries(PgStat_StatDBEntry *dbentry,
+									   Oid *relids, int nrelids);
 static void pgstat_recv_recoveryconflict(PgStat_MsgRecoveryConflict *msg, int len);
 static void pgstat_recv_deadlock(PgStat_MsgDeadlock *msg, int len);
 static void pgstat_recv_checksum_failure(PgStat_MsgChecksumFailure *msg, int len);
@@ -851,7 +878,7 @@ pgstat_report_stat(bool force)
 	/* Don't expend a clock check if nothing to do */
 	if ((pgStatTabList == NULL || pgStatTabList->tsa_used == 0) &&
 		pgStatXactCommit == 0 && pgStatXactRollback == 0 &&
-		!have_function_stats)
+		!have_function_stats && !have_toast_stats)
 		return;
 
 	/*
@@ -938,6 +965,9 @@ pgstat_report_stat(bool force)
 	/* Now, send function statistics */
 	pgstat_send_funcstats();
 
+	/* Then TOAST statistics */
+	pgstat_send_toaststats();
+
 	/* Finally send SLRU statistics */
 	pgstat_send_slru();
 }
@@ -1041,6 +1071,91 @@ pgstat_send_funcstats(void)
 	have_function_stats = false;
 }
 
+/*
+ * Subroutine for pgstat_report_stat: populate and send TOAST compression and
+ * decompression stat messages
+ */
+static void
+pgstat_send_toaststats(void)
+{
+	/* we assume this inits to all zeroes: */
+	static const PgStat_ToastCounts all_zeroes;
+
+	PgStat_MsgToaststat msg;
+	PgStat_MsgDecompression d_msg;
+	PgStat_BackendToastEntry *entry;
+	HASH_SEQ_STATUS tstat;
+	bool		have_decompression = false;
+
+	if (!have_toast_stats)
+		return;
+
+	if (pgStatToastColumns != NULL)
+	{
+		pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_TOASTSTAT);
+		msg.m_databaseid = MyDatabaseId;
+		msg.m_nentries = 0;
+
+		hash_seq_init(&tstat, pgStatToastColumns);
+		while ((entry = (PgStat_BackendToastEntry *) hash_seq_search(&tstat)) != NULL)
+		{
+			PgStat_ToastEntry *m_ent;
+
+			/* Skip it if no counts accumulated since last time */
+			if (memcmp(&entry->t_counts, &all_zeroes,
+					   sizeof(PgStat_ToastCounts)) == 0)
+				continue;
+
+			/* need to convert format of time accumulators */
+			m_ent = &msg.m_entry[msg.m_nentries];
+			m_ent->t_key = entry->t_key;
+			m_ent->t_numcompressed = entry->t_counts.t_numcompressed;
+			m_ent->t_numfailed = entry->t_counts.t_numfailed;
+			m_ent->t_raw_bytes = entry->t_counts.t_raw_bytes;
+			m_ent->t_compressed_bytes = entry->t_counts.t_compressed_bytes;
+			m_ent->t_compress_time = INSTR_TIME_GET_MICROSEC(entry->t_counts.t_compress_time);
+
+			if (++msg.m_nentries >= PGSTAT_NUM_TOASTENTRIES)
+			{
+				pgstat_send(&msg, offsetof(PgStat_MsgToaststat, m_entry[0]) +
+							msg.m_nentries * sizeof(PgStat_ToastEntry));
+				msg.m_nentries = 0;
+			}
+
+			/* reset the entry's counts */
+			MemSet(&entry->t_counts, 0, sizeof(PgStat_ToastCounts));
+		}
+
+		if (msg.m_nentries > 0)
+			pgstat_send(&msg, offsetof(PgStat_MsgToaststat, m_entry[0]) +
+						msg.m_nentries * sizeof(PgStat_ToastEntry));
+	}
+
+	MemSet(&d_msg, 0, sizeof(d_msg));
+	for (int i = 0; i < TOAST_INVALID_COMPRESSION_ID; i++)
+	{
+		if (pgStatDecompressed[i] == 0)
+			continue;
+
+		d_msg.m_numdecompressed[i] = pgStatDecompressed[i];
+		d_msg.m_raw_bytes[i] = pgStatDecompressedBytes[i];
+		d_msg.m_decompress_time[i] = INSTR_TIME_GET_MICROSEC(pgStatDecompressTime[i]);
+		have_decompression = true;
+
+		pgStatDecompressed[i] = 0;
+		pgStatDecompressedBytes[i] = 0;
+		INSTR_TIME_SET_ZERO(pgStatDecompressTime[i]);
+	}
+
+	if (have_decompression)
+	{
+		pgstat_setheader(&d_msg.m_hdr, PGSTAT_MTYPE_DECOMPRESSION);
+		pgstat_send(&d_msg, sizeof(d_msg));
+	}
+
+	have_toast_stats = false;
+}
+
 
 /* ----------
  * pgstat_vacuum_stat() -
@@ -1147,6 +1262,41 @@ pgstat_vacuum_stat(void)
 		}
 	}
 
+	/*
+	 * Do the same for relations that only have TOAST column stats left.  The
+	 * collector removes those along with the table stats.
+	 */
+	if (dbentry->toastcolumns != NULL)
+	{
+		PgStat_StatToastEntry *toastentry;
+
+		hash_seq_init(&hstat, dbentry->toastcolumns);
+		while ((toastentry = (PgStat_StatToastEntry *) hash_seq_search(&hstat)) != NULL)
+		{
+			Oid			tabid = toastentry->key.relid;
+
+			CHECK_FOR_INTERRUPTS();
+
+			if (hash_search(htab, (void *) &tabid, HASH_FIND, NULL) != NULL ||
+				hash_search(dbentry->tables, (void *) &tabid, HASH_FIND, NULL) != NULL)
+				continue;
+
+			msg.m_tableid[msg.m_nentries++] = tabid;
+
+			if (msg.m_nentries >= PGSTAT_NUM_TABPURGE)
+			{
+				len = offsetof(PgStat_MsgTabpurge, m_tableid[0])
+					+ msg.m_nentries * sizeof(Oid);
+
+				pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_TABPURGE);
+				msg.m_databaseid = MyDatabaseId;
+				pgstat_send(&msg, len);
+
+				msg.m_nentries = 0;
+			}
+		}
+	}
+
 	/*
 	 * Send the rest
 	 */
@@ -1363,6 +1513,13 @@ pgstat_reset_shared_counters(const char *target)
 {
 	PgStat_MsgResetsharedcounter msg;
 
+	/* These counters are kept in shared memory, not by the collector */
+	if (strcmp(target, "recovery_prefetch") == 0)
+	{
+		XLogPrefetchRequestResetStats();
+		return;
+	}
+
 	if (pgStatSock == PGINVALID_SOCKET)
 		return;
 
@@ -1370,11 +1527,13 @@ pgstat_reset_shared_counters(const char *target)
 		msg.m_resettarget = RESET_ARCHIVER;
 	else if (strcmp(target, "bgwriter") == 0)
 		msg.m_resettarget = RESET_BGWRITER;
+	else if (strcmp(target, "decompression") == 0)
+		msg.m_resettarget = RESET_DECOMPRESSION;
 	else
 		ereport(ERROR,
 				(errcode(ERRCODE_INVALID_PARAMETER_VALUE),
 				 errmsg("unrecognized reset target: \"%s\"", target),
-				 errhint("Target must be \"archiver\" or \"bgwriter\".")));
+				 errhint("Target must be \"archiver\", \"bgwriter\", \"decompression\" or \"recovery_prefetch\".")));
 
 	pgstat_setheader(&msg.m_hdr, PGSTAT_MTYPE_RESETSHAREDCOUNTER);
 	pgstat_send(&msg, sizeof(msg));
@@ -1787,6 +1946,81 @@ pgstat_end_function_usage(PgStat_FunctionCallUsage *fcu, bool finalize)
 	have_function_stats = true;
 }
 
+/*
+ * Count an attempt to compress a value of the given column for TOAST,
+ * which started at the given time.  compressed_size is negative if the
+ * attempt failed.  Called only if track_toast is on.
+ */
+void
+pgstat_count_toast_compression(Oid relid, AttrNumber attnum,
+							   int32 rawsize, int32 compressed_size,
+							   instr_time start)
+{
+	PgStat_ToastColumnKey key;
+	PgStat_BackendToastEntry *htabent;
+	instr_time	elapsed;
+	bool		found;
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	if (!pgStatToastColumns)
+	{
+		/* First time through - initialize TOAST stat table */
+		HASHCTL		hash_ctl;
+
+		memset(&hash_ctl, 0, sizeof(hash_ctl));
+		hash_ctl.keysize = sizeof(PgStat_ToastColumnKey);
+		hash_ctl.entrysize = sizeof(PgStat_BackendToastEntry);
+		pgStatToastColumns = hash_create("TOAST stat entries",
+										 PGSTAT_TOAST_HASH_SIZE,
+										 &hash_ctl,
+										 HASH_ELEM | HASH_BLOBS);
+	}
+
+	/* Get the stats entry for this column, create if necessary */
+	MemSet(&key, 0, sizeof(key));
+	key.relid = relid;
+	key.attnum = attnum;
+	htabent = hash_search(pgStatToastColumns, &key, HASH_ENTER, &found);
+	if (!found)
+		MemSet(&htabent->t_counts, 0, sizeof(PgStat_ToastCounts));
+
+	if (compressed_size >= 0)
+	{
+		htabent->t_counts.t_numcompressed++;
+		htabent->t_counts.t_raw_bytes += rawsize;
+		htabent->t_counts.t_compressed_bytes += compressed_size;
+	}
+	else
+		htabent->t_counts.t_numfailed++;
+	INSTR_TIME_ADD(htabent->t_counts.t_compress_time, elapsed);
+
+	have_toast_stats = true;
+}
+
+/*
+ * Count the decompression of a TOAST value compressed with the given method,
+ * which started at the given time.  Called only if track_toast is on.
+ */
+void
+pgstat_count_toast_decompression(ToastCompressionId cmid, int32 rawsize,
+								 instr_time start)
+{
+	instr_time	elapsed;
+
+	Assert(cmid < TOAST_INVALID_COMPRESSION_ID);
+
+	INSTR_TIME_SET_CURRENT(elapsed);
+	INSTR_TIME_SUBTRACT(elapsed, start);
+
+	pgStatDecompressed[cmid]++;
+	pgStatDecompressedBytes[cmid] += rawsize;
+	INSTR_TIME_ADD(pgStatDecompressTime[cmid], elapsed);
+
+	have_toast_stats = true;
+}
+
 
 /* ----------
  * pgstat_initstats() -
@@ -2692,6 +2926,24 @@ pgstat_fetch_slru(void)
 }
 
 
+/*
+ * ---------
+ * pgstat_fetch_decompression() -
+ *
+ *	Support function for the SQL-callable pgstat* functions. Returns
+ *	a pointer to the decompression statistics, an array indexed by
+ *	compression method ID.
+ * ---------
+ */
+PgStat_DecompressionStats *
+pgstat_fetch_decompression(void)
+{
+	backend_read_statsfile();
+
+	return decompressionStats;
+}
+
+
 /* ------------------------------------------------------------
  * Functions for management of the shared-memory PgBackendStatus array
  * ------------------------------------------------------------
@@ -3663,6 +3915,9 @@ pgstat_get_wait_activity(WaitEventActivity w)
 		case WAIT_EVENT_CHECKPOINTER_MAIN:
 			event_name = "CheckpointerMain";
 			break;
+		case WAIT_EVENT_IO_WORKER_MAIN:
+			event_name = "IoWorkerMain";
+			break;
 		case WAIT_EVENT_LOGICAL_APPLY_MAIN:
 			event_name = "LogicalApplyMain";
 			break;
@@ -3752,6 +4007,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 
 	switch (w)
 	{
+		case WAIT_EVENT_AIO_COMPLETION:
+			event_name = "AioCompletion";
+			break;
 		case WAIT_EVENT_BACKUP_WAIT_WAL_ARCHIVE:
 			event_name = "BackupWaitWalArchive";
 			break;
@@ -3845,6 +4103,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_PARALLEL_FINISH:
 			event_name = "ParallelFinish";
 			break;
+		case WAIT_EVENT_PARALLEL_REDO_WORKERS:
+			event_name = "ParallelRedoWorkers";
+			break;
 		case WAIT_EVENT_PROCARRAY_GROUP_UPDATE:
 			event_name = "ProcArrayGroupUpdate";
 			break;
@@ -3875,6 +4136,9 @@ pgstat_get_wait_ipc(WaitEventIPC w)
 		case WAIT_EVENT_SYNC_REP:
 			event_name = "SyncRep";
 			break;
+		case WAIT_EVENT_WAL_GROUP_FLUSH:
+			event_name = "WALGroupFlush";
+			break;
 		case WAIT_EVENT_XACT_GROUP_UPDATE:
 			event_name = "XactGroupUpdate";
 			break;
@@ -4655,6 +4919,14 @@ PgstatCollectorMain(int argc, char *argv[])
 					pgstat_recv_funcpurge(&msg.msg_funcpurge, len);
 					break;
 
+				case PGSTAT_MTYPE_TOASTSTAT:
+					pgstat_recv_toaststat(&msg.msg_toaststat, len);
+					break;
+
+				case PGSTAT_MTYPE_DECOMPRESSION:
+					pgstat_recv_decompression(&msg.msg_decompression, len);
+					break;
+
 				case PGSTAT_MTYPE_RECOVERYCONFLICT:
 					pgstat_recv_recoveryconflict(&msg.msg_recoveryconflict,
 												 len);
@@ -4718,7 +4990,7 @@ PgstatCollectorMain(int argc, char *argv[])
 /*
  * Subroutine to clear stats in a database entry
  *
- * Tables and functions hashes are initialized to empty.
+ * Tables, functions and TOAST columns hashes are initialized to empty.
  */
 static void
 reset_dbentry_counters(PgStat_StatDBEntry *dbentry)
@@ -4765,6 +5037,13 @@ reset_dbentry_counters(PgStat_StatDBEntry *dbentry)
 									 PGSTAT_FUNCTION_HASH_SIZE,
 									 &hash_ctl,
 									 HASH_ELEM | HASH_BLOBS);
+
+	hash_ctl.keysize = sizeof(PgStat_ToastColumnKey);
+	hash_ctl.entrysize = sizeof(PgStat_StatToastEntry);
+	dbentry->toastcolumns = hash_create("Per-database TOAST column",
+										PGSTAT_TOAST_HASH_SIZE,
+										&hash_ctl,
+										HASH_ELEM | HASH_BLOBS);
 }
 
 /*
@@ -4789,7 +5068,7 @@ pgstat_get_db_entry(Oid databaseid, bool create)
 
 	/*
 	 * If not found, initialize the new one.  This creates empty hash tables
-	 * for tables and functions, too.
+	 * for tables, functions and TOAST columns, too.
 	 */
 	if (!found)
 		reset_dbentry_counters(result);
@@ -4918,6 +5197,12 @@ pgstat_write_statsfiles(bool permanent, bool allDbs)
 	rc = fwrite(slruStats, sizeof(slruStats), 1, fpout);
 	(void) rc;					/* we'll check for error with ferror */
 
+	/*
+	 * Write decompression stats struct
+	 */
+	rc = fwrite(decompressionStats, sizeof(decompressionStats), 1, fpout);
+	(void) rc;					/* we'll check for error with ferror */
+
 	/*
 	 * Walk through the database table.
 	 */
@@ -4937,8 +5222,9 @@ pgstat_write_statsfiles(bool permanent, bool allDbs)
 		}
 
 		/*
-		 * Write out the DB entry. We don't write the tables or functions
-		 * pointers, since they're of no use to any other process.
+		 * Write out the DB entry. We don't write the tables, functions or
+		 * toastcolumns pointers, since they're of no use to any other
+		 * process.
 		 */
 		fputc('D', fpout);
 		rc = fwrite(dbentry, offsetof(PgStat_StatDBEntry, tables), 1, fpout);
@@ -5024,8 +5310,10 @@ pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent)
 {
 	HASH_SEQ_STATUS tstat;
 	HASH_SEQ_STATUS fstat;
+	HASH_SEQ_STATUS cstat;
 	PgStat_StatTabEntry *tabentry;
 	PgStat_StatFuncEntry *funcentry;
+	PgStat_StatToastEntry *toastentry;
 	FILE	   *fpout;
 	int32		format_id;
 	Oid			dbid = dbentry->databaseid;
@@ -5080,6 +5368,17 @@ pgstat_write_db_statsfile(PgStat_StatDBEntry *dbentry, bool permanent)
 		(void) rc;				/* we'll check for error with ferror */
 	}
 
+	/*
+	 * Walk through the database's TOAST column stats table.
+	 */
+	hash_seq_init(&cstat, dbentry->toastcolumns);
+	while ((toastentry = (PgStat_StatToastEntry *) hash_seq_search(&cstat)) != NULL)
+	{
+		fputc('C', fpout);
+		rc = fwrite(toastentry, sizeof(PgStat_StatToastEntry), 1, fpout);
+		(void) rc;				/* we'll check for error with ferror */
+	}
+
 	/*
 	 * No more output to be done. Close the temp file and replace the old
 	 * pgstat.stat with it.  The ferror() check replaces testing for error
@@ -5177,6 +5476,7 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 	memset(&globalStats, 0, sizeof(globalStats));
 	memset(&archiverStats, 0, sizeof(archiverStats));
 	memset(&slruStats, 0, sizeof(slruStats));
+	memset(&decompressionStats, 0, sizeof(decompressionStats));
 
 	/*
 	 * Set the current timestamp (will be kept only in case we can't load an
@@ -5191,6 +5491,12 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 	for (i = 0; i < SLRU_NUM_ELEMENTS; i++)
 		slruStats[i].stat_reset_timestamp = globalStats.stat_reset_timestamp;
 
+	/*
+	 * And for the decompression stats of each compression method.
+	 */
+	for (i = 0; i < TOAST_INVALID_COMPRESSION_ID; i++)
+		decompressionStats[i].stat_reset_timestamp = globalStats.stat_reset_timestamp;
+
 	/*
 	 * Try to open the stats file. If it doesn't exist, the backends simply
 	 * return zero for anything and the collector simply starts from scratch
@@ -5264,6 +5570,18 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 		goto done;
 	}
 
+	/*
+	 * Read decompression stats struct
+	 */
+	if (fread(decompressionStats, 1, sizeof(decompressionStats),
+			  fpin) != sizeof(decompressionStats))
+	{
+		ereport(pgStatRunningInCollector ? LOG : WARNING,
+				(errmsg("corrupted statistics file \"%s\"", statfile)));
+		memset(&decompressionStats, 0, sizeof(decompressionStats));
+		goto done;
+	}
+
 	/*
 	 * We found an existing collector stats file. Read it and put all the
 	 * hashtable entries into place.
@@ -5304,6 +5622,7 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 				memcpy(dbentry, &dbbuf, sizeof(PgStat_StatDBEntry));
 				dbentry->tables = NULL;
 				dbentry->functions = NULL;
+				dbentry->toastcolumns = NULL;
 
 				/*
 				 * In the collector, disregard the timestamp we read from the
@@ -5342,6 +5661,14 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 												 &hash_ctl,
 												 HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
 
+				hash_ctl.keysize = sizeof(PgStat_ToastColumnKey);
+				hash_ctl.entrysize = sizeof(PgStat_StatToastEntry);
+				hash_ctl.hcxt = pgStatLocalContext;
+				dbentry->toastcolumns = hash_create("Per-database TOAST column",
+													PGSTAT_TOAST_HASH_SIZE,
+													&hash_ctl,
+													HASH_ELEM | HASH_BLOBS | HASH_CONTEXT);
+
 				/*
 				 * If requested, read the data from the database-specific
 				 * file.  Otherwise we just leave the hashtables empty.
@@ -5350,6 +5677,7 @@ pgstat_read_statsfiles(Oid onlydb, bool permanent, bool deep)
 					pgstat_read_db_statsfile(dbentry->databaseid,
 											 dbentry->tables,
 											 dbentry->functions,
+											 dbentry->toastcolumns,
 											 permanent);
 
 				break;
@@ -5383,24 +5711,26 @@ done:
  * pgstat_read_db_statsfile() -
  *
  *	Reads in the existing statistics collector file for the given database,
- *	filling the passed-in tables and functions hash tables.
+ *	filling the passed-in tables, functions and TOAST columns hash tables.
  *
  *	As in pgstat_read_statsfiles, if the permanent file is requested, it is
  *	removed after reading.
  *
- *	Note: this code has the ability to skip storing per-table or per-function
- *	data, if NULL is passed for the corresponding hashtable.  That's not used
- *	at the moment though.
+ *	Note: this code has the ability to skip storing per-table, per-function or
+ *	per-column data, if NULL is passed for the corresponding hashtable.  That's
+ *	not used at the moment though.
  * ----------
  */
 static void
 pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
-						 bool permanent)
+						 HTAB *toasthash, bool permanent)
 {
 	PgStat_StatTabEntry *tabentry;
 	PgStat_StatTabEntry tabbuf;
 	PgStat_StatFuncEntry funcbuf;
 	PgStat_StatFuncEntry *funcentry;
+	PgStat_StatToastEntry toastbuf;
+	PgStat_StatToastEntry *toastentry;
 	FILE	   *fpin;
 	int32		format_id;
 	bool		found;
@@ -5514,6 +5844,40 @@ pgstat_read_db_statsfile(Oid databaseid, HTAB *tabhash, HTAB *funchash,
 				memcpy(funcentry, &funcbuf, sizeof(funcbuf));
 				break;
 
+				/*
+				 * 'C'	A PgStat_StatToastEntry follows.
+				 */
+			case 'C':
+				if (fread(&toastbuf, 1, sizeof(PgStat_StatToastEntry),
+						  fpin) != sizeof(PgStat_StatToastEntry))
+				{
+					ereport(pgStatRunningInCollector ? LOG : WARNING,
+							(errmsg("corrupted statistics file \"%s\"",
+									statfile)));
+					goto done;
+				}
+
+				/*
+				 * Skip if TOAST column data not wanted.
+				 */
+				if (toasthash == NULL)
+					break;
+
+				toastentry = (PgStat_StatToastEntry *) hash_search(toasthash,
+																   (void *) &toastbuf.key,
+																   HASH_ENTER, &found);
+
+				if (found)
+				{
+					ereport(pgStatRunningInCollector ? LOG : WARNING,
+							(errmsg("corrupted statistics file \"%s\"",
+									statfile)));
+					goto done;
+				}
+
+				memcpy(toastentry, &toastbuf, sizeof(toastbuf));
+				break;
+
 				/*
 				 * 'E'	The EOF marker of a complete stats file.
 				 */
@@ -5563,6 +5927,7 @@ pgstat_read_db_statsfile_timestamp(Oid databaseid, bool permanent,
 	PgStat_GlobalStats myGlobalStats;
 	PgStat_ArchiverStats myArchiverStats;
 	PgStat_SLRUStats mySLRUStats[SLRU_NUM_ELEMENTS];
+	PgStat_DecompressionStats myDecompressionStats[TOAST_INVALID_COMPRESSION_ID];
 	FILE	   *fpin;
 	int32		format_id;
 	const char *statfile = permanent ? PGSTAT_STAT_PERMANENT_FILENAME : pgstat_stat_filename;
@@ -5628,6 +5993,18 @@ pgstat_read_db_statsfile_timestamp(Oid databaseid, bool permanent,
 		return false;
 	}
 
+	/*
+	 * Read decompression stats struct
+	 */
+	if (fread(myDecompressionStats, 1, sizeof(myDecompressionStats),
+			  fpin) != sizeof(myDecompressionStats))
+	{
+		ereport(pgStatRunningInCollector ? LOG : WARNING,
+				(errmsg("corrupted statistics file \"%s\"", statfile)));
+		FreeFile(fpin);
+		return false;
+	}
+
 	/* By default, we're going to return the timestamp of the global file. */
 	*ts = myGlobalStats.stats_timestamp;
 
@@ -6088,6 +6465,42 @@ pgstat_recv_tabpurge(PgStat_MsgTabpurge *msg, int len)
 						   (void *) &(msg->m_tableid[i]),
 						   HASH_REMOVE, NULL);
 	}
+
+	/* Likewise the tables' TOAST column entries */
+	pgstat_purge_toast_entries(dbentry, msg->m_tableid, msg->m_nentries);
+}
+
+/* ----------
+ * pgstat_purge_toast_entries() -
+ *
+ *	Remove the TOAST column entries of the given tables.
+ * ----------
+ */
+static void
+pgstat_purge_toast_entries(PgStat_StatDBEntry *dbentry, Oid *relids,
+						   int nrelids)
+{
+	HASH_SEQ_STATUS hstat;
+	PgStat_StatToastEntry *toastentry;
+
+	if (dbentry->toastcolumns == NULL ||
+		hash_get_num_entries(dbentry->toastcolumns) == 0)
+		return;
+
+	hash_seq_init(&hstat, dbentry->toastcolumns);
+	while ((toastentry = (PgStat_StatToastEntry *) hash_seq_search(&hstat)) != NULL)
+	{
+		for (int i = 0; i < nrelids; i++)
+		{
+			if (toastentry->key.relid == relids[i])
+			{
+				(void) hash_search(dbentry->toastcolumns,
+								   (void *) &toastentry->key,
+								   HASH_REMOVE, NULL);
+				break;
+			}
+		}
+	}
 }
 
 
@@ -6124,6 +6537,8 @@ pgstat_recv_dropdb(PgStat_MsgDropdb *msg, int len)
 			hash_destroy(dbentry->tables);
 		if (dbentry->functions != NULL)
 			hash_destroy(dbentry->functions);
+		if (dbentry->toastcolumns != NULL)
+			hash_destroy(dbentry->toastcolumns);
 
 		if (hash_search(pgStatDBHash,
 						(void *) &dbid,
@@ -6161,13 +6576,16 @@ pgstat_recv_resetcounter(PgStat_MsgResetcounter *msg, int len)
 		hash_destroy(dbentry->tables);
 	if (dbentry->functions != NULL)
 		hash_destroy(dbentry->functions);
+	if (dbentry->toastcolumns != NULL)
+		hash_destroy(dbentry->toastcolumns);
 
 	dbentry->tables = NULL;
 	dbentry->functions = NULL;
+	dbentry->toastcolumns = NULL;
 
 	/*
 	 * Reset database-level stats, too.  This creates empty hash tables for
-	 * tables and functions.
+	 * tables, functions and TOAST columns.
 	 */
 	reset_dbentry_counters(dbentry);
 }
@@ -6193,6 +6611,15 @@ pgstat_recv_resetsharedcounter(PgStat_MsgResetsharedcounter *msg, int len)
 		memset(&archiverStats, 0, sizeof(archiverStats));
 		archiverStats.stat_reset_timestamp = GetCurrentTimestamp();
 	}
+	else if (msg->m_resettarget == RESET_DECOMPRESSION)
+	{
+		TimestampTz ts = GetCurrentTimestamp();
+
+		/* Reset the decompression statistics for the cluster. */
+		memset(&decompressionStats, 0, sizeof(decompressionStats));
+		for (int i = 0; i < TOAST_INVALID_COMPRESSION_ID; i++)
+			decompressionStats[i].stat_reset_timestamp = ts;
+	}
 
 	/*
 	 * Presumably the sender of this message validated the target, don't
@@ -6221,8 +6648,11 @@ pgstat_recv_resetsinglecounter(PgStat_MsgResetsinglecounter *msg, int len)
 
 	/* Remove object if it exists, ignore it if not */
 	if (msg->m_resettype == RESET_TABLE)
+	{
 		(void) hash_search(dbentry->tables, (void *) &(msg->m_objectid),
 						   HASH_REMOVE, NULL);
+		pgstat_purge_toast_entries(dbentry, &msg->m_objectid, 1);
+	}
 	else if (msg->m_resettype == RESET_FUNCTION)
 		(void) hash_search(dbentry->functions, (void *) &(msg->m_objectid),
 						   HASH_REMOVE, NULL);
@@ -6595,6 +7025,75 @@ pgstat_recv_funcpurge(PgStat_MsgFuncpurge *msg, int len)
 	}
 }
 
+/* ----------
+ * pgstat_recv_toaststat() -
+ *
+ *	Count what the backend has compressed.
+ * ----------
+ */
+static void
+pgstat_recv_toaststat(PgStat_MsgToaststat *msg, int len)
+{
+	PgStat_ToastEntry *toastmsg = &(msg->m_entry[0]);
+	PgStat_StatDBEntry *dbentry;
+	PgStat_StatToastEntry *toastentry;
+	int			i;
+	bool		found;
+
+	dbentry = pgstat_get_db_entry(msg->m_databaseid, true);
+
+	/*
+	 * Process all column entries in the message.
+	 */
+	for (i = 0; i < msg->m_nentries; i++, toastmsg++)
+	{
+		toastentry = (PgStat_StatToastEntry *) hash_search(dbentry->toastcolumns,
+														   (void *) &(toastmsg->t_key),
+														   HASH_ENTER, &found);
+
+		if (!found)
+		{
+			/*
+			 * If it's a new column entry, initialize counters to the values
+			 * we just got.
+			 */
+			toastentry->numcompressed = toastmsg->t_numcompressed;
+			toastentry->numfailed = toastmsg->t_numfailed;
+			toastentry->raw_bytes = toastmsg->t_raw_bytes;
+			toastentry->compressed_bytes = toastmsg->t_compressed_bytes;
+			toastentry->compress_time = toastmsg->t_compress_time;
+		}
+		else
+		{
+			/*
+			 * Otherwise add the values to the existing entry.
+			 */
+			toastentry->numcompressed += toastmsg->t_numcompressed;
+			toastentry->numfailed += toastmsg->t_numfailed;
+			toastentry->raw_bytes += toastmsg->t_raw_bytes;
+			toastentry->compressed_bytes += toastmsg->t_compressed_bytes;
+			toastentry->compress_time += toastmsg->t_compress_time;
+		}
+	}
+}
+
+/* ----------
+ * pgstat_recv_decompression() -
+ *
+ *	Count what the backend has decompressed.
+ * ----------
+ */
+static void
+pgstat_recv_decompression(PgStat_MsgDecompression *msg, int len)
+{
+	for (int i = 0; i < TOAST_INVALID_COMPRESSION_ID; i++)
+	{
+		decompressionStats[i].numdecompressed += msg->m_numdecompressed[i];
+		decompressionStats[i].raw_bytes += msg->m_raw_bytes[i];
+		decompressionStats[i].decompress_time += msg->m_decompress_time[i];
+	}
+}
+
 /* ----------
  * pgstat_write_statsfile_needed() -
  *
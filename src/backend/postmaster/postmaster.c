@@ -117,6 +117,7 @@
 #include "postmaster/syslogger.h"
 #include "replication/logicallauncher.h"
 #include "replication/walsender.h"
+#include "storage/aio.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
 #include "storage/pg_shmem.h"
@@ -980,6 +981,9 @@ PostmasterMain(int argc, char *argv[])
 	 */
 	ApplyLauncherRegister();
 
+	/* Likewise for the I/O workers, if io_method uses them */
+	AioWorkerRegister();
+
 	/*
 	 * process any libraries that should be preloaded at postmaster start
 	 */
@@ -0,0 +1,812 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio.c
+ *	  Asynchronous I/O on relation data files.
+ *
+ * Each process that can start I/Os owns PGAIO_MAX_IN_FLIGHT handles in
+ * shared memory.  Starting an I/O fills in one of them and passes it to the
+ * I/O method; the completion callback runs later, in pgaio_reap() or
+ * pgaio_wait_all(), in the process that started the I/O.
+ *
+ * With io_method = worker, I/Os are put on a queue in shared memory, from
+ * which a pool of I/O worker processes (background workers) takes them and
+ * performs them with the ordinary, synchronous smgr functions.  The pages
+ * are in shared memory, so the worker can read into or write from them
+ * directly.  A worker that fails an I/O passes the error message back, and
+ * the process that started it raises the error when it collects the I/O.
+ * When no workers are running, as during shutdown, I/Os are performed
+ * synchronously.
+ *
+ * io_method = io_uring is implemented in aio_uring.c.  With io_method =
+ * sync, or in processes that cannot use handles, I/Os are performed, and
+ * their callbacks run, when they are started.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/aio/aio.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include <signal.h>
+
+#include "miscadmin.h"
+#include "pgstat.h"
+#include "postmaster/bgworker.h"
+#include "postmaster/bgwriter.h"
+#include "storage/aio_internal.h"
+#include "storage/ipc.h"
+#include "storage/latch.h"
+#include "storage/proc.h"
+#include "storage/shmem.h"
+#include "storage/smgr.h"
+#include "storage/spin.h"
+#include "utils/memutils.h"
+
+/* GUC variables */
+int			io_method = IOMETHOD_SYNC;
+int			io_workers = 3;
+
+/*
+ * Shared state of the I/O workers: the queue of I/Os waiting for them, as
+ * handle numbers, and their latches, to wake them up.
+ */
+typedef struct AioCtlData
+{
+	slock_t		lock;			/* protects all the fields */
+	int			nworkers;		/* number of running workers */
+	Latch	   *worker_latches[MAX_IO_WORKERS];
+	int			next_worker;	/* worker to wake up next */
+	int			queue_head;		/* position of the oldest queued I/O */
+	int			queue_len;		/* number of queued I/Os */
+	int			queue[FLEXIBLE_ARRAY_MEMBER];
+} AioCtlData;
+
+static AioCtlData *AioCtl = NULL;
+PgAioHandle *AioHandles = NULL;
+
+/*
+ * Bounce buffers, for the handles of auxiliary processes: pages are written
+ * from a copy, so that the checkpointer and the background writer need not
+ * keep them locked until the write completes.  Each holds PGAIO_MAX_BLOCKS
+ * pages.
+ */
+static char *AioBounceBuffers = NULL;
+
+#define AioNumProcs()	(MaxBackends + NUM_AUXILIARY_PROCS)
+#define AioNumHandles() (AioNumProcs() * PGAIO_MAX_IN_FLIGHT)
+#define AioBounceBufferSize (PGAIO_MAX_BLOCKS * BLCKSZ)
+
+/* Process-local state */
+static int	my_first_handle = -1;	/* number of this process's first handle */
+static int	my_num_in_flight = 0;	/* handles not idle */
+static int	my_reserved_handle = -1;	/* reserved by pgaio_bounce_buffer */
+static PgAioCallback my_callbacks[PGAIO_MAX_IN_FLIGHT];
+
+/* I/O worker state */
+static volatile sig_atomic_t io_worker_shutdown_pending = false;
+static int	io_worker_current = -1; /* handle being performed */
+
+static void pgaio_start(const PgAioRequest *req, PgAioCallback callback);
+static int	pgaio_get_handle(void);
+static void pgaio_execute(const PgAioRequest *req);
+static void pgaio_complete(int n);
+static void pgaio_process(bool wait);
+static bool pgaio_worker_submit(int n);
+static void pgaio_worker_wait(void);
+static void pgaio_worker_steal(bool always);
+static void IoWorkerSigterm(SIGNAL_ARGS);
+static void IoWorkerExit(int code, Datum arg);
+
+
+/*
+ * Report shared-memory space needed by AioShmemInit
+ */
+Size
+AioShmemSize(void)
+{
+	Size		size;
+
+	if (io_method == IOMETHOD_SYNC)
+		return 0;
+
+	size = offsetof(AioCtlData, queue);
+	size = add_size(size, mul_size(AioNumHandles(), sizeof(int)));
+	size = add_size(size, mul_size(AioNumHandles(), sizeof(PgAioHandle)));
+	size = add_size(size, mul_size(NUM_AUXILIARY_PROCS * PGAIO_MAX_IN_FLIGHT,
+								   AioBounceBufferSize));
+	/* to allow aligning the bounce buffers */
+	size = add_size(size, PG_CACHE_LINE_SIZE);
+
+	return size;
+}
+
+/*
+ * Allocate and initialize the shared state of asynchronous I/O
+ */
+void
+AioShmemInit(void)
+{
+	bool		found;
+	int			i;
+
+	if (io_method == IOMETHOD_SYNC)
+		return;
+
+	AioCtl = (AioCtlData *)
+		ShmemInitStruct("AIO control",
+						add_size(offsetof(AioCtlData, queue),
+								 mul_size(AioNumHandles(), sizeof(int))),
+						&found);
+	AioHandles = (PgAioHandle *)
+		ShmemInitStruct("AIO handles",
+						mul_size(AioNumHandles(), sizeof(PgAioHandle)),
+						&found);
+	AioBounceBuffers = (char *)
+		CACHELINEALIGN(ShmemInitStruct("AIO bounce buffers",
+									   add_size(mul_size(NUM_AUXILIARY_PROCS * PGAIO_MAX_IN_FLIGHT,
+														 AioBounceBufferSize),
+												PG_CACHE_LINE_SIZE),
+									   &found));
+
+	if (!found)
+	{
+		SpinLockInit(&AioCtl->lock);
+		AioCtl->nworkers = 0;
+		for (i = 0; i < MAX_IO_WORKERS; i++)
+			AioCtl->worker_latches[i] = NULL;
+		AioCtl->next_worker = 0;
+		AioCtl->queue_head = 0;
+		AioCtl->queue_len = 0;
+
+		for (i = 0; i < AioNumHandles(); i++)
+			pg_atomic_init_u32(&AioHandles[i].state, PGAIO_IDLE);
+	}
+}
+
+/*
+ * pgaio_start_readv
+ *		Start reading nblocks consecutive blocks into the given pages, which
+ *		must be in shared memory.  callback is called with the request
+ *		once the read has completed successfully.
+ */
+void
+pgaio_start_readv(SMgrRelation reln, ForkNumber forknum,
+				  BlockNumber blocknum, char **pages, int nblocks,
+				  const int *cb_data, PgAioCallback callback)
+{
+	PgAioRequest req;
+
+	Assert(nblocks > 0 && nblocks <= PGAIO_MAX_BLOCKS);
+
+	req.op = PGAIO_OP_READV;
+	req.rnode = reln->smgr_rnode;
+	req.forknum = forknum;
+	req.blocknum = blocknum;
+	req.nblocks = nblocks;
+	req.skipFsync = false;
+	memcpy(req.pages, pages, nblocks * sizeof(char *));
+	memcpy(req.cb_data, cb_data, nblocks * sizeof(int));
+
+	pgaio_start(&req, callback);
+}
+
+/*
+ * pgaio_start_writev
+ *		Start writing nblocks pages, which must be in shared memory, to
+ *		consecutive blocks.  callback is called with the request once the
+ *		write has completed successfully.
+ */
+void
+pgaio_start_writev(SMgrRelation reln, ForkNumber forknum,
+				   BlockNumber blocknum, char **pages, int nblocks,
+				   bool skipFsync, const int *cb_data, PgAioCallback callback)
+{
+	PgAioRequest req;
+
+	Assert(nblocks > 0 && nblocks <= PGAIO_MAX_BLOCKS);
+
+	req.op = PGAIO_OP_WRITEV;
+	req.rnode = reln->smgr_rnode;
+	req.forknum = forknum;
+	req.blocknum = blocknum;
+	req.nblocks = nblocks;
+	req.skipFsync = skipFsync;
+	memcpy(req.pages, pages, nblocks * sizeof(char *));
+	memcpy(req.cb_data, cb_data, nblocks * sizeof(int));
+
+	pgaio_start(&req, callback);
+}
+
+/*
+ * pgaio_bounce_buffer
+ *		Return a buffer in shared memory, with room for PGAIO_MAX_BLOCKS
+ *		pages, to copy pages to be written with pgaio_start_writev() to, or
+ *		NULL if this process has none.
+ *
+ * The buffer belongs to the handle the next I/O of this process will use.
+ * Getting it may run the callbacks of completed I/Os.
+ */
+char *
+pgaio_bounce_buffer(void)
+{
+	int			n;
+
+	if (AioHandles == NULL || MyProc == NULL ||
+		MyProc->pgprocno < MaxBackends)
+		return NULL;
+
+	n = pgaio_get_handle();
+	my_reserved_handle = n;
+
+	return AioBounceBuffers +
+		(Size) (n - MaxBackends * PGAIO_MAX_IN_FLIGHT) * AioBounceBufferSize;
+}
+
+/*
+ * pgaio_reap
+ *		Run the callbacks of the I/Os of this process that have completed,
+ *		without waiting for any.
+ */
+void
+pgaio_reap(void)
+{
+	if (my_num_in_flight > 0)
+		pgaio_process(false);
+}
+
+/*
+ * pgaio_wait_all
+ *		Wait for all I/Os of this process to complete, and run their
+ *		callbacks.  If an I/O failed, its error is raised.
+ */
+void
+pgaio_wait_all(void)
+{
+	while (my_num_in_flight > 0)
+		pgaio_process(true);
+}
+
+/*
+ * pgaio_at_error
+ *		Clean up after an error: wait for the I/Os of this process still in
+ *		flight to finish, as they may still be using the pages, and forget
+ *		all of them without running their callbacks.
+ *
+ * The caller (AbortBufferIO) marks the buffers involved as failed.
+ */
+void
+pgaio_at_error(void)
+{
+	int			i;
+
+	my_reserved_handle = -1;
+
+	if (my_num_in_flight == 0)
+		return;
+
+	for (;;)
+	{
+		bool		busy = false;
+
+		for (i = 0; i < PGAIO_MAX_IN_FLIGHT; i++)
+		{
+			PgAioHandle *ioh = &AioHandles[my_first_handle + i];
+			uint32		state = pg_atomic_read_u32(&ioh->state);
+
+			if (state == PGAIO_QUEUED || state == PGAIO_IN_FLIGHT)
+				busy = true;
+		}
+		if (!busy)
+			break;
+
+#ifdef USE_LIBURING
+		if (io_method == IOMETHOD_IO_URING)
+		{
+			pgaio_uring_drain(true);
+			continue;
+		}
+#endif
+		/* Take back what no worker has started on, then wait for the rest */
+		pgaio_worker_steal(true);
+		pgaio_worker_wait();
+	}
+
+	for (i = 0; i < PGAIO_MAX_IN_FLIGHT; i++)
+		pg_atomic_write_u32(&AioHandles[my_first_handle + i].state,
+							PGAIO_IDLE);
+	my_num_in_flight = 0;
+}
+
+/*
+ * Start an I/O with the configured method, or perform it right away if
+ * that's not possible.
+ */
+static void
+pgaio_start(const PgAioRequest *req, PgAioCallback callback)
+{
+	if (AioHandles != NULL && MyProc != NULL &&
+		req->rnode.backend == InvalidBackendId)
+	{
+		int			n = pgaio_get_handle();
+		PgAioHandle *ioh = &AioHandles[n];
+		bool		started = false;
+
+		ioh->req = *req;
+		ioh->kernel_result = false;
+		ioh->result = 0;
+		ioh->error_code = 0;
+		my_callbacks[n - my_first_handle] = callback;
+
+#ifdef USE_LIBURING
+		if (io_method == IOMETHOD_IO_URING)
+			started = pgaio_uring_submit(ioh, n);
+#endif
+		if (io_method == IOMETHOD_WORKER)
+			started = pgaio_worker_submit(n);
+
+		if (started)
+		{
+			my_num_in_flight++;
+			return;
+		}
+	}
+
+	pgaio_execute(req);
+	callback(req);
+}
+
+/*
+ * Get an idle handle of this process, first waiting for an I/O to complete
+ * if they are all in use.
+ */
+static int
+pgaio_get_handle(void)
+{
+	int			i;
+
+	if (my_reserved_handle >= 0)
+	{
+		i = my_reserved_handle;
+		my_reserved_handle = -1;
+		return i;
+	}
+
+	if (my_first_handle < 0)
+		my_first_handle = MyProc->pgprocno * PGAIO_MAX_IN_FLIGHT;
+
+	while (my_num_in_flight >= PGAIO_MAX_IN_FLIGHT)
+		pgaio_process(true);
+
+	for (i = 0; i < PGAIO_MAX_IN_FLIGHT; i++)
+	{
+		if (pg_atomic_read_u32(&AioHandles[my_first_handle + i].state) ==
+			PGAIO_IDLE)
+			return my_first_handle + i;
+	}
+
+	elog(ERROR, "no free asynchronous I/O handle");
+	return -1;					/* keep compiler quiet */
+}
+
+/*
+ * Perform an I/O synchronously
+ */
+static void
+pgaio_execute(const PgAioRequest *req)
+{
+	SMgrRelation reln = smgropen(req->rnode.node, req->rnode.backend);
+
+	switch (req->op)
+	{
+		case PGAIO_OP_READV:
+			smgrreadv(reln, req->forknum, req->blocknum,
+					  (char **) req->pages, req->nblocks);
+			break;
+		case PGAIO_OP_WRITEV:
+			smgrwritev(reln, req->forknum, req->blocknum,
+					   (char **) req->pages, req->nblocks, req->skipFsync);
+			break;
+	}
+}
+
+/*
+ * Collect a completed I/O of this process: raise its error, or run its
+ * callback.
+ */
+static void
+pgaio_complete(int n)
+{
+	PgAioHandle *ioh = &AioHandles[n];
+	PgAioCallback callback = my_callbacks[n - my_first_handle];
+	PgAioRequest req;
+	bool		kernel_result;
+	int			result;
+	int			error_code;
+	char		error_msg[PGAIO_ERROR_MSG_LEN];
+
+	/* Read the results only after seeing the state set to done */
+	pg_read_barrier();
+
+	req = ioh->req;
+	kernel_result = ioh->kernel_result;
+	result = ioh->result;
+	error_code = ioh->error_code;
+	if (error_code != 0)
+		strlcpy(error_msg, ioh->error_msg, sizeof(error_msg));
+
+	pg_atomic_write_u32(&ioh->state, PGAIO_IDLE);
+	my_num_in_flight--;
+
+	if (error_code != 0)
+		ereport(ERROR,
+				(errcode(error_code),
+				 errmsg_internal("%s", error_msg)));
+
+	if (kernel_result)
+	{
+		SMgrRelation reln = smgropen(req.rnode.node, req.rnode.backend);
+		int			nbytes = result;
+
+		if (result < 0)
+		{
+			errno = -result;
+			nbytes = -1;
+		}
+
+		if (req.op == PGAIO_OP_READV)
+			smgrreadv_complete(reln, req.forknum, req.blocknum,
+							   req.pages, req.nblocks, nbytes);
+		else
+			smgrwrite_complete(reln, req.forknum, req.blocknum,
+							   req.nblocks, nbytes, req.skipFsync);
+	}
+
+	callback(&req);
+}
+
+/*
+ * Collect the completed I/Os of this process.  If wait is true, and none
+ * has completed, first wait for one to.
+ */
+static void
+pgaio_process(bool wait)
+{
+	for (;;)
+	{
+		bool		found = false;
+		int			i;
+
+#ifdef USE_LIBURING
+		if (io_method == IOMETHOD_IO_URING)
+			pgaio_uring_drain(false);
+#endif
+
+		for (i = 0; i < PGAIO_MAX_IN_FLIGHT; i++)
+		{
+			int			n = my_first_handle + i;
+
+			if (pg_atomic_read_u32(&AioHandles[n].state) == PGAIO_DONE)
+			{
+				pgaio_complete(n);
+				found = true;
+			}
+		}
+
+		if (found || !wait || my_num_in_flight == 0)
+			return;
+
+#ifdef USE_LIBURING
+		if (io_method == IOMETHOD_IO_URING)
+		{
+			pgaio_uring_drain(true);
+			continue;
+		}
+#endif
+		pgaio_worker_wait();
+	}
+}
+
+/*
+ * Queue an I/O for the workers.  Returns false if no workers are running.
+ */
+static bool
+pgaio_worker_submit(int n)
+{
+	Latch	   *latch = NULL;
+	int			i;
+
+	SpinLockAcquire(&AioCtl->lock);
+	if (AioCtl->nworkers == 0)
+	{
+		SpinLockRelease(&AioCtl->lock);
+		return false;
+	}
+
+	pg_atomic_write_u32(&AioHandles[n].state, PGAIO_QUEUED);
+	AioCtl->queue[(AioCtl->queue_head + AioCtl->queue_len) % AioNumHandles()] = n;
+	AioCtl->queue_len++;
+
+	/* Wake up the workers in turn */
+	for (i = 0; i < MAX_IO_WORKERS; i++)
+	{
+		int			w = (AioCtl->next_worker + i) % MAX_IO_WORKERS;
+
+		if (AioCtl->worker_latches[w] != NULL)
+		{
+			latch = AioCtl->worker_latches[w];
+			AioCtl->next_worker = w + 1;
+			break;
+		}
+	}
+	SpinLockRelease(&AioCtl->lock);
+
+	if (latch)
+		SetLatch(latch);
+
+	return true;
+}
+
+/*
+ * Wait for a worker to complete an I/O of this process.
+ */
+static void
+pgaio_worker_wait(void)
+{
+	/* If the workers have exited, perform our queued I/Os ourselves */
+	pgaio_worker_steal(false);
+
+	(void) WaitLatch(MyLatch,
+					 WL_LATCH_SET | WL_TIMEOUT | WL_EXIT_ON_PM_DEATH,
+					 10L, WAIT_EVENT_AIO_COMPLETION);
+	ResetLatch(MyLatch);
+
+	/*
+	 * The workers may be forwarding fsync requests for our writes to the
+	 * checkpointer, so it must not let the request queue fill up.
+	 */
+	if (AmCheckpointerProcess())
+		AbsorbSyncRequests();
+}
+
+/*
+ * Take this process's I/Os off the workers' queue: all of them if always is
+ * true, which leaves them idle, else only if no workers are running, in
+ * which case they are performed here.
+ */
+static void
+pgaio_worker_steal(bool always)
+{
+	int			stolen[PGAIO_MAX_IN_FLIGHT];
+	int			nstolen = 0;
+	int			i;
+	int			j;
+
+	SpinLockAcquire(&AioCtl->lock);
+	if (always || AioCtl->nworkers == 0)
+	{
+		int			len = AioCtl->queue_len;
+
+		/* Compact the queue, leaving out our entries */
+		AioCtl->queue_len = 0;
+		for (i = 0; i < len; i++)
+		{
+			int			n = AioCtl->queue[(AioCtl->queue_head + i) % AioNumHandles()];
+
+			if (n >= my_first_handle && n < my_first_handle + PGAIO_MAX_IN_FLIGHT)
+				stolen[nstolen++] = n;
+			else
+				AioCtl->queue[(AioCtl->queue_head + AioCtl->queue_len++) % AioNumHandles()] = n;
+		}
+		for (i = 0; i < nstolen; i++)
+			pg_atomic_write_u32(&AioHandles[stolen[i]].state,
+								always ? PGAIO_IDLE : PGAIO_IN_FLIGHT);
+	}
+	SpinLockRelease(&AioCtl->lock);
+
+	if (always)
+	{
+		my_num_in_flight -= nstolen;
+		return;
+	}
+
+	for (i = 0; i < nstolen; i++)
+	{
+		PgAioHandle *ioh = &AioHandles[stolen[i]];
+
+		/* If this fails, let pgaio_at_error() forget about the rest */
+		PG_TRY();
+		{
+			pgaio_execute(&ioh->req);
+		}
+		PG_CATCH();
+		{
+			for (j = i; j < nstolen; j++)
+				pg_atomic_write_u32(&AioHandles[stolen[j]].state, PGAIO_IDLE);
+			my_num_in_flight -= nstolen - i;
+			PG_RE_THROW();
+		}
+		PG_END_TRY();
+
+		pg_atomic_write_u32(&ioh->state, PGAIO_DONE);
+	}
+}
+
+/*
+ * AioWorkerRegister
+ *		Register the I/O workers, if io_method calls for them.
+ */
+void
+AioWorkerRegister(void)
+{
+	BackgroundWorker bgw;
+	int			i;
+
+	if (io_method != IOMETHOD_WORKER)
+		return;
+
+	for (i = 0; i < io_workers; i++)
+	{
+		memset(&bgw, 0, sizeof(bgw));
+		bgw.bgw_flags = BGWORKER_SHMEM_ACCESS;
+		bgw.bgw_start_time = BgWorkerStart_PostmasterStart;
+		snprintf(bgw.bgw_library_name, BGW_MAXLEN, "postgres");
+		snprintf(bgw.bgw_function_name, BGW_MAXLEN, "IoWorkerMain");
+		snprintf(bgw.bgw_name, BGW_MAXLEN, "io worker %d", i);
+		snprintf(bgw.bgw_type, BGW_MAXLEN, "io worker");
+		bgw.bgw_restart_time = 1;
+		bgw.bgw_notify_pid = 0;
+		bgw.bgw_main_arg = Int32GetDatum(i);
+
+		RegisterBackgroundWorker(&bgw);
+	}
+}
+
+/*
+ * Main entry point for an I/O worker process
+ */
+void
+IoWorkerMain(Datum main_arg)
+{
+	int			id = DatumGetInt32(main_arg);
+	MemoryContext worker_context;
+	bool		files_open = false;
+
+	pqsignal(SIGTERM, IoWorkerSigterm);
+	BackgroundWorkerUnblockSignals();
+
+	worker_context = AllocSetContextCreate(TopMemoryContext,
+										   "I/O worker",
+										   ALLOCSET_DEFAULT_SIZES);
+	MemoryContextSwitchTo(worker_context);
+
+	on_shmem_exit(IoWorkerExit, Int32GetDatum(id));
+
+	SpinLockAcquire(&AioCtl->lock);
+	AioCtl->worker_latches[id] = MyLatch;
+	AioCtl->nworkers++;
+	SpinLockRelease(&AioCtl->lock);
+
+	for (;;)
+	{
+		PgAioHandle *ioh;
+		int			n = -1;
+		int			owner;
+
+		ResetLatch(MyLatch);
+
+		SpinLockAcquire(&AioCtl->lock);
+		if (AioCtl->queue_len > 0)
+		{
+			n = AioCtl->queue[AioCtl->queue_head];
+			AioCtl->queue_head = (AioCtl->queue_head + 1) % AioNumHandles();
+			AioCtl->queue_len--;
+			pg_atomic_write_u32(&AioHandles[n].state, PGAIO_IN_FLIGHT);
+		}
+		else if (io_worker_shutdown_pending)
+		{
+			/*
+			 * Leave only when there's nothing left to do; from now on, I/Os
+			 * are performed synchronously if no workers are left.
+			 */
+			AioCtl->worker_latches[id] = NULL;
+			AioCtl->nworkers--;
+			SpinLockRelease(&AioCtl->lock);
+			proc_exit(0);
+		}
+		SpinLockRelease(&AioCtl->lock);
+
+		if (n < 0)
+		{
+			/* Don't keep files of dropped relations open while idle */
+			if (files_open)
+				smgrcloseall();
+			files_open = false;
+
+			(void) WaitLatch(MyLatch, WL_LATCH_SET | WL_EXIT_ON_PM_DEATH, -1L,
+							 WAIT_EVENT_IO_WORKER_MAIN);
+			continue;
+		}
+
+		ioh = &AioHandles[n];
+		io_worker_current = n;
+		files_open = true;
+
+		PG_TRY();
+		{
+			pgaio_execute(&ioh->req);
+		}
+		PG_CATCH();
+		{
+			ErrorData  *edata;
+
+			MemoryContextSwitchTo(worker_context);
+			edata = CopyErrorData();
+			FlushErrorState();
+			LWLockReleaseAll();
+
+			ioh->error_code = edata->sqlerrcode;
+			strlcpy(ioh->error_msg, edata->message, PGAIO_ERROR_MSG_LEN);
+			FreeErrorData(edata);
+			smgrcloseall();
+		}
+		PG_END_TRY();
+
+		io_worker_current = -1;
+
+		/* Let the owner see the result, and wake it up */
+		owner = n / PGAIO_MAX_IN_FLIGHT;
+		pg_write_barrier();
+		pg_atomic_write_u32(&ioh->state, PGAIO_DONE);
+		SetLatch(&ProcGlobal->allProcs[owner].procLatch);
+
+		MemoryContextReset(worker_context);
+	}
+}
+
+/*
+ * SIGTERM handler for I/O workers: exit once the queue is empty
+ */
+static void
+IoWorkerSigterm(SIGNAL_ARGS)
+{
+	int			save_errno = errno;
+
+	io_worker_shutdown_pending = true;
+	SetLatch(MyLatch);
+
+	errno = save_errno;
+}
+
+/*
+ * Make sure no process waits for an I/O worker that has exited
+ */
+static void
+IoWorkerExit(int code, Datum arg)
+{
+	int			id = DatumGetInt32(arg);
+
+	SpinLockAcquire(&AioCtl->lock);
+	if (AioCtl->worker_latches[id] != NULL)
+	{
+		AioCtl->worker_latches[id] = NULL;
+		AioCtl->nworkers--;
+	}
+	SpinLockRelease(&AioCtl->lock);
+
+	if (io_worker_current >= 0)
+	{
+		PgAioHandle *ioh = &AioHandles[io_worker_current];
+
+		ioh->error_code = ERRCODE_IO_ERROR;
+		strlcpy(ioh->error_msg, "I/O worker exited while performing an I/O",
+				PGAIO_ERROR_MSG_LEN);
+		pg_write_barrier();
+		pg_atomic_write_u32(&ioh->state, PGAIO_DONE);
+		SetLatch(&ProcGlobal->allProcs[io_worker_current / PGAIO_MAX_IN_FLIGHT].procLatch);
+	}
+}
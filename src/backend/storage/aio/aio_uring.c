@@ -0,0 +1,161 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio_uring.c
+ *	  Asynchronous I/O with io_uring.
+ *
+ * Each process submits its I/Os to an io_uring ring of its own, created
+ * when it first needs one.  The kernel performs them directly on the
+ * data files, so only the checks and bookkeeping that md.c does after a
+ * read or write are left for the process to do when it collects them; see
+ * mdreadv_complete() and mdwrite_complete().
+ *
+ * I/Os that md.c cannot hand over this way are performed synchronously:
+ * those that cross a segment boundary, and writes including pages that
+ * md.c would store compressed.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/aio/aio_uring.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LIBURING
+
+#include <liburing.h>
+#include <sys/uio.h>
+
+#include "storage/aio_internal.h"
+#include "storage/bufpage.h"
+#include "storage/smgr.h"
+
+static struct io_uring pgaio_uring;
+static bool pgaio_uring_initialized = false;
+
+/* The iovecs must stay valid until the kernel has consumed them */
+static struct iovec pgaio_uring_iovecs[PGAIO_MAX_IN_FLIGHT][PGAIO_MAX_BLOCKS];
+
+/*
+ * Submit an I/O to the kernel.  Returns false if it must be performed
+ * synchronously instead.
+ */
+bool
+pgaio_uring_submit(PgAioHandle *ioh, int n)
+{
+	PgAioRequest *req = &ioh->req;
+	SMgrRelation reln;
+	struct io_uring_sqe *sqe;
+	struct iovec *iov;
+	BlockNumber segblocks;
+	off_t		off;
+	int			fd;
+	int			slot = n % PGAIO_MAX_IN_FLIGHT;
+	int			ret;
+	int			i;
+
+	if (req->op == PGAIO_OP_WRITEV)
+	{
+		for (i = 0; i < req->nblocks; i++)
+			if (PageIsCompressible((Page) req->pages[i]))
+				return false;
+	}
+
+	if (!pgaio_uring_initialized)
+	{
+		ret = io_uring_queue_init(PGAIO_MAX_IN_FLIGHT, &pgaio_uring, 0);
+		if (ret < 0)
+			ereport(ERROR,
+					(errcode(ERRCODE_INSUFFICIENT_RESOURCES),
+					 errmsg("could not set up io_uring: %s", strerror(-ret))));
+		pgaio_uring_initialized = true;
+	}
+
+	reln = smgropen(req->rnode.node, req->rnode.backend);
+	fd = smgrfd(reln, req->forknum, req->blocknum, &off, &segblocks);
+	if (segblocks < (BlockNumber) req->nblocks)
+		return false;
+
+	sqe = io_uring_get_sqe(&pgaio_uring);
+	if (sqe == NULL)
+		return false;
+
+	iov = pgaio_uring_iovecs[slot];
+	for (i = 0; i < req->nblocks; i++)
+	{
+		iov[i].iov_base = req->pages[i];
+		iov[i].iov_len = BLCKSZ;
+	}
+	if (req->op == PGAIO_OP_READV)
+		io_uring_prep_readv(sqe, fd, iov, req->nblocks, off);
+	else
+		io_uring_prep_writev(sqe, fd, iov, req->nblocks, off);
+
+	io_uring_sqe_set_data(sqe, (void *) (intptr_t) n);
+
+	do
+	{
+		ret = io_uring_submit(&pgaio_uring);
+	} while (ret == -EINTR);
+	if (ret < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not submit I/O to io_uring: %s", strerror(-ret))));
+
+	/*
+	 * Only now is the I/O in flight; pgaio_at_error() waits for those.  No
+	 * completion can be collected before, as only this process drains the
+	 * ring.
+	 */
+	ioh->kernel_result = true;
+	pg_atomic_write_u32(&ioh->state, PGAIO_IN_FLIGHT);
+
+	return true;
+}
+
+/*
+ * Mark the I/Os the kernel has completed as done.  If wait is true, wait
+ * for at least one to complete first.
+ */
+void
+pgaio_uring_drain(bool wait)
+{
+	struct io_uring_cqe *cqe;
+	int			ret;
+
+	if (!pgaio_uring_initialized)
+		return;
+
+	for (;;)
+	{
+		PgAioHandle *ioh;
+
+		if (wait)
+			ret = io_uring_wait_cqe(&pgaio_uring, &cqe);
+		else
+			ret = io_uring_peek_cqe(&pgaio_uring, &cqe);
+
+		if (ret == -EINTR)
+			continue;
+		if (ret == -EAGAIN)
+			break;
+		if (ret < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not get I/O completion from io_uring: %s",
+							strerror(-ret))));
+
+		ioh = &AioHandles[(intptr_t) io_uring_cqe_get_data(cqe)];
+		ioh->result = cqe->res;
+		pg_atomic_write_u32(&ioh->state, PGAIO_DONE);
+		io_uring_cqe_seen(&pgaio_uring, cqe);
+
+		/* Having waited for one, collect the rest without waiting */
+		wait = false;
+	}
+}
+
+#endif							/* USE_LIBURING */
@@ -16,6 +16,7 @@
 
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/pg_shmem.h"
 
 BufferDescPadded *BufferDescriptors;
 char	   *BufferBlocks;
@@ -108,6 +109,29 @@ InitBufferPool(void)
 	{
 		int			i;
 
+		/*
+		 * With shared_memory_numa = partition, give each NUMA node an equal
+		 * share of the buffers, with their headers and pages allocated on
+		 * it.  The clock sweep partitions follow the same division, see
+		 * StrategyInitialize().  This must be done before the memory is first
+		 * touched.
+		 */
+		if (shared_memory_numa == SHMEM_NUMA_PARTITION && ShmemNumaNodes() > 1)
+		{
+			int			nnodes = ShmemNumaNodes();
+
+			for (i = 0; i < nnodes; i++)
+			{
+				int			first = (int) ((int64) NBuffers * i / nnodes);
+				int			nbuffers = (int) ((int64) NBuffers * (i + 1) / nnodes) - first;
+
+				ShmemNumaBind(GetBufferDescriptor(first),
+							  nbuffers * sizeof(BufferDescPadded), i);
+				ShmemNumaBind(BufferBlocks + first * (Size) BLCKSZ,
+							  nbuffers * (Size) BLCKSZ, i);
+			}
+		}
+
 		/*
 		 * Initialize all the buffer headers.
 		 */
@@ -7,7 +7,8 @@
  * must hold a suitable lock on the appropriate BufMappingLock, as specified
  * in the comments.  We can't do the locking inside these functions because
  * in most cases the caller needs to adjust the buffer header contents
- * before the lock is released (see notes in README).
+ * before the lock is released (see notes in README).  The exception is
+ * BufTableLookupOptimistic(), for which the caller holds no lock at all.
  *
  *
  * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
@@ -21,8 +22,10 @@
  */
 #include "postgres.h"
 
+#include "port/atomics.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/shmem.h"
 
 /* entry for buffer lookup hashtable */
 typedef struct
@@ -33,6 +36,24 @@ typedef struct
 
 static HTAB *SharedBufHash;
 
+/*
+ * Change counters for optimistic lookups, one per buffer mapping partition,
+ * each in a cache line of its own.  Insertions and deletions advance the
+ * partition's counter before and after changing the hashtable, so it is odd
+ * while a change is in progress, and a lookup that sees the same even value
+ * before and after it knows that no change overlapped it.
+ */
+typedef union BufTableChangeCount
+{
+	pg_atomic_uint32 count;
+	char		pad[PG_CACHE_LINE_SIZE];
+} BufTableChangeCount;
+
+static BufTableChangeCount *BufTableChangeCounts;
+
+#define BufTableChangeCounter(hashcode) \
+	(&BufTableChangeCounts[BufTableHashPartition(hashcode)].count)
+
 
 /*
  * Estimate space needed for mapping hashtable
@@ -41,7 +62,9 @@ static HTAB *SharedBufHash;
 Size
 BufTableShmemSize(int size)
 {
-	return hash_estimate_size(size, sizeof(BufferLookupEnt));
+	return add_size(hash_estimate_size(size, sizeof(BufferLookupEnt)),
+					mul_size(NUM_BUFFER_PARTITIONS,
+							 sizeof(BufTableChangeCount)));
 }
 
 /*
@@ -52,6 +75,8 @@ void
 InitBufTable(int size)
 {
 	HASHCTL		info;
+	bool		found;
+	int			i;
 
 	/* assume no locking is needed yet */
 
@@ -64,6 +89,16 @@ InitBufTable(int size)
 								  size, size,
 								  &info,
 								  HASH_ELEM | HASH_BLOBS | HASH_PARTITION);
+
+	BufTableChangeCounts = (BufTableChangeCount *)
+		ShmemInitStruct("Shared Buffer Lookup Change Counts",
+						NUM_BUFFER_PARTITIONS * sizeof(BufTableChangeCount),
+						&found);
+	if (!found)
+	{
+		for (i = 0; i < NUM_BUFFER_PARTITIONS; i++)
+			pg_atomic_init_u32(&BufTableChangeCounts[i].count, 0);
+	}
 }
 
 /*
@@ -105,6 +140,47 @@ BufTableLookup(BufferTag *tagPtr, uint32 hashcode)
 	return result->id;
 }
 
+/*
+ * BufTableLookupOptimistic
+ *		Lookup the given BufferTag without locking; return buffer ID, or -1
+ *		if not found
+ *
+ * The result is only a hint: by the time the caller looks at the buffer it
+ * may hold another page.  The caller must pin the buffer, and then check its
+ * tag, as the tag can't change while it's pinned.  -1 is also returned if
+ * the hashtable was changed during the lookup, so the caller must repeat the
+ * lookup with the lock before concluding the page is not in the pool.
+ *
+ * Caller need not hold any lock.
+ */
+int
+BufTableLookupOptimistic(BufferTag *tagPtr, uint32 hashcode)
+{
+	pg_atomic_uint32 *counter = BufTableChangeCounter(hashcode);
+	BufferLookupEnt *result;
+	uint32		count;
+	int			id;
+
+	count = pg_atomic_read_u32(counter);
+	if (count & 1)
+		return -1;				/* change in progress */
+
+	pg_read_barrier();
+
+	result = (BufferLookupEnt *)
+		hash_search_optimistic(SharedBufHash, (void *) tagPtr, hashcode);
+	if (!result)
+		return -1;
+	id = *((volatile int *) &result->id);
+
+	pg_read_barrier();
+
+	if (pg_atomic_read_u32(counter) != count || id < 0 || id >= NBuffers)
+		return -1;
+
+	return id;
+}
+
 /*
  * BufTableInsert
  *		Insert a hashtable entry for given tag and buffer ID,
@@ -124,6 +200,9 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 	Assert(buf_id >= 0);		/* -1 is reserved for not-in-table */
 	Assert(tagPtr->blockNum != P_NEW);	/* invalid tag */
 
+	/* Tell optimistic lookups that the hashtable is changing */
+	pg_atomic_fetch_add_u32(BufTableChangeCounter(hashcode), 1);
+
 	result = (BufferLookupEnt *)
 		hash_search_with_hash_value(SharedBufHash,
 									(void *) tagPtr,
@@ -131,11 +210,14 @@ BufTableInsert(BufferTag *tagPtr, uint32 hashcode, int buf_id)
 									HASH_ENTER,
 									&found);
 
+	if (!found)
+		result->id = buf_id;
+
+	pg_atomic_fetch_add_u32(BufTableChangeCounter(hashcode), 1);
+
 	if (found)					/* found something already in the table */
 		return result->id;
 
-	result->id = buf_id;
-
 	return -1;
 }
 
@@ -150,6 +232,9 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 {
 	BufferLookupEnt *result;
 
+	/* Tell optimistic lookups that the hashtable is changing */
+	pg_atomic_fetch_add_u32(BufTableChangeCounter(hashcode), 1);
+
 	result = (BufferLookupEnt *)
 		hash_search_with_hash_value(SharedBufHash,
 									(void *) tagPtr,
@@ -157,6 +242,8 @@ BufTableDelete(BufferTag *tagPtr, uint32 hashcode)
 									HASH_REMOVE,
 									NULL);
 
+	pg_atomic_fetch_add_u32(BufTableChangeCounter(hashcode), 1);
+
 	if (!result)				/* shouldn't happen */
 		elog(ERROR, "shared buffer hash table corrupted");
 }
@@ -43,6 +43,7 @@
 #include "pg_trace.h"
 #include "pgstat.h"
 #include "postmaster/bgwriter.h"
+#include "storage/aio.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
 #include "storage/ipc.h"
@@ -50,6 +51,7 @@
 #include "storage/smgr.h"
 #include "storage/standby.h"
 #include "utils/memdebug.h"
+#include "utils/memutils.h"
 #include "utils/ps_status.h"
 #include "utils/rel.h"
 #include "utils/resowner_private.h"
@@ -149,9 +151,25 @@ int			checkpoint_flush_after = 0;
 int			bgwriter_flush_after = 0;
 int			backend_flush_after = 0;
 
-/* local state for StartBufferIO and related functions */
-static BufferDesc *InProgressBuf = NULL;
-static bool IsForInput;
+/* maximum number of adjacent blocks the checkpointer writes at once */
+int			checkpoint_combine_limit = MAX_BUFFERS_PER_WRITE;
+
+/*
+ * local state for StartBufferIO and related functions.  A backend has at
+ * most one I/O in progress, except while ReadBuffersRange() reads runs of
+ * blocks, or while the checkpointer writes runs of blocks, or while the
+ * checkpointer or background writer has asynchronous writes in flight.
+ * Each in-progress buffer holds its io_in_progress lock, so there can't be
+ * too many of them.
+ */
+#define MAX_BUFFERS_IN_PROGRESS 64
+
+static BufferDesc *InProgressBufs[MAX_BUFFERS_IN_PROGRESS];
+static bool IsForInput[MAX_BUFFERS_IN_PROGRESS];
+static int	NumInProgressBufs = 0;
+
+/* writeback context of the writes started by FlushBufferRun */
+static WritebackContext *FlushWritebackContext = NULL;
 
 /* local state for LockBufferForCleanup */
 static BufferDesc *PinCountWaitBuf = NULL;
@@ -460,8 +478,10 @@ static void BufferSync(int flags);
 static uint32 WaitBufHdrUnlocked(BufferDesc *buf);
 static int	SyncOneBuffer(int buf_id, bool skip_recently_used,
 						  WritebackContext *wb_context);
+static int	SyncBufferRun(const CkptSortItem *items, int nitems,
+						  WritebackContext *wb_context, int *nwritten);
 static void WaitIO(BufferDesc *buf);
-static bool StartBufferIO(BufferDesc *buf, bool forInput);
+static bool StartBufferIO(BufferDesc *buf, bool forInput, bool nowait);
 static void TerminateBufferIO(BufferDesc *buf, bool clear_dirty,
 							  uint32 set_flag_bits);
 static void shared_buffer_write_error_callback(void *arg);
@@ -471,8 +491,16 @@ static BufferDesc *BufferAlloc(SMgrRelation smgr,
 							   ForkNumber forkNum,
 							   BlockNumber blockNum,
 							   BufferAccessStrategy strategy,
-							   bool *foundPtr);
+							   bool *foundPtr, bool nowait);
+static void ReadBuffersWait(void);
+static void ReadBuffersRunComplete(const PgAioRequest *req);
+static void ReadBuffersRun(SMgrRelation smgr, ForkNumber forkNum,
+						   BlockNumber blockNum, BufferDesc **bufs, int nbufs);
 static void FlushBuffer(BufferDesc *buf, SMgrRelation reln);
+static int	FlushBufferRun(BufferDesc **bufs, int nbufs,
+						   WritebackContext *wb_context);
+static void FlushBufferRunComplete(const PgAioRequest *req);
+static void FlushBufferDone(BufferDesc *buf);
 static void AtProcExit_Buffers(int code, Datum arg);
 static void CheckForBufferLeaks(void);
 static int	rnode_comparator(const void *p1, const void *p2);
@@ -681,6 +709,219 @@ ReadBufferExtended(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
 	return buf;
 }
 
+/*
+ * ReadBuffersRange -- pin a range of consecutive blocks of a relation
+ *
+ * Like calling ReadBufferExtended() in RBM_NORMAL mode for blocks blockNum,
+ * blockNum + 1, ... in turn, except that runs of blocks that are not in the
+ * buffer pool are read with a single vectored read instead of one read
+ * each.  The reads are started asynchronously, so with an io_method other
+ * than sync, several runs can be read at once.  Used by sequential scans and
+ * VACUUM, which read whole relations.
+ *
+ * At most nblocks buffers are pinned and stored in buffers[]; possibly
+ * fewer, to limit the number of pins a backend holds.  Returns the number
+ * of buffers pinned, which is always at least one.  The caller must release
+ * each of them.
+ */
+int
+ReadBuffersRange(Relation reln, ForkNumber forkNum, BlockNumber blockNum,
+				 int nblocks, BufferAccessStrategy strategy, Buffer *buffers)
+{
+	BufferDesc *run[MAX_BUFFERS_PER_READ];
+	int			nrun = 0;
+	int			i;
+
+	Assert(nblocks > 0);
+
+	/* Open it at the smgr level if not already done */
+	RelationOpenSmgr(reln);
+
+	/* See ReadBufferExtended */
+	if (RELATION_IS_OTHER_TEMP(reln))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("cannot access temporary tables of other sessions")));
+
+	/*
+	 * Don't let a backend pin more than its fair share of shared buffers,
+	 * lest concurrent scans run out of unpinned buffers.
+	 */
+	nblocks = Min(nblocks, MAX_BUFFERS_PER_READ);
+	nblocks = Min(nblocks, Max(NBuffers / MaxBackends, 1));
+
+	/* Local buffers are cheap to read one at a time */
+	if (SmgrIsTemp(reln->rd_smgr) || nblocks == 1)
+	{
+		for (i = 0; i < nblocks; i++)
+			buffers[i] = ReadBufferExtended(reln, forkNum, blockNum + i,
+											RBM_NORMAL, strategy);
+		return nblocks;
+	}
+
+	for (i = 0; i < nblocks; i++)
+	{
+		BufferDesc *bufHdr;
+		bool		found;
+
+		/* Make sure we will have room to remember the buffer pin */
+		ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+
+		/*
+		 * While we have I/Os in progress, don't wait for anyone else's; they
+		 * might be waiting for ours.
+		 */
+		bufHdr = BufferAlloc(reln->rd_smgr, reln->rd_rel->relpersistence,
+							 forkNum, blockNum + i, strategy, &found,
+							 NumInProgressBufs > 0);
+
+		if (bufHdr == NULL || found)
+		{
+			/* This block breaks the run; read what we have so far */
+			if (nrun > 0)
+				ReadBuffersRun(reln->rd_smgr, forkNum, blockNum + i - nrun,
+							   run, nrun);
+			nrun = 0;
+
+			/*
+			 * Someone else is reading the block; wait for them as usual, once
+			 * our own reads are done.
+			 */
+			if (bufHdr == NULL)
+			{
+				ReadBuffersWait();
+				buffers[i] = ReadBufferExtended(reln, forkNum, blockNum + i,
+												RBM_NORMAL, strategy);
+				continue;
+			}
+
+			pgBufferUsage.shared_blks_hit++;
+			VacuumPageHit++;
+			if (VacuumCostActive)
+				VacuumCostBalance += VacuumCostPageHit;
+			pgstat_count_buffer_hit(reln);
+		}
+		else
+			run[nrun++] = bufHdr;
+
+		pgstat_count_buffer_read(reln);
+		buffers[i] = BufferDescriptorGetBuffer(bufHdr);
+	}
+
+	if (nrun > 0)
+		ReadBuffersRun(reln->rd_smgr, forkNum, blockNum + nblocks - nrun,
+					   run, nrun);
+
+	ReadBuffersWait();
+
+	return nblocks;
+}
+
+/*
+ * ReadBuffersRun -- subroutine for ReadBuffersRange.  Starts reading a run
+ *		of consecutive blocks, starting at blockNum, into buffers that we
+ *		have started input I/O on.  ReadBuffersRunComplete marks them
+ *		valid once the read is done.
+ */
+static void
+ReadBuffersRun(SMgrRelation smgr, ForkNumber forkNum, BlockNumber blockNum,
+			   BufferDesc **bufs, int nbufs)
+{
+	char	   *pages[MAX_BUFFERS_PER_READ];
+	int			buf_ids[MAX_BUFFERS_PER_READ];
+	instr_time	io_start,
+				io_time;
+	int			i;
+
+	for (i = 0; i < nbufs; i++)
+	{
+		pages[i] = (char *) BufHdrGetBlock(bufs[i]);
+		buf_ids[i] = bufs[i]->buf_id;
+	}
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+
+	pgaio_start_readv(smgr, forkNum, blockNum, pages, nbufs, buf_ids,
+					  ReadBuffersRunComplete);
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_SUBTRACT(io_time, io_start);
+		pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
+		INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
+	}
+}
+
+/*
+ * ReadBuffersWait -- subroutine for ReadBuffersRange.  Waits for the reads
+ *		started by ReadBuffersRun to complete.
+ */
+static void
+ReadBuffersWait(void)
+{
+	instr_time	io_start,
+				io_time;
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+
+	pgaio_wait_all();
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_SUBTRACT(io_time, io_start);
+		pgstat_count_buffer_read_time(INSTR_TIME_GET_MICROSEC(io_time));
+		INSTR_TIME_ADD(pgBufferUsage.blk_read_time, io_time);
+	}
+}
+
+/*
+ * ReadBuffersRunComplete -- completion callback of the reads started by
+ *		ReadBuffersRun.  Checks the pages and marks the buffers valid.
+ */
+static void
+ReadBuffersRunComplete(const PgAioRequest *req)
+{
+	int			i;
+
+	for (i = 0; i < req->nblocks; i++)
+	{
+		BufferDesc *buf = GetBufferDescriptor(req->cb_data[i]);
+		char	   *page = req->pages[i];
+
+		/* check for garbage data, as in ReadBuffer_common */
+		if (!PageIsVerified((Page) page, req->blocknum + i))
+		{
+			if (zero_damaged_pages)
+			{
+				ereport(WARNING,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("invalid page in block %u of relation %s; zeroing out page",
+								req->blocknum + i,
+								relpath(req->rnode, req->forknum))));
+				MemSet(page, 0, BLCKSZ);
+			}
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("invalid page in block %u of relation %s",
+								req->blocknum + i,
+								relpath(req->rnode, req->forknum))));
+		}
+
+		/* Set BM_VALID, terminate IO, and wake up any waiters */
+		TerminateBufferIO(buf, false, BM_VALID);
+
+		pgBufferUsage.shared_blks_read++;
+		VacuumPageMiss++;
+		if (VacuumCostActive)
+			VacuumCostBalance += VacuumCostPageMiss;
+	}
+}
+
 
 /*
  * ReadBufferWithoutRelcache -- like ReadBufferExtended, but doesn't require
@@ -759,7 +1000,7 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 		 * not currently in memory.
 		 */
 		bufHdr = BufferAlloc(smgr, relpersistence, forkNum, blockNum,
-							 strategy, &found);
+							 strategy, &found, false);
 		if (found)
 			pgBufferUsage.shared_blks_hit++;
 		else if (isExtend)
@@ -856,7 +1097,7 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				Assert(buf_state & BM_VALID);
 				buf_state &= ~BM_VALID;
 				UnlockBufHdr(bufHdr, buf_state);
-			} while (!StartBufferIO(bufHdr, true));
+			} while (!StartBufferIO(bufHdr, true, false));
 		}
 	}
 
@@ -1000,13 +1241,16 @@ ReadBuffer_common(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
  * *foundPtr is actually redundant with the buffer's BM_VALID flag, but
  * we keep it for simplicity in ReadBuffer.
  *
+ * If nowait is true and another backend is reading in the page, returns
+ * NULL instead of waiting for it, without holding a pin.
+ *
  * No locks are held either at entry or exit.
  */
 static BufferDesc *
 BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			BlockNumber blockNum,
 			BufferAccessStrategy strategy,
-			bool *foundPtr)
+			bool *foundPtr, bool nowait)
 {
 	BufferTag	newTag;			/* identity of requested block */
 	uint32		newHash;		/* hash value for newTag */
@@ -1027,23 +1271,55 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	newHash = BufTableHashCode(&newTag);
 	newPartitionLock = BufMappingPartitionLock(newHash);
 
-	/* see if the block is in the buffer pool already */
-	LWLockAcquire(newPartitionLock, LW_SHARED);
-	buf_id = BufTableLookup(&newTag, newHash);
+	/*
+	 * See if the block is in the buffer pool already, first without taking
+	 * the mapping lock.  Such a lookup can find a buffer that is being given
+	 * another page at the same time, but once we have pinned it that can no
+	 * longer happen, so it's ours if it still has our tag then.
+	 */
+	buf_id = BufTableLookupOptimistic(&newTag, newHash);
 	if (buf_id >= 0)
 	{
-		/*
-		 * Found it.  Now, pin the buffer so no one can steal it from the
-		 * buffer pool, and check to see if the correct data has been loaded
-		 * into the buffer.
-		 */
 		buf = GetBufferDescriptor(buf_id);
 
 		valid = PinBuffer(buf, strategy);
 
-		/* Can release the mapping lock as soon as we've pinned it */
+		if (!BUFFERTAGS_EQUAL(buf->tag, newTag))
+		{
+			UnpinBuffer(buf, true);
+			buf_id = -1;
+		}
+	}
+
+	if (buf_id < 0)
+	{
+		LWLockAcquire(newPartitionLock, LW_SHARED);
+		buf_id = BufTableLookup(&newTag, newHash);
+		if (buf_id >= 0)
+		{
+			/*
+			 * Found it.  Now, pin the buffer so no one can steal it from the
+			 * buffer pool.
+			 */
+			buf = GetBufferDescriptor(buf_id);
+
+			valid = PinBuffer(buf, strategy);
+		}
+
+		/*
+		 * Can release the mapping lock as soon as we've pinned it.  If we
+		 * didn't find it, we'll initialize a new buffer, and must not hold
+		 * the mapping lock while doing the work.
+		 */
 		LWLockRelease(newPartitionLock);
+	}
 
+	if (buf_id >= 0)
+	{
+		/*
+		 * Found it, and pinned it.  Check to see if the correct data has
+		 * been loaded into the buffer.
+		 */
 		*foundPtr = true;
 
 		if (!valid)
@@ -1055,7 +1331,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 			 * own read attempt if the page is still not BM_VALID.
 			 * StartBufferIO does it all.
 			 */
-			if (StartBufferIO(buf, true))
+			if (StartBufferIO(buf, true, nowait))
 			{
 				/*
 				 * If we get here, previous attempts to read the buffer must
@@ -1063,6 +1339,12 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				 */
 				*foundPtr = false;
 			}
+			else if (nowait &&
+					 !(pg_atomic_read_u32(&buf->state) & BM_VALID))
+			{
+				UnpinBuffer(buf, true);
+				return NULL;
+			}
 		}
 
 		return buf;
@@ -1070,9 +1352,8 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 
 	/*
 	 * Didn't find it in the buffer pool.  We'll have to initialize a new
-	 * buffer.  Remember to unlock the mapping lock while doing the work.
+	 * buffer.
 	 */
-	LWLockRelease(newPartitionLock);
 
 	/* Loop here in case we have to try another victim buffer */
 	for (;;)
@@ -1267,7 +1548,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 				 * then set up our own read attempt if the page is still not
 				 * BM_VALID.  StartBufferIO does it all.
 				 */
-				if (StartBufferIO(buf, true))
+				if (StartBufferIO(buf, true, nowait))
 				{
 					/*
 					 * If we get here, previous attempts to read the buffer
@@ -1275,6 +1556,12 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 					 */
 					*foundPtr = false;
 				}
+				else if (nowait &&
+						 !(pg_atomic_read_u32(&buf->state) & BM_VALID))
+				{
+					UnpinBuffer(buf, true);
+					return NULL;
+				}
 			}
 
 			return buf;
@@ -1342,7 +1629,7 @@ BufferAlloc(SMgrRelation smgr, char relpersistence, ForkNumber forkNum,
 	 * lock.  If StartBufferIO returns false, then someone else managed to
 	 * read it before we did, so there's nothing left for BufferAlloc() to do.
 	 */
-	if (StartBufferIO(buf, true))
+	if (StartBufferIO(buf, true, false))
 		*foundPtr = false;
 	else
 		*foundPtr = true;
@@ -2017,46 +2304,38 @@ BufferSync(int flags)
 	num_written = 0;
 	while (!binaryheap_empty(ts_heap))
 	{
-		BufferDesc *bufHdr = NULL;
 		CkptTsStatus *ts_stat = (CkptTsStatus *)
 		DatumGetPointer(binaryheap_first(ts_heap));
+		int			nprocessed;
+		int			nwritten;
 
-		buf_id = CkptBufferIds[ts_stat->index].buf_id;
-		Assert(buf_id != -1);
-
-		bufHdr = GetBufferDescriptor(buf_id);
-
-		num_processed++;
+		Assert(CkptBufferIds[ts_stat->index].buf_id != -1);
 
 		/*
-		 * We don't need to acquire the lock here, because we're only looking
-		 * at a single bit. It's possible that someone else writes the buffer
-		 * and clears the flag right after we check, but that doesn't matter
-		 * since SyncOneBuffer will then do nothing.  However, there is a
-		 * further race condition: it's conceivable that between the time we
-		 * examine the bit here and the time SyncOneBuffer acquires the lock,
-		 * someone else not only wrote the buffer but replaced it with another
-		 * page and dirtied it.  In that improbable case, SyncOneBuffer will
-		 * write the buffer though we didn't need to.  It doesn't seem worth
-		 * guarding against this, though.
+		 * Write the next buffer of the tablespace, together with those after
+		 * it that hold the following blocks of the same relation fork.  The
+		 * sort order makes such runs consecutive in CkptBufferIds.
 		 */
-		if (pg_atomic_read_u32(&bufHdr->state) & BM_CHECKPOINT_NEEDED)
-		{
-			if (SyncOneBuffer(buf_id, false, &wb_context) & BUF_WRITTEN)
-			{
-				TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(buf_id);
-				BgWriterStats.m_buf_written_checkpoints++;
-				num_written++;
-			}
-		}
+		nprocessed = SyncBufferRun(&CkptBufferIds[ts_stat->index],
+								   ts_stat->num_to_scan - ts_stat->num_scanned,
+								   &wb_context, &nwritten);
+
+		for (i = 0; i < nwritten; i++)
+			TRACE_POSTGRESQL_BUFFER_SYNC_WRITTEN(CkptBufferIds[ts_stat->index + i].buf_id);
+		BgWriterStats.m_buf_written_checkpoints += nwritten;
+		num_written += nwritten;
+
+		/* Release the buffers whose writes have completed */
+		pgaio_reap();
 
 		/*
 		 * Measure progress independent of actually having to flush the buffer
 		 * - otherwise writing become unbalanced.
 		 */
-		ts_stat->progress += ts_stat->progress_slice;
-		ts_stat->num_scanned++;
-		ts_stat->index++;
+		num_processed += nprocessed;
+		ts_stat->progress += ts_stat->progress_slice * nprocessed;
+		ts_stat->num_scanned += nprocessed;
+		ts_stat->index += nprocessed;
 
 		/* Have all the buffers from the tablespace been processed? */
 		if (ts_stat->num_scanned == ts_stat->num_to_scan)
@@ -2077,7 +2356,8 @@ BufferSync(int flags)
 		CheckpointWriteDelay(flags, (double) num_processed / num_to_scan);
 	}
 
-	/* issue all pending flushes */
+	/* wait for the writes still in flight, then issue all pending flushes */
+	pgaio_wait_all();
 	IssuePendingWritebacks(&wb_context);
 
 	pfree(per_ts_stat);
@@ -2093,39 +2373,112 @@ BufferSync(int flags)
 	TRACE_POSTGRESQL_BUFFER_SYNC_DONE(NBuffers, num_written, num_to_scan);
 }
 
+/*
+ * State of the LRU scan ahead of one clock sweep partition's hand, saved
+ * between calls of BgBufferSync so we can determine the strategy point's
+ * advance rate and avoid scanning already-cleaned buffers.  Buffer indexes
+ * are relative to the first buffer of the partition.
+ */
+typedef struct BgSyncPartition
+{
+	bool		saved_info_valid;
+	int			prev_strategy_buf_id;
+	uint32		prev_strategy_passes;
+	int			next_to_clean;
+	uint32		next_passes;
+
+	/* Moving averages of allocation rate and clean-buffer density */
+	float		smoothed_alloc;
+	float		smoothed_density;
+} BgSyncPartition;
+
+static BgSyncPartition BgSyncPartitions[MAX_CLOCK_PARTITIONS];
+static bool BgSyncPartitionsInitialized = false;
+
+/* Partition the next call of BgBufferSync starts with */
+static int	BgSyncNextPartition = 0;
+
+static bool BgBufferSyncPartition(int partition, BgSyncPartition *state,
+								  int *num_written, WritebackContext *wb_context);
+
 /*
  * BgBufferSync -- Write out some dirty buffers in the pool.
  *
  * This is called periodically by the background writer process.
  *
+ * Each clock sweep partition has a strategy point of its own (see
+ * freelist.c), so we scan ahead of each of them separately, sharing the
+ * bgwriter_lru_maxpages limit between them.  We start with a different
+ * partition each time, so that none of them is starved when the limit is
+ * reached.
+ *
  * Returns true if it's appropriate for the bgwriter process to go into
  * low-power hibernation mode.  (This happens if the strategy clock sweep
- * has been "lapped" and no buffer allocations have occurred recently,
- * or if the bgwriter has been effectively disabled by setting
- * bgwriter_lru_maxpages to 0.)
+ * has been "lapped" and no buffer allocations have occurred recently in
+ * every partition, or if the bgwriter has been effectively disabled by
+ * setting bgwriter_lru_maxpages to 0.)
  */
 bool
 BgBufferSync(WritebackContext *wb_context)
+{
+	int			npartitions = StrategySyncPartitions();
+	int			num_written = 0;
+	bool		can_hibernate = true;
+	int			i;
+
+	if (!BgSyncPartitionsInitialized)
+	{
+		for (i = 0; i < MAX_CLOCK_PARTITIONS; i++)
+		{
+			BgSyncPartitions[i].saved_info_valid = false;
+			BgSyncPartitions[i].smoothed_alloc = 0;
+			BgSyncPartitions[i].smoothed_density = 10.0;
+		}
+		BgSyncPartitionsInitialized = true;
+	}
+
+	/* Make sure we can handle the pin inside SyncOneBuffer */
+	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+
+	for (i = 0; i < npartitions; i++)
+	{
+		int			partition = (BgSyncNextPartition + i) % npartitions;
+
+		if (!BgBufferSyncPartition(partition, &BgSyncPartitions[partition],
+								   &num_written, wb_context))
+			can_hibernate = false;
+	}
+	BgSyncNextPartition = (BgSyncNextPartition + 1) % npartitions;
+
+	if (bgwriter_lru_maxpages > 0 && num_written >= bgwriter_lru_maxpages)
+		BgWriterStats.m_maxwritten_clean++;
+
+	/* Finish the writes before the buffers are counted on to be clean */
+	pgaio_wait_all();
+
+	BgWriterStats.m_buf_written_clean += num_written;
+
+	return can_hibernate;
+}
+
+/*
+ * BgBufferSyncPartition -- LRU scan of BgBufferSync for one partition.
+ *
+ * *num_written is the number of buffers written so far by this round of
+ * BgBufferSync; we add the ones we write to it, and stop once it reaches
+ * bgwriter_lru_maxpages.  Returns true if the partition allows hibernating.
+ */
+static bool
+BgBufferSyncPartition(int partition, BgSyncPartition *state,
+					  int *num_written, WritebackContext *wb_context)
 {
 	/* info obtained from freelist.c */
+	int			first_buffer;
+	int			num_buffers;
 	int			strategy_buf_id;
 	uint32		strategy_passes;
 	uint32		recent_alloc;
 
-	/*
-	 * Information saved between calls so we can determine the strategy
-	 * point's advance rate and avoid scanning already-cleaned buffers.
-	 */
-	static bool saved_info_valid = false;
-	static int	prev_strategy_buf_id;
-	static uint32 prev_strategy_passes;
-	static int	next_to_clean;
-	static uint32 next_passes;
-
-	/* Moving averages of allocation rate and clean-buffer density */
-	static float smoothed_alloc = 0;
-	static float smoothed_density = 10.0;
-
 	/* Potentially these could be tunables, but for now, not */
 	float		smoothing_samples = 16;
 	float		scan_whole_pool_milliseconds = 120000.0;
@@ -2141,7 +2494,6 @@ BgBufferSync(WritebackContext *wb_context)
 
 	/* Variables for the scanning loop proper */
 	int			num_to_scan;
-	int			num_written;
 	int			reusable_buffers;
 
 	/* Variables for final smoothed_density update */
@@ -2149,10 +2501,11 @@ BgBufferSync(WritebackContext *wb_context)
 	uint32		new_recent_alloc;
 
 	/*
-	 * Find out where the freelist clock sweep currently is, and how many
+	 * Find out where the partition's clock sweep currently is, and how many
 	 * buffer allocations have happened since our last call.
 	 */
-	strategy_buf_id = StrategySyncStart(&strategy_passes, &recent_alloc);
+	strategy_buf_id = StrategySyncStart(partition, &first_buffer, &num_buffers,
+										&strategy_passes, &recent_alloc);
 
 	/* Report buffer alloc counts to pgstat */
 	BgWriterStats.m_buf_alloc += recent_alloc;
@@ -2164,7 +2517,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 */
 	if (bgwriter_lru_maxpages <= 0)
 	{
-		saved_info_valid = false;
+		state->saved_info_valid = false;
 		return true;
 	}
 
@@ -2176,34 +2529,34 @@ BgBufferSync(WritebackContext *wb_context)
 	 * weird-looking coding of xxx_passes comparisons are to avoid bogus
 	 * behavior when the passes counts wrap around.
 	 */
-	if (saved_info_valid)
+	if (state->saved_info_valid)
 	{
-		int32		passes_delta = strategy_passes - prev_strategy_passes;
+		int32		passes_delta = strategy_passes - state->prev_strategy_passes;
 
-		strategy_delta = strategy_buf_id - prev_strategy_buf_id;
-		strategy_delta += (long) passes_delta * NBuffers;
+		strategy_delta = strategy_buf_id - state->prev_strategy_buf_id;
+		strategy_delta += (long) passes_delta * num_buffers;
 
 		Assert(strategy_delta >= 0);
 
-		if ((int32) (next_passes - strategy_passes) > 0)
+		if ((int32) (state->next_passes - strategy_passes) > 0)
 		{
 			/* we're one pass ahead of the strategy point */
-			bufs_to_lap = strategy_buf_id - next_to_clean;
+			bufs_to_lap = strategy_buf_id - state->next_to_clean;
 #ifdef BGW_DEBUG
-			elog(DEBUG2, "bgwriter ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
-				 next_passes, next_to_clean,
+			elog(DEBUG2, "bgwriter partition %d ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
+				 partition, state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta, bufs_to_lap);
 #endif
 		}
-		else if (next_passes == strategy_passes &&
-				 next_to_clean >= strategy_buf_id)
+		else if (state->next_passes == strategy_passes &&
+				 state->next_to_clean >= strategy_buf_id)
 		{
 			/* on same pass, but ahead or at least not behind */
-			bufs_to_lap = NBuffers - (next_to_clean - strategy_buf_id);
+			bufs_to_lap = num_buffers - (state->next_to_clean - strategy_buf_id);
 #ifdef BGW_DEBUG
-			elog(DEBUG2, "bgwriter ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
-				 next_passes, next_to_clean,
+			elog(DEBUG2, "bgwriter partition %d ahead: bgw %u-%u strategy %u-%u delta=%ld lap=%d",
+				 partition, state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta, bufs_to_lap);
 #endif
@@ -2215,14 +2568,14 @@ BgBufferSync(WritebackContext *wb_context)
 			 * cleaning from there.
 			 */
 #ifdef BGW_DEBUG
-			elog(DEBUG2, "bgwriter behind: bgw %u-%u strategy %u-%u delta=%ld",
-				 next_passes, next_to_clean,
+			elog(DEBUG2, "bgwriter partition %d behind: bgw %u-%u strategy %u-%u delta=%ld",
+				 partition, state->next_passes, state->next_to_clean,
 				 strategy_passes, strategy_buf_id,
 				 strategy_delta);
 #endif
-			next_to_clean = strategy_buf_id;
-			next_passes = strategy_passes;
-			bufs_to_lap = NBuffers;
+			state->next_to_clean = strategy_buf_id;
+			state->next_passes = strategy_passes;
+			bufs_to_lap = num_buffers;
 		}
 	}
 	else
@@ -2232,19 +2585,19 @@ BgBufferSync(WritebackContext *wb_context)
 		 * start at the strategy point.
 		 */
 #ifdef BGW_DEBUG
-		elog(DEBUG2, "bgwriter initializing: strategy %u-%u",
-			 strategy_passes, strategy_buf_id);
+		elog(DEBUG2, "bgwriter partition %d initializing: strategy %u-%u",
+			 partition, strategy_passes, strategy_buf_id);
 #endif
 		strategy_delta = 0;
-		next_to_clean = strategy_buf_id;
-		next_passes = strategy_passes;
-		bufs_to_lap = NBuffers;
+		state->next_to_clean = strategy_buf_id;
+		state->next_passes = strategy_passes;
+		bufs_to_lap = num_buffers;
 	}
 
 	/* Update saved info for next time */
-	prev_strategy_buf_id = strategy_buf_id;
-	prev_strategy_passes = strategy_passes;
-	saved_info_valid = true;
+	state->prev_strategy_buf_id = strategy_buf_id;
+	state->prev_strategy_passes = strategy_passes;
+	state->saved_info_valid = true;
 
 	/*
 	 * Compute how many buffers had to be scanned for each new allocation, ie,
@@ -2255,7 +2608,7 @@ BgBufferSync(WritebackContext *wb_context)
 	if (strategy_delta > 0 && recent_alloc > 0)
 	{
 		scans_per_alloc = (float) strategy_delta / (float) recent_alloc;
-		smoothed_density += (scans_per_alloc - smoothed_density) /
+		state->smoothed_density += (scans_per_alloc - state->smoothed_density) /
 			smoothing_samples;
 	}
 
@@ -2264,22 +2617,22 @@ BgBufferSync(WritebackContext *wb_context)
 	 * strategy point and where we've scanned ahead to, based on the smoothed
 	 * density estimate.
 	 */
-	bufs_ahead = NBuffers - bufs_to_lap;
-	reusable_buffers_est = (float) bufs_ahead / smoothed_density;
+	bufs_ahead = num_buffers - bufs_to_lap;
+	reusable_buffers_est = (float) bufs_ahead / state->smoothed_density;
 
 	/*
 	 * Track a moving average of recent buffer allocations.  Here, rather than
 	 * a true average we want a fast-attack, slow-decline behavior: we
 	 * immediately follow any increase.
 	 */
-	if (smoothed_alloc <= (float) recent_alloc)
-		smoothed_alloc = recent_alloc;
+	if (state->smoothed_alloc <= (float) recent_alloc)
+		state->smoothed_alloc = recent_alloc;
 	else
-		smoothed_alloc += ((float) recent_alloc - smoothed_alloc) /
+		state->smoothed_alloc += ((float) recent_alloc - state->smoothed_alloc) /
 			smoothing_samples;
 
 	/* Scale the estimate by a GUC to allow more aggressive tuning. */
-	upcoming_alloc_est = (int) (smoothed_alloc * bgwriter_lru_multiplier);
+	upcoming_alloc_est = (int) (state->smoothed_alloc * bgwriter_lru_multiplier);
 
 	/*
 	 * If recent_alloc remains at zero for many cycles, smoothed_alloc will
@@ -2290,7 +2643,7 @@ BgBufferSync(WritebackContext *wb_context)
 	 * syndrome.  It will pop back up as soon as recent_alloc increases.
 	 */
 	if (upcoming_alloc_est == 0)
-		smoothed_alloc = 0;
+		state->smoothed_alloc = 0;
 
 	/*
 	 * Even in cases where there's been little or no buffer allocation
@@ -2300,15 +2653,15 @@ BgBufferSync(WritebackContext *wb_context)
 	 *
 	 * (scan_whole_pool_milliseconds / BgWriterDelay) computes how many times
 	 * the BGW will be called during the scan_whole_pool time; slice the
-	 * buffer pool into that many sections.
+	 * partition into that many sections.
 	 */
-	min_scan_buffers = (int) (NBuffers / (scan_whole_pool_milliseconds / BgWriterDelay));
+	min_scan_buffers = (int) (num_buffers / (scan_whole_pool_milliseconds / BgWriterDelay));
 
 	if (upcoming_alloc_est < (min_scan_buffers + reusable_buffers_est))
 	{
 #ifdef BGW_DEBUG
-		elog(DEBUG2, "bgwriter: alloc_est=%d too small, using min=%d + reusable_est=%d",
-			 upcoming_alloc_est, min_scan_buffers, reusable_buffers_est);
+		elog(DEBUG2, "bgwriter partition %d: alloc_est=%d too small, using min=%d + reusable_est=%d",
+			 partition, upcoming_alloc_est, min_scan_buffers, reusable_buffers_est);
 #endif
 		upcoming_alloc_est = min_scan_buffers + reusable_buffers_est;
 	}
@@ -2319,48 +2672,39 @@ BgBufferSync(WritebackContext *wb_context)
 	 * enough buffers to match our estimate of the next cycle's allocation
 	 * requirements, or hit the bgwriter_lru_maxpages limit.
 	 */
-
-	/* Make sure we can handle the pin inside SyncOneBuffer */
-	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
-
 	num_to_scan = bufs_to_lap;
-	num_written = 0;
 	reusable_buffers = reusable_buffers_est;
 
 	/* Execute the LRU scan */
-	while (num_to_scan > 0 && reusable_buffers < upcoming_alloc_est)
+	while (num_to_scan > 0 && reusable_buffers < upcoming_alloc_est &&
+		   *num_written < bgwriter_lru_maxpages)
 	{
-		int			sync_state = SyncOneBuffer(next_to_clean, true,
-											   wb_context);
+		int			sync_state = SyncOneBuffer(first_buffer + state->next_to_clean,
+											   true, wb_context);
 
-		if (++next_to_clean >= NBuffers)
+		if (++state->next_to_clean >= num_buffers)
 		{
-			next_to_clean = 0;
-			next_passes++;
+			state->next_to_clean = 0;
+			state->next_passes++;
 		}
 		num_to_scan--;
 
 		if (sync_state & BUF_WRITTEN)
 		{
 			reusable_buffers++;
-			if (++num_written >= bgwriter_lru_maxpages)
-			{
-				BgWriterStats.m_maxwritten_clean++;
-				break;
-			}
+			++*num_written;
 		}
 		else if (sync_state & BUF_REUSABLE)
 			reusable_buffers++;
 	}
 
-	BgWriterStats.m_buf_written_clean += num_written;
-
 #ifdef BGW_DEBUG
-	elog(DEBUG1, "bgwriter: recent_alloc=%u smoothed=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
-		 recent_alloc, smoothed_alloc, strategy_delta, bufs_ahead,
-		 smoothed_density, reusable_buffers_est, upcoming_alloc_est,
+	elog(DEBUG1, "bgwriter partition %d: recent_alloc=%u smoothed=%.2f delta=%ld ahead=%d density=%.2f reusable_est=%d upcoming_est=%d scanned=%d wrote=%d reusable=%d",
+		 partition, recent_alloc, state->smoothed_alloc, strategy_delta,
+		 bufs_ahead, state->smoothed_density, reusable_buffers_est,
+		 upcoming_alloc_est,
 		 bufs_to_lap - num_to_scan,
-		 num_written,
+		 *num_written,
 		 reusable_buffers - reusable_buffers_est);
 #endif
 
@@ -2377,13 +2721,13 @@ BgBufferSync(WritebackContext *wb_context)
 	if (new_strategy_delta > 0 && new_recent_alloc > 0)
 	{
 		scans_per_alloc = (float) new_strategy_delta / (float) new_recent_alloc;
-		smoothed_density += (scans_per_alloc - smoothed_density) /
+		state->smoothed_density += (scans_per_alloc - state->smoothed_density) /
 			smoothing_samples;
 
 #ifdef BGW_DEBUG
-		elog(DEBUG2, "bgwriter: cleaner density alloc=%u scan=%ld density=%.2f new smoothed=%.2f",
-			 new_recent_alloc, new_strategy_delta,
-			 scans_per_alloc, smoothed_density);
+		elog(DEBUG2, "bgwriter partition %d: cleaner density alloc=%u scan=%ld density=%.2f new smoothed=%.2f",
+			 partition, new_recent_alloc, new_strategy_delta,
+			 scans_per_alloc, state->smoothed_density);
 #endif
 	}
 
@@ -2402,9 +2746,12 @@ BgBufferSync(WritebackContext *wb_context)
  *	BUF_REUSABLE: buffer is available for replacement, ie, it has
  *		pin count 0 and usage count 0.
  *
- * (BUF_WRITTEN could be set in error if FlushBuffer finds the buffer clean
+ * (BUF_WRITTEN could be set in error if FlushBufferRun finds the buffer clean
  * after locking it, but we don't care all that much.)
  *
+ * The write may only be started; see FlushBufferRun.  The caller must wait
+ * for the writes with pgaio_wait_all() before relying on them.
+ *
  * Note: caller must have done ResourceOwnerEnlargeBuffers.
  */
 static int
@@ -2413,7 +2760,6 @@ SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext *wb_context)
 	BufferDesc *bufHdr = GetBufferDescriptor(buf_id);
 	int			result = 0;
 	uint32		buf_state;
-	BufferTag	tag;
 
 	ReservePrivateRefCountEntry();
 
@@ -2448,23 +2794,89 @@ SyncOneBuffer(int buf_id, bool skip_recently_used, WritebackContext *wb_context)
 	}
 
 	/*
-	 * Pin it, share-lock it, write it.  (FlushBuffer will do nothing if the
-	 * buffer is clean by the time we've locked it.)
+	 * Pin it and write it.  (FlushBufferRun will do nothing if the buffer is
+	 * clean by the time we've locked it.)  The pin is released when the write
+	 * completes; make room for the next one.
 	 */
 	PinBuffer_Locked(bufHdr);
-	LWLockAcquire(BufferDescriptorGetContentLock(bufHdr), LW_SHARED);
 
-	FlushBuffer(bufHdr, NULL);
+	(void) FlushBufferRun(&bufHdr, 1, wb_context);
 
-	LWLockRelease(BufferDescriptorGetContentLock(bufHdr));
+	ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
 
-	tag = bufHdr->tag;
+	return result | BUF_WRITTEN;
+}
 
-	UnpinBuffer(bufHdr, true);
+/*
+ * SyncBufferRun -- write out a run of buffers during a checkpoint.
+ *
+ * items are the next nitems entries of CkptBufferIds for a tablespace.  The
+ * leading ones, up to checkpoint_combine_limit of them, that hold
+ * consecutive blocks of a relation fork and still need writing are written
+ * with a single write.
+ *
+ * Returns the number of entries processed, which is at least one, and sets
+ * *nwritten to the number of buffers written.
+ *
+ * Note: caller must have done ResourceOwnerEnlargeBuffers.
+ */
+static int
+SyncBufferRun(const CkptSortItem *items, int nitems,
+			  WritebackContext *wb_context, int *nwritten)
+{
+	BufferDesc *bufs[MAX_BUFFERS_PER_WRITE];
+	int			nbufs;
 
-	ScheduleBufferTagForWriteback(wb_context, &tag);
+	nitems = Min(nitems, checkpoint_combine_limit);
+	*nwritten = 0;
 
-	return result | BUF_WRITTEN;
+	for (nbufs = 0; nbufs < nitems; nbufs++)
+	{
+		const CkptSortItem *item = &items[nbufs];
+		BufferDesc *bufHdr = GetBufferDescriptor(item->buf_id);
+		uint32		buf_state;
+
+		/* The sort order puts the blocks of a relation fork in sequence */
+		if (nbufs > 0 &&
+			(item->relNode != items[0].relNode ||
+			 item->forkNum != items[0].forkNum ||
+			 item->blockNum != items[0].blockNum + nbufs))
+			break;
+
+		ReservePrivateRefCountEntry();
+
+		/*
+		 * The buffer may have been written, or even replaced, since
+		 * BufferSync marked it; check that it still needs writing, and that
+		 * it still holds the block we expect.  If someone else wrote it and
+		 * replaced it with another page that they dirtied in the meantime, we
+		 * write it anyway, which is harmless.
+		 */
+		buf_state = LockBufHdr(bufHdr);
+
+		if (!(buf_state & BM_CHECKPOINT_NEEDED) ||
+			!(buf_state & BM_VALID) || !(buf_state & BM_DIRTY) ||
+			(nbufs > 0 &&
+			 (!RelFileNodeEquals(bufHdr->tag.rnode, bufs[0]->tag.rnode) ||
+			  bufHdr->tag.forkNum != bufs[0]->tag.forkNum ||
+			  bufHdr->tag.blockNum != bufs[0]->tag.blockNum + nbufs)))
+		{
+			UnlockBufHdr(bufHdr, buf_state);
+			break;
+		}
+
+		PinBuffer_Locked(bufHdr);
+		bufs[nbufs] = bufHdr;
+
+		ResourceOwnerEnlargeBuffers(CurrentResourceOwner);
+	}
+
+	if (nbufs == 0)
+		return 1;
+
+	*nwritten = FlushBufferRun(bufs, nbufs, wb_context);
+
+	return Max(*nwritten, 1);
 }
 
 /*
@@ -2740,7 +3152,7 @@ FlushBuffer(BufferDesc *buf, SMgrRelation reln)
 	 * false, then someone else flushed the buffer before we could, so we need
 	 * not do anything.
 	 */
-	if (!StartBufferIO(buf, false))
+	if (!StartBufferIO(buf, false, false))
 		return;
 
 	/* Setup error traceback support for ereport() */
@@ -2843,6 +3255,216 @@ FlushBuffer(BufferDesc *buf, SMgrRelation reln)
 	error_context_stack = errcallback.previous;
 }
 
+/*
+ * FlushBufferRun
+ *		Write out a run of buffers holding consecutive blocks of a relation
+ *		fork, with a single write.
+ *
+ * The caller must have pinned the buffers, but not locked them.  The pages
+ * are copied, with their checksums set, to a bounce buffer if this process
+ * has one, or else to private storage, so each buffer is share-locked only
+ * while it is copied.  With a bounce buffer, the write is only started, and
+ * FlushBufferRunComplete finishes the job when it completes.  Either way,
+ * the pins are released once the buffers are written, and the buffers are
+ * scheduled for writeback in wb_context.
+ *
+ * While we have writes in progress, we must not wait for anyone else's I/O
+ * on a buffer, lest they be waiting for ours; so a buffer that is being
+ * written by someone else cuts the run short there, and is left to the
+ * caller.  Returns the number of buffers, from the start of the run,
+ * written.  That is zero if the first buffer turned out to be clean.
+ */
+static int
+FlushBufferRun(BufferDesc **bufs, int nbufs, WritebackContext *wb_context)
+{
+	static char *privateCopy = NULL;
+	char	   *copy;
+	char	   *bounce;
+	char	   *pages[MAX_BUFFERS_PER_WRITE];
+	int			buf_ids[MAX_BUFFERS_PER_WRITE];
+	XLogRecPtr	recptr = InvalidXLogRecPtr;
+	ErrorContextCallback errcallback;
+	instr_time	io_start,
+				io_time;
+	SMgrRelation reln;
+	int			nstarted;
+	int			i;
+
+	StaticAssertStmt(MAX_BUFFERS_PER_WRITE <= PGAIO_MAX_BLOCKS,
+					 "MAX_BUFFERS_PER_WRITE exceeds PGAIO_MAX_BLOCKS");
+	Assert(nbufs > 0 && nbufs <= MAX_BUFFERS_PER_WRITE);
+
+	/*
+	 * The writes in flight must complete before they can be scheduled for
+	 * writeback in another context.
+	 */
+	if (wb_context != FlushWritebackContext)
+	{
+		pgaio_wait_all();
+		FlushWritebackContext = wb_context;
+	}
+
+	bounce = pgaio_bounce_buffer();
+	if (bounce != NULL)
+		copy = bounce;
+	else
+	{
+		if (privateCopy == NULL)
+			privateCopy = MemoryContextAlloc(TopMemoryContext,
+											 MAX_BUFFERS_PER_WRITE * BLCKSZ);
+		copy = privateCopy;
+	}
+
+	/* Don't have more buffer I/Os in progress than we can keep track of */
+	if (NumInProgressBufs + nbufs > MAX_BUFFERS_IN_PROGRESS)
+		pgaio_wait_all();
+
+	for (nstarted = 0; nstarted < nbufs; nstarted++)
+	{
+		BufferDesc *buf = bufs[nstarted];
+		LWLock	   *content_lock = BufferDescriptorGetContentLock(buf);
+		uint32		buf_state;
+
+		LWLockAcquire(content_lock, LW_SHARED);
+
+		/*
+		 * Acquire the buffer's io_in_progress lock.  If StartBufferIO returns
+		 * false, then someone else flushed the buffer before we could, or is
+		 * flushing it.  Only for the first buffer can we wait for them to
+		 * finish, after waiting for our own writes.
+		 */
+		if (!StartBufferIO(buf, false, NumInProgressBufs > 0))
+		{
+			bool		started = false;
+
+			if (nstarted == 0 && NumInProgressBufs > 0)
+			{
+				LWLockRelease(content_lock);
+				pgaio_wait_all();
+				LWLockAcquire(content_lock, LW_SHARED);
+				started = StartBufferIO(buf, false, false);
+			}
+			if (!started)
+			{
+				LWLockRelease(content_lock);
+				break;
+			}
+		}
+
+		TRACE_POSTGRESQL_BUFFER_FLUSH_START(buf->tag.forkNum,
+											buf->tag.blockNum,
+											buf->tag.rnode.spcNode,
+											buf->tag.rnode.dbNode,
+											buf->tag.rnode.relNode);
+
+		/* See FlushBuffer */
+		buf_state = LockBufHdr(buf);
+		if ((buf_state & BM_PERMANENT) && BufferGetLSN(buf) > recptr)
+			recptr = BufferGetLSN(buf);
+		buf_state &= ~BM_JUST_DIRTIED;
+		UnlockBufHdr(buf, buf_state);
+
+		pages[nstarted] = copy + nstarted * BLCKSZ;
+		memcpy(pages[nstarted], BufHdrGetBlock(buf), BLCKSZ);
+
+		LWLockRelease(content_lock);
+
+		PageSetChecksumInplace((Page) pages[nstarted], buf->tag.blockNum);
+		buf_ids[nstarted] = buf->buf_id;
+	}
+
+	/* Release the buffers we didn't get to */
+	for (i = nstarted; i < nbufs; i++)
+		UnpinBuffer(bufs[i], true);
+
+	if (nstarted == 0)
+		return 0;
+
+	/* Setup error traceback support for ereport() */
+	errcallback.callback = shared_buffer_write_error_callback;
+	errcallback.arg = (void *) bufs[0];
+	errcallback.previous = error_context_stack;
+	error_context_stack = &errcallback;
+
+	/*
+	 * Force XLOG flush up to the buffers' LSN, as in FlushBuffer.  The
+	 * copies can't be newer than that, as the pages can't change while
+	 * share-locked, except for hint bits.
+	 */
+	if (!XLogRecPtrIsInvalid(recptr))
+		XLogFlush(recptr);
+
+	reln = smgropen(bufs[0]->tag.rnode, InvalidBackendId);
+
+	if (track_io_timing)
+		INSTR_TIME_SET_CURRENT(io_start);
+
+	if (bounce != NULL)
+		pgaio_start_writev(reln, bufs[0]->tag.forkNum, bufs[0]->tag.blockNum,
+						   pages, nstarted, false, buf_ids,
+						   FlushBufferRunComplete);
+	else
+	{
+		smgrwritev(reln, bufs[0]->tag.forkNum, bufs[0]->tag.blockNum,
+				   pages, nstarted, false);
+
+		for (i = 0; i < nstarted; i++)
+			FlushBufferDone(bufs[i]);
+	}
+
+	if (track_io_timing)
+	{
+		INSTR_TIME_SET_CURRENT(io_time);
+		INSTR_TIME_SUBTRACT(io_time, io_start);
+		pgstat_count_buffer_write_time(INSTR_TIME_GET_MICROSEC(io_time));
+		INSTR_TIME_ADD(pgBufferUsage.blk_write_time, io_time);
+	}
+
+	/* Pop the error context stack */
+	error_context_stack = errcallback.previous;
+
+	return nstarted;
+}
+
+/*
+ * FlushBufferRunComplete
+ *		Completion callback of the writes started by FlushBufferRun.
+ */
+static void
+FlushBufferRunComplete(const PgAioRequest *req)
+{
+	int			i;
+
+	for (i = 0; i < req->nblocks; i++)
+		FlushBufferDone(GetBufferDescriptor(req->cb_data[i]));
+}
+
+/*
+ * FlushBufferDone
+ *		Finish writing a buffer for FlushBufferRun: mark it clean (unless
+ *		BM_JUST_DIRTIED has become set), end the io_in_progress state,
+ *		release the pin, and schedule writeback.
+ */
+static void
+FlushBufferDone(BufferDesc *buf)
+{
+	BufferTag	tag = buf->tag;
+
+	pgBufferUsage.shared_blks_written++;
+
+	TerminateBufferIO(buf, true, 0);
+
+	TRACE_POSTGRESQL_BUFFER_FLUSH_DONE(tag.forkNum,
+									   tag.blockNum,
+									   tag.rnode.spcNode,
+									   tag.rnode.dbNode,
+									   tag.rnode.relNode);
+
+	UnpinBuffer(buf, true);
+
+	ScheduleBufferTagForWriteback(FlushWritebackContext, &tag);
+}
+
 /*
  * RelationGetNumberOfBlocksInFork
  *		Determines the current number of pages in the specified relation fork.
@@ -4089,13 +4711,14 @@ WaitIO(BufferDesc *buf)
 /*
  * StartBufferIO: begin I/O on this buffer
  *	(Assumptions)
- *	My process is executing no IO
+ *	My process is executing no IO, or input IO started by ReadBuffersRange
  *	The buffer is Pinned
  *
  * In some scenarios there are race conditions in which multiple backends
  * could attempt the same I/O operation concurrently.  If someone else
  * has already started I/O on this buffer then we will block on the
- * io_in_progress lock until he's done.
+ * io_in_progress lock until he's done, or, if nowait is true, return false
+ * at once.  The caller can tell this case by the buffer not being valid.
  *
  * Input operations are only attempted on buffers that are not BM_VALID,
  * and output operations only on buffers that are BM_VALID and BM_DIRTY,
@@ -4105,11 +4728,11 @@ WaitIO(BufferDesc *buf)
  * false if someone else already did the work.
  */
 static bool
-StartBufferIO(BufferDesc *buf, bool forInput)
+StartBufferIO(BufferDesc *buf, bool forInput, bool nowait)
 {
 	uint32		buf_state;
 
-	Assert(!InProgressBuf);
+	Assert(NumInProgressBufs < MAX_BUFFERS_IN_PROGRESS);
 
 	for (;;)
 	{
@@ -4117,13 +4740,24 @@ StartBufferIO(BufferDesc *buf, bool forInput)
 		 * Grab the io_in_progress lock so that other processes can wait for
 		 * me to finish the I/O.
 		 */
-		LWLockAcquire(BufferDescriptorGetIOLock(buf), LW_EXCLUSIVE);
+		if (!nowait)
+			LWLockAcquire(BufferDescriptorGetIOLock(buf), LW_EXCLUSIVE);
+		else if (!LWLockConditionalAcquire(BufferDescriptorGetIOLock(buf),
+										   LW_EXCLUSIVE))
+			return false;
 
 		buf_state = LockBufHdr(buf);
 
 		if (!(buf_state & BM_IO_IN_PROGRESS))
 			break;
 
+		if (nowait)
+		{
+			UnlockBufHdr(buf, buf_state);
+			LWLockRelease(BufferDescriptorGetIOLock(buf));
+			return false;
+		}
+
 		/*
 		 * The only way BM_IO_IN_PROGRESS could be set when the io_in_progress
 		 * lock isn't held is if the process doing the I/O is recovering from
@@ -4148,8 +4782,9 @@ StartBufferIO(BufferDesc *buf, bool forInput)
 	buf_state |= BM_IO_IN_PROGRESS;
 	UnlockBufHdr(buf, buf_state);
 
-	InProgressBuf = buf;
-	IsForInput = forInput;
+	InProgressBufs[NumInProgressBufs] = buf;
+	IsForInput[NumInProgressBufs] = forInput;
+	NumInProgressBufs++;
 
 	return true;
 }
@@ -4175,8 +4810,7 @@ static void
 TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 {
 	uint32		buf_state;
-
-	Assert(buf == InProgressBuf);
+	int			i;
 
 	buf_state = LockBufHdr(buf);
 
@@ -4189,7 +4823,19 @@ TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 	buf_state |= set_flag_bits;
 	UnlockBufHdr(buf, buf_state);
 
-	InProgressBuf = NULL;
+	/* Forget it; the common case is that it's the only or last one */
+	for (i = NumInProgressBufs - 1; i >= 0; i--)
+	{
+		if (InProgressBufs[i] == buf)
+			break;
+	}
+	Assert(i >= 0);
+	for (; i < NumInProgressBufs - 1; i++)
+	{
+		InProgressBufs[i] = InProgressBufs[i + 1];
+		IsForInput[i] = IsForInput[i + 1];
+	}
+	NumInProgressBufs--;
 
 	LWLockRelease(BufferDescriptorGetIOLock(buf));
 }
@@ -4206,10 +4852,13 @@ TerminateBufferIO(BufferDesc *buf, bool clear_dirty, uint32 set_flag_bits)
 void
 AbortBufferIO(void)
 {
-	BufferDesc *buf = InProgressBuf;
+	/* Wait out our asynchronous I/Os, which may still use the buffers */
+	pgaio_at_error();
+	FlushWritebackContext = NULL;
 
-	if (buf)
+	while (NumInProgressBufs > 0)
 	{
+		BufferDesc *buf = InProgressBufs[NumInProgressBufs - 1];
 		uint32		buf_state;
 
 		/*
@@ -4222,7 +4871,7 @@ AbortBufferIO(void)
 
 		buf_state = LockBufHdr(buf);
 		Assert(buf_state & BM_IO_IN_PROGRESS);
-		if (IsForInput)
+		if (IsForInput[NumInProgressBufs - 1])
 		{
 			Assert(!(buf_state & BM_DIRTY));
 
@@ -18,26 +18,68 @@
 #include "port/atomics.h"
 #include "storage/buf_internals.h"
 #include "storage/bufmgr.h"
+#include "storage/pg_shmem.h"
 #include "storage/proc.h"
+#include "storage/shmem.h"
 
 #define INT_ACCESS_ONCE(var)	((int)(*((volatile int *)&(var))))
 
-
 /*
- * The shared freelist control information.
+ * The clock sweep is split into partitions, each covering a contiguous range
+ * of the buffer array and having a clock hand of its own, so that backends
+ * allocating buffers concurrently mostly advance different hands.  Each
+ * partition has at least MIN_CLOCK_PARTITION_BUFFERS buffers, so small
+ * buffer pools have just one.
+ *
+ * With shared_memory_numa = partition, each NUMA node's share of the buffers
+ * (see InitBufferPool()) is divided into the same number of partitions, and
+ * processes tied to a node allocate buffers from its partitions.
  */
+#define MIN_CLOCK_PARTITION_BUFFERS	1024
+
 typedef struct
 {
-	/* Spinlock: protects the values below */
-	slock_t		buffer_strategy_lock;
-
 	/*
-	 * Clock sweep hand: index of next buffer to consider grabbing. Note that
-	 * this isn't a concrete buffer - we only ever increase the value. So, to
-	 * get an actual buffer, it needs to be used modulo NBuffers.
+	 * Clock sweep hand: index of next buffer to consider grabbing, relative
+	 * to firstBuffer. Note that this isn't a concrete buffer - we only ever
+	 * increase the value. So, to get an actual buffer, it needs to be used
+	 * modulo numBuffers.
 	 */
 	pg_atomic_uint32 nextVictimBuffer;
 
+	/* Buffers allocated from this partition since last reset */
+	pg_atomic_uint32 numBufferAllocs;
+
+	/* Complete cycles of the clock sweep, protected by buffer_strategy_lock */
+	uint32		completePasses;
+
+	int			firstBuffer;	/* First buffer of the partition */
+	int			numBuffers;		/* Number of buffers in the partition */
+} ClockPartition;
+
+/* Keep each partition's hand in a cache line of its own */
+typedef union ClockPartitionPadded
+{
+	ClockPartition part;
+	char		pad[PG_CACHE_LINE_SIZE];
+} ClockPartitionPadded;
+
+/*
+ * The shared freelist control information.
+ */
+typedef struct
+{
+	/* The clock sweep partitions, numClockPartitions of them in use */
+	ClockPartitionPadded partitions[MAX_CLOCK_PARTITIONS];
+	int			numClockPartitions;
+
+	/* NUMA nodes the partitions are divided between, or 1 */
+	int			numClockNodes;
+	int			clockPartitionsPerNode;
+
+	/* Spinlock: protects the values below, and completePasses above */
+	slock_t		buffer_strategy_lock;
+
 	int			firstFreeBuffer;	/* Head of list of unused buffers */
 	int			lastFreeBuffer; /* Tail of list of unused buffers */
 
@@ -46,13 +88,6 @@ typedef struct
 	 * when the list is empty)
 	 */
 
-	/*
-	 * Statistics.  These counters should be wide enough that they can't
-	 * overflow during a single bgwriter cycle.
-	 */
-	uint32		completePasses; /* Complete cycles of the clock sweep */
-	pg_atomic_uint32 numBufferAllocs;	/* Buffers allocated since last reset */
-
 	/*
 	 * Bgworker process to be notified upon activity or -1 if none. See
 	 * StrategyNotifyBgWriter.
@@ -63,6 +98,14 @@ typedef struct
 /* Pointers to shared state */
 static BufferStrategyControl *StrategyControl = NULL;
 
+/*
+ * The partition this backend allocates its next buffer from, among those of
+ * its NUMA node if it's tied to one.  Backends go round the partitions one
+ * allocation at a time, starting from different ones, so that each hand
+ * advances at about the same rate however many backends there are.
+ */
+static int	MyClockPartition = -1;
+
 /*
  * Private (non-shared) state for managing a ring of shared buffers to re-use.
  * This is currently the only kind of BufferAccessStrategy object, but someday
@@ -104,13 +147,13 @@ static void AddBufferToRing(BufferAccessStrategy strategy,
 							BufferDesc *buf);
 
 /*
- * ClockSweepTick - Helper routine for StrategyGetBuffer()
+ * ClockSweepTick - Helper routine for ClockSweep()
  *
- * Move the clock hand one buffer ahead of its current position and return the
- * id of the buffer now under the hand.
+ * Move the partition's clock hand one buffer ahead of its current position
+ * and return the id of the buffer now under the hand.
  */
 static inline uint32
-ClockSweepTick(void)
+ClockSweepTick(ClockPartition *part)
 {
 	uint32		victim;
 
@@ -119,15 +162,14 @@ ClockSweepTick(void)
 	 * doing this, this can lead to buffers being returned slightly out of
 	 * apparent order.
 	 */
-	victim =
-		pg_atomic_fetch_add_u32(&StrategyControl->nextVictimBuffer, 1);
+	victim = pg_atomic_fetch_add_u32(&part->nextVictimBuffer, 1);
 
-	if (victim >= NBuffers)
+	if (victim >= part->numBuffers)
 	{
 		uint32		originalVictim = victim;
 
 		/* always wrap what we look up in BufferDescriptors */
-		victim = victim % NBuffers;
+		victim = victim % part->numBuffers;
 
 		/*
 		 * If we're the one that just caused a wraparound, force
@@ -155,17 +197,92 @@ ClockSweepTick(void)
 				 */
 				SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
 
-				wrapped = expected % NBuffers;
+				wrapped = expected % part->numBuffers;
 
-				success = pg_atomic_compare_exchange_u32(&StrategyControl->nextVictimBuffer,
+				success = pg_atomic_compare_exchange_u32(&part->nextVictimBuffer,
 														 &expected, wrapped);
 				if (success)
-					StrategyControl->completePasses++;
+					part->completePasses++;
 				SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 			}
 		}
 	}
-	return victim;
+	return part->firstBuffer + victim;
+}
+
+/*
+ * ClockSweep - Helper routine for StrategyGetBuffer()
+ *
+ * Run the clock sweep in one partition until it finds a buffer that is
+ * neither pinned nor recently used, and return that with the buffer header
+ * spinlock held.  Returns NULL if a whole pass found every buffer pinned.
+ *
+ * Most buffers the hand passes over are pinned or have a nonzero usage
+ * count, and are dealt with without taking the buffer header spinlock: a
+ * pinned buffer is just skipped, and the usage count is decremented with a
+ * compare-and-swap, as PinBuffer() increments it.  If that fails, someone
+ * else changed the buffer meanwhile, and we just move on.  Only a likely
+ * victim is locked, and checked again.
+ */
+static BufferDesc *
+ClockSweep(ClockPartition *part, uint32 *buf_state)
+{
+	BufferDesc *buf;
+	int			trycounter;
+	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
+
+	trycounter = part->numBuffers;
+	for (;;)
+	{
+		buf = GetBufferDescriptor(ClockSweepTick(part));
+
+		local_buf_state = pg_atomic_read_u32(&buf->state);
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0 &&
+			BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0 &&
+			!(local_buf_state & BM_LOCKED))
+		{
+			pg_atomic_compare_exchange_u32(&buf->state, &local_buf_state,
+										   local_buf_state - BUF_USAGECOUNT_ONE);
+			trycounter = part->numBuffers;
+			continue;
+		}
+
+		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+		{
+			/*
+			 * If the buffer has a nonzero usage_count or has been pinned
+			 * since we looked, we cannot use it after all; decrement the
+			 * usage_count (unless pinned) and keep scanning.
+			 */
+			local_buf_state = LockBufHdr(buf);
+
+			if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
+			{
+				if (BUF_STATE_GET_USAGECOUNT(local_buf_state) == 0)
+				{
+					/* Found a usable buffer */
+					*buf_state = local_buf_state;
+					return buf;
+				}
+				local_buf_state -= BUF_USAGECOUNT_ONE;
+				UnlockBufHdr(buf, local_buf_state);
+				trycounter = part->numBuffers;
+				continue;
+			}
+			UnlockBufHdr(buf, local_buf_state);
+		}
+
+		if (--trycounter == 0)
+		{
+			/*
+			 * We've scanned all the buffers of the partition without making
+			 * any state changes, so they are all pinned (or were when we
+			 * looked at them).
+			 */
+			return NULL;
+		}
+	}
 }
 
 /*
@@ -202,7 +319,10 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 {
 	BufferDesc *buf;
 	int			bgwprocno;
-	int			trycounter;
+	int			nparts;
+	int			nodeparts;
+	int			partno;
+	int			i;
 	uint32		local_buf_state;	/* to avoid repeated (de-)referencing */
 
 	/*
@@ -242,12 +362,25 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 		SetLatch(&ProcGlobal->allProcs[bgwprocno].procLatch);
 	}
 
+	/* Pick the partition to allocate from, and the one for next time */
+	nparts = StrategyControl->numClockPartitions;
+	if (MyNumaNode >= 0 && MyNumaNode < StrategyControl->numClockNodes)
+		nodeparts = StrategyControl->clockPartitionsPerNode;
+	else
+		nodeparts = nparts;
+	if (MyClockPartition < 0)
+		MyClockPartition = MyProc != NULL ? MyProc->pgprocno % nodeparts : 0;
+	partno = MyClockPartition;
+	MyClockPartition = (partno + 1) % nodeparts;
+	if (nodeparts < nparts)
+		partno += MyNumaNode * nodeparts;
+
 	/*
 	 * We count buffer allocation requests so that the bgwriter can estimate
 	 * the rate of buffer consumption.  Note that buffers recycled by a
 	 * strategy object are intentionally not counted here.
 	 */
-	pg_atomic_fetch_add_u32(&StrategyControl->numBufferAllocs, 1);
+	pg_atomic_fetch_add_u32(&StrategyControl->partitions[partno].part.numBufferAllocs, 1);
 
 	/*
 	 * First check, without acquiring the lock, whether there's buffers in the
@@ -312,49 +445,33 @@ StrategyGetBuffer(BufferAccessStrategy strategy, uint32 *buf_state)
 		}
 	}
 
-	/* Nothing on the freelist, so run the "clock sweep" algorithm */
-	trycounter = NBuffers;
-	for (;;)
+	/*
+	 * Nothing on the freelist, so run the "clock sweep" algorithm, moving on
+	 * to the other partitions only if all the buffers of this one are
+	 * pinned.
+	 */
+	for (i = 0; i < nparts; i++)
 	{
-		buf = GetBufferDescriptor(ClockSweepTick());
-
-		/*
-		 * If the buffer is pinned or has a nonzero usage_count, we cannot use
-		 * it; decrement the usage_count (unless pinned) and keep scanning.
-		 */
-		local_buf_state = LockBufHdr(buf);
-
-		if (BUF_STATE_GET_REFCOUNT(local_buf_state) == 0)
-		{
-			if (BUF_STATE_GET_USAGECOUNT(local_buf_state) != 0)
-			{
-				local_buf_state -= BUF_USAGECOUNT_ONE;
-
-				trycounter = NBuffers;
-			}
-			else
-			{
-				/* Found a usable buffer */
-				if (strategy != NULL)
-					AddBufferToRing(strategy, buf);
-				*buf_state = local_buf_state;
-				return buf;
-			}
-		}
-		else if (--trycounter == 0)
+		buf = ClockSweep(&StrategyControl->partitions[partno].part,
+						 &local_buf_state);
+		if (buf != NULL)
 		{
-			/*
-			 * We've scanned all the buffers without making any state changes,
-			 * so all the buffers are pinned (or were when we looked at them).
-			 * We could hope that someone will free one eventually, but it's
-			 * probably better to fail than to risk getting stuck in an
-			 * infinite loop.
-			 */
-			UnlockBufHdr(buf, local_buf_state);
-			elog(ERROR, "no unpinned buffers available");
+			if (strategy != NULL)
+				AddBufferToRing(strategy, buf);
+			*buf_state = local_buf_state;
+			return buf;
 		}
-		UnlockBufHdr(buf, local_buf_state);
+		partno = (partno + 1) % nparts;
 	}
+
+	/*
+	 * We've scanned all the buffers without making any state changes, so all
+	 * the buffers are pinned (or were when we looked at them).  We could hope
+	 * that someone will free one eventually, but it's probably better to fail
+	 * than to risk getting stuck in an infinite loop.
+	 */
+	elog(ERROR, "no unpinned buffers available");
+	return NULL;				/* keep compiler quiet */
 }
 
 /*
@@ -380,43 +497,63 @@ StrategyFreeBuffer(BufferDesc *buf)
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
 }
 
+/*
+ * StrategySyncPartitions -- number of clock sweep partitions
+ *
+ * BgBufferSync() runs its scan ahead of each partition's clock hand
+ * separately, as the hands move independently of each other.
+ */
+int
+StrategySyncPartitions(void)
+{
+	return StrategyControl->numClockPartitions;
+}
+
 /*
  * StrategySyncStart -- tell BufferSync where to start syncing
  *
- * The result is the buffer index of the best buffer to sync first.
- * BufferSync() will proceed circularly around the buffer array from there.
+ * The result is the position of the given partition's clock hand, as an
+ * index relative to the first buffer of the partition, which is returned
+ * in *first_buffer along with the partition's size in *num_buffers.
+ * BgBufferSync() will proceed circularly around the partition from there.
  *
- * In addition, we return the completed-pass count (which is effectively
- * the higher-order bits of nextVictimBuffer) and the count of recent buffer
- * allocs if non-NULL pointers are passed.  The alloc count is reset after
- * being read.
+ * In addition, we return the partition's completed-pass count (which is
+ * effectively the higher-order bits of its nextVictimBuffer) and the count
+ * of recent buffer allocs from it if non-NULL pointers are passed.  The
+ * alloc count is reset after being read.
  */
 int
-StrategySyncStart(uint32 *complete_passes, uint32 *num_buf_alloc)
+StrategySyncStart(int partition, int *first_buffer, int *num_buffers,
+				  uint32 *complete_passes, uint32 *num_buf_alloc)
 {
+	ClockPartition *part;
 	uint32		nextVictimBuffer;
 	int			result;
 
+	Assert(partition >= 0 && partition < StrategyControl->numClockPartitions);
+	part = &StrategyControl->partitions[partition].part;
+
 	SpinLockAcquire(&StrategyControl->buffer_strategy_lock);
-	nextVictimBuffer = pg_atomic_read_u32(&StrategyControl->nextVictimBuffer);
-	result = nextVictimBuffer % NBuffers;
+	nextVictimBuffer = pg_atomic_read_u32(&part->nextVictimBuffer);
+	result = nextVictimBuffer % part->numBuffers;
 
 	if (complete_passes)
 	{
-		*complete_passes = StrategyControl->completePasses;
+		*complete_passes = part->completePasses;
 
 		/*
 		 * Additionally add the number of wraparounds that happened before
 		 * completePasses could be incremented. C.f. ClockSweepTick().
 		 */
-		*complete_passes += nextVictimBuffer / NBuffers;
+		*complete_passes += nextVictimBuffer / part->numBuffers;
 	}
 
 	if (num_buf_alloc)
-	{
-		*num_buf_alloc = pg_atomic_exchange_u32(&StrategyControl->numBufferAllocs, 0);
-	}
+		*num_buf_alloc = pg_atomic_exchange_u32(&part->numBufferAllocs, 0);
 	SpinLockRelease(&StrategyControl->buffer_strategy_lock);
+
+	*first_buffer = part->firstBuffer;
+	*num_buffers = part->numBuffers;
 	return result;
 }
 
@@ -475,6 +612,9 @@ void
 StrategyInitialize(bool init)
 {
 	bool		found;
+	int			nparts;
+	int			nnodes;
+	int			i;
 
 	/*
 	 * Initialize the shared buffer lookup hashtable.
@@ -512,12 +652,39 @@ StrategyInitialize(bool init)
 		StrategyControl->firstFreeBuffer = 0;
 		StrategyControl->lastFreeBuffer = NBuffers - 1;
 
-		/* Initialize the clock sweep pointer */
-		pg_atomic_init_u32(&StrategyControl->nextVictimBuffer, 0);
+		/*
+		 * Divide the buffers between the clock sweep partitions, giving each
+		 * NUMA node the same number of partitions if they're partitioned
+		 * between nodes.  As InitBufferPool() gives node n the buffers from
+		 * NBuffers * n / nnodes on, the partitions of a node then cover
+		 * exactly its buffers.
+		 */
+		nparts = Min(MAX_CLOCK_PARTITIONS,
+					 Max(NBuffers / MIN_CLOCK_PARTITION_BUFFERS, 1));
+		nnodes = 1;
+		if (shared_memory_numa == SHMEM_NUMA_PARTITION &&
+			ShmemNumaNodes() > 1 && ShmemNumaNodes() <= MAX_CLOCK_PARTITIONS)
+			nnodes = ShmemNumaNodes();
+		nparts = Max(nparts / nnodes, 1) * nnodes;
+		StrategyControl->numClockPartitions = nparts;
+		StrategyControl->numClockNodes = nnodes;
+		StrategyControl->clockPartitionsPerNode = nparts / nnodes;
+
+		for (i = 0; i < nparts; i++)
+		{
+			ClockPartition *part = &StrategyControl->partitions[i].part;
 
-		/* Clear statistics */
-		StrategyControl->completePasses = 0;
-		pg_atomic_init_u32(&StrategyControl->numBufferAllocs, 0);
+			part->firstBuffer = (int) ((int64) NBuffers * i / nparts);
+			part->numBuffers =
+				(int) ((int64) NBuffers * (i + 1) / nparts) - part->firstBuffer;
+
+			/* Initialize the clock sweep pointer */
+			pg_atomic_init_u32(&part->nextVictimBuffer, 0);
+
+			/* Clear statistics */
+			part->completePasses = 0;
+			pg_atomic_init_u32(&part->numBufferAllocs, 0);
+		}
 
 		/* No pending notification */
 		StrategyControl->bgwprocno = -1;
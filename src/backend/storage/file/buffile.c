@@ -36,18 +36,36 @@
  * other backends, as infrastructure for parallel execution.  Such files need
  * to be created as a member of a SharedFileSet that all participants are
  * attached to.
+ *
+ * Private BufFiles can also be compressed, as selected by the
+ * temp_file_compression GUC.  Each BLCKSZ-sized block of the logical file is
+ * then compressed on its own and stored wherever there is room in the
+ * physical files, and an in-memory map tells where each block is.  That
+ * keeps random access by block, which logtape.c relies on, cheap: a seek
+ * only has to find the block in the map and decompress it.  A block that
+ * is written again is stored anew, and the space of its old version is
+ * reused for later blocks of a similar size.
  *-------------------------------------------------------------------------
  */
 
 #include "postgres.h"
 
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+#ifdef USE_ZSTD
+#include <zstd.h>
+#endif
+
 #include "commands/tablespace.h"
+#include "common/pg_lzcompress.h"
 #include "executor/instrument.h"
 #include "miscadmin.h"
 #include "pgstat.h"
 #include "storage/buf_internals.h"
 #include "storage/buffile.h"
 #include "storage/fd.h"
+#include "utils/memutils.h"
 #include "utils/resowner.h"
 
 /*
@@ -58,6 +76,36 @@
 #define MAX_PHYSICAL_FILESIZE	0x40000000
 #define BUFFILE_SEG_SIZE		(MAX_PHYSICAL_FILESIZE / BLCKSZ)
 
+/*
+ * Space for compressed blocks is handed out in multiples of this, so that
+ * the space of a block that is written again can be reused by a later block
+ * that compresses to a similar size.
+ */
+#define BUFFILE_EXTENT_UNIT		512
+#define BUFFILE_NUM_EXTENT_SIZES	(BLCKSZ / BUFFILE_EXTENT_UNIT)
+
+/* zstd level for temporary files; speed matters more than ratio here */
+#define BUFFILE_ZSTD_LEVEL		1
+
+/* GUC variable */
+int			temp_file_compression = TEMP_FILE_COMPRESSION_NONE;
+
+/* Location of a block of a compressed BufFile */
+typedef struct BufFileBlock
+{
+	int64		pos;			/* position in the physical files, or -1 */
+	int32		clen;			/* stored length; rawlen if not compressed */
+	int32		rawlen;			/* number of valid bytes in the block */
+} BufFileBlock;
+
+/* Free space of one size in the physical files of a compressed BufFile */
+typedef struct BufFileExtentList
+{
+	int64	   *pos;			/* palloc'd array of positions */
+	int			num;			/* number of valid entries */
+	int			max;			/* allocated length of array */
+} BufFileExtentList;
+
 /*
  * This data structure represents a buffered file that consists of one or
  * more physical files (each accessed through a virtual file descriptor
@@ -91,9 +139,27 @@ struct BufFile
 	off_t		curOffset;		/* offset part of current pos */
 	int			pos;			/* next read/write position in buffer */
 	int			nbytes;			/* total # of valid bytes in buffer */
+
+	/*
+	 * For a compressed file, the buffer is always for a whole block, so
+	 * curOffset is a multiple of BLCKSZ and pos can be up to BLCKSZ.  The
+	 * block is only read in when it's needed; blockLoaded tells whether
+	 * that has happened.
+	 */
+	int			compression;	/* TEMP_FILE_COMPRESSION_xxx */
+	bool		blockLoaded;	/* buffer holds current block's contents? */
+	BufFileBlock *blocks;		/* palloc'd array, indexed by block number */
+	long		numBlocks;		/* number of valid entries in blocks */
+	long		maxBlocks;		/* allocated length of blocks */
+	int64		physicalEnd;	/* end of used space in the physical files */
+	BufFileExtentList *freeExtents; /* palloc'd array, or NULL */
+
 	PGAlignedBlock buffer;
 };
 
+/* Scratch space for compressing and decompressing blocks */
+static char *compressBuffer = NULL;
+
 static BufFile *makeBufFileCommon(int nfiles);
 static BufFile *makeBufFile(File firstfile);
 static void extendBufFile(BufFile *file);
@@ -101,6 +167,16 @@ static void BufFileLoadBuffer(BufFile *file);
 static void BufFileDumpBuffer(BufFile *file);
 static void BufFileFlush(BufFile *file);
 static File MakeNewSharedSegment(BufFile *file, int segment);
+static long BufFileCurrentBlock(BufFile *file);
+static void BufFileLoadBlock(BufFile *file);
+static void BufFileDumpBlock(BufFile *file);
+static void BufFileNextBlock(BufFile *file);
+static int64 BufFileAllocExtent(BufFile *file, int size);
+static void BufFileFreeExtent(BufFile *file, int64 pos, int size);
+static size_t BufFileReadCompressed(BufFile *file, void *ptr, size_t size);
+static void BufFileWriteCompressed(BufFile *file, void *ptr, size_t size);
+static int	BufFileSeekCompressed(BufFile *file, int fileno, off_t offset,
+								  int whence);
 
 /*
  * Create BufFile and perform the common initialization.
@@ -118,6 +194,13 @@ makeBufFileCommon(int nfiles)
 	file->curOffset = 0L;
 	file->pos = 0;
 	file->nbytes = 0;
+	file->compression = TEMP_FILE_COMPRESSION_NONE;
+	file->blockLoaded = false;
+	file->blocks = NULL;
+	file->numBlocks = 0;
+	file->maxBlocks = 0;
+	file->physicalEnd = 0;
+	file->freeExtents = NULL;
 
 	return file;
 }
@@ -206,6 +289,35 @@ BufFileCreateTemp(bool interXact)
 	return file;
 }
 
+/*
+ * Create a BufFile for a new temporary file, like BufFileCreateTemp, but
+ * compressed with the method selected by temp_file_compression.
+ *
+ * This is meant for large files that are mostly written and read a block
+ * at a time, like the spill files of sorts and hash joins.  Seeking to
+ * another block means decompressing it, and writing to a block that was
+ * already written stores the whole block again.
+ */
+BufFile *
+BufFileCreateCompressedTemp(bool interXact)
+{
+	BufFile    *file = BufFileCreateTemp(interXact);
+
+	if (temp_file_compression == TEMP_FILE_COMPRESSION_NONE)
+		return file;
+
+	if (compressBuffer == NULL)
+		compressBuffer = MemoryContextAlloc(TopMemoryContext,
+											PGLZ_MAX_OUTPUT(BLCKSZ));
+
+	file->compression = temp_file_compression;
+	file->maxBlocks = 16;
+	file->blocks = (BufFileBlock *) palloc(sizeof(BufFileBlock) *
+										   file->maxBlocks);
+
+	return file;
+}
+
 /*
  * Build the name for a given segment of a given BufFile.
  */
@@ -392,12 +504,24 @@ BufFileClose(BufFile *file)
 {
 	int			i;
 
-	/* flush any unwritten data */
-	BufFileFlush(file);
+	/* flush any unwritten data; a compressed file is never shared */
+	if (file->compression == TEMP_FILE_COMPRESSION_NONE)
+		BufFileFlush(file);
 	/* close and delete the underlying file(s) */
 	for (i = 0; i < file->numFiles; i++)
 		FileClose(file->files[i]);
 	/* release the buffer space */
+	if (file->blocks)
+		pfree(file->blocks);
+	if (file->freeExtents)
+	{
+		for (i = 0; i < BUFFILE_NUM_EXTENT_SIZES; i++)
+		{
+			if (file->freeExtents[i].pos)
+				pfree(file->freeExtents[i].pos);
+		}
+		pfree(file->freeExtents);
+	}
 	pfree(file->files);
 	pfree(file);
 }
@@ -541,6 +665,9 @@ BufFileRead(BufFile *file, void *ptr, size_t size)
 	size_t		nread = 0;
 	size_t		nthistime;
 
+	if (file->compression != TEMP_FILE_COMPRESSION_NONE)
+		return BufFileReadCompressed(file, ptr, size);
+
 	BufFileFlush(file);
 
 	while (size > 0)
@@ -585,6 +712,12 @@ BufFileWrite(BufFile *file, void *ptr, size_t size)
 
 	Assert(!file->readOnly);
 
+	if (file->compression != TEMP_FILE_COMPRESSION_NONE)
+	{
+		BufFileWriteCompressed(file, ptr, size);
+		return;
+	}
+
 	while (size > 0)
 	{
 		if (file->pos >= BLCKSZ)
@@ -648,6 +781,9 @@ BufFileSeek(BufFile *file, int fileno, off_t offset, int whence)
 	int			newFile;
 	off_t		newOffset;
 
+	if (file->compression != TEMP_FILE_COMPRESSION_NONE)
+		return BufFileSeekCompressed(file, fileno, offset, whence);
+
 	switch (whence)
 	{
 		case SEEK_SET:
@@ -838,3 +974,427 @@ BufFileAppend(BufFile *target, BufFile *source)
 
 	return startBlock;
 }
+
+/*
+ * Return the number of the block of a compressed file that the buffer is for.
+ */
+static long
+BufFileCurrentBlock(BufFile *file)
+{
+	Assert(file->curOffset % BLCKSZ == 0);
+
+	return (long) file->curFile * BUFFILE_SEG_SIZE + file->curOffset / BLCKSZ;
+}
+
+/*
+ * BufFileLoadBlock
+ *
+ * Read in and decompress the current block of a compressed file.  A block
+ * that was never written reads as empty if it's past the end of the file,
+ * and as zeroes otherwise, like a hole in an uncompressed file.
+ */
+static void
+BufFileLoadBlock(BufFile *file)
+{
+	long		blknum = BufFileCurrentBlock(file);
+	BufFileBlock *block;
+	File		thisfile;
+	int			nread;
+	int			len = -1;
+
+	Assert(!file->dirty && !file->blockLoaded);
+
+	file->blockLoaded = true;
+
+	if (blknum >= file->numBlocks)
+	{
+		file->nbytes = 0;
+		return;
+	}
+
+	block = &file->blocks[blknum];
+	if (block->pos < 0)
+	{
+		MemSet(file->buffer.data, 0, BLCKSZ);
+		file->nbytes = BLCKSZ;
+		return;
+	}
+
+	thisfile = file->files[block->pos / MAX_PHYSICAL_FILESIZE];
+	nread = FileRead(thisfile,
+					 block->clen < block->rawlen ? compressBuffer : file->buffer.data,
+					 block->clen,
+					 block->pos % MAX_PHYSICAL_FILESIZE,
+					 WAIT_EVENT_BUFFILE_READ);
+	if (nread != block->clen)
+	{
+		file->blockLoaded = false;
+		if (nread < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not read file \"%s\": %m",
+							FilePathName(thisfile))));
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not read file \"%s\": read only %d of %d bytes",
+						FilePathName(thisfile), nread, block->clen)));
+	}
+
+	if (block->clen == block->rawlen)
+		len = block->rawlen;	/* stored uncompressed */
+	else
+	{
+		switch (file->compression)
+		{
+			case TEMP_FILE_COMPRESSION_PGLZ:
+				len = pglz_decompress(compressBuffer, block->clen,
+									  file->buffer.data, block->rawlen, true);
+				break;
+			case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+				len = LZ4_decompress_safe(compressBuffer, file->buffer.data,
+										  block->clen, block->rawlen);
+#endif
+				break;
+			case TEMP_FILE_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+				{
+					size_t		zlen;
+
+					zlen = ZSTD_decompress(file->buffer.data, block->rawlen,
+										   compressBuffer, block->clen);
+					len = ZSTD_isError(zlen) ? -1 : (int) zlen;
+				}
+#endif
+				break;
+		}
+	}
+
+	if (len != block->rawlen)
+	{
+		file->blockLoaded = false;
+		ereport(ERROR,
+				(errcode(ERRCODE_DATA_CORRUPTED),
+				 errmsg("could not decompress block %ld of temporary file \"%s\"",
+						blknum, FilePathName(thisfile))));
+	}
+
+	file->nbytes = block->rawlen;
+	pgBufferUsage.temp_blks_read++;
+}
+
+/*
+ * BufFileDumpBlock
+ *
+ * Compress the current block of a compressed file and write it out.  Unlike
+ * BufFileDumpBuffer, this leaves the buffer and the position alone.
+ */
+static void
+BufFileDumpBlock(BufFile *file)
+{
+	long		blknum = BufFileCurrentBlock(file);
+	BufFileBlock *block;
+	char	   *data = compressBuffer;
+	int			len = -1;
+	int64		pos;
+	File		thisfile;
+	int			nwritten;
+
+	Assert(file->dirty && file->blockLoaded && file->nbytes > 0);
+
+	/* Only keep the compressed version if it saves something */
+	switch (file->compression)
+	{
+		case TEMP_FILE_COMPRESSION_PGLZ:
+			len = pglz_compress(file->buffer.data, file->nbytes,
+								compressBuffer, PGLZ_strategy_default);
+			break;
+		case TEMP_FILE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_compress_default(file->buffer.data, compressBuffer,
+									   file->nbytes, file->nbytes - 1);
+			if (len <= 0)
+				len = -1;
+#endif
+			break;
+		case TEMP_FILE_COMPRESSION_ZSTD:
+#ifdef USE_ZSTD
+			{
+				size_t		zlen;
+
+				zlen = ZSTD_compress(compressBuffer, file->nbytes - 1,
+									 file->buffer.data, file->nbytes,
+									 BUFFILE_ZSTD_LEVEL);
+				len = ZSTD_isError(zlen) ? -1 : (int) zlen;
+			}
+#endif
+			break;
+	}
+	if (len < 0 || len >= file->nbytes)
+	{
+		data = file->buffer.data;
+		len = file->nbytes;
+	}
+
+	/* Make room in the block map */
+	if (blknum >= file->maxBlocks)
+	{
+		long		newmax = file->maxBlocks;
+
+		while (blknum >= newmax)
+			newmax *= 2;
+		file->blocks = (BufFileBlock *)
+			repalloc_huge(file->blocks, sizeof(BufFileBlock) * newmax);
+		file->maxBlocks = newmax;
+	}
+	while (file->numBlocks <= blknum)
+		file->blocks[file->numBlocks++].pos = -1;
+
+	/* Store the block anew, releasing the space of its previous version */
+	block = &file->blocks[blknum];
+	if (block->pos >= 0)
+	{
+		BufFileFreeExtent(file, block->pos, block->clen);
+		block->pos = -1;
+	}
+	pos = BufFileAllocExtent(file, len);
+
+	thisfile = file->files[pos / MAX_PHYSICAL_FILESIZE];
+	nwritten = FileWrite(thisfile, data, len, pos % MAX_PHYSICAL_FILESIZE,
+						 WAIT_EVENT_BUFFILE_WRITE);
+	if (nwritten != len)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not write to file \"%s\": %m",
+						FilePathName(thisfile))));
+
+	block->pos = pos;
+	block->clen = len;
+	block->rawlen = file->nbytes;
+	file->dirty = false;
+
+	pgBufferUsage.temp_blks_written++;
+}
+
+/*
+ * Move on to the start of the next block of a compressed file.
+ */
+static void
+BufFileNextBlock(BufFile *file)
+{
+	Assert(file->pos == BLCKSZ);
+
+	if (file->dirty)
+		BufFileDumpBlock(file);
+
+	file->curOffset += BLCKSZ;
+	if (file->curOffset >= MAX_PHYSICAL_FILESIZE)
+	{
+		file->curFile++;
+		file->curOffset = 0L;
+	}
+	file->pos = 0;
+	file->nbytes = 0;
+	file->blockLoaded = false;
+}
+
+/*
+ * Find space for a compressed block of the given size in the physical files.
+ * Free space of the right size is reused; otherwise the space is taken from
+ * the end, skipping to the next physical file rather than straddling two.
+ */
+static int64
+BufFileAllocExtent(BufFile *file, int size)
+{
+	int			sizeclass = (size - 1) / BUFFILE_EXTENT_UNIT;
+	int64		pos;
+
+	if (file->freeExtents != NULL && file->freeExtents[sizeclass].num > 0)
+	{
+		BufFileExtentList *list = &file->freeExtents[sizeclass];
+
+		return list->pos[--list->num];
+	}
+
+	pos = file->physicalEnd;
+	if (pos % MAX_PHYSICAL_FILESIZE + size > MAX_PHYSICAL_FILESIZE)
+		pos += MAX_PHYSICAL_FILESIZE - pos % MAX_PHYSICAL_FILESIZE;
+	while (pos / MAX_PHYSICAL_FILESIZE >= file->numFiles)
+		extendBufFile(file);
+
+	file->physicalEnd = pos + (sizeclass + 1) * BUFFILE_EXTENT_UNIT;
+
+	return pos;
+}
+
+/*
+ * Remember the space of a compressed block for reuse.
+ */
+static void
+BufFileFreeExtent(BufFile *file, int64 pos, int size)
+{
+	int			sizeclass = (size - 1) / BUFFILE_EXTENT_UNIT;
+	BufFileExtentList *list;
+
+	/* Same memory context as the block map */
+	if (file->freeExtents == NULL)
+		file->freeExtents = (BufFileExtentList *)
+			MemoryContextAllocZero(GetMemoryChunkContext(file->blocks),
+								   sizeof(BufFileExtentList) * BUFFILE_NUM_EXTENT_SIZES);
+
+	list = &file->freeExtents[sizeclass];
+	if (list->num >= list->max)
+	{
+		if (list->pos == NULL)
+		{
+			list->max = 16;
+			list->pos = (int64 *)
+				MemoryContextAlloc(GetMemoryChunkContext(file->blocks),
+								   sizeof(int64) * list->max);
+		}
+		else
+		{
+			list->max *= 2;
+			list->pos = (int64 *)
+				repalloc_huge(list->pos, sizeof(int64) * list->max);
+		}
+	}
+	list->pos[list->num++] = pos;
+}
+
+/*
+ * BufFileRead for a compressed file.
+ */
+static size_t
+BufFileReadCompressed(BufFile *file, void *ptr, size_t size)
+{
+	size_t		nread = 0;
+	size_t		nthistime;
+
+	while (size > 0)
+	{
+		if (file->pos >= BLCKSZ)
+			BufFileNextBlock(file);
+		if (!file->blockLoaded)
+			BufFileLoadBlock(file);
+		if (file->pos >= file->nbytes)
+			break;				/* no more data available */
+
+		nthistime = file->nbytes - file->pos;
+		if (nthistime > size)
+			nthistime = size;
+
+		memcpy(ptr, file->buffer.data + file->pos, nthistime);
+
+		file->pos += nthistime;
+		ptr = (void *) ((char *) ptr + nthistime);
+		size -= nthistime;
+		nread += nthistime;
+	}
+
+	return nread;
+}
+
+/*
+ * BufFileWrite for a compressed file.
+ */
+static void
+BufFileWriteCompressed(BufFile *file, void *ptr, size_t size)
+{
+	size_t		nthistime;
+
+	while (size > 0)
+	{
+		if (file->pos >= BLCKSZ)
+			BufFileNextBlock(file);
+		if (!file->blockLoaded)
+		{
+			/* no need to read in a block that is overwritten entirely */
+			if (file->pos == 0 && size >= BLCKSZ)
+			{
+				file->nbytes = 0;
+				file->blockLoaded = true;
+			}
+			else
+				BufFileLoadBlock(file);
+		}
+
+		/* writing past the end of the data leaves zeroes in between */
+		if (file->pos > file->nbytes)
+			MemSet(file->buffer.data + file->nbytes, 0,
+				   file->pos - file->nbytes);
+
+		nthistime = BLCKSZ - file->pos;
+		if (nthistime > size)
+			nthistime = size;
+		Assert(nthistime > 0);
+
+		memcpy(file->buffer.data + file->pos, ptr, nthistime);
+
+		file->dirty = true;
+		file->pos += nthistime;
+		if (file->nbytes < file->pos)
+			file->nbytes = file->pos;
+		ptr = (void *) ((char *) ptr + nthistime);
+		size -= nthistime;
+	}
+}
+
+/*
+ * BufFileSeek for a compressed file.  Seeking past the end of the data is
+ * allowed up to the start of the block after the last one.
+ */
+static int
+BufFileSeekCompressed(BufFile *file, int fileno, off_t offset, int whence)
+{
+	int64		newPos;
+	long		newBlock;
+	long		curBlock = BufFileCurrentBlock(file);
+	long		endBlock;
+
+	switch (whence)
+	{
+		case SEEK_SET:
+			if (fileno < 0)
+				return EOF;
+			newPos = (int64) fileno * MAX_PHYSICAL_FILESIZE + offset;
+			break;
+		case SEEK_CUR:
+			newPos = (int64) file->curFile * MAX_PHYSICAL_FILESIZE +
+				file->curOffset + file->pos + offset;
+			break;
+		default:
+			elog(ERROR, "invalid whence: %d", whence);
+			return EOF;
+	}
+	if (newPos < 0)
+		return EOF;
+
+	endBlock = file->numBlocks;
+	if (file->dirty && curBlock >= endBlock)
+		endBlock = curBlock + 1;
+
+	newBlock = (long) (newPos / BLCKSZ);
+	if (newBlock > endBlock)
+		return EOF;
+
+	if (newBlock != curBlock)
+	{
+		/* a seek to the end of the current block stays with it */
+		if (newBlock == curBlock + 1 && newPos % BLCKSZ == 0)
+		{
+			file->pos = BLCKSZ;
+			return 0;
+		}
+
+		if (file->dirty)
+			BufFileDumpBlock(file);
+		file->curFile = (int) (newPos / MAX_PHYSICAL_FILESIZE);
+		file->curOffset = newBlock % BUFFILE_SEG_SIZE * (off_t) BLCKSZ;
+		file->nbytes = 0;
+		file->blockLoaded = false;
+	}
+	file->pos = (int) (newPos % BLCKSZ);
+
+	return 0;
+}
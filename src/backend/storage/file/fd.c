@@ -91,6 +91,7 @@
 #include "common/file_perm.h"
 #include "miscadmin.h"
 #include "pgstat.h"
+#include "port/pg_iovec.h"
 #include "portability/mem.h"
 #include "storage/fd.h"
 #include "storage/ipc.h"
@@ -2025,6 +2026,61 @@ retry:
 	return returnCode;
 }
 
+/*
+ * Read into several buffers from consecutive positions of a file, starting
+ * at the given offset, with a single system call where the platform has
+ * preadv().  Like FileRead, returns the number of bytes read, which is
+ * less than the total size of the buffers only at the end of the file.
+ */
+int
+FileReadV(File file, const struct iovec *iov, int iovcnt, off_t offset,
+		  uint32 wait_event_info)
+{
+	int			returnCode;
+#ifdef HAVE_PREADV
+	Vfd		   *vfdP;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FileReadV: %d (%s) " INT64_FORMAT " %d",
+			   file, VfdCache[file].fileName,
+			   (int64) offset, iovcnt));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	vfdP = &VfdCache[file];
+
+retry:
+	pgstat_report_wait_start(wait_event_info);
+	returnCode = preadv(vfdP->fd, iov, iovcnt, offset);
+	pgstat_report_wait_end();
+
+	/* OK to retry if interrupted */
+	if (returnCode < 0 && errno == EINTR)
+		goto retry;
+#else
+	int			i;
+	int			total = 0;
+
+	/* Do it one buffer at a time */
+	for (i = 0; i < iovcnt; i++)
+	{
+		returnCode = FileRead(file, iov[i].iov_base, iov[i].iov_len,
+							  offset + total, wait_event_info);
+		if (returnCode < 0)
+			return returnCode;
+		total += returnCode;
+		if (returnCode < iov[i].iov_len)
+			break;
+	}
+	returnCode = total;
+#endif
+
+	return returnCode;
+}
+
 int
 FileWrite(File file, char *buffer, int amount, off_t offset,
 		  uint32 wait_event_info)
@@ -2123,6 +2179,73 @@ retry:
 	return returnCode;
 }
 
+/*
+ * Write several buffers to consecutive positions of a file, starting at the
+ * given offset, with a single system call where the platform has
+ * pwritev().  Like FileWrite, returns the number of bytes written; if that
+ * is less than the total size of the buffers, errno is set.  Not for
+ * temporary files subject to temp_file_limit.
+ */
+int
+FileWriteV(File file, const struct iovec *iov, int iovcnt, off_t offset,
+		   uint32 wait_event_info)
+{
+	int			returnCode;
+#ifdef HAVE_PWRITEV
+	Vfd		   *vfdP;
+	int			amount = 0;
+	int			i;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FileWriteV: %d (%s) " INT64_FORMAT " %d",
+			   file, VfdCache[file].fileName,
+			   (int64) offset, iovcnt));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	vfdP = &VfdCache[file];
+	Assert(!(vfdP->fdstate & FD_TEMP_FILE_LIMIT));
+
+	for (i = 0; i < iovcnt; i++)
+		amount += iov[i].iov_len;
+
+retry:
+	errno = 0;
+	pgstat_report_wait_start(wait_event_info);
+	returnCode = pwritev(vfdP->fd, iov, iovcnt, offset);
+	pgstat_report_wait_end();
+
+	/* if write didn't set errno, assume problem is no disk space */
+	if (returnCode != amount && errno == 0)
+		errno = ENOSPC;
+
+	/* OK to retry if interrupted */
+	if (returnCode < 0 && errno == EINTR)
+		goto retry;
+#else
+	int			i;
+	int			total = 0;
+
+	/* Do it one buffer at a time */
+	for (i = 0; i < iovcnt; i++)
+	{
+		returnCode = FileWrite(file, iov[i].iov_base, iov[i].iov_len,
+							   offset + total, wait_event_info);
+		if (returnCode < 0)
+			return returnCode;
+		total += returnCode;
+		if (returnCode < iov[i].iov_len)
+			break;
+	}
+	returnCode = total;
+#endif
+
+	return returnCode;
+}
+
 int
 FileSync(File file, uint32 wait_event_info)
 {
@@ -2190,6 +2313,40 @@ FileTruncate(File file, off_t offset, uint32 wait_event_info)
 	return returnCode;
 }
 
+/*
+ * Deallocate a range of a file without changing its size, leaving a hole
+ * that reads as zeroes.  Fails with EOPNOTSUPP where the platform or the
+ * filesystem doesn't support that.
+ */
+int
+FilePunchHole(File file, off_t offset, off_t amount, uint32 wait_event_info)
+{
+#ifdef FALLOC_FL_PUNCH_HOLE
+	int			returnCode;
+
+	Assert(FileIsValid(file));
+
+	DO_DB(elog(LOG, "FilePunchHole %d (%s) " INT64_FORMAT " " INT64_FORMAT,
+			   file, VfdCache[file].fileName,
+			   (int64) offset, (int64) amount));
+
+	returnCode = FileAccess(file);
+	if (returnCode < 0)
+		return returnCode;
+
+	pgstat_report_wait_start(wait_event_info);
+	returnCode = fallocate(VfdCache[file].fd,
+						   FALLOC_FL_PUNCH_HOLE | FALLOC_FL_KEEP_SIZE,
+						   offset, amount);
+	pgstat_report_wait_end();
+
+	return returnCode;
+#else
+	errno = EOPNOTSUPP;
+	return -1;
+#endif
+}
+
 /*
  * Return the pathname associated with an open file.
  *
@@ -2205,7 +2362,9 @@ FilePathName(File file)
 }
 
 /*
- * Return the raw file descriptor of an opened file.
+ * Return the raw file descriptor of an opened file, reopening it if we
+ * closed it to stay under max_safe_fds.  Returns -1 with errno set if that
+ * fails.
  *
  * The returned file descriptor will be valid until the file is closed, but
  * there are a lot of things that can make that happen.  So the caller should
@@ -2216,6 +2375,9 @@ int
 FileGetRawDesc(File file)
 {
 	Assert(FileIsValid(file));
+
+	if (FileAccess(file) < 0)
+		return -1;
 	return VfdCache[file].fd;
 }
 
@@ -15,13 +15,16 @@
 #include "postgres.h"
 
 #include "access/clog.h"
+#include "access/colcache.h"
 #include "access/commit_ts.h"
 #include "access/heapam.h"
 #include "access/multixact.h"
 #include "access/nbtree.h"
+#include "access/parallelredo.h"
 #include "access/subtrans.h"
 #include "access/syncscan.h"
 #include "access/twophase.h"
+#include "access/xlogprefetch.h"
 #include "commands/async.h"
 #include "miscadmin.h"
 #include "pgstat.h"
@@ -34,6 +37,7 @@
 #include "replication/slot.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
+#include "storage/aio.h"
 #include "storage/bufmgr.h"
 #include "storage/dsm.h"
 #include "storage/ipc.h"
@@ -149,6 +153,10 @@ CreateSharedMemoryAndSemaphores(void)
 		size = add_size(size, BTreeShmemSize());
 		size = add_size(size, SyncScanShmemSize());
 		size = add_size(size, AsyncShmemSize());
+		size = add_size(size, AioShmemSize());
+		size = add_size(size, ParallelRedoShmemSize());
+		size = add_size(size, XLogPrefetchShmemSize());
+		size = add_size(size, ColumnarCacheShmemSize());
 #ifdef EXEC_BACKEND
 		size = add_size(size, ShmemBackendArraySize());
 #endif
@@ -267,6 +275,10 @@ CreateSharedMemoryAndSemaphores(void)
 	BTreeShmemInit();
 	SyncScanShmemInit();
 	AsyncShmemInit();
+	AioShmemInit();
+	ParallelRedoShmemInit();
+	XLogPrefetchShmemInit();
+	ColumnarCacheShmemInit();
 
 #ifdef EXEC_BACKEND
 
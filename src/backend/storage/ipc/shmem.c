@@ -69,6 +69,7 @@
 #include "fmgr.h"
 #include "funcapi.h"
 #include "miscadmin.h"
+#include "port/pg_numa.h"
 #include "storage/lwlock.h"
 #include "storage/pg_shmem.h"
 #include "storage/shmem.h"
@@ -90,6 +91,8 @@ slock_t    *ShmemLock;			/* spinlock for shared memory and LWLock
 
 static HTAB *ShmemIndex = NULL; /* primary index hashtable for shmem */
 
+int			MyNumaNode = -1;	/* NUMA node we're tied to, or -1 */
+
 
 /*
  *	InitShmemAccess() --- set up basic pointers to shared memory.
@@ -107,6 +110,92 @@ InitShmemAccess(void *seghdr)
 	ShmemEnd = (char *) ShmemBase + shmhdr->totalsize;
 }
 
+/*
+ *	ShmemNumaInit() --- spread shared memory over the NUMA nodes.
+ *
+ * With shared_memory_numa = interleave or partition, the pages of the
+ * segment are interleaved over all nodes, as they are first touched; with
+ * partition, InitBufferPool() then gives each node a share of the buffers.
+ * Otherwise, each page ends up on the node of the process that happens to
+ * touch it first, which mostly means the postmaster's.
+ *
+ * This should be called only in the postmaster or a standalone backend,
+ * before the segment is filled.
+ */
+static void
+ShmemNumaInit(void)
+{
+	if (shared_memory_numa == SHMEM_NUMA_OFF)
+		return;
+
+	if (pg_numa_init() == -1)
+	{
+		ereport(LOG,
+				(errmsg("NUMA is not available on this system, shared memory will not be spread over NUMA nodes")));
+		return;
+	}
+
+	ShmemSegHdr->numa_nodes = pg_numa_get_max_node() + 1;
+	pg_numa_interleave_memory(ShmemSegHdr, ShmemSegHdr->totalsize);
+}
+
+/*
+ *	ShmemNumaNodes() --- number of NUMA nodes shared memory is spread over.
+ *
+ * Returns 0 if it isn't spread.
+ */
+int
+ShmemNumaNodes(void)
+{
+	return ShmemSegHdr->numa_nodes;
+}
+
+/*
+ *	ShmemNumaBind() --- have a piece of shared memory allocated on one node.
+ *
+ * Only whole pages can be placed, so pages that the piece shares with its
+ * neighbours are left alone.  That includes all of a piece smaller than a
+ * page, which matters with huge pages.
+ */
+void
+ShmemNumaBind(void *start, Size size, int node)
+{
+	Size		pagesize = ShmemSegHdr->pagesize;
+	char	   *first = (char *) TYPEALIGN(pagesize, start);
+	char	   *end = (char *) TYPEALIGN_DOWN(pagesize, (char *) start + size);
+
+	Assert(node >= 0 && node < ShmemSegHdr->numa_nodes);
+
+	if (end > first)
+		pg_numa_bind_memory(first, end - first, node);
+}
+
+/*
+ *	ShmemNumaPinProcess() --- tie this process to a NUMA node.
+ *
+ * With shared_memory_numa = partition and numa_pin_backends, each process
+ * runs on the CPUs of the node chosen by its PGPROC number, and allocates
+ * buffers from that node's share of the buffer pool, see StrategyGetBuffer().
+ */
+void
+ShmemNumaPinProcess(int pgprocno)
+{
+	int			nodes = ShmemSegHdr->numa_nodes;
+
+	if (!numa_pin_backends || shared_memory_numa != SHMEM_NUMA_PARTITION ||
+		nodes <= 1)
+		return;
+
+	/* The node may have no CPUs, if so just carry on untied */
+	if (pg_numa_run_on_node(pgprocno % nodes) == -1)
+	{
+		elog(DEBUG1, "could not run on NUMA node %d: %m", pgprocno % nodes);
+		return;
+	}
+
+	MyNumaNode = pgprocno % nodes;
+}
+
 /*
  *	InitShmemAllocation() --- set up shared-memory space allocation.
  *
@@ -120,6 +209,9 @@ InitShmemAllocation(void)
 
 	Assert(shmhdr != NULL);
 
+	/* Spread the segment over the NUMA nodes before we start filling it */
+	ShmemNumaInit();
+
 	/*
 	 * Initialize the spinlock used by ShmemAlloc.  We must use
 	 * ShmemAllocUnlocked, since obviously ShmemAlloc can't be called yet.
@@ -605,3 +697,143 @@ pg_get_shmem_allocations(PG_FUNCTION_ARGS)
 
 	return (Datum) 0;
 }
+
+/*
+ * SQL SRF showing how much of each allocation from the main shared memory
+ * segment is on each NUMA node
+ *
+ * The kernel only knows the node of pages that some process has touched, so
+ * we touch all the pages first.  Pages shared between two allocations are
+ * counted for both.  That can take a while for a large segment, so we do it
+ * on a copy of the index entries, without holding ShmemIndexLock; the
+ * allocations themselves are never freed.
+ */
+Datum
+pg_get_shmem_allocations_numa(PG_FUNCTION_ARGS)
+{
+#define PG_GET_SHMEM_NUMA_SIZES_COLS 3
+#define NUMA_QUERY_PAGES 1024
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	HASH_SEQ_STATUS hstat;
+	ShmemIndexEnt *ent;
+	ShmemIndexEnt *ents;
+	int			nents = 0;
+	int			entno;
+	Size		pagesize = ShmemSegHdr->pagesize;
+	int			max_node;
+	Size	   *node_sizes;
+	void	   *pages[NUMA_QUERY_PAGES];
+	int			status[NUMA_QUERY_PAGES];
+	Datum		values[PG_GET_SHMEM_NUMA_SIZES_COLS];
+	bool		nulls[PG_GET_SHMEM_NUMA_SIZES_COLS];
+
+#ifndef USE_LIBNUMA
+	ereport(ERROR,
+			(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+			 errmsg("NUMA is not supported by this build"),
+			 errdetail("This functionality requires the server to be built with libnuma support."),
+			 errhint("You need to rebuild PostgreSQL using %s.", "--with-libnuma")));
+#endif
+
+	if (pg_numa_init() == -1)
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("NUMA is not available on this system")));
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	max_node = pg_numa_get_max_node();
+	node_sizes = (Size *) palloc((max_node + 1) * sizeof(Size));
+
+	LWLockAcquire(ShmemIndexLock, LW_SHARED);
+
+	ents = (ShmemIndexEnt *)
+		palloc(hash_get_num_entries(ShmemIndex) * sizeof(ShmemIndexEnt));
+	hash_seq_init(&hstat, ShmemIndex);
+	while ((ent = (ShmemIndexEnt *) hash_seq_search(&hstat)) != NULL)
+		ents[nents++] = *ent;
+
+	LWLockRelease(ShmemIndexLock);
+
+	memset(nulls, 0, sizeof(nulls));
+	for (entno = 0; entno < nents; entno++)
+	{
+		char	   *ptr;
+		char	   *end;
+		int			node;
+
+		ent = &ents[entno];
+		ptr = (char *) TYPEALIGN_DOWN(pagesize, ent->location);
+		end = (char *) TYPEALIGN(pagesize,
+								 (char *) ent->location + ent->allocated_size);
+
+		memset(node_sizes, 0, (max_node + 1) * sizeof(Size));
+
+		while (ptr < end)
+		{
+			int			npages = 0;
+			int			i;
+
+			CHECK_FOR_INTERRUPTS();
+
+			while (ptr < end && npages < NUMA_QUERY_PAGES)
+			{
+				(void) *(volatile char *) ptr;
+				pages[npages++] = ptr;
+				ptr += pagesize;
+			}
+
+			if (pg_numa_query_pages(0, npages, pages, status) == -1)
+				ereport(ERROR,
+						(errmsg("could not query NUMA nodes of shared memory pages: %m")));
+
+			for (i = 0; i < npages; i++)
+			{
+				if (status[i] >= 0 && status[i] <= max_node)
+					node_sizes[status[i]] += pagesize;
+			}
+		}
+
+		for (node = 0; node <= max_node; node++)
+		{
+			if (node_sizes[node] == 0)
+				continue;
+
+			values[0] = CStringGetTextDatum(ent->key);
+			values[1] = Int32GetDatum(node);
+			values[2] = Int64GetDatum(node_sizes[node]);
+
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+	}
+
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
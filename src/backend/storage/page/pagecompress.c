@@ -0,0 +1,145 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.c
+ *	  On-disk compression of whole data pages.
+ *
+ * Heap pages that VACUUM has found to be all-frozen are marked
+ * PD_COMPRESSIBLE if their table has the page_compression storage
+ * parameter.  md.c then writes such pages out compressed, punching a hole
+ * in the file for the unused tail of the block, and decompresses them
+ * transparently when they are read back.  See storage/pagecompress.h for
+ * the image format.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ *
+ * IDENTIFICATION
+ *	  src/backend/storage/page/pagecompress.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#ifdef USE_LZ4
+#include <lz4.h>
+#endif
+
+#include "access/xlog.h"
+#include "common/pg_lzcompress.h"
+#include "storage/checksum.h"
+#include "storage/pagecompress.h"
+
+/* Largest compressed size that still saves at least one filesystem block */
+#define PAGE_COMPRESS_MAX_DATA \
+	(BLCKSZ - PAGE_COMPRESS_ALIGN - (int) SizeOfCompressedPageHeaderData)
+
+/*
+ * PageCompress
+ *		Compress a page into an on-disk image.
+ *
+ * image must be a BLCKSZ-sized, suitably aligned buffer.  Returns the
+ * number of leading bytes of the image that need to be written, a multiple
+ * of PAGE_COMPRESS_ALIGN; the rest of it is zeroes.  Returns 0 if the page
+ * doesn't compress well enough to save any space.
+ */
+int
+PageCompress(Page page, BlockNumber blkno, char *image)
+{
+	CompressedPageHeaderData *hdr = (CompressedPageHeaderData *) image;
+	char	   *dest = image + SizeOfCompressedPageHeaderData;
+	PGAlignedBlock copy;
+	int32		len;
+	int			method;
+
+	if (PAGE_COMPRESS_MAX_DATA <= 0)
+		return 0;
+
+	/*
+	 * The caller may hold only a share lock on the buffer, so hint bits can
+	 * change while we work.  Compress a private copy, so that the image is
+	 * at least self-consistent.
+	 */
+	memcpy(copy.data, page, BLCKSZ);
+
+#ifdef USE_LZ4
+	len = LZ4_compress_default(copy.data, dest, BLCKSZ,
+							   PAGE_COMPRESS_MAX_DATA);
+	if (len <= 0)
+		return 0;
+	method = PAGE_COMPRESSION_LZ4;
+#else
+	{
+		char		buf[PGLZ_MAX_OUTPUT(BLCKSZ)];
+
+		len = pglz_compress(copy.data, BLCKSZ, buf, PGLZ_strategy_default);
+		if (len < 0 || len > PAGE_COMPRESS_MAX_DATA)
+			return 0;
+		memcpy(dest, buf, len);
+	}
+	method = PAGE_COMPRESSION_PGLZ;
+#endif
+
+	len += SizeOfCompressedPageHeaderData;
+	memset(image + len, 0, BLCKSZ - len);
+
+	hdr->pd_lsn = ((PageHeader) copy.data)->pd_lsn;
+	hdr->pd_checksum = 0;
+	hdr->pd_flags = PD_COMPRESSED_IMAGE;
+	hdr->pd_compressed_size = len - SizeOfCompressedPageHeaderData;
+	hdr->pd_method = method;
+
+	/*
+	 * Give the image a checksum of its own, so that tools that verify the
+	 * checksums of the files without decompressing anything, like
+	 * pg_checksums and base backups, are happy with it.
+	 */
+	if (DataChecksumsEnabled())
+		hdr->pd_checksum = pg_checksum_page(image, blkno);
+
+	return TYPEALIGN(PAGE_COMPRESS_ALIGN, len);
+}
+
+/*
+ * PageDecompress
+ *		Replace a compressed on-disk image with the page it holds.
+ *
+ * Returns false if the image is corrupt.
+ */
+bool
+PageDecompress(char *buffer)
+{
+	CompressedPageHeaderData *hdr = (CompressedPageHeaderData *) buffer;
+	char	   *source = buffer + SizeOfCompressedPageHeaderData;
+	int32		slen = hdr->pd_compressed_size;
+	int32		len = -1;
+	PGAlignedBlock tmp;
+
+	if (slen <= 0 || slen > BLCKSZ - SizeOfCompressedPageHeaderData)
+		return false;
+
+	switch (hdr->pd_method)
+	{
+		case PAGE_COMPRESSION_PGLZ:
+			len = pglz_decompress(source, slen, tmp.data, BLCKSZ, true);
+			break;
+
+		case PAGE_COMPRESSION_LZ4:
+#ifdef USE_LZ4
+			len = LZ4_decompress_safe(source, tmp.data, slen, BLCKSZ);
+#else
+			ereport(ERROR,
+					(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+					 errmsg("could not decompress page compressed with LZ4"),
+					 errdetail("This functionality requires the server to be built with lz4 support."),
+					 errhint("You need to rebuild PostgreSQL using %s.", "--with-lz4")));
+#endif
+			break;
+	}
+
+	if (len != BLCKSZ)
+		return false;
+
+	memcpy(buffer, tmp.data, BLCKSZ);
+	return true;
+}
@@ -31,10 +31,12 @@
 #include "miscadmin.h"
 #include "pg_trace.h"
 #include "pgstat.h"
+#include "port/pg_iovec.h"
 #include "postmaster/bgwriter.h"
 #include "storage/bufmgr.h"
 #include "storage/fd.h"
 #include "storage/md.h"
+#include "storage/pagecompress.h"
 #include "storage/relfilenode.h"
 #include "storage/smgr.h"
 #include "storage/sync.h"
@@ -87,6 +89,9 @@ typedef struct _MdfdVec
 
 static MemoryContext MdCxt;		/* context for all MdfdVec objects */
 
+/* cleared once we find that we can't store compressed pages, see mdwrite */
+static bool hole_punching_supported = true;
+
 
 /* Populate a file tag describing an md.c segment file. */
 #define INIT_MD_FILETAG(a,xx_rnode,xx_forknum,xx_segno) \
@@ -139,6 +144,10 @@ static MdfdVec *_mdfd_getseg(SMgrRelation reln, ForkNumber forkno,
 							 BlockNumber blkno, bool skipFsync, int behavior);
 static BlockNumber _mdnblocks(SMgrRelation reln, ForkNumber forknum,
 							  MdfdVec *seg);
+static void mdwritev_finish(SMgrRelation reln, ForkNumber forknum, MdfdVec *v,
+							BlockNumber blocknum, int n, int nbytes,
+							bool skipFsync);
+static bool mdpage_compresses(ForkNumber forknum, char *buffer);
 
 
 /*
@@ -657,6 +666,234 @@ mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 							blocknum, FilePathName(v->mdfd_vfd),
 							nbytes, BLCKSZ)));
 	}
+	else if (PageIsCompressedImage(buffer))
+	{
+		/*
+		 * If the image is corrupt, leave it alone.  It is not a valid page,
+		 * so the caller's page verification will complain about it.
+		 */
+		(void) PageDecompress(buffer);
+	}
+}
+
+/*
+ * mdreadv_finish() -- Check the result of reading n blocks from segment v
+ *		into buffers, and decompress compressed page images.
+ *
+ * nbytes is the number of bytes read, or -1 with errno set on failure.
+ * Errors and short reads are handled as in mdread().
+ */
+static void
+mdreadv_finish(MdfdVec *v, BlockNumber blocknum, char **buffers, int n,
+			   int nbytes)
+{
+	int			nread;
+	int			i;
+
+	if (nbytes < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not read blocks %u..%u in file \"%s\": %m",
+						blocknum, blocknum + n - 1,
+						FilePathName(v->mdfd_vfd))));
+
+	nread = nbytes / BLCKSZ;
+	for (i = 0; i < n; i++)
+	{
+		if (i >= nread)
+		{
+			/* Short read, see mdread() */
+			if (zero_damaged_pages || InRecovery)
+				MemSet(buffers[i], 0, BLCKSZ);
+			else
+				ereport(ERROR,
+						(errcode(ERRCODE_DATA_CORRUPTED),
+						 errmsg("could not read block %u in file \"%s\": read only %d of %d bytes",
+								blocknum + i, FilePathName(v->mdfd_vfd),
+								i == nread ? nbytes % BLCKSZ : 0,
+								BLCKSZ)));
+		}
+		else if (PageIsCompressedImage(buffers[i]))
+			(void) PageDecompress(buffers[i]);
+	}
+}
+
+/*
+ *	mdreadv() -- Read a range of consecutive blocks from a relation.
+ *
+ *		The blocks are read into the given buffers with as few system calls
+ *		as possible: one per segment file touched, or per PG_IOV_MAX blocks.
+ *		Errors and short reads are handled as in mdread().
+ */
+void
+mdreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		char **buffers, BlockNumber nblocks)
+{
+	while (nblocks > 0)
+	{
+		struct iovec iov[PG_IOV_MAX];
+		off_t		seekpos;
+		int			nbytes;
+		int			i;
+		MdfdVec    *v;
+		BlockNumber segend;
+		BlockNumber n;
+
+		v = _mdfd_getseg(reln, forknum, blocknum, false,
+						 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+		seekpos = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+
+		Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
+
+		/* Don't cross a segment boundary, or read more than fits in iov */
+		segend = RELSEG_SIZE - blocknum % ((BlockNumber) RELSEG_SIZE);
+		n = Min(nblocks, segend);
+		n = Min(n, PG_IOV_MAX);
+
+		for (i = 0; i < n; i++)
+		{
+			iov[i].iov_base = buffers[i];
+			iov[i].iov_len = BLCKSZ;
+		}
+
+		TRACE_POSTGRESQL_SMGR_MD_READ_START(forknum, blocknum,
+											reln->smgr_rnode.node.spcNode,
+											reln->smgr_rnode.node.dbNode,
+											reln->smgr_rnode.node.relNode,
+											reln->smgr_rnode.backend);
+
+		nbytes = FileReadV(v->mdfd_vfd, iov, n, seekpos,
+						   WAIT_EVENT_DATA_FILE_READ);
+
+		TRACE_POSTGRESQL_SMGR_MD_READ_DONE(forknum, blocknum,
+										   reln->smgr_rnode.node.spcNode,
+										   reln->smgr_rnode.node.dbNode,
+										   reln->smgr_rnode.node.relNode,
+										   reln->smgr_rnode.backend,
+										   nbytes,
+										   BLCKSZ * n);
+
+		mdreadv_finish(v, blocknum, buffers, n, nbytes);
+
+		buffers += n;
+		blocknum += n;
+		nblocks -= n;
+	}
+}
+
+/*
+ *	mdfd() -- Get the kernel file descriptor and offset of a block, for
+ *		asynchronous I/O on it.
+ *
+ *		Also returns the number of blocks from blocknum to the end of the
+ *		segment file in *nblocks, as I/Os can't cross segment boundaries.
+ *		The result of a read must be passed to mdreadv_complete(), and that
+ *		of a write to mdwrite_complete().  Pages that mdwrite() would store
+ *		compressed must be written with mdwrite() instead.
+ */
+int
+mdfd(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+	 off_t *off, BlockNumber *nblocks)
+{
+	MdfdVec    *v;
+	int			fd;
+
+	v = _mdfd_getseg(reln, forknum, blocknum, false,
+					 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+	fd = FileGetRawDesc(v->mdfd_vfd);
+	if (fd < 0)
+		ereport(ERROR,
+				(errcode_for_file_access(),
+				 errmsg("could not open file \"%s\": %m",
+						FilePathName(v->mdfd_vfd))));
+
+	*off = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+	*nblocks = RELSEG_SIZE - blocknum % ((BlockNumber) RELSEG_SIZE);
+
+	return fd;
+}
+
+/*
+ *	mdreadv_complete() -- Finish an asynchronous read started with the file
+ *		descriptor from mdfd().  nbytes is the number of bytes read, or -1
+ *		with errno set.
+ */
+void
+mdreadv_complete(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				 char **buffers, BlockNumber nblocks, int nbytes)
+{
+	MdfdVec    *v;
+
+	v = _mdfd_getseg(reln, forknum, blocknum, false,
+					 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+	mdreadv_finish(v, blocknum, buffers, nblocks, nbytes);
+}
+
+/*
+ *	mdwrite_complete() -- Finish an asynchronous write of nblocks blocks
+ *		started with the file descriptor from mdfd().  nbytes is the number
+ *		of bytes written, or -1 with errno set.
+ */
+void
+mdwrite_complete(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				 BlockNumber nblocks, int nbytes, bool skipFsync)
+{
+	MdfdVec    *v;
+
+	v = _mdfd_getseg(reln, forknum, blocknum, skipFsync,
+					 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+	mdwritev_finish(reln, forknum, v, blocknum, nblocks, nbytes, skipFsync);
+}
+
+/*
+ * mdwritev_finish() -- Check the result of writing n blocks to segment v,
+ *		and register the segment for fsync.
+ *
+ * nbytes is the number of bytes written, or -1 with errno set on failure.
+ */
+static void
+mdwritev_finish(SMgrRelation reln, ForkNumber forknum, MdfdVec *v,
+				BlockNumber blocknum, int n, int nbytes, bool skipFsync)
+{
+	if (nbytes != BLCKSZ * n)
+	{
+		if (nbytes < 0)
+			ereport(ERROR,
+					(errcode_for_file_access(),
+					 errmsg("could not write blocks %u..%u in file \"%s\": %m",
+							blocknum, blocknum + n - 1,
+							FilePathName(v->mdfd_vfd))));
+		/* short write: complain appropriately */
+		ereport(ERROR,
+				(errcode(ERRCODE_DISK_FULL),
+				 errmsg("could not write blocks %u..%u in file \"%s\": wrote only %d of %d bytes",
+						blocknum, blocknum + n - 1,
+						FilePathName(v->mdfd_vfd),
+						nbytes, BLCKSZ * n),
+				 errhint("Check free disk space.")));
+	}
+
+	if (!skipFsync && !SmgrIsTemp(reln))
+		register_dirty_segment(reln, forknum, v);
+}
+
+/*
+ * mdpage_compresses() -- Will mdwrite() store this page compressed?
+ *
+ * Store the page compressed if VACUUM marked it so.  A compressed image
+ * doesn't survive a torn write the way an ordinary page with only some hint
+ * bits changed does, so this is only done when changes to hint bits are
+ * WAL-logged with full-page images.
+ */
+static bool
+mdpage_compresses(ForkNumber forknum, char *buffer)
+{
+	return forknum == MAIN_FORKNUM && PageIsCompressible(buffer) &&
+		hole_punching_supported && XLogHintBitIsNeeded();
 }
 
 /*
@@ -673,6 +910,8 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	off_t		seekpos;
 	int			nbytes;
 	MdfdVec    *v;
+	PGAlignedBlock image;
+	int			len = 0;
 
 	/* This assert is too expensive to have on normally ... */
 #ifdef CHECK_WRITE_VS_EXTEND
@@ -692,7 +931,34 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 
 	Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
 
-	nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_WRITE);
+	/* Store the page compressed if VACUUM marked it so */
+	if (mdpage_compresses(forknum, buffer))
+		len = PageCompress((Page) buffer, blocknum, image.data);
+
+	if (len > 0)
+	{
+		nbytes = FileWrite(v->mdfd_vfd, image.data, len, seekpos,
+						   WAIT_EVENT_DATA_FILE_WRITE);
+		if (nbytes == len)
+		{
+			if (FilePunchHole(v->mdfd_vfd, seekpos + len, BLCKSZ - len,
+							  WAIT_EVENT_DATA_FILE_WRITE) == 0)
+				nbytes = BLCKSZ;
+			else
+			{
+				if (errno == EOPNOTSUPP)
+					hole_punching_supported = false;
+
+				/* write the zeroes, then */
+				nbytes = FileWrite(v->mdfd_vfd, image.data + len, BLCKSZ - len,
+								   seekpos + len, WAIT_EVENT_DATA_FILE_WRITE);
+				if (nbytes >= 0)
+					nbytes += len;
+			}
+		}
+	}
+	else
+		nbytes = FileWrite(v->mdfd_vfd, buffer, BLCKSZ, seekpos, WAIT_EVENT_DATA_FILE_WRITE);
 
 	TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum,
 										reln->smgr_rnode.node.spcNode,
@@ -723,6 +989,84 @@ mdwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 		register_dirty_segment(reln, forknum, v);
 }
 
+/*
+ *	mdwritev() -- Write a range of consecutive blocks of a relation.
+ *
+ *		Like mdwrite() for each block in turn, but with as few system calls
+ *		as possible: one per segment file touched, or per PG_IOV_MAX blocks.
+ *		Pages to be stored compressed are written one at a time, with
+ *		mdwrite().
+ */
+void
+mdwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		 char **buffers, BlockNumber nblocks, bool skipFsync)
+{
+	while (nblocks > 0)
+	{
+		struct iovec iov[PG_IOV_MAX];
+		off_t		seekpos;
+		int			nbytes;
+		int			i;
+		MdfdVec    *v;
+		BlockNumber segend;
+		BlockNumber n;
+
+		if (mdpage_compresses(forknum, buffers[0]))
+		{
+			mdwrite(reln, forknum, blocknum, buffers[0], skipFsync);
+			buffers++;
+			blocknum++;
+			nblocks--;
+			continue;
+		}
+
+		v = _mdfd_getseg(reln, forknum, blocknum, skipFsync,
+						 EXTENSION_FAIL | EXTENSION_CREATE_RECOVERY);
+
+		seekpos = (off_t) BLCKSZ * (blocknum % ((BlockNumber) RELSEG_SIZE));
+
+		Assert(seekpos < (off_t) BLCKSZ * RELSEG_SIZE);
+
+		/* Don't cross a segment boundary, or write more than fits in iov */
+		segend = RELSEG_SIZE - blocknum % ((BlockNumber) RELSEG_SIZE);
+		n = Min(nblocks, segend);
+		n = Min(n, PG_IOV_MAX);
+
+		for (i = 0; i < n; i++)
+		{
+			/* stop before a page to be compressed */
+			if (i > 0 && mdpage_compresses(forknum, buffers[i]))
+				break;
+			iov[i].iov_base = buffers[i];
+			iov[i].iov_len = BLCKSZ;
+		}
+		n = i;
+
+		TRACE_POSTGRESQL_SMGR_MD_WRITE_START(forknum, blocknum,
+											 reln->smgr_rnode.node.spcNode,
+											 reln->smgr_rnode.node.dbNode,
+											 reln->smgr_rnode.node.relNode,
+											 reln->smgr_rnode.backend);
+
+		nbytes = FileWriteV(v->mdfd_vfd, iov, n, seekpos,
+							WAIT_EVENT_DATA_FILE_WRITE);
+
+		TRACE_POSTGRESQL_SMGR_MD_WRITE_DONE(forknum, blocknum,
+											reln->smgr_rnode.node.spcNode,
+											reln->smgr_rnode.node.dbNode,
+											reln->smgr_rnode.node.relNode,
+											reln->smgr_rnode.backend,
+											nbytes,
+											BLCKSZ * n);
+
+		mdwritev_finish(reln, forknum, v, blocknum, n, nbytes, skipFsync);
+
+		buffers += n;
+		blocknum += n;
+		nblocks -= n;
+	}
+}
+
 /*
  *	mdnblocks() -- Get the number of blocks stored in a relation.
  *
@@ -54,8 +54,23 @@ typedef struct f_smgr
 								  BlockNumber blocknum);
 	void		(*smgr_read) (SMgrRelation reln, ForkNumber forknum,
 							  BlockNumber blocknum, char *buffer);
+	void		(*smgr_readv) (SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber blocknum, char **buffers,
+							   BlockNumber nblocks);
+	int			(*smgr_fd) (SMgrRelation reln, ForkNumber forknum,
+							BlockNumber blocknum, off_t *off,
+							BlockNumber *nblocks);
+	void		(*smgr_readv_complete) (SMgrRelation reln, ForkNumber forknum,
+										BlockNumber blocknum, char **buffers,
+										BlockNumber nblocks, int nbytes);
+	void		(*smgr_write_complete) (SMgrRelation reln, ForkNumber forknum,
+										BlockNumber blocknum, BlockNumber nblocks,
+										int nbytes, bool skipFsync);
 	void		(*smgr_write) (SMgrRelation reln, ForkNumber forknum,
 							   BlockNumber blocknum, char *buffer, bool skipFsync);
+	void		(*smgr_writev) (SMgrRelation reln, ForkNumber forknum,
+								BlockNumber blocknum, char **buffers,
+								BlockNumber nblocks, bool skipFsync);
 	void		(*smgr_writeback) (SMgrRelation reln, ForkNumber forknum,
 								   BlockNumber blocknum, BlockNumber nblocks);
 	BlockNumber (*smgr_nblocks) (SMgrRelation reln, ForkNumber forknum);
@@ -77,7 +92,12 @@ static const f_smgr smgrsw[] = {
 		.smgr_extend = mdextend,
 		.smgr_prefetch = mdprefetch,
 		.smgr_read = mdread,
+		.smgr_readv = mdreadv,
+		.smgr_fd = mdfd,
+		.smgr_readv_complete = mdreadv_complete,
+		.smgr_write_complete = mdwrite_complete,
 		.smgr_write = mdwrite,
+		.smgr_writev = mdwritev,
 		.smgr_writeback = mdwriteback,
 		.smgr_nblocks = mdnblocks,
 		.smgr_truncate = mdtruncate,
@@ -505,6 +525,63 @@ smgrread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 	smgrsw[reln->smgr_which].smgr_read(reln, forknum, blocknum, buffer);
 }
 
+/*
+ *	smgrreadv() -- read a range of consecutive blocks from a relation into
+ *				   the supplied buffers, one per block.
+ *
+ *		This is equivalent to calling smgrread() for each block, but lets
+ *		the storage manager issue fewer, larger reads.
+ */
+void
+smgrreadv(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		  char **buffers, BlockNumber nblocks)
+{
+	smgrsw[reln->smgr_which].smgr_readv(reln, forknum, blocknum, buffers,
+										nblocks);
+}
+
+/*
+ *	smgrfd() -- get the kernel file descriptor and offset to read or write
+ *				a block with, for asynchronous I/O.
+ *
+ *		*nblocks is set to the number of blocks from blocknum on that can be
+ *		read through the same file descriptor.  The result of the I/O must
+ *		be passed to smgrreadv_complete() or smgrwrite_complete().
+ */
+int
+smgrfd(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+	   off_t *off, BlockNumber *nblocks)
+{
+	return smgrsw[reln->smgr_which].smgr_fd(reln, forknum, blocknum, off,
+											nblocks);
+}
+
+/*
+ *	smgrreadv_complete() -- check the result of an asynchronous read, and
+ *							turn what was read into pages in the format
+ *							POSTGRES expects.
+ */
+void
+smgrreadv_complete(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				   char **buffers, BlockNumber nblocks, int nbytes)
+{
+	smgrsw[reln->smgr_which].smgr_readv_complete(reln, forknum, blocknum,
+												 buffers, nblocks, nbytes);
+}
+
+/*
+ *	smgrwrite_complete() -- check the result of an asynchronous write, and
+ *							arrange for it to be fsync'd as smgrwrite()
+ *							would.
+ */
+void
+smgrwrite_complete(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				   BlockNumber nblocks, int nbytes, bool skipFsync)
+{
+	smgrsw[reln->smgr_which].smgr_write_complete(reln, forknum, blocknum,
+												 nblocks, nbytes, skipFsync);
+}
+
 /*
  *	smgrwrite() -- Write the supplied buffer out.
  *
@@ -528,6 +605,21 @@ smgrwrite(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 										buffer, skipFsync);
 }
 
+/*
+ *	smgrwritev() -- Write a range of consecutive blocks of a relation from
+ *					the supplied buffers.
+ *
+ *		Like calling smgrwrite() for each block in turn, but the storage
+ *		manager may combine the writes.
+ */
+void
+smgrwritev(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+		   char **buffers, BlockNumber nblocks, bool skipFsync)
+{
+	smgrsw[reln->smgr_which].smgr_writev(reln, forknum, blocknum,
+										 buffers, nblocks, skipFsync);
+}
+
 
 /*
  *	smgrwriteback() -- Trigger kernel writeback for the supplied range of
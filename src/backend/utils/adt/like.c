@@ -47,6 +47,7 @@ static int	SB_IMatchText(const char *t, int tlen, const char *p, int plen,
 
 static int	GenericMatchText(const char *s, int slen, const char *p, int plen, Oid collation);
 static int	Generic_Text_IC_like(text *str, text *pat, Oid collation);
+static text *like_get_text_arg(FunctionCallInfo fcinfo, text *pat);
 
 /*--------------------
  * Support routine for MatchText. Compares given multibyte streams
@@ -234,6 +235,43 @@ Generic_Text_IC_like(text *str, text *pat, Oid collation)
 	}
 }
 
+/*
+ * Fetch the string argument of textlike() or textnlike().
+ *
+ * If the pattern is a fixed prefix followed by nothing but '%'s, only that
+ * many leading bytes of the string can affect the result, so for a toasted
+ * string we detoast no more than that.  Literal pattern characters are
+ * compared bytewise, so a prefix cut in the middle of a multibyte character
+ * can only fail to match, as the whole string would.
+ */
+static text *
+like_get_text_arg(FunctionCallInfo fcinfo, text *pat)
+{
+	const char *p = VARDATA_ANY(pat);
+	int			plen = VARSIZE_ANY_EXHDR(pat);
+	struct varlena *str = (struct varlena *) DatumGetPointer(PG_GETARG_DATUM(0));
+	int			prefixlen;
+
+	/* A string with a short header is as good as a plain one */
+	if (!VARATT_IS_EXTERNAL(str) && !VARATT_IS_COMPRESSED(str))
+		return PG_GETARG_TEXT_PP(0);
+
+	for (prefixlen = 0; prefixlen < plen; prefixlen++)
+	{
+		if (p[prefixlen] == '%' || p[prefixlen] == '_' || p[prefixlen] == '\\')
+			break;
+	}
+	if (prefixlen == 0 || prefixlen == plen)
+		return PG_GETARG_TEXT_PP(0);
+	for (int i = prefixlen; i < plen; i++)
+	{
+		if (p[i] != '%')
+			return PG_GETARG_TEXT_PP(0);
+	}
+
+	return PG_GETARG_TEXT_P_SLICE(0, 0, prefixlen);
+}
+
 /*
  *	interface routines called by the function manager
  */
@@ -283,8 +321,8 @@ namenlike(PG_FUNCTION_ARGS)
 Datum
 textlike(PG_FUNCTION_ARGS)
 {
-	text	   *str = PG_GETARG_TEXT_PP(0);
 	text	   *pat = PG_GETARG_TEXT_PP(1);
+	text	   *str = like_get_text_arg(fcinfo, pat);
 	bool		result;
 	char	   *s,
 			   *p;
@@ -304,8 +342,8 @@ textlike(PG_FUNCTION_ARGS)
 Datum
 textnlike(PG_FUNCTION_ARGS)
 {
-	text	   *str = PG_GETARG_TEXT_PP(0);
 	text	   *pat = PG_GETARG_TEXT_PP(1);
+	text	   *str = like_get_text_arg(fcinfo, pat);
 	bool		result;
 	char	   *s,
 			   *p;
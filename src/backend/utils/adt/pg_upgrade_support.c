@@ -15,6 +15,7 @@
 #include "catalog/heap.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_type.h"
+#include "catalog/pg_zstd_dictionary.h"
 #include "commands/extension.h"
 #include "miscadmin.h"
 #include "utils/array.h"
@@ -197,3 +198,18 @@ binary_upgrade_set_missing_value(PG_FUNCTION_ARGS)
 
 	PG_RETURN_VOID();
 }
+
+Datum
+binary_upgrade_add_zstd_dictionary(PG_FUNCTION_ARGS)
+{
+	Oid			dictid = PG_GETARG_OID(0);
+	Oid			relid = PG_GETARG_OID(1);
+	int16		attnum = PG_GETARG_INT16(2);
+	bool		current = PG_GETARG_BOOL(3);
+	bytea	   *dict = PG_GETARG_BYTEA_PP(4);
+
+	CHECK_IS_BINARY_UPGRADE;
+	ZstdDictionaryRestore(dictid, relid, attnum, current, dict);
+
+	PG_RETURN_VOID();
+}
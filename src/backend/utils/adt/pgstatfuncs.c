@@ -15,6 +15,7 @@
 #include "postgres.h"
 
 #include "access/htup_details.h"
+#include "access/toast_compression.h"
 #include "access/xlog.h"
 #include "catalog/pg_authid.h"
 #include "catalog/pg_type.h"
@@ -1774,6 +1775,152 @@ pg_stat_get_slru(PG_FUNCTION_ARGS)
 	return (Datum) 0;
 }
 
+/*
+ * Returns TOAST compression statistics of the columns of the current
+ * database.
+ */
+Datum
+pg_stat_get_toast_columns(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_TOAST_COLUMNS_COLS	7
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	PgStat_StatDBEntry *dbentry;
+	HASH_SEQ_STATUS hstat;
+	PgStat_StatToastEntry *toastentry;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	/* request the database's stats from the stat collector */
+	dbentry = pgstat_fetch_stat_dbentry(MyDatabaseId);
+
+	if (dbentry != NULL && dbentry->toastcolumns != NULL)
+	{
+		hash_seq_init(&hstat, dbentry->toastcolumns);
+		while ((toastentry = (PgStat_StatToastEntry *) hash_seq_search(&hstat)) != NULL)
+		{
+			/* for each row */
+			Datum		values[PG_STAT_GET_TOAST_COLUMNS_COLS];
+			bool		nulls[PG_STAT_GET_TOAST_COLUMNS_COLS];
+
+			MemSet(values, 0, sizeof(values));
+			MemSet(nulls, 0, sizeof(nulls));
+
+			values[0] = ObjectIdGetDatum(toastentry->key.relid);
+			values[1] = Int16GetDatum(toastentry->key.attnum);
+			values[2] = Int64GetDatum(toastentry->numcompressed);
+			values[3] = Int64GetDatum(toastentry->numfailed);
+			values[4] = Int64GetDatum(toastentry->raw_bytes);
+			values[5] = Int64GetDatum(toastentry->compressed_bytes);
+			/* convert counter from microsec to millisec for display */
+			values[6] = Float8GetDatum(((double) toastentry->compress_time) / 1000.0);
+
+			tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+		}
+	}
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
+/*
+ * Returns TOAST decompression statistics, per compression method.
+ */
+Datum
+pg_stat_get_toast_decompression(PG_FUNCTION_ARGS)
+{
+#define PG_STAT_GET_TOAST_DECOMPRESSION_COLS	5
+	ReturnSetInfo *rsinfo = (ReturnSetInfo *) fcinfo->resultinfo;
+	TupleDesc	tupdesc;
+	Tuplestorestate *tupstore;
+	MemoryContext per_query_ctx;
+	MemoryContext oldcontext;
+	int			i;
+	PgStat_DecompressionStats *stats;
+
+	/* check to see if caller supports us returning a tuplestore */
+	if (rsinfo == NULL || !IsA(rsinfo, ReturnSetInfo))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("set-valued function called in context that cannot accept a set")));
+	if (!(rsinfo->allowedModes & SFRM_Materialize))
+		ereport(ERROR,
+				(errcode(ERRCODE_FEATURE_NOT_SUPPORTED),
+				 errmsg("materialize mode required, but it is not allowed in this context")));
+
+	/* Build a tuple descriptor for our result type */
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	per_query_ctx = rsinfo->econtext->ecxt_per_query_memory;
+	oldcontext = MemoryContextSwitchTo(per_query_ctx);
+
+	tupstore = tuplestore_begin_heap(true, false, work_mem);
+	rsinfo->returnMode = SFRM_Materialize;
+	rsinfo->setResult = tupstore;
+	rsinfo->setDesc = tupdesc;
+
+	MemoryContextSwitchTo(oldcontext);
+
+	/* request decompression stats from the stat collector */
+	stats = pgstat_fetch_decompression();
+
+	for (i = 0; i < TOAST_INVALID_COMPRESSION_ID; i++)
+	{
+		/* for each row */
+		Datum		values[PG_STAT_GET_TOAST_DECOMPRESSION_COLS];
+		bool		nulls[PG_STAT_GET_TOAST_DECOMPRESSION_COLS];
+		PgStat_DecompressionStats stat = stats[i];
+		const CompressionRoutine *routine;
+
+		routine = GetCompressionRoutineById((ToastCompressionId) i);
+
+		MemSet(values, 0, sizeof(values));
+		MemSet(nulls, 0, sizeof(nulls));
+
+		values[0] = PointerGetDatum(cstring_to_text(routine->cmname));
+		values[1] = Int64GetDatum(stat.numdecompressed);
+		values[2] = Int64GetDatum(stat.raw_bytes);
+		/* convert counter from microsec to millisec for display */
+		values[3] = Float8GetDatum(((double) stat.decompress_time) / 1000.0);
+		values[4] = TimestampTzGetDatum(stat.stat_reset_timestamp);
+
+		tuplestore_putvalues(tupstore, tupdesc, values, nulls);
+	}
+
+	/* clean up and return the tuplestore */
+	tuplestore_donestoring(tupstore);
+
+	return (Datum) 0;
+}
+
 Datum
 pg_stat_get_xact_numscans(PG_FUNCTION_ARGS)
 {
@@ -1113,6 +1113,53 @@ hash_search_with_hash_value(HTAB *hashp,
 	return NULL;				/* keep compiler quiet */
 }
 
+/*
+ * hash_search_optimistic -- look up key in a shared table without locking
+ *
+ * This is HASH_FIND for callers that don't hold the lock on the key's
+ * partition, but detect concurrent changes to the table some other way,
+ * such as a counter that everyone changing the table advances.  Entries may
+ * be added and removed while we follow the collision chain, so the result
+ * is only a guess until the caller has checked that nothing changed; the
+ * entry returned may not even be consistent.  All we promise is not to crash
+ * or loop forever: the elements of a shared table are never freed, so every
+ * link we follow leads to some element, and we give up after
+ * OPTIMISTIC_MAX_LINKS of them.  Returns NULL if the key wasn't found or we
+ * gave up.
+ *
+ * Only partitioned tables are supported, as their buckets are never split.
+ */
+#define OPTIMISTIC_MAX_LINKS	64
+
+void *
+hash_search_optimistic(HTAB *hashp, const void *keyPtr, uint32 hashvalue)
+{
+	HASHHDR    *hctl = hashp->hctl;
+	uint32		bucket;
+	HASHSEGMENT segp;
+	HASHBUCKET	currBucket;
+	int			nlinks = 0;
+
+	Assert(IS_PARTITIONED(hctl));
+
+	bucket = calc_bucket(hctl, hashvalue);
+	segp = hashp->dir[bucket >> hashp->sshift];
+
+	currBucket = *((volatile HASHBUCKET *) &segp[MOD(bucket, hashp->ssize)]);
+	while (currBucket != NULL)
+	{
+		if (currBucket->hashvalue == hashvalue &&
+			hashp->match(ELEMENTKEY(currBucket), keyPtr, hashp->keysize) == 0)
+			return (void *) ELEMENTKEY(currBucket);
+
+		if (++nlinks >= OPTIMISTIC_MAX_LINKS)
+			break;
+		currBucket = *((volatile HASHBUCKET *) &currBucket->link);
+	}
+
+	return NULL;
+}
+
 /*
  * hash_update_hash_key -- change the hash key of an existing table entry
  *
@@ -29,14 +29,18 @@
 #endif
 #include <unistd.h>
 
+#include "access/colcache.h"
 #include "access/commit_ts.h"
 #include "access/gin.h"
+#include "access/parallelredo.h"
 #include "access/rmgr.h"
 #include "access/tableam.h"
+#include "access/toast_compression.h"
 #include "access/transam.h"
 #include "access/twophase.h"
 #include "access/xact.h"
 #include "access/xlog_internal.h"
+#include "access/xlogprefetch.h"
 #include "catalog/namespace.h"
 #include "catalog/pg_authid.h"
 #include "catalog/storage.h"
@@ -47,6 +51,8 @@
 #include "commands/vacuum.h"
 #include "commands/variable.h"
 #include "common/string.h"
+#include "executor/execBatch.h"
+#include "executor/nodeHash.h"
 #include "funcapi.h"
 #include "jit/jit.h"
 #include "libpq/auth.h"
@@ -75,6 +81,8 @@
 #include "replication/syncrep.h"
 #include "replication/walreceiver.h"
 #include "replication/walsender.h"
+#include "storage/aio.h"
+#include "storage/buffile.h"
 #include "storage/bufmgr.h"
 #include "storage/dsm_impl.h"
 #include "storage/fd.h"
@@ -201,6 +209,7 @@ static bool check_max_wal_senders(int *newval, void **extra, GucSource source);
 static bool check_autovacuum_work_mem(int *newval, void **extra, GucSource source);
 static bool check_effective_io_concurrency(int *newval, void **extra, GucSource source);
 static bool check_maintenance_io_concurrency(int *newval, void **extra, GucSource source);
+static bool check_recovery_prefetch(bool *newval, void **extra, GucSource source);
 static bool check_huge_page_size(int *newval, void **extra, GucSource source);
 static void assign_pgstat_temp_directory(const char *newval, void *extra);
 static bool check_application_name(char **newval, void **extra, GucSource source);
@@ -447,6 +456,15 @@ static const struct config_enum_entry huge_pages_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry shared_memory_numa_options[] = {
+	{"off", SHMEM_NUMA_OFF, false},
+#ifdef USE_LIBNUMA
+	{"interleave", SHMEM_NUMA_INTERLEAVE, false},
+	{"partition", SHMEM_NUMA_PARTITION, false},
+#endif
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry force_parallel_mode_options[] = {
 	{"off", FORCE_PARALLEL_OFF, false},
 	{"on", FORCE_PARALLEL_ON, false},
@@ -467,6 +485,60 @@ static const struct config_enum_entry plan_cache_mode_options[] = {
 	{NULL, 0, false}
 };
 
+static const struct config_enum_entry default_toast_compression_options[] = {
+	{"pglz", TOAST_PGLZ_COMPRESSION, false},
+#ifdef USE_LZ4
+	{"lz4", TOAST_LZ4_COMPRESSION, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", TOAST_ZSTD_COMPRESSION, false},
+#endif
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry temp_file_compression_options[] = {
+	{"pglz", TEMP_FILE_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", TEMP_FILE_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", TEMP_FILE_COMPRESSION_ZSTD, false},
+#endif
+	{"off", TEMP_FILE_COMPRESSION_NONE, false},
+	{"false", TEMP_FILE_COMPRESSION_NONE, true},
+	{"no", TEMP_FILE_COMPRESSION_NONE, true},
+	{"0", TEMP_FILE_COMPRESSION_NONE, true},
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry io_method_options[] = {
+	{"sync", IOMETHOD_SYNC, false},
+	{"worker", IOMETHOD_WORKER, false},
+#ifdef USE_LIBURING
+	{"io_uring", IOMETHOD_IO_URING, false},
+#endif
+	{NULL, 0, false}
+};
+
+static const struct config_enum_entry wal_compression_options[] = {
+	{"pglz", WAL_COMPRESSION_PGLZ, false},
+#ifdef USE_LZ4
+	{"lz4", WAL_COMPRESSION_LZ4, false},
+#endif
+#ifdef USE_ZSTD
+	{"zstd", WAL_COMPRESSION_ZSTD, false},
+#endif
+	{"on", WAL_COMPRESSION_PGLZ, false},
+	{"off", WAL_COMPRESSION_NONE, false},
+	{"true", WAL_COMPRESSION_PGLZ, true},
+	{"false", WAL_COMPRESSION_NONE, true},
+	{"yes", WAL_COMPRESSION_PGLZ, true},
+	{"no", WAL_COMPRESSION_NONE, true},
+	{"1", WAL_COMPRESSION_PGLZ, true},
+	{"0", WAL_COMPRESSION_NONE, true},
+	{NULL, 0, false}
+};
+
 static const struct config_enum_entry password_encryption_options[] = {
 	{"md5", PASSWORD_TYPE_MD5, false},
 	{"scram-sha-256", PASSWORD_TYPE_SCRAM_SHA_256, false},
@@ -581,6 +653,8 @@ int			ssl_renegotiation_limit;
  */
 int			huge_pages;
 int			huge_page_size;
+int			shared_memory_numa;
+bool		numa_pin_backends;
 
 /*
  * These variables are all dummies that don't do anything, except in some
@@ -705,6 +779,8 @@ const char *const config_group_names[] =
 	gettext_noop("Write-Ahead Log / Checkpoints"),
 	/* WAL_ARCHIVING */
 	gettext_noop("Write-Ahead Log / Archiving"),
+	/* WAL_RECOVERY */
+	gettext_noop("Write-Ahead Log / Recovery"),
 	/* WAL_ARCHIVE_RECOVERY */
 	gettext_noop("Write-Ahead Log / Archive Recovery"),
 	/* WAL_RECOVERY_TARGET */
@@ -1046,6 +1122,16 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_hashjoin_filter", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables filtering the outer input of hash joins with the inner join keys."),
+			NULL,
+			GUC_EXPLAIN
+		},
+		&enable_hashjoin_filter,
+		true,
+		NULL, NULL, NULL
+	},
 	{
 		{"enable_gathermerge", PGC_USERSET, QUERY_TUNING_METHOD,
 			gettext_noop("Enables the planner's use of gather merge plans."),
@@ -1108,6 +1194,17 @@ static struct config_bool ConfigureNamesBool[] =
 		true,
 		NULL, NULL, NULL
 	},
+	{
+		{"enable_batch_execution", PGC_USERSET, QUERY_TUNING_METHOD,
+			gettext_noop("Enables batch execution of sequential scans and aggregates."),
+			gettext_noop("Sequential scans read and filter rows in batches, "
+						 "and plain aggregates over them consume whole batches."),
+			GUC_EXPLAIN
+		},
+		&enable_batch_execution,
+		false,
+		NULL, NULL, NULL
+	},
 	{
 		{"geqo", PGC_USERSET, QUERY_TUNING_GEQO,
 			gettext_noop("Enables genetic query optimization."),
@@ -1259,16 +1356,6 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
-	{
-		{"wal_compression", PGC_SUSET, WAL_SETTINGS,
-			gettext_noop("Compresses full-page writes written in WAL file."),
-			NULL
-		},
-		&wal_compression,
-		false,
-		NULL, NULL, NULL
-	},
-
 	{
 		{"wal_init_zero", PGC_SUSET, WAL_SETTINGS,
 			gettext_noop("Writes zeroes to new WAL files before first use."),
@@ -1289,6 +1376,26 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"wal_group_commit", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Flushes WAL for concurrent commits in groups, led by one process."),
+			gettext_noop("Without commit_delay, the leader waits adaptively, based on recent flush times.")
+		},
+		&wal_group_commit,
+		true,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"recovery_prefetch", PGC_SIGHUP, WAL_RECOVERY,
+			gettext_noop("Prefetches blocks referenced in the WAL during recovery."),
+			gettext_noop("Reads ahead in the WAL to find blocks that are not yet cached.")
+		},
+		&recovery_prefetch,
+		false,
+		check_recovery_prefetch, NULL, NULL
+	},
+
 	{
 		{"log_checkpoints", PGC_SIGHUP, LOGGING_WHAT,
 			gettext_noop("Logs each checkpoint."),
@@ -1482,6 +1589,15 @@ static struct config_bool ConfigureNamesBool[] =
 		false,
 		NULL, NULL, NULL
 	},
+	{
+		{"track_toast", PGC_SUSET, STATS_COLLECTOR,
+			gettext_noop("Collects statistics on TOAST compression and decompression."),
+			NULL
+		},
+		&pgstat_track_toast,
+		false,
+		NULL, NULL, NULL
+	},
 
 	{
 		{"update_process_title", PGC_SUSET, PROCESS_TITLE,
@@ -1940,6 +2056,16 @@ static struct config_bool ConfigureNamesBool[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"numa_pin_backends", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Runs each process on one NUMA node, using that node's share of shared buffers."),
+			gettext_noop("Only has an effect with shared_memory_numa = partition.")
+		},
+		&numa_pin_backends,
+		false,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"jit", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Allow JIT compilation."),
@@ -2268,6 +2394,18 @@ static struct config_int ConfigureNamesInt[] =
 		check_temp_buffers, NULL, NULL
 	},
 
+	{
+		{"columnar_cache_size", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Sets the amount of shared memory used to cache attribute offsets of heap pages."),
+			gettext_noop("Only tables with the columnar_cache storage parameter are cached. "
+						 "0 disables the cache."),
+			GUC_UNIT_KB
+		},
+		&columnar_cache_size,
+		0, 0, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"port", PGC_POSTMASTER, CONN_AUTH_SETTINGS,
 			gettext_noop("Sets the TCP port the server listens on."),
@@ -2707,6 +2845,17 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"checkpoint_combine_limit", PGC_SIGHUP, WAL_CHECKPOINTS,
+			gettext_noop("Maximum number of adjacent pages a checkpoint writes with a single write."),
+			NULL,
+			GUC_UNIT_BLOCKS
+		},
+		&checkpoint_combine_limit,
+		MAX_BUFFERS_PER_WRITE, 1, MAX_BUFFERS_PER_WRITE,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_buffers", PGC_POSTMASTER, WAL_SETTINGS,
 			gettext_noop("Sets the number of disk-page buffers in shared memory for WAL."),
@@ -2718,6 +2867,17 @@ static struct config_int ConfigureNamesInt[] =
 		check_wal_buffers, NULL, NULL
 	},
 
+	{
+		{"wal_insert_locks", PGC_POSTMASTER, WAL_SETTINGS,
+			gettext_noop("Sets the number of locks for concurrent insertion of WAL records."),
+			gettext_noop("-1 sets the number based on max_connections.")
+		},
+		&NumXLogInsertLocks,
+		/* they are all acquired at once at times, so stay within lwlock.c's limit */
+		-1, -1, 128,
+		check_wal_insert_locks, NULL, NULL
+	},
+
 	{
 		{"wal_writer_delay", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Time between WAL flushes performed in the WAL writer."),
@@ -2982,6 +3142,18 @@ static struct config_int ConfigureNamesInt[] =
 		check_max_worker_processes, NULL, NULL
 	},
 
+	{
+		{"io_workers",
+			PGC_POSTMASTER,
+			RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Number of I/O worker processes, for io_method = worker."),
+			NULL,
+		},
+		&io_workers,
+		3, 1, MAX_IO_WORKERS,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"max_logical_replication_workers",
 			PGC_POSTMASTER,
@@ -3106,6 +3278,27 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"recovery_parallel_workers", PGC_POSTMASTER, WAL_RECOVERY,
+			gettext_noop("Sets the number of worker processes that replay WAL records in parallel during recovery."),
+			gettext_noop("Zero replays all records in the startup process.")
+		},
+		&recovery_parallel_workers,
+		0, 0, MAX_PARALLEL_REDO_WORKERS,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"recovery_prefetch_distance", PGC_SIGHUP, WAL_RECOVERY,
+			gettext_noop("Sets how far ahead of replay to read the WAL for prefetching during recovery."),
+			NULL,
+			GUC_UNIT_BYTE
+		},
+		&recovery_prefetch_distance,
+		256 * 1024, 0, INT_MAX,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_segment_size", PGC_INTERNAL, PRESET_OPTIONS,
 			gettext_noop("Shows the size of write ahead log segments."),
@@ -3310,6 +3503,17 @@ static struct config_int ConfigureNamesInt[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"cpu_cache_size", PGC_USERSET, QUERY_TUNING_COST,
+			gettext_noop("Sets the assumed size of the CPU cache available to a single query."),
+			gettext_noop("Hash joins whose hash table is much larger than this are built and probed in partitions of about this size."),
+			GUC_UNIT_KB | GUC_EXPLAIN
+		},
+		&cpu_cache_size,
+		4096, 64, MAX_KILOBYTES,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"min_parallel_table_scan_size", PGC_USERSET, QUERY_TUNING_COST,
 			gettext_noop("Sets the minimum amount of table data for a parallel scan."),
@@ -4477,6 +4681,17 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"default_toast_compression", PGC_USERSET, CLIENT_CONN_STATEMENT,
+			gettext_noop("Sets the default compression method for compressible values."),
+			NULL
+		},
+		&default_toast_compression,
+		TOAST_PGLZ_COMPRESSION,
+		default_toast_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"client_min_messages", PGC_USERSET, CLIENT_CONN_STATEMENT,
 			gettext_noop("Sets the message levels that are sent to the client."),
@@ -4685,6 +4900,36 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"io_method", PGC_POSTMASTER, RESOURCES_ASYNCHRONOUS,
+			gettext_noop("Selects the method used to perform asynchronous I/O."),
+			NULL
+		},
+		&io_method,
+		IOMETHOD_SYNC, io_method_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"temp_file_compression", PGC_USERSET, RESOURCES_DISK,
+			gettext_noop("Compresses temporary files of sorts and hash joins with specified method."),
+			NULL
+		},
+		&temp_file_compression,
+		TEMP_FILE_COMPRESSION_NONE, temp_file_compression_options,
+		NULL, NULL, NULL
+	},
+
+	{
+		{"wal_compression", PGC_SUSET, WAL_SETTINGS,
+			gettext_noop("Compresses full-page writes written in WAL file with specified method."),
+			NULL
+		},
+		&wal_compression,
+		WAL_COMPRESSION_NONE, wal_compression_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"wal_sync_method", PGC_SIGHUP, WAL_SETTINGS,
 			gettext_noop("Selects the method used for forcing WAL updates to disk."),
@@ -4726,6 +4971,16 @@ static struct config_enum ConfigureNamesEnum[] =
 		NULL, NULL, NULL
 	},
 
+	{
+		{"shared_memory_numa", PGC_POSTMASTER, RESOURCES_MEM,
+			gettext_noop("Selects how the main shared memory region is placed on NUMA nodes."),
+			NULL
+		},
+		&shared_memory_numa,
+		SHMEM_NUMA_OFF, shared_memory_numa_options,
+		NULL, NULL, NULL
+	},
+
 	{
 		{"force_parallel_mode", PGC_USERSET, QUERY_TUNING_OTHER,
 			gettext_noop("Forces use of parallel query facilities."),
@@ -11594,6 +11849,19 @@ check_maintenance_io_concurrency(int *newval, void **extra, GucSource source)
 	return true;
 }
 
+static bool
+check_recovery_prefetch(bool *newval, void **extra, GucSource source)
+{
+#ifndef USE_PREFETCH
+	if (*newval)
+	{
+		GUC_check_errdetail("recovery_prefetch must be set to off on platforms that lack posix_fadvise().");
+		return false;
+	}
+#endif							/* USE_PREFETCH */
+	return true;
+}
+
 static bool
 check_huge_page_size(int *newval, void **extra, GucSource source)
 {
@@ -711,7 +711,7 @@ LogicalTapeSetCreate(int ntapes, TapeShare *shared, SharedFileSet *fileset,
 		lts->pfile = BufFileCreateShared(fileset, filename);
 	}
 	else
-		lts->pfile = BufFileCreateTemp(false);
+		lts->pfile = BufFileCreateCompressedTemp(false);
 
 	return lts;
 }
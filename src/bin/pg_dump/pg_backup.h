@@ -151,6 +151,7 @@ typedef struct _dumpOptions
 	int			no_publications;
 	int			no_subscriptions;
 	int			no_synchronized_snapshots;
+	int			no_toast_compression;
 	int			no_unlogged_table_data;
 	int			serializable_deferrable;
 	int			disable_triggers;
@@ -380,6 +380,7 @@ main(int argc, char **argv)
 		{"no-publications", no_argument, &dopt.no_publications, 1},
 		{"no-security-labels", no_argument, &dopt.no_security_labels, 1},
 		{"no-synchronized-snapshots", no_argument, &dopt.no_synchronized_snapshots, 1},
+		{"no-toast-compression", no_argument, &dopt.no_toast_compression, 1},
 		{"no-unlogged-table-data", no_argument, &dopt.no_unlogged_table_data, 1},
 		{"no-subscriptions", no_argument, &dopt.no_subscriptions, 1},
 		{"no-sync", no_argument, NULL, 7},
@@ -1034,6 +1035,7 @@ help(const char *progname)
 	printf(_("  --no-subscriptions           do not dump subscriptions\n"));
 	printf(_("  --no-synchronized-snapshots  do not use synchronized snapshots in parallel jobs\n"));
 	printf(_("  --no-tablespaces             do not dump tablespace assignments\n"));
+	printf(_("  --no-toast-compression       do not dump TOAST compression methods\n"));
 	printf(_("  --no-unlogged-table-data     do not dump unlogged table data\n"));
 	printf(_("  --on-conflict-do-nothing     add ON CONFLICT DO NOTHING to INSERT commands\n"));
 	printf(_("  --quote-all-identifiers      quote all identifiers, even if not key words\n"));
@@ -3107,6 +3109,62 @@ dumpDatabase(Archive *fout)
 		destroyPQExpBuffer(loOutQry);
 	}
 
+	/*
+	 * zstd-compressed values refer to their pg_zstd_dictionary entry by OID,
+	 * and come from the old system intact, so carry over the dictionaries
+	 * with their OIDs.
+	 */
+	if (dopt->binary_upgrade && fout->remoteVersion >= 140000)
+	{
+		PGresult   *zd_res;
+		PQExpBuffer zdOutQry = createPQExpBuffer();
+		int			i_oid,
+					i_zdrelid,
+					i_zdattnum,
+					i_zdcurrent,
+					i_zddict;
+		int			i;
+
+		zd_res = ExecuteSqlQuery(fout,
+								 "SELECT oid, zdrelid, zdattnum, zdcurrent, zddict\n"
+								 "FROM pg_catalog.pg_zstd_dictionary\n"
+								 "ORDER BY oid",
+								 PGRES_TUPLES_OK);
+
+		i_oid = PQfnumber(zd_res, "oid");
+		i_zdrelid = PQfnumber(zd_res, "zdrelid");
+		i_zdattnum = PQfnumber(zd_res, "zdattnum");
+		i_zdcurrent = PQfnumber(zd_res, "zdcurrent");
+		i_zddict = PQfnumber(zd_res, "zddict");
+
+		if (PQntuples(zd_res) > 0)
+		{
+			appendPQExpBufferStr(zdOutQry, "\n-- For binary upgrade, restore zstd dictionaries with their OIDs\n");
+			for (i = 0; i < PQntuples(zd_res); i++)
+			{
+				appendPQExpBuffer(zdOutQry,
+								  "SELECT pg_catalog.binary_upgrade_add_zstd_dictionary('%s'::pg_catalog.oid, '%s'::pg_catalog.oid, '%s'::pg_catalog.int2, '%s'::pg_catalog.bool, ",
+								  PQgetvalue(zd_res, i, i_oid),
+								  PQgetvalue(zd_res, i, i_zdrelid),
+								  PQgetvalue(zd_res, i, i_zdattnum),
+								  PQgetvalue(zd_res, i, i_zdcurrent));
+				appendStringLiteralAH(zdOutQry,
+									  PQgetvalue(zd_res, i, i_zddict), fout);
+				appendPQExpBufferStr(zdOutQry, "::pg_catalog.bytea);\n");
+			}
+
+			ArchiveEntry(fout, nilCatalogId, createDumpId(),
+						 ARCHIVE_OPTS(.tag = "pg_zstd_dictionary",
+									  .description = "pg_zstd_dictionary",
+									  .section = SECTION_PRE_DATA,
+									  .createStmt = zdOutQry->data));
+		}
+
+		PQclear(zd_res);
+
+		destroyPQExpBuffer(zdOutQry);
+	}
+
 	PQclear(res);
 
 	free(qdatname);
@@ -8530,10 +8588,17 @@ getTableAttrs(Archive *fout, TableInfo *tblinfo, int numTables)
 
 		if (fout->remoteVersion >= 120000)
 			appendPQExpBufferStr(q,
-								 "a.attgenerated\n");
+								 "a.attgenerated,\n");
+		else
+			appendPQExpBufferStr(q,
+								 "'' AS attgenerated,\n");
+
+		if (fout->remoteVersion >= 140000)
+			appendPQExpBufferStr(q,
+								 "a.attcompression\n");
 		else
 			appendPQExpBufferStr(q,
-								 "'' AS attgenerated\n");
+								 "'' AS attcompression\n");
 
 		/* need left join here to not fail on dropped columns ... */
 		appendPQExpBuffer(q,
@@ -8555,6 +8620,7 @@ getTableAttrs(Archive *fout, TableInfo *tblinfo, int numTables)
 		tbinfo->attstattarget = (int *) pg_malloc(ntups * sizeof(int));
 		tbinfo->attstorage = (char *) pg_malloc(ntups * sizeof(char));
 		tbinfo->typstorage = (char *) pg_malloc(ntups * sizeof(char));
+		tbinfo->attcompression = (char *) pg_malloc(ntups * sizeof(char));
 		tbinfo->attidentity = (char *) pg_malloc(ntups * sizeof(char));
 		tbinfo->attgenerated = (char *) pg_malloc(ntups * sizeof(char));
 		tbinfo->attisdropped = (bool *) pg_malloc(ntups * sizeof(bool));
@@ -8581,6 +8647,7 @@ getTableAttrs(Archive *fout, TableInfo *tblinfo, int numTables)
 			tbinfo->attstattarget[j] = atoi(PQgetvalue(res, j, PQfnumber(res, "attstattarget")));
 			tbinfo->attstorage[j] = *(PQgetvalue(res, j, PQfnumber(res, "attstorage")));
 			tbinfo->typstorage[j] = *(PQgetvalue(res, j, PQfnumber(res, "typstorage")));
+			tbinfo->attcompression[j] = *(PQgetvalue(res, j, PQfnumber(res, "attcompression")));
 			tbinfo->attidentity[j] = *(PQgetvalue(res, j, PQfnumber(res, "attidentity")));
 			tbinfo->attgenerated[j] = *(PQgetvalue(res, j, PQfnumber(res, "attgenerated")));
 			tbinfo->needs_override = tbinfo->needs_override || (tbinfo->attidentity[j] == ATTRIBUTE_IDENTITY_ALWAYS);
@@ -16114,6 +16181,36 @@ dumpTableSchema(Archive *fout, TableInfo *tbinfo)
 									  storage);
 			}
 
+			/*
+			 * Dump per-column compression, if it's been set.
+			 */
+			if (!dopt->no_toast_compression)
+			{
+				const char *cmname;
+
+				switch (tbinfo->attcompression[j])
+				{
+					case 'p':
+						cmname = "pglz";
+						break;
+					case 'l':
+						cmname = "lz4";
+						break;
+					case 'z':
+						cmname = "zstd";
+						break;
+					default:
+						cmname = NULL;
+						break;
+				}
+
+				if (cmname != NULL)
+					appendPQExpBuffer(q, "ALTER %sTABLE ONLY %s ALTER COLUMN %s SET COMPRESSION %s;\n",
+									  foreign, qualrelname,
+									  fmtId(tbinfo->attnames[j]),
+									  cmname);
+			}
+
 			/*
 			 * Dump per-column attributes.
 			 */
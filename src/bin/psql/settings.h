@@ -128,6 +128,7 @@ typedef struct _psqlSettings
 	bool		singleline;
 	bool		singlestep;
 	bool		hide_tableam;
+	bool		hide_compression;
 	int			fetch_count;
 	int			histsize;
 	int			ignoreeof;
@@ -1163,6 +1163,13 @@ hide_tableam_hook(const char *newval)
 	return ParseVariableBool(newval, "HIDE_TABLEAM", &pset.hide_tableam);
 }
 
+static bool
+hide_compression_hook(const char *newval)
+{
+	return ParseVariableBool(newval, "HIDE_TOAST_COMPRESSION",
+							 &pset.hide_compression);
+}
+
 static void
 EstablishVariableSpace(void)
 {
@@ -1228,4 +1235,7 @@ EstablishVariableSpace(void)
 	SetVariableHooks(pset.vars, "HIDE_TABLEAM",
 					 bool_substitute_hook,
 					 hide_tableam_hook);
+	SetVariableHooks(pset.vars, "HIDE_TOAST_COMPRESSION",
+					 bool_substitute_hook,
+					 hide_compression_hook);
 }
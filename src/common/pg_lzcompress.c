@@ -120,15 +120,18 @@
  *			The compressor creates a table for lists of positions.
  *			For each input position (except the last 3), a hash key is
  *			built from the 4 next input bytes and the position remembered
- *			in the appropriate list. Thus, the table points to linked
- *			lists of likely to be at least in the first 4 characters
- *			matching strings. This is done on the fly while the input
- *			is compressed into the output area.  Table entries are only
- *			kept for the last 4096 input positions, since we cannot use
- *			back-pointers larger than that anyway.  The size of the hash
- *			table is chosen based on the size of the input - a larger table
- *			has a larger startup cost, as it needs to be initialized to
- *			zero, but reduces the number of hash collisions on long inputs.
+ *			in the appropriate list. Thus, the table points to chains
+ *			of likely to be at least in the first 4 characters matching
+ *			strings. The chains are kept as arrays of positions: the table
+ *			holds the latest position per hash key, and a 4096-entry ring
+ *			indexed by position holds the previous position of the same
+ *			chain.  This is done on the fly while the input is compressed
+ *			into the output area.  Only the last 4096 input positions are
+ *			remembered, since we cannot use back-pointers larger than that
+ *			anyway.  The size of the hash table is chosen based on the size
+ *			of the input - a larger table has a larger startup cost, as it
+ *			needs to be initialized, but reduces the number of hash
+ *			collisions on long inputs.
  *
  *			For each byte in the input, its hash key (built from this
  *			byte and the next 3) is used to find the appropriate list
@@ -151,12 +154,14 @@
  *			Another "speed against ratio" preference characteristic of
  *			the algorithm.
  *
- *			Thus there are 3 stop conditions for the lookup of matches:
+ *			Thus there are 4 stop conditions for the lookup of matches:
  *
  *				- a match >= good_match is found
  *				- there are no more history entries to look at
  *				- the next history entry is already too far back
- *				  to be coded into a tag.
+ *				  to be coded into a tag
+ *				- PGLZ_MAX_PROBES entries have been looked at, which
+ *				  bounds the work on long chains of near-misses.
  *
  *			Finally the match algorithm checks that at least a match
  *			of 3 or more bytes has been found, because that is the smallest
@@ -165,6 +170,12 @@
  *			scanned for the history add's, otherwise a literal character
  *			is omitted and only his history entry added.
  *
+ *			Before starting, an input that the strategy allows to give up
+ *			on is sampled for repeated byte pairs; if there are hardly any,
+ *			as in already compressed or encrypted data, compression is not
+ *			attempted at all instead of failing only after first_success_by
+ *			bytes.
+ *
  *		Acknowledgments:
  *
  *			Many thanks to Adisak Pochanayon, who's article about SLZ
@@ -193,27 +204,17 @@
  * ----------
  */
 #define PGLZ_MAX_HISTORY_LISTS	8192	/* must be power of 2 */
-#define PGLZ_HISTORY_SIZE		4096
+#define PGLZ_HISTORY_SIZE		4096	/* must be power of 2 */
 #define PGLZ_MAX_MATCH			273
+#define PGLZ_MAX_PROBES			64	/* history entries to try per position */
 
-
-/* ----------
- * PGLZ_HistEntry -
- *
- *		Linked list for the backward history lookup
- *
- * All the entries sharing a hash key are linked in a doubly linked list.
- * This makes it easy to remove an entry when it's time to recycle it
- * (because it's more than 4K positions old).
- * ----------
+/*
+ * Inputs at least this large are sampled before compressing, to give up
+ * early on data that is already compressed.
  */
-typedef struct PGLZ_HistEntry
-{
-	struct PGLZ_HistEntry *next;	/* links for my hash key's list */
-	struct PGLZ_HistEntry *prev;
-	int			hindex;			/* my current hash key */
-	const char *pos;			/* my input position */
-} PGLZ_HistEntry;
+#define PGLZ_SAMPLE_MIN_INPUT	2048
+#define PGLZ_SAMPLE_CHUNKS		16
+#define PGLZ_SAMPLE_CHUNK_SIZE	64
 
 
 /* ----------
@@ -250,23 +251,24 @@ const PGLZ_Strategy *const PGLZ_strategy_always = &strategy_always_data;
 
 /* ----------
  * Statically allocated work arrays for history
+ *
+ * hist_head[] holds, for each hash key, the most recent input position
+ * (as an offset from the start of the input) with that key, or -1.
+ * hist_prev[] links each position to the previous one with the same key;
+ * it is indexed by position modulo PGLZ_HISTORY_SIZE, so an entry is
+ * overwritten only once its position is too far back to be referenced by
+ * a tag, and is never consulted after that.  Both arrays are small enough
+ * to stay in cache while compressing.
  * ----------
  */
-static int16 hist_start[PGLZ_MAX_HISTORY_LISTS];
-static PGLZ_HistEntry hist_entries[PGLZ_HISTORY_SIZE + 1];
-
-/*
- * Element 0 in hist_entries is unused, and means 'invalid'. Likewise,
- * INVALID_ENTRY_PTR in next/prev pointers mean 'invalid'.
- */
-#define INVALID_ENTRY			0
-#define INVALID_ENTRY_PTR		(&hist_entries[INVALID_ENTRY])
+static int32 hist_head[PGLZ_MAX_HISTORY_LISTS];
+static int32 hist_prev[PGLZ_HISTORY_SIZE];
 
 /* ----------
  * pglz_hist_idx -
  *
  *		Computes the history table slot for the lookup by the next 4
- *		characters in the input.
+ *		characters in the input, which the caller must make sure exist.
  *
  * NB: because we use the next 4 characters, we are not guaranteed to
  * find 3-character matches; they very possibly will be in the wrong
@@ -274,57 +276,32 @@ static PGLZ_HistEntry hist_entries[PGLZ_HISTORY_SIZE + 1];
  * hash keys more.
  * ----------
  */
-#define pglz_hist_idx(_s,_e, _mask) (										\
-			((((_e) - (_s)) < 4) ? (int) (_s)[0] :							\
-			 (((_s)[0] << 6) ^ ((_s)[1] << 4) ^								\
-			  ((_s)[2] << 2) ^ (_s)[3])) & (_mask)				\
-		)
+static inline int
+pglz_hist_idx(const char *s, int mask)
+{
+	uint32		v;
+
+	memcpy(&v, s, sizeof(v));
+
+	/* Fibonacci hashing: the high bits of the product are well mixed */
+	return (int) ((v * 2654435761U) >> 19) & mask;
+}
 
 
 /* ----------
  * pglz_hist_add -
  *
- *		Adds a new entry to the history table.
- *
- * If _recycle is true, then we are recycling a previously used entry,
- * and must first delink it from its old hashcode's linked list.
- *
- * NOTE: beware of multiple evaluations of macro's arguments, and note that
- * _hn and _recycle are modified in the macro.
+ *		Adds input position pos to the history table.
  * ----------
  */
-#define pglz_hist_add(_hs,_he,_hn,_recycle,_s,_e, _mask)	\
-do {									\
-			int __hindex = pglz_hist_idx((_s),(_e), (_mask));				\
-			int16 *__myhsp = &(_hs)[__hindex];								\
-			PGLZ_HistEntry *__myhe = &(_he)[_hn];							\
-			if (_recycle) {													\
-				if (__myhe->prev == NULL)									\
-					(_hs)[__myhe->hindex] = __myhe->next - (_he);			\
-				else														\
-					__myhe->prev->next = __myhe->next;						\
-				if (__myhe->next != NULL)									\
-					__myhe->next->prev = __myhe->prev;						\
-			}																\
-			__myhe->next = &(_he)[*__myhsp];								\
-			__myhe->prev = NULL;											\
-			__myhe->hindex = __hindex;										\
-			__myhe->pos  = (_s);											\
-			/* If there was an existing entry in this hash slot, link */	\
-			/* this new entry to it. However, the 0th entry in the */		\
-			/* entries table is unused, so we can freely scribble on it. */ \
-			/* So don't bother checking if the slot was used - we'll */		\
-			/* scribble on the unused entry if it was not, but that's */	\
-			/* harmless. Avoiding the branch in this critical path */		\
-			/* speeds this up a little bit. */								\
-			/* if (*__myhsp != INVALID_ENTRY) */							\
-				(_he)[(*__myhsp)].prev = __myhe;							\
-			*__myhsp = _hn;													\
-			if (++(_hn) >= PGLZ_HISTORY_SIZE + 1) {							\
-				(_hn) = 1;													\
-				(_recycle) = true;											\
-			}																\
-} while (0)
+static inline void
+pglz_hist_add(const char *source, int32 pos, int mask)
+{
+	int			hindex = pglz_hist_idx(source + pos, mask);
+
+	hist_prev[pos & (PGLZ_HISTORY_SIZE - 1)] = hist_head[hindex];
+	hist_head[hindex] = pos;
+}
 
 
 /* ----------
@@ -387,6 +364,38 @@ do { \
 } while (0)
 
 
+/* ----------
+ * pglz_match_length -
+ *
+ *		Returns the number of leading bytes ip and hp have in common, up to
+ *		the end of the input or PGLZ_MAX_MATCH.  Compares 8 bytes at a time
+ *		as long as possible.
+ * ----------
+ */
+static inline int32
+pglz_match_length(const char *ip, const char *hp, const char *end)
+{
+	int32		maxlen = Min(end - ip, PGLZ_MAX_MATCH);
+	int32		len = 0;
+
+	while (len + 8 <= maxlen)
+	{
+		uint64		a;
+		uint64		b;
+
+		memcpy(&a, ip + len, sizeof(a));
+		memcpy(&b, hp + len, sizeof(b));
+		if (a != b)
+			break;
+		len += 8;
+	}
+	while (len < maxlen && ip[len] == hp[len])
+		len++;
+
+	return len;
+}
+
+
 /* ----------
  * pglz_find_match -
  *
@@ -396,91 +405,61 @@ do { \
  * ----------
  */
 static inline int
-pglz_find_match(int16 *hstart, const char *input, const char *end,
+pglz_find_match(const char *source, const char *input, const char *end,
 				int *lenp, int *offp, int good_match, int good_drop, int mask)
 {
-	PGLZ_HistEntry *hent;
-	int16		hentno;
+	int32		pos = input - source;
+	int32		maxlen = Min(end - input, PGLZ_MAX_MATCH);
+	int32		cand;
 	int32		len = 0;
 	int32		off = 0;
+	int			probes = PGLZ_MAX_PROBES;
 
 	/*
-	 * Traverse the linked history list until a good enough match is found.
+	 * Walk the hash chain, newest entry first, until a good enough match is
+	 * found or we've tried enough entries.
 	 */
-	hentno = hstart[pglz_hist_idx(input, end, mask)];
-	hent = &hist_entries[hentno];
-	while (hent != INVALID_ENTRY_PTR)
+	cand = hist_head[pglz_hist_idx(input, mask)];
+	while (cand >= 0)
 	{
-		const char *ip = input;
-		const char *hp = hent->pos;
-		int32		thisoff;
-		int32		thislen;
+		const char *hp = source + cand;
+		int32		thisoff = pos - cand;
 
 		/*
-		 * Stop if the offset does not fit into our tag anymore.
+		 * Stop if the offset does not fit into our tag anymore.  This also
+		 * guarantees that cand's hist_prev[] entry hasn't been reused.
 		 */
-		thisoff = ip - hp;
 		if (thisoff >= 0x0fff)
 			break;
 
 		/*
-		 * Determine length of match. A better match must be larger than the
-		 * best so far. And if we already have a match of 16 or more bytes,
-		 * it's worth the call overhead to use memcmp() to check if this match
-		 * is equal for the same size. After that we must fallback to
-		 * character by character comparison to know the exact position where
-		 * the diff occurred.
+		 * A candidate can only beat the best match so far if it agrees with
+		 * the input on the byte just past that match, so check that first.
 		 */
-		thislen = 0;
-		if (len >= 16)
+		if (len == 0 || hp[len] == input[len])
 		{
-			if (memcmp(ip, hp, len) == 0)
-			{
-				thislen = len;
-				ip += len;
-				hp += len;
-				while (ip < end && *ip == *hp && thislen < PGLZ_MAX_MATCH)
-				{
-					thislen++;
-					ip++;
-					hp++;
-				}
-			}
-		}
-		else
-		{
-			while (ip < end && *ip == *hp && thislen < PGLZ_MAX_MATCH)
+			int32		thislen = pglz_match_length(input, hp, end);
+
+			/*
+			 * Remember this match as the best (if it is)
+			 */
+			if (thislen > len)
 			{
-				thislen++;
-				ip++;
-				hp++;
+				len = thislen;
+				off = thisoff;
+				if (len >= maxlen)
+					break;
 			}
 		}
 
 		/*
-		 * Remember this match as the best (if it is)
-		 */
-		if (thislen > len)
-		{
-			len = thislen;
-			off = thisoff;
-		}
-
-		/*
-		 * Advance to the next history entry
+		 * Be happy with lesser good matches the more entries we visited.
 		 */
-		hent = hent->next;
+		if (len >= good_match || --probes == 0)
+			break;
+		good_match -= (good_match * good_drop) / 100;
 
-		/*
-		 * Be happy with lesser good matches the more entries we visited. But
-		 * no point in doing calculation if we're at end of list.
-		 */
-		if (hent != INVALID_ENTRY_PTR)
-		{
-			if (len >= good_match)
-				break;
-			good_match -= (good_match * good_drop) / 100;
-		}
+		cand = hist_prev[cand & (PGLZ_HISTORY_SIZE - 1)];
 	}
 
 	/*
@@ -498,6 +477,54 @@ pglz_find_match(int16 *hstart, const char *input, const char *end,
 }
 
 
+/* ----------
+ * pglz_sample_incompressible -
+ *
+ *		Guess from a sample of the input whether it is already compressed
+ *		(or otherwise random), so that trying to compress it is pointless.
+ *
+ * We draw PGLZ_SAMPLE_CHUNKS chunks from evenly spaced places in the input
+ * and estimate how likely two of their bytes are to be equal.  That is
+ * 1/256 for random bytes, and much higher for anything pglz can compress
+ * by a useful amount: text, numeric data, or mostly-zero binary.  Data
+ * with a nearly uniform byte distribution could only be compressed by long
+ * repeats within the 4K history window, which are rare enough in practice
+ * that we don't look for them.
+ * ----------
+ */
+static bool
+pglz_sample_incompressible(const char *source, int32 slen)
+{
+	uint16		counts[256];
+	int32		step = slen / PGLZ_SAMPLE_CHUNKS;
+	int64		n = PGLZ_SAMPLE_CHUNKS * PGLZ_SAMPLE_CHUNK_SIZE;
+	int64		pairs = 0;
+	int			i;
+	int			j;
+
+	Assert(step >= PGLZ_SAMPLE_CHUNK_SIZE);
+
+	memset(counts, 0, sizeof(counts));
+	for (i = 0; i < PGLZ_SAMPLE_CHUNKS; i++)
+	{
+		const unsigned char *p = (const unsigned char *) source + i * step;
+
+		for (j = 0; j < PGLZ_SAMPLE_CHUNK_SIZE; j++)
+			counts[p[j]]++;
+	}
+
+	/* Count ordered pairs of distinct sampled bytes that are equal */
+	for (i = 0; i < 256; i++)
+		pairs += (int64) counts[i] * (counts[i] - 1);
+
+	/*
+	 * Give up if fewer than 1 in 200 pairs are equal, meaning that the bytes
+	 * are spread almost evenly over more than 200 values.
+	 */
+	return pairs * 200 < n * (n - 1);
+}
+
+
 /* ----------
  * pglz_compress -
  *
@@ -511,10 +538,9 @@ pglz_compress(const char *source, int32 slen, char *dest,
 {
 	unsigned char *bp = (unsigned char *) dest;
 	unsigned char *bstart = bp;
-	int			hist_next = 1;
-	bool		hist_recycle = false;
 	const char *dp = source;
 	const char *dend = source + slen;
+	const char *hend = dend - Min(slen, 3);	/* history is kept up to here */
 	unsigned char ctrl_dummy = 0;
 	unsigned char *ctrlp = &ctrl_dummy;
 	unsigned char ctrlb = 0;
@@ -545,6 +571,16 @@ pglz_compress(const char *source, int32 slen, char *dest,
 		slen > strategy->max_input_size)
 		return -1;
 
+	/*
+	 * If the strategy lets us give up early on incompressible input, and the
+	 * input is large enough to sample, see if it looks incompressible before
+	 * spending any effort on it.
+	 */
+	if (strategy->first_success_by < slen &&
+		slen >= PGLZ_SAMPLE_MIN_INPUT &&
+		pglz_sample_incompressible(source, slen))
+		return -1;
+
 	/*
 	 * Limit the match parameters to the supported range.
 	 */
@@ -598,10 +634,10 @@ pglz_compress(const char *source, int32 slen, char *dest,
 	mask = hashsz - 1;
 
 	/*
-	 * Initialize the history lists to empty.  We do not need to zero the
-	 * hist_entries[] array; its entries are initialized as they are used.
+	 * Initialize the history lists to empty.  We do not need to initialize
+	 * hist_prev[]; its entries are set before they are used.
 	 */
-	memset(hist_start, 0, hashsz * sizeof(int16));
+	memset(hist_head, 0xff, hashsz * sizeof(int32));
 
 	/*
 	 * Compress the source directly into the output buffer.
@@ -628,9 +664,11 @@ pglz_compress(const char *source, int32 slen, char *dest,
 			return -1;
 
 		/*
-		 * Try to find a match in the history
+		 * Try to find a match in the history.  The last 3 bytes of the input
+		 * have no history entries of their own, so they're always literals.
 		 */
-		if (pglz_find_match(hist_start, dp, dend, &match_len,
+		if (dp < hend &&
+			pglz_find_match(source, dp, dend, &match_len,
 							&match_off, good_match, good_drop, mask))
 		{
 			/*
@@ -640,11 +678,9 @@ pglz_compress(const char *source, int32 slen, char *dest,
 			pglz_out_tag(ctrlp, ctrlb, ctrl, bp, match_len, match_off);
 			while (match_len--)
 			{
-				pglz_hist_add(hist_start, hist_entries,
-							  hist_next, hist_recycle,
-							  dp, dend, mask);
-				dp++;			/* Do not do this ++ in the line above! */
-				/* The macro would do it four times - Jan.  */
+				if (dp < hend)
+					pglz_hist_add(source, dp - source, mask);
+				dp++;
 			}
 			found_match = true;
 		}
@@ -654,11 +690,9 @@ pglz_compress(const char *source, int32 slen, char *dest,
 			 * No match found. Copy one literal byte.
 			 */
 			pglz_out_literal(ctrlp, ctrlb, ctrl, bp, *dp);
-			pglz_hist_add(hist_start, hist_entries,
-						  hist_next, hist_recycle,
-						  dp, dend, mask);
-			dp++;				/* Do not do this ++ in the line above! */
-			/* The macro would do it four times - Jan.  */
+			if (dp < hend)
+				pglz_hist_add(source, dp - source, mask);
+			dp++;
 		}
 	}
 
@@ -676,6 +710,54 @@ pglz_compress(const char *source, int32 slen, char *dest,
 }
 
 
+/* ----------
+ * pglz_copy_match -
+ *
+ *		Copy a match of len bytes starting off bytes back in the output to
+ *		dp, in chunks of 8 or 16 bytes rather than byte by byte.  This may
+ *		write up to PGLZ_COPY_SLOP - 1 bytes beyond the end of the match,
+ *		which the caller must have room for; they are overwritten by what
+ *		follows in the output anyway.
+ * ----------
+ */
+#define PGLZ_COPY_SLOP			16
+
+static inline void
+pglz_copy_match(unsigned char *dp, int32 off, int32 len)
+{
+	unsigned char *end = dp + len;
+
+	/*
+	 * With an offset below the chunk size, each chunk would read bytes the
+	 * same chunk is to produce, so first replicate the pattern by doubling
+	 * as in pglz_decompress().  That takes at most three short copies.
+	 */
+	while (off < 8)
+	{
+		memcpy(dp, dp - off, off);
+		dp += off;
+		off += off;
+	}
+
+	if (off >= 16)
+	{
+		while (dp < end)
+		{
+			memcpy(dp, dp - off, 16);
+			dp += 16;
+		}
+	}
+	else
+	{
+		while (dp < end)
+		{
+			memcpy(dp, dp - off, 8);
+			dp += 8;
+		}
+	}
+}
+
+
 /* ----------
  * pglz_decompress -
  *
@@ -708,6 +790,18 @@ pglz_decompress(const char *source, int32 slen, char *dest,
 		unsigned char ctrl = *sp++;
 		int			ctrlc;
 
+		/*
+		 * Eight literal bytes in a row are common in poorly compressible
+		 * data, so copy them in one go when there's room.
+		 */
+		if (ctrl == 0 && srcend - sp >= 8 && destend - dp >= 8)
+		{
+			memcpy(dp, sp, 8);
+			sp += 8;
+			dp += 8;
+			continue;
+		}
+
 		for (ctrlc = 0; ctrlc < 8 && sp < srcend && dp < destend; ctrlc++)
 		{
 
@@ -731,6 +825,24 @@ pglz_decompress(const char *source, int32 slen, char *dest,
 				if (len == 18)
 					len += *sp++;
 
+				/*
+				 * Check for corrupt data: a match must refer to output we
+				 * have already produced.
+				 */
+				if (unlikely(off == 0 || off > dp - (unsigned char *) dest))
+					return -1;
+
+				/*
+				 * Away from the end of the output, copy in wide chunks.
+				 */
+				if (likely(destend - dp >= len + PGLZ_COPY_SLOP))
+				{
+					pglz_copy_match(dp, off, len);
+					dp += len;
+					ctrl >>= 1;
+					continue;
+				}
+
 				/*
 				 * Now we copy the bytes specified by the tag from OUTPUT to
 				 * OUTPUT (copy len bytes from dp - off to dp). The copied
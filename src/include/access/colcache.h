@@ -0,0 +1,62 @@
+/*-------------------------------------------------------------------------
+ *
+ * colcache.h
+ *	  Columnar cache of the attribute offsets on all-visible heap pages.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/colcache.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef COLCACHE_H
+#define COLCACHE_H
+
+#include "access/htup.h"
+#include "access/xlogdefs.h"
+#include "storage/block.h"
+#include "storage/buf.h"
+#include "storage/relfilenode.h"
+#include "utils/relcache.h"
+
+/* GUC parameter */
+extern PGDLLIMPORT int columnar_cache_size;
+
+/* has this backend loaded any pages from the cache? */
+extern PGDLLIMPORT bool ColumnarCacheInUse;
+
+/*
+ * The cache entry of a heap page.  For each line pointer, and for each of
+ * the first 'natts' attributes of the tuple it points to, it holds the
+ * offset of the attribute's data from the start of the page, or 0 if the
+ * attribute is null or not present in the tuple.  The offsets are stored
+ * column by column, following the offsets of the tuples themselves, so that
+ * data[maxoff * attnum + offnum - 1] is the offset of attribute 'attnum' of
+ * the tuple at 'offnum', and attnum 0 gives the offset of the tuple header.
+ *
+ * An entry is only valid as long as the page's LSN is the one it was built
+ * from.
+ */
+typedef struct ColumnarPage
+{
+	RelFileNode rnode;			/* relation and block of the page */
+	BlockNumber blkno;
+	XLogRecPtr	lsn;			/* LSN of the page the entry was built from */
+	uint16		maxoff;			/* number of line pointers on the page */
+	uint16		natts;			/* number of attributes cached */
+	uint16		data[FLEXIBLE_ARRAY_MEMBER];
+} ColumnarPage;
+
+#define ColumnarPageOffset(cpage, attnum, offnum) \
+	((cpage)->data[(cpage)->maxoff * (attnum) + (offnum) - 1])
+
+extern Size ColumnarCacheShmemSize(void);
+extern void ColumnarCacheShmemInit(void);
+
+extern bool ColumnarCacheEnabled(Relation rel);
+extern void ColumnarCacheLoad(Relation rel, Buffer buffer);
+extern ColumnarPage *ColumnarCacheLookup(Buffer buffer, HeapTuple tuple);
+extern void ColumnarCacheInvalidate(Relation rel, BlockNumber blkno);
+
+#endif							/* COLCACHE_H */
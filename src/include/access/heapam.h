@@ -22,6 +22,7 @@
 #include "access/tableam.h"
 #include "nodes/lockoptions.h"
 #include "nodes/primnodes.h"
+#include "storage/bufmgr.h"
 #include "storage/bufpage.h"
 #include "storage/dsm.h"
 #include "storage/lockdefs.h"
@@ -60,9 +61,18 @@ typedef struct HeapScanDescData
 	Buffer		rs_cbuf;		/* current buffer in scan, if any */
 	/* NB: if rs_cbuf is not InvalidBuffer, we hold a pin on that buffer */
 
+	/* buffers read ahead by heapgetpage, all pinned; see heap_getbuffer() */
+	Buffer		rs_readahead[MAX_BUFFERS_PER_READ];
+	BlockNumber rs_rablock;		/* block # of rs_readahead[0] */
+	int			rs_nreadahead;	/* number of buffers read ahead */
+	int			rs_ranext;		/* index of next one to use */
+
 	/* rs_numblocks is usually InvalidBlockNumber, meaning "scan whole rel" */
 	BufferAccessStrategy rs_strategy;	/* access strategy for reads */
 
+	bool		rs_colcache;	/* load all-visible pages into the columnar
+								 * cache? */
+
 	HeapTupleData rs_ctup;		/* current tuple in scan, if any */
 
 	/* these fields only used in page-at-a-time mode and for bitmap scans */
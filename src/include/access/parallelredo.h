@@ -0,0 +1,44 @@
+/*-------------------------------------------------------------------------
+ *
+ * parallelredo.h
+ *	  Replay of WAL records by parallel redo workers.
+ *
+ * With recovery_parallel_workers > 0, the startup process hands records
+ * that modify a single relation block to a pool of redo workers, chosen by
+ * the block, and replays all other records itself once the workers have
+ * caught up.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/parallelredo.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PARALLELREDO_H
+#define PARALLELREDO_H
+
+#include "access/xlogreader.h"
+#include "storage/block.h"
+#include "storage/relfilenode.h"
+
+/* GUC parameter */
+extern PGDLLIMPORT int recovery_parallel_workers;
+
+/* upper limit for recovery_parallel_workers */
+#define MAX_PARALLEL_REDO_WORKERS	32
+
+extern Size ParallelRedoShmemSize(void);
+extern void ParallelRedoShmemInit(void);
+
+extern void ParallelRedoStart(void);
+extern bool ParallelRedoDispatch(XLogReaderState *record);
+extern void ParallelRedoBarrier(XLogReaderState *record);
+extern void ParallelRedoWait(void);
+extern void ParallelRedoFinish(void);
+
+extern void ParallelRedoWorkerMain(Datum main_arg);
+extern bool ParallelRedoReportInvalidPage(RelFileNode node, ForkNumber forkno,
+										  BlockNumber blkno, bool present);
+
+#endif							/* PARALLELREDO_H */
@@ -0,0 +1,127 @@
+/*-------------------------------------------------------------------------
+ *
+ * toast_compression.h
+ *	  Functions for toast compression.
+ *
+ * Copyright (c) 2020, PostgreSQL Global Development Group
+ *
+ * src/include/access/toast_compression.h
+ *
+ *-------------------------------------------------------------------------
+ */
+
+#ifndef TOAST_COMPRESSION_H
+#define TOAST_COMPRESSION_H
+
+/*
+ * GUC support.
+ *
+ * default_toast_compression is an integer for purposes of the GUC machinery,
+ * but the value is one of the char values defined below, as they appear in
+ * pg_attribute.attcompression, e.g. TOAST_PGLZ_COMPRESSION.
+ */
+extern int	default_toast_compression;
+
+/*
+ * Built-in compression method ID.  The toast compression header will store
+ * this in the first 2 bits of the raw length.  These built-in compression
+ * method IDs are directly mapped to the built-in compression methods.
+ *
+ * Don't use these values for anything other than understanding the meaning
+ * of the raw bits from a varlena; in particular, if the goal is to identify
+ * a compression method, use the constants TOAST_PGLZ_COMPRESSION, etc.
+ * below. We might someday support more than 4 compression methods, but
+ * we can never have more than 4 values in this enum, because there are
+ * only 2 bits available in the places where this is stored.
+ */
+typedef enum ToastCompressionId
+{
+	TOAST_PGLZ_COMPRESSION_ID = 0,
+	TOAST_LZ4_COMPRESSION_ID = 1,
+	TOAST_ZSTD_COMPRESSION_ID = 2,
+	TOAST_INVALID_COMPRESSION_ID = 3
+} ToastCompressionId;
+
+/*
+ * Built-in compression methods.  pg_attribute will store these in the
+ * attcompression column.  In attcompression, InvalidCompressionMethod
+ * denotes the default behavior.
+ */
+#define TOAST_PGLZ_COMPRESSION			'p'
+#define TOAST_LZ4_COMPRESSION			'l'
+#define TOAST_ZSTD_COMPRESSION			'z'
+#define InvalidCompressionMethod		'\0'
+
+#define CompressionMethodIsValid(cm)  ((cm) != InvalidCompressionMethod)
+
+/*
+ * CompressionRoutine
+ *
+ * Each compression method is described by one of these.  The table of
+ * methods lives in toast_compression.c and is searched both by the
+ * attcompression code (when compressing) and by the compression method ID
+ * stored in the compressed datum (when decompressing), so that every datum
+ * is decompressed by the method that compressed it regardless of the
+ * column's current setting.
+ *
+ * compress returns NULL if the method declines to compress the value (for
+ * example because it is outside the range the method handles); the caller
+ * decides whether the result saves enough space to be worth keeping.
+ * dictid identifies a pg_zstd_dictionary entry to compress with, or is
+ * InvalidOid; methods that don't support dictionaries ignore it.
+ *
+ * decompress_slice decompresses only the first slicelength bytes of the
+ * value, and must cope with being given just a prefix of the compressed
+ * data.  compressed_slice_size returns how much compressed data, counting
+ * from just after the toast compression header, is enough to decompress
+ * the first slicelength bytes of a value of rawsize bytes that compressed
+ * to compressed_size bytes; detoast_attr_slice() fetches only that many
+ * bytes of an external value.  It may simply return compressed_size if the
+ * method can't tell.
+ */
+typedef struct CompressionRoutine
+{
+	char		cmethod;		/* pg_attribute.attcompression value */
+	ToastCompressionId cmid;	/* ID stored in compressed datums */
+	const char *cmname;			/* name used in SQL */
+
+	struct varlena *(*compress) (const struct varlena *value, Oid dictid);
+	struct varlena *(*decompress) (const struct varlena *value);
+	struct varlena *(*decompress_slice) (const struct varlena *value,
+										 int32 slicelength);
+	int32		(*compressed_slice_size) (int32 slicelength, int32 rawsize,
+										  int32 compressed_size);
+} CompressionRoutine;
+
+
+/* compression method routines */
+extern struct varlena *pglz_compress_datum(const struct varlena *value,
+											Oid dictid);
+extern struct varlena *pglz_decompress_datum(const struct varlena *value);
+extern struct varlena *pglz_decompress_datum_slice(const struct varlena *value,
+												   int32 slicelength);
+extern int32 pglz_compressed_slice_size(int32 slicelength, int32 rawsize,
+										int32 compressed_size);
+extern struct varlena *lz4_compress_datum(const struct varlena *value,
+										   Oid dictid);
+extern struct varlena *lz4_decompress_datum(const struct varlena *value);
+extern struct varlena *lz4_decompress_datum_slice(const struct varlena *value,
+												  int32 slicelength);
+extern int32 lz4_compressed_slice_size(int32 slicelength, int32 rawsize,
+									   int32 compressed_size);
+extern struct varlena *zstd_compress_datum(const struct varlena *value,
+										   Oid dictid);
+extern struct varlena *zstd_decompress_datum(const struct varlena *value);
+extern struct varlena *zstd_decompress_datum_slice(const struct varlena *value,
+												   int32 slicelength);
+extern int32 zstd_compressed_slice_size(int32 slicelength, int32 rawsize,
+										int32 compressed_size);
+
+/* other stuff */
+extern const CompressionRoutine *GetCompressionRoutine(char cmethod);
+extern const CompressionRoutine *GetCompressionRoutineById(ToastCompressionId cmid);
+extern ToastCompressionId toast_get_compression_id(struct varlena *attr);
+extern char CompressionNameToMethod(const char *compression);
+extern const char *GetCompressionMethodName(char method);
+
+#endif							/* TOAST_COMPRESSION_H */
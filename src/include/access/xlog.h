@@ -110,15 +110,17 @@ extern int	max_wal_size_mb;
 extern int	wal_keep_size_mb;
 extern int	max_slot_wal_keep_size_mb;
 extern int	XLOGbuffers;
+extern int	NumXLogInsertLocks;
 extern int	XLogArchiveTimeout;
 extern int	wal_retrieve_retry_interval;
 extern char *XLogArchiveCommand;
 extern bool EnableHotStandby;
 extern bool fullPageWrites;
 extern bool wal_log_hints;
-extern bool wal_compression;
+extern int	wal_compression;
 extern bool wal_init_zero;
 extern bool wal_recycle;
+extern bool wal_group_commit;
 extern bool *wal_consistency_checking;
 extern char *wal_consistency_checking_string;
 extern bool log_checkpoints;
@@ -166,6 +168,15 @@ typedef enum WalLevel
 	WAL_LEVEL_LOGICAL
 } WalLevel;
 
+/* Compression algorithms for WAL */
+typedef enum WalCompression
+{
+	WAL_COMPRESSION_NONE = 0,
+	WAL_COMPRESSION_PGLZ,
+	WAL_COMPRESSION_LZ4,
+	WAL_COMPRESSION_ZSTD
+} WalCompression;
+
 /* Recovery states */
 typedef enum RecoveryState
 {
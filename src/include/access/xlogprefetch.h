@@ -0,0 +1,30 @@
+/*-------------------------------------------------------------------------
+ *
+ * xlogprefetch.h
+ *	  Prefetching of the blocks referenced by WAL records during recovery.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/access/xlogprefetch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef XLOGPREFETCH_H
+#define XLOGPREFETCH_H
+
+#include "access/xlogdefs.h"
+
+/* GUC parameters */
+extern PGDLLIMPORT bool recovery_prefetch;
+extern PGDLLIMPORT int recovery_prefetch_distance;
+
+extern Size XLogPrefetchShmemSize(void);
+extern void XLogPrefetchShmemInit(void);
+
+extern void XLogPrefetch(XLogRecPtr replaying_lsn);
+extern void XLogPrefetchEnd(void);
+
+extern void XLogPrefetchRequestResetStats(void);
+
+#endif							/* XLOGPREFETCH_H */
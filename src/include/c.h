@@ -206,6 +206,18 @@
 #define unlikely(x) ((x) != 0)
 #endif
 
+/*
+ * Hint to the CPU that the memory at the given address will be read soon,
+ * so that it can start loading it into cache.  This is only worth it if
+ * there is other work to do in the meantime, and the address is unlikely to
+ * be in cache already.
+ */
+#if __GNUC__ >= 3
+#define pg_prefetch_mem(a)	__builtin_prefetch(a)
+#else
+#define pg_prefetch_mem(a)	((void) 0)
+#endif
+
 /*
  * CppAsString
  *		Convert the argument to a string, using the C preprocessor.
@@ -368,4 +368,9 @@ DECLARE_UNIQUE_INDEX(pg_subscription_subname_index, 6115, on pg_subscription usi
 DECLARE_UNIQUE_INDEX(pg_subscription_rel_srrelid_srsubid_index, 6117, on pg_subscription_rel using btree(srrelid oid_ops, srsubid oid_ops));
 #define SubscriptionRelSrrelidSrsubidIndexId 6117
 
+DECLARE_UNIQUE_INDEX(pg_zstd_dictionary_oid_index, 9253, on pg_zstd_dictionary using btree(oid oid_ops));
+#define ZstdDictionaryOidIndexId	9253
+DECLARE_INDEX(pg_zstd_dictionary_relid_attnum_index, 9254, on pg_zstd_dictionary using btree(zdrelid oid_ops, zdattnum int2_ops));
+#define ZstdDictionaryRelidAttnumIndexId	9254
+
 #endif							/* INDEXING_H */
@@ -0,0 +1,66 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_zstd_dictionary.h
+ *	  definition of the "zstd dictionary" system catalog
+ *	  (pg_zstd_dictionary)
+ *
+ * Each row holds a zstd dictionary trained on the values of one column.
+ * zstd-compressed datums record the OID of the dictionary they were
+ * compressed with, so rows are never removed: datums copied into other
+ * tables keep referring to the dictionary even after the column it was
+ * trained on is gone.  When the table is dropped, zdrelid is set to zero.
+ * pg_upgrade carries the rows over with their OIDs.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/catalog/pg_zstd_dictionary.h
+ *
+ * NOTES
+ *	  The Catalog.pm module reads this file and derives schema
+ *	  information.
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PG_ZSTD_DICTIONARY_H
+#define PG_ZSTD_DICTIONARY_H
+
+#include "access/attnum.h"
+#include "catalog/genbki.h"
+#include "catalog/pg_zstd_dictionary_d.h"
+
+/* ----------------
+ *		pg_zstd_dictionary definition.  cpp turns this into
+ *		typedef struct FormData_pg_zstd_dictionary
+ * ----------------
+ */
+CATALOG(pg_zstd_dictionary,9250,ZstdDictionaryRelationId)
+{
+	Oid			oid;			/* oid */
+	Oid			zdrelid;		/* relation the dictionary was trained on */
+	int16		zdattnum;		/* column the dictionary was trained on */
+	bool		zdcurrent;		/* used to compress new values? */
+
+#ifdef CATALOG_VARLEN			/* variable-length fields start here */
+	bytea		zddict BKI_FORCE_NOT_NULL;	/* dictionary contents */
+#endif
+} FormData_pg_zstd_dictionary;
+
+/* ----------------
+ *		Form_pg_zstd_dictionary corresponds to a pointer to a tuple with
+ *		the format of pg_zstd_dictionary relation.
+ * ----------------
+ */
+typedef FormData_pg_zstd_dictionary *Form_pg_zstd_dictionary;
+
+/*
+ * prototypes for functions in pg_zstd_dictionary.c
+ */
+extern Oid	ZstdDictionaryCreate(Oid relid, AttrNumber attnum, bytea *dict);
+extern void ZstdDictionaryRestore(Oid dictid, Oid relid, AttrNumber attnum,
+								  bool current, bytea *dict);
+extern void ZstdDictionaryRetire(Oid relid);
+extern bytea *ZstdDictionaryGetData(Oid dictid);
+extern Oid	GetColumnZstdDictionary(Oid relid, AttrNumber attnum);
+
+#endif							/* PG_ZSTD_DICTIONARY_H */
@@ -0,0 +1,115 @@
+/*-------------------------------------------------------------------------
+ *
+ * execBatch.h
+ *	  Batch execution of scans, quals and aggregates.
+ *
+ * With enable_batch_execution on, a sequential scan reads its rows in
+ * batches of up to EXEC_BATCH_SIZE, extracts the columns it needs into
+ * arrays, and evaluates simple comparisons of a column with a constant over
+ * a whole column at a time.  A plain aggregate directly above such a scan
+ * can consume the batches, advancing simple aggregates a column at a time.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/executor/execBatch.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef EXECBATCH_H
+#define EXECBATCH_H
+
+#include "executor/tuptable.h"
+#include "nodes/execnodes.h"
+#include "nodes/primnodes.h"
+
+/* GUC parameter */
+extern PGDLLIMPORT bool enable_batch_execution;
+
+/* maximum number of rows in a batch */
+#define EXEC_BATCH_SIZE		1024
+
+/*
+ * Maximum number of buffers that the rows of a batch may keep pinned.  The
+ * ring of buffers a large sequential scan reads into (see GetAccessStrategy)
+ * has 32 of them at the default block size, and pinned ones can't be
+ * reused, so a batch must hold far fewer.
+ */
+#define EXEC_BATCH_MAX_BUFFERS	8
+
+/*
+ * A batch of rows.  Each row is stored in a slot of its own; the columns
+ * that batch-aware steps use are extracted into arrays as well.  The rows
+ * that have passed the quals so far are listed in 'selected'.
+ */
+typedef struct TupleBatch
+{
+	int			nrows;			/* number of rows in the batch */
+	int			nselected;		/* number of entries in selected[] */
+	int			next;			/* next selected row to return, when rows
+								 * are returned one at a time */
+	uint16	   *selected;		/* indexes of the selected rows */
+	TupleTableSlot **slots;		/* the rows */
+
+	int			ncolumns;		/* number of columns extracted */
+	int			maxcolumns;		/* allocated length of the arrays below */
+	AttrNumber	maxattr;		/* highest attribute number extracted */
+	AttrNumber *attnums;		/* attribute number of each column */
+	Datum	  **values;			/* values[column][row] */
+	bool	  **isnull;			/* isnull[column][row] */
+} TupleBatch;
+
+/* comparisons that can be evaluated over a column */
+typedef enum BatchCompare
+{
+	BATCH_LT,
+	BATCH_LE,
+	BATCH_EQ,
+	BATCH_NE,
+	BATCH_GE,
+	BATCH_GT
+} BatchCompare;
+
+/*
+ * A comparison of a column with a constant, "column cmp value".  Integer
+ * and date columns are compared as int64, float columns as float8.
+ */
+typedef struct BatchPredicate
+{
+	int			column;			/* index of the column in the batch */
+	Oid			coltype;		/* type of the column */
+	BatchCompare cmp;
+	int64		ivalue;			/* the constant, for integer types */
+	float8		fvalue;			/* the constant, for float types */
+} BatchPredicate;
+
+/* aggregate transition functions that can be advanced over a column */
+typedef enum BatchAggKind
+{
+	BATCH_AGG_COUNT_STAR,		/* int8inc */
+	BATCH_AGG_COUNT,			/* int8inc_any */
+	BATCH_AGG_SUM_INT,			/* int2_sum, int4_sum */
+	BATCH_AGG_SUM_FLOAT,		/* float4pl, float8pl */
+	BATCH_AGG_MIN,				/* int2/int4/int8/float4/float8/date smaller */
+	BATCH_AGG_MAX				/* int2/int4/int8/float4/float8/date larger */
+} BatchAggKind;
+
+extern TupleBatch *ExecCreateBatch(EState *estate, TupleDesc tupdesc,
+								   const TupleTableSlotOps *tts_ops);
+extern int	ExecBatchAddColumn(TupleBatch *batch, AttrNumber attnum);
+extern void ExecBatchReset(TupleBatch *batch);
+extern void ExecBatchExtractColumns(TupleBatch *batch);
+
+extern bool ExecBatchMakePredicate(Expr *clause, TupleBatch *batch,
+								   BatchPredicate *pred);
+extern void ExecBatchFilter(TupleBatch *batch, BatchPredicate *pred);
+
+extern bool ExecBatchAggSupported(Oid transfn_oid, Oid inputtype,
+								  bool initValueIsNull, BatchAggKind *kind);
+extern void ExecBatchAdvanceAggregate(BatchAggKind kind, Oid type,
+									  TupleBatch *batch, int column,
+									  Datum *transValue,
+									  bool *transValueIsNull,
+									  bool *noTransValue);
+
+#endif							/* EXECBATCH_H */
@@ -14,6 +14,7 @@
 #ifndef HASHJOIN_H
 #define HASHJOIN_H
 
+#include "lib/bloomfilter.h"
 #include "nodes/execnodes.h"
 #include "port/atomics.h"
 #include "storage/barrier.h"
@@ -80,6 +81,39 @@ typedef struct HashJoinTupleData
 #define HJTUPLE_MINTUPLE(hjtup)  \
 	((MinimalTuple) ((char *) (hjtup) + HJTUPLE_OVERHEAD))
 
+/*
+ * Each bucket of an unshared hash table has a one-byte tag, a tiny Bloom
+ * filter over the hash values of the tuples in the bucket: the bit selected
+ * by the top three bits of each hash value is set.  (The bucket number is
+ * taken from the low bits and the batch number from the bits just above
+ * those, so the top bits are the ones most likely to still differ.)  A probe
+ * whose bit is not set in the tag can skip the bucket without touching the
+ * bucket array or its tuples; as the tags are much denser than the buckets,
+ * they are also much more likely to be in cache.
+ */
+#define HJ_BUCKET_TAG(hashvalue)	((uint8) (1 << ((uint32) (hashvalue) >> 29)))
+
+/* memory used per bucket of an unshared hash table */
+#define HJ_BUCKET_SIZE	(sizeof(HashJoinTuple) + sizeof(uint8))
+
+/*
+ * When one batch of the hash table is much larger than the CPU caches, the
+ * planner may ask for it to be divided into radix partitions.  Partition i
+ * is the i'th contiguous range of buckets, identified by the high bits of
+ * the bucket number, together with the tuples in those buckets.  The tuples
+ * of each partition are stored together, and each partition is built in
+ * turn, and outer tuples are probed in groups sorted by partition, so that
+ * the memory being worked on at any moment is about the size of one
+ * partition rather than of the whole table.  Parallel Hash only sorts its
+ * insertions into the shared buckets by partition; see
+ * ExecParallelHashFlushTuples.
+ *
+ * HASH_RADIX_MAX_PARTITIONS must not exceed the minimum number of buckets.
+ */
+#define HASH_RADIX_MAX_PARTITIONS	256
+#define HJ_RADIX_PARTITION(hashtable, bucketno) \
+	((bucketno) >> ((hashtable)->log2_nbuckets - (hashtable)->log2_npartitions))
+
 /*
  * If the outer relation's distribution is sufficiently nonuniform, we attempt
  * to optimize the join by treating the hash values corresponding to the outer
@@ -299,6 +333,30 @@ typedef struct HashJoinTableData
 		dsa_pointer_atomic *shared;
 	}			buckets;
 
+	/* bucketTags[i] is the tag of the i'th bucket; unshared tables only */
+	uint8	   *bucketTags;
+
+	/*
+	 * Radix partitioning: log2 of the number of partitions of the current
+	 * batch's buckets (0 if not partitioned), and of the most partitions
+	 * the plan allows (0 if partitioning is not used at all).  A private
+	 * hash table only links its tuples into buckets once the whole batch
+	 * has been loaded, when ExecHashBuildPartitions decides how many
+	 * partitions it needs.  Parallel Hash always uses the planned number,
+	 * and collects the tuples it has stored but not yet linked into the
+	 * shared buckets in 'deferred'.
+	 */
+	int			log2_npartitions;
+	int			log2_npartitions_max;
+	dsa_pointer *deferred;		/* tuples waiting to be linked */
+	int			ndeferred;		/* number of entries in deferred[] */
+
+	/*
+	 * Bloom filter over the hash values of all the inner tuples, for the
+	 * hash join to pass down to its outer scan; NULL if not wanted.
+	 */
+	bloom_filter *filter;
+
 	bool		keepNulls;		/* true to store unmatchable NULL tuples */
 
 	bool		skewEnabled;	/* are we using skew optimization? */
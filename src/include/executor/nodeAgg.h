@@ -15,6 +15,7 @@
 #define NODEAGG_H
 
 #include "access/parallel.h"
+#include "executor/execBatch.h"
 #include "nodes/execnodes.h"
 
 
@@ -313,6 +314,21 @@ typedef struct AggStatePerHashData
 	Agg		   *aggnode;		/* original Agg node, for numGroups etc. */
 }			AggStatePerHashData;
 
+/*
+ * AggStatePerBatchData - per-transition batch execution information
+ *
+ * When a plain aggregate consumes batches of rows directly from a sequential
+ * scan (see agg_retrieve_batch), we have one of these for each transition
+ * state, telling how to advance it a column at a time.
+ */
+typedef struct AggStatePerBatchData
+{
+	BatchAggKind kind;			/* what the transition function does */
+	int			column;			/* batch column holding the argument, or -1
+								 * for count(*) */
+	Oid			type;			/* type of the argument */
+}			AggStatePerBatchData;
+
 
 extern AggState *ExecInitAgg(Agg *node, EState *estate, int eflags);
 extern void ExecEndAgg(AggState *node);
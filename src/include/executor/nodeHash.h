@@ -19,6 +19,9 @@
 
 struct SharedHashJoinBatch;
 
+/* GUC parameter */
+extern PGDLLIMPORT int cpu_cache_size;
+
 extern HashState *ExecInitHash(Hash *node, EState *estate, int eflags);
 extern Node *MultiExecHash(HashState *node);
 extern void ExecEndHash(HashState *node);
@@ -28,6 +31,7 @@ extern HashJoinTable ExecHashTableCreate(HashState *state, List *hashOperators,
 										 bool keepNulls);
 extern void ExecParallelHashTableAlloc(HashJoinTable hashtable,
 									   int batchno);
+extern Size ExecHashFilterSize(HashState *node);
 extern void ExecHashTableDestroy(HashJoinTable hashtable);
 extern void ExecHashTableDetach(HashJoinTable hashtable);
 extern void ExecHashTableDetachBatch(HashJoinTable hashtable);
@@ -43,6 +47,8 @@ extern void ExecParallelHashTableInsert(HashJoinTable hashtable,
 extern void ExecParallelHashTableInsertCurrentBatch(HashJoinTable hashtable,
 													TupleTableSlot *slot,
 													uint32 hashvalue);
+extern void ExecHashBuildPartitions(HashJoinTable hashtable);
+extern void ExecParallelHashFlushTuples(HashJoinTable hashtable);
 extern bool ExecHashGetHashValue(HashJoinTable hashtable,
 								 ExprContext *econtext,
 								 List *hashkeys,
@@ -67,6 +73,8 @@ extern void ExecChooseHashTableSize(double ntuples, int tupwidth, bool useskew,
 									int *numbuckets,
 									int *numbatches,
 									int *num_skew_mcvs);
+extern int	ExecChooseHashPartitions(double ntuples, int tupwidth,
+									 int nbuckets, int nbatch);
 extern int	ExecHashGetSkewBucket(HashJoinTable hashtable, uint32 hashvalue);
 extern void ExecHashEstimate(HashState *node, ParallelContext *pcxt);
 extern void ExecHashInitializeDSM(HashState *node, ParallelContext *pcxt);
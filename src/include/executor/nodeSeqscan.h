@@ -15,12 +15,21 @@
 #define NODESEQSCAN_H
 
 #include "access/parallel.h"
+#include "executor/execBatch.h"
+#include "lib/bloomfilter.h"
 #include "nodes/execnodes.h"
 
 extern SeqScanState *ExecInitSeqScan(SeqScan *node, EState *estate, int eflags);
 extern void ExecEndSeqScan(SeqScanState *node);
 extern void ExecReScanSeqScan(SeqScanState *node);
 
+/* batch execution support */
+extern TupleBatch *ExecSeqScanNextBatch(SeqScanState *node);
+
+/* hash join filter support */
+extern void ExecSeqScanSetFilter(SeqScanState *node, bloom_filter *filter);
+extern void ExecSeqScanShareFilter(SeqScanState *node, Size size);
+
 /* parallel scan support */
 extern void ExecSeqScanEstimate(SeqScanState *node, ParallelContext *pcxt);
 extern void ExecSeqScanInitializeDSM(SeqScanState *node, ParallelContext *pcxt);
@@ -1343,6 +1343,20 @@ typedef struct SeqScanState
 {
 	ScanState	ss;				/* its first field is NodeTag */
 	Size		pscan_len;		/* size of parallel heap scan descriptor */
+
+	/* batch execution, see execBatch.h; batch is NULL if not used */
+	struct TupleBatch *batch;	/* current batch of rows */
+	int			nbatchpreds;	/* number of quals evaluated over columns */
+	struct BatchPredicate *batchpreds;	/* array of nbatchpreds entries */
+
+	/* hash join filter, see ExecSeqScanSetFilter; filterkeys is NIL if none */
+	List	   *filterkeys;		/* list of ExprState nodes */
+	FmgrInfo   *filterhashfunctions;	/* outer hash functions of the join */
+	Oid		   *filtercollations;	/* and their collations */
+	bool	   *filterstrict;	/* is each join operator strict? */
+	struct bloom_filter *filter;	/* the filter, or NULL if not available */
+	Size		sharedfilter_len;	/* room for a copy in the parallel DSM */
+	struct SeqScanSharedFilter *sharedfilter;	/* that copy, if any */
 } SeqScanState;
 
 /* ----------------
@@ -1957,6 +1971,14 @@ typedef struct HashJoinState
 	int			hj_JoinState;
 	bool		hj_MatchedOuter;
 	bool		hj_OuterNotEmpty;
+	bool		hj_Prefetch;	/* read outer tuples ahead? */
+	int			hj_PrefetchCount;	/* # of outer tuples read ahead */
+	int			hj_PrefetchNext;	/* next one to return */
+	bool		hj_PrefetchEnd; /* reached the end of the batch? */
+	TupleTableSlot **hj_PrefetchSlots;	/* outer tuples read ahead */
+	uint32	   *hj_PrefetchHashValues;	/* and their hash values */
+	int		   *hj_PrefetchOrder;	/* order to return them in */
+	SeqScanState *hj_FilterScan;	/* outer scan to pass the filter to */
 } HashJoinState;
 
 
@@ -2140,6 +2162,7 @@ typedef struct AggStatePerTransData *AggStatePerTrans;
 typedef struct AggStatePerGroupData *AggStatePerGroup;
 typedef struct AggStatePerPhaseData *AggStatePerPhase;
 typedef struct AggStatePerHashData *AggStatePerHash;
+typedef struct AggStatePerBatchData *AggStatePerBatch;
 
 typedef struct AggState
 {
@@ -2216,6 +2239,10 @@ typedef struct AggState
 										 * ->hash_pergroup */
 	ProjectionInfo *combinedproj;	/* projection machinery */
 	SharedAggInfo *shared_info; /* one entry per worker */
+
+	/* batch execution of a plain aggregate; batch_input is NULL if unused */
+	SeqScanState *batch_input;	/* the outer plan, read a batch at a time */
+	AggStatePerBatch perbatch;	/* array of numtrans entries */
 } AggState;
 
 /* ----------------
@@ -2385,6 +2412,7 @@ typedef struct HashInstrumentation
 	int			nbatch;			/* number of batches at end of execution */
 	int			nbatch_original;	/* planned number of batches */
 	Size		space_peak;		/* peak memory usage in bytes */
+	int			npartitions;	/* max number of radix partitions */
 } HashInstrumentation;
 
 /* ----------------
@@ -2424,6 +2452,9 @@ typedef struct HashState
 
 	/* Parallel hash state. */
 	struct ParallelHashJoinState *parallel_state;
+
+	/* build a Bloom filter over the hash values, see ExecHashFilterSize */
+	bool		build_filter;
 } HashState;
 
 /* ----------------
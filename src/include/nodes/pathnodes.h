@@ -1600,6 +1600,7 @@ typedef struct HashPath
 	List	   *path_hashclauses;	/* join clauses used for hashing */
 	int			num_batches;	/* number of batches expected */
 	double		inner_rows_total;	/* total inner rows expected */
+	int			num_radix_partitions;	/* radix partitions per batch */
 } HashPath;
 
 /*
@@ -347,9 +347,22 @@ typedef struct Scan
 
 /* ----------------
  *		sequential scan node
+ *
+ * If filterkeys isn't NIL, the scan is the outer input of a hash join, and
+ * can skip rows that the join would find no match for.  The hash join builds
+ * a Bloom filter over the hash values of its inner rows, and the scan looks
+ * up the hash value of filterkeys, computed with the hash functions of
+ * filteroperators and filtercollations, as the join computes it for the
+ * outer row.  See ExecSeqScanSetFilter.
  * ----------------
  */
-typedef Scan SeqScan;
+typedef struct SeqScan
+{
+	Scan		scan;
+	List	   *filterkeys;		/* expressions over the scanned relation */
+	List	   *filteroperators;	/* OIDs of the join's hash operators */
+	List	   *filtercollations;	/* and their collations */
+} SeqScan;
 
 /* ----------------
  *		table sample scan node
@@ -933,6 +946,7 @@ typedef struct Hash
 	bool		skewInherit;	/* is outer join rel an inheritance tree? */
 	/* all other info is in the parent HashJoin node */
 	double		rows_total;		/* estimate total rows if parallel_aware */
+	int			radix_partitions;	/* max radix partitions per batch */
 } Hash;
 
 /* ----------------
@@ -11,6 +11,8 @@
 #ifndef PGSTAT_H
 #define PGSTAT_H
 
+#include "access/attnum.h"
+#include "access/toast_compression.h"
 #include "datatype/timestamp.h"
 #include "libpq/pqcomm.h"
 #include "miscadmin.h"
@@ -64,6 +66,8 @@ typedef enum StatMsgType
 	PGSTAT_MTYPE_SLRU,
 	PGSTAT_MTYPE_FUNCSTAT,
 	PGSTAT_MTYPE_FUNCPURGE,
+	PGSTAT_MTYPE_TOASTSTAT,
+	PGSTAT_MTYPE_DECOMPRESSION,
 	PGSTAT_MTYPE_RECOVERYCONFLICT,
 	PGSTAT_MTYPE_TEMPFILE,
 	PGSTAT_MTYPE_DEADLOCK,
@@ -122,7 +126,8 @@ typedef struct PgStat_TableCounts
 typedef enum PgStat_Shared_Reset_Target
 {
 	RESET_ARCHIVER,
-	RESET_BGWRITER
+	RESET_BGWRITER,
+	RESET_DECOMPRESSION
 } PgStat_Shared_Reset_Target;
 
 /* Possible object types for resetting single counters */
@@ -550,6 +555,95 @@ typedef struct PgStat_MsgFuncpurge
 	Oid			m_functionid[PGSTAT_NUM_FUNCPURGE];
 } PgStat_MsgFuncpurge;
 
+/* ----------
+ * PgStat_ToastColumnKey		Identifies a table column in TOAST statistics
+ * ----------
+ */
+typedef struct PgStat_ToastColumnKey
+{
+	Oid			relid;
+	AttrNumber	attnum;
+} PgStat_ToastColumnKey;
+
+/* ----------
+ * PgStat_ToastCounts			The actual per-column TOAST compression
+ *								counts kept by a backend
+ *
+ * This struct should contain only actual event counters, because we memcmp
+ * it against zeroes to detect whether there are any counts to transmit.
+ *
+ * A compression attempt fails if the method declines to compress the value
+ * or doesn't save enough space.  The byte counts only cover successful
+ * attempts, while the time counter covers all of them; it is in instr_time
+ * format here and converted to microseconds when transmitted.
+ * ----------
+ */
+typedef struct PgStat_ToastCounts
+{
+	PgStat_Counter t_numcompressed;
+	PgStat_Counter t_numfailed;
+	PgStat_Counter t_raw_bytes;
+	PgStat_Counter t_compressed_bytes;
+	instr_time	t_compress_time;
+} PgStat_ToastCounts;
+
+/* ----------
+ * PgStat_BackendToastEntry		Entry in backend's per-column TOAST hash table
+ * ----------
+ */
+typedef struct PgStat_BackendToastEntry
+{
+	PgStat_ToastColumnKey t_key;
+	PgStat_ToastCounts t_counts;
+} PgStat_BackendToastEntry;
+
+/* ----------
+ * PgStat_ToastEntry			Per-column info in a MsgToaststat
+ * ----------
+ */
+typedef struct PgStat_ToastEntry
+{
+	PgStat_ToastColumnKey t_key;
+	PgStat_Counter t_numcompressed;
+	PgStat_Counter t_numfailed;
+	PgStat_Counter t_raw_bytes;
+	PgStat_Counter t_compressed_bytes;
+	PgStat_Counter t_compress_time; /* time in microseconds */
+} PgStat_ToastEntry;
+
+/* ----------
+ * PgStat_MsgToaststat			Sent by the backend to report TOAST
+ *								compression statistics.
+ * ----------
+ */
+#define PGSTAT_NUM_TOASTENTRIES \
+	((PGSTAT_MSG_PAYLOAD - sizeof(Oid) - sizeof(int))  \
+	 / sizeof(PgStat_ToastEntry))
+
+typedef struct PgStat_MsgToaststat
+{
+	PgStat_MsgHdr m_hdr;
+	Oid			m_databaseid;
+	int			m_nentries;
+	PgStat_ToastEntry m_entry[PGSTAT_NUM_TOASTENTRIES];
+} PgStat_MsgToaststat;
+
+/* ----------
+ * PgStat_MsgDecompression		Sent by the backend to report decompression
+ *								of TOAST values, per compression method.
+ *								Decompression happens without knowing what
+ *								column the value came from.
+ * ----------
+ */
+typedef struct PgStat_MsgDecompression
+{
+	PgStat_MsgHdr m_hdr;
+	PgStat_Counter m_numdecompressed[TOAST_INVALID_COMPRESSION_ID];
+	PgStat_Counter m_raw_bytes[TOAST_INVALID_COMPRESSION_ID];
+	/* times in microseconds */
+	PgStat_Counter m_decompress_time[TOAST_INVALID_COMPRESSION_ID];
+} PgStat_MsgDecompression;
+
 /* ----------
  * PgStat_MsgDeadlock			Sent by the backend to tell the collector
  *								about a deadlock that occurred.
@@ -599,6 +693,8 @@ typedef union PgStat_Msg
 	PgStat_MsgSLRU msg_slru;
 	PgStat_MsgFuncstat msg_funcstat;
 	PgStat_MsgFuncpurge msg_funcpurge;
+	PgStat_MsgToaststat msg_toaststat;
+	PgStat_MsgDecompression msg_decompression;
 	PgStat_MsgRecoveryConflict msg_recoveryconflict;
 	PgStat_MsgDeadlock msg_deadlock;
 	PgStat_MsgTempFile msg_tempfile;
@@ -614,7 +710,7 @@ typedef union PgStat_Msg
  * ------------------------------------------------------------
  */
 
-#define PGSTAT_FILE_FORMAT_ID	0x01A5BC9D
+#define PGSTAT_FILE_FORMAT_ID	0x01A5BC9E
 
 /* ----------
  * PgStat_StatDBEntry			The collector's data per database
@@ -650,11 +746,12 @@ typedef struct PgStat_StatDBEntry
 	TimestampTz stats_timestamp;	/* time of db stats file update */
 
 	/*
-	 * tables and functions must be last in the struct, because we don't write
-	 * the pointers out to the stats file.
+	 * tables, functions and toastcolumns must be last in the struct, because
+	 * we don't write the pointers out to the stats file.
 	 */
 	HTAB	   *tables;
 	HTAB	   *functions;
+	HTAB	   *toastcolumns;
 } PgStat_StatDBEntry;
 
 
@@ -710,6 +807,23 @@ typedef struct PgStat_StatFuncEntry
 } PgStat_StatFuncEntry;
 
 
+/* ----------
+ * PgStat_StatToastEntry		The collector's data per table column
+ *								about TOAST compression
+ * ----------
+ */
+typedef struct PgStat_StatToastEntry
+{
+	PgStat_ToastColumnKey key;
+
+	PgStat_Counter numcompressed;
+	PgStat_Counter numfailed;
+	PgStat_Counter raw_bytes;
+	PgStat_Counter compressed_bytes;
+	PgStat_Counter compress_time;	/* time in microseconds */
+} PgStat_StatToastEntry;
+
+
 /*
  * Archiver statistics kept in the stats collector
  */
@@ -760,6 +874,18 @@ typedef struct PgStat_SLRUStats
 	TimestampTz stat_reset_timestamp;
 } PgStat_SLRUStats;
 
+/*
+ * Decompression statistics kept in the stats collector, per compression
+ * method
+ */
+typedef struct PgStat_DecompressionStats
+{
+	PgStat_Counter numdecompressed;
+	PgStat_Counter raw_bytes;
+	PgStat_Counter decompress_time; /* time in microseconds */
+	TimestampTz stat_reset_timestamp;
+} PgStat_DecompressionStats;
+
 
 /* ----------
  * Backend states
@@ -806,6 +932,7 @@ typedef enum
 	WAIT_EVENT_BGWRITER_HIBERNATE,
 	WAIT_EVENT_BGWRITER_MAIN,
 	WAIT_EVENT_CHECKPOINTER_MAIN,
+	WAIT_EVENT_IO_WORKER_MAIN,
 	WAIT_EVENT_LOGICAL_APPLY_MAIN,
 	WAIT_EVENT_LOGICAL_LAUNCHER_MAIN,
 	WAIT_EVENT_PGSTAT_MAIN,
@@ -846,7 +973,8 @@ typedef enum
  */
 typedef enum
 {
-	WAIT_EVENT_BACKUP_WAIT_WAL_ARCHIVE = PG_WAIT_IPC,
+	WAIT_EVENT_AIO_COMPLETION = PG_WAIT_IPC,
+	WAIT_EVENT_BACKUP_WAIT_WAL_ARCHIVE,
 	WAIT_EVENT_BGWORKER_SHUTDOWN,
 	WAIT_EVENT_BGWORKER_STARTUP,
 	WAIT_EVENT_BTREE_PAGE,
@@ -877,6 +1005,7 @@ typedef enum
 	WAIT_EVENT_PARALLEL_BITMAP_SCAN,
 	WAIT_EVENT_PARALLEL_CREATE_INDEX_SCAN,
 	WAIT_EVENT_PARALLEL_FINISH,
+	WAIT_EVENT_PARALLEL_REDO_WORKERS,
 	WAIT_EVENT_PROCARRAY_GROUP_UPDATE,
 	WAIT_EVENT_PROC_SIGNAL_BARRIER,
 	WAIT_EVENT_PROMOTE,
@@ -887,6 +1016,7 @@ typedef enum
 	WAIT_EVENT_REPLICATION_SLOT_DROP,
 	WAIT_EVENT_SAFE_SNAPSHOT,
 	WAIT_EVENT_SYNC_REP,
+	WAIT_EVENT_WAL_GROUP_FLUSH,
 	WAIT_EVENT_XACT_GROUP_UPDATE
 } WaitEventIPC;
 
@@ -1250,6 +1380,7 @@ typedef struct PgStat_FunctionCallUsage
 extern PGDLLIMPORT bool pgstat_track_activities;
 extern PGDLLIMPORT bool pgstat_track_counts;
 extern PGDLLIMPORT int pgstat_track_functions;
+extern PGDLLIMPORT bool pgstat_track_toast;
 extern PGDLLIMPORT int pgstat_track_activity_query_size;
 extern char *pgstat_stat_directory;
 extern char *pgstat_stat_tmpname;
@@ -1457,6 +1588,12 @@ extern void pgstat_twophase_postcommit(TransactionId xid, uint16 info,
 extern void pgstat_twophase_postabort(TransactionId xid, uint16 info,
 									  void *recdata, uint32 len);
 
+extern void pgstat_count_toast_compression(Oid relid, AttrNumber attnum,
+										   int32 rawsize, int32 compressed_size,
+										   instr_time start);
+extern void pgstat_count_toast_decompression(ToastCompressionId cmid,
+											 int32 rawsize, instr_time start);
+
 extern void pgstat_send_archiver(const char *xlog, bool failed);
 extern void pgstat_send_bgwriter(void);
 
@@ -1474,6 +1611,7 @@ extern int	pgstat_fetch_stat_numbackends(void);
 extern PgStat_ArchiverStats *pgstat_fetch_stat_archiver(void);
 extern PgStat_GlobalStats *pgstat_fetch_global(void);
 extern PgStat_SLRUStats *pgstat_fetch_slru(void);
+extern PgStat_DecompressionStats *pgstat_fetch_decompression(void);
 
 extern void pgstat_count_slru_page_zeroed(int slru_idx);
 extern void pgstat_count_slru_page_hit(int slru_idx);
@@ -0,0 +1,38 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_iovec.h
+ *	  Header for vectored I/O functions, to use in place of <sys/uio.h>.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/port/pg_iovec.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PG_IOVEC_H
+#define PG_IOVEC_H
+
+#include <limits.h>
+
+#ifndef WIN32
+#include <sys/uio.h>
+#endif
+
+#ifndef IOV_MAX
+/* POSIX requires at least 16 as the maximum iovcnt */
+#define IOV_MAX 16
+#endif
+
+#ifdef WIN32
+struct iovec
+{
+	void	   *iov_base;
+	size_t		iov_len;
+};
+#endif
+
+/* A maximum that is reasonable to put on the stack */
+#define PG_IOV_MAX Min(IOV_MAX, 32)
+
+#endif							/* PG_IOVEC_H */
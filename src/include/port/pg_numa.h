@@ -0,0 +1,24 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_numa.h
+ *	  Basic NUMA portability routines
+ *
+ *
+ * Copyright (c) 2020, PostgreSQL Global Development Group
+ *
+ * src/include/port/pg_numa.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PG_NUMA_H
+#define PG_NUMA_H
+
+extern int	pg_numa_init(void);
+extern int	pg_numa_get_max_node(void);
+extern int	pg_numa_query_pages(int pid, unsigned long count, void **pages,
+								int *status);
+extern void pg_numa_interleave_memory(void *start, size_t size);
+extern void pg_numa_bind_memory(void *start, size_t size, int node);
+extern int	pg_numa_run_on_node(int node);
+
+#endif							/* PG_NUMA_H */
@@ -0,0 +1,94 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio.h
+ *	  Asynchronous I/O on relation data files.
+ *
+ * A process starts I/Os on shared buffers with pgaio_start_readv() or
+ * pgaio_start_writev() and later collects them with pgaio_wait_all(), which
+ * runs the completion callback of each I/O in the process that started it.
+ * Up to PGAIO_MAX_IN_FLIGHT I/Os per process can be in flight at a time.
+ *
+ * How the I/O is performed depends on io_method: synchronously when it is
+ * started ("sync"), by a pool of I/O worker processes ("worker"), or by the
+ * kernel through an io_uring ("io_uring", Linux only).
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/aio.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AIO_H
+#define AIO_H
+
+#include "storage/block.h"
+#include "storage/relfilenode.h"
+
+struct SMgrRelationData;
+
+/* Possible values for io_method */
+typedef enum IoMethod
+{
+	IOMETHOD_SYNC,
+	IOMETHOD_WORKER,
+	IOMETHOD_IO_URING
+} IoMethod;
+
+/* GUC parameters */
+extern PGDLLIMPORT int io_method;
+extern PGDLLIMPORT int io_workers;
+
+/* upper limit for io_workers */
+#define MAX_IO_WORKERS			32
+
+/* number of I/Os a process can have in flight */
+#define PGAIO_MAX_IN_FLIGHT		16
+
+/* maximum number of blocks in one I/O */
+#define PGAIO_MAX_BLOCKS		16
+
+typedef enum PgAioOp
+{
+	PGAIO_OP_READV,				/* read consecutive blocks */
+	PGAIO_OP_WRITEV				/* write consecutive blocks */
+} PgAioOp;
+
+/*
+ * Description of an I/O, as passed to its completion callback.  The pages
+ * must be in shared memory, that is shared buffers or a bounce buffer from
+ * pgaio_bounce_buffer(), so that an I/O worker can access them.  cb_data
+ * is for the callback's use.
+ */
+typedef struct PgAioRequest
+{
+	PgAioOp		op;
+	RelFileNodeBackend rnode;
+	ForkNumber	forknum;
+	BlockNumber blocknum;
+	int			nblocks;
+	bool		skipFsync;		/* for writes */
+	char	   *pages[PGAIO_MAX_BLOCKS];
+	int			cb_data[PGAIO_MAX_BLOCKS];
+} PgAioRequest;
+
+typedef void (*PgAioCallback) (const PgAioRequest *req);
+
+extern Size AioShmemSize(void);
+extern void AioShmemInit(void);
+extern void AioWorkerRegister(void);
+extern void IoWorkerMain(Datum main_arg);
+
+extern void pgaio_start_readv(struct SMgrRelationData *reln, ForkNumber forknum,
+							  BlockNumber blocknum, char **pages, int nblocks,
+							  const int *cb_data, PgAioCallback callback);
+extern void pgaio_start_writev(struct SMgrRelationData *reln, ForkNumber forknum,
+							   BlockNumber blocknum, char **pages, int nblocks,
+							   bool skipFsync, const int *cb_data,
+							   PgAioCallback callback);
+extern char *pgaio_bounce_buffer(void);
+extern void pgaio_reap(void);
+extern void pgaio_wait_all(void);
+extern void pgaio_at_error(void);
+
+#endif							/* AIO_H */
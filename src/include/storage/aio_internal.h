@@ -0,0 +1,60 @@
+/*-------------------------------------------------------------------------
+ *
+ * aio_internal.h
+ *	  Definitions shared by the asynchronous I/O methods, see aio.h.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/aio_internal.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef AIO_INTERNAL_H
+#define AIO_INTERNAL_H
+
+#include "port/atomics.h"
+#include "storage/aio.h"
+
+/* States of an I/O handle */
+typedef enum PgAioState
+{
+	PGAIO_IDLE,					/* not in use */
+	PGAIO_QUEUED,				/* waiting for an I/O worker */
+	PGAIO_IN_FLIGHT,			/* being performed */
+	PGAIO_DONE					/* performed, callback not run yet */
+} PgAioState;
+
+#define PGAIO_ERROR_MSG_LEN		256
+
+/*
+ * An I/O in shared memory.  Each process that can start I/Os owns
+ * PGAIO_MAX_IN_FLIGHT consecutive handles, starting at handle number
+ * pgprocno * PGAIO_MAX_IN_FLIGHT.
+ */
+typedef struct PgAioHandle
+{
+	pg_atomic_uint32 state;		/* a PgAioState */
+	PgAioRequest req;
+
+	/*
+	 * Result of the I/O.  If kernel_result is set, result is what the
+	 * kernel returned for it (byte count or negated errno), to be checked by
+	 * the smgr; otherwise it was checked when it was performed, and a failure
+	 * is reported in error_code and error_msg.
+	 */
+	bool		kernel_result;
+	int			result;
+	int			error_code;
+	char		error_msg[PGAIO_ERROR_MSG_LEN];
+} PgAioHandle;
+
+extern PgAioHandle *AioHandles;
+
+/* in aio_uring.c */
+#ifdef USE_LIBURING
+extern bool pgaio_uring_submit(PgAioHandle *ioh, int n);
+extern void pgaio_uring_drain(bool wait);
+#endif
+
+#endif							/* AIO_INTERNAL_H */
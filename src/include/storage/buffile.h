@@ -32,11 +32,24 @@
 
 typedef struct BufFile BufFile;
 
+/* Compression methods for temporary files, see temp_file_compression */
+typedef enum TempFileCompression
+{
+	TEMP_FILE_COMPRESSION_NONE,
+	TEMP_FILE_COMPRESSION_PGLZ,
+	TEMP_FILE_COMPRESSION_LZ4,
+	TEMP_FILE_COMPRESSION_ZSTD
+} TempFileCompression;
+
+/* GUC variable */
+extern PGDLLIMPORT int temp_file_compression;
+
 /*
  * prototypes for functions in buffile.c
  */
 
 extern BufFile *BufFileCreateTemp(bool interXact);
+extern BufFile *BufFileCreateCompressedTemp(bool interXact);
 extern void BufFileClose(BufFile *file);
 extern size_t BufFileRead(BufFile *file, void *ptr, size_t size);
 extern void BufFileWrite(BufFile *file, void *ptr, size_t size);
@@ -73,6 +73,7 @@ extern int	effective_io_concurrency;
 extern int	maintenance_io_concurrency;
 
 extern int	checkpoint_flush_after;
+extern int	checkpoint_combine_limit;
 extern int	backend_flush_after;
 extern int	bgwriter_flush_after;
 
@@ -87,6 +88,12 @@ extern PGDLLIMPORT int32 *LocalRefCount;
 /* upper limit for effective_io_concurrency */
 #define MAX_IO_CONCURRENCY 1000
 
+/* upper limit on the number of blocks ReadBuffersRange() reads at once */
+#define MAX_BUFFERS_PER_READ 16
+
+/* upper limit for checkpoint_combine_limit */
+#define MAX_BUFFERS_PER_WRITE 16
+
 /* special block number for ReadBuffer() */
 #define P_NEW	InvalidBlockNumber	/* grow the file to get a new page */
 
@@ -180,6 +187,9 @@ extern Buffer ReadBuffer(Relation reln, BlockNumber blockNum);
 extern Buffer ReadBufferExtended(Relation reln, ForkNumber forkNum,
 								 BlockNumber blockNum, ReadBufferMode mode,
 								 BufferAccessStrategy strategy);
+extern int	ReadBuffersRange(Relation reln, ForkNumber forkNum,
+							 BlockNumber blockNum, int nblocks,
+							 BufferAccessStrategy strategy, Buffer *buffers);
 extern Buffer ReadBufferWithoutRelcache(RelFileNode rnode,
 										ForkNumber forkNum, BlockNumber blockNum,
 										ReadBufferMode mode, BufferAccessStrategy strategy);
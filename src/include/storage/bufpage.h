@@ -176,13 +176,20 @@ typedef PageHeaderData *PageHeader;
  * PD_PAGE_FULL is set if an UPDATE doesn't find enough free space in the
  * page for its new tuple version; this suggests that a prune is needed.
  * Again, this is just a hint.
+ *
+ * PD_COMPRESSIBLE is set by VACUUM on all-frozen heap pages of tables with
+ * the page_compression storage parameter, and tells the storage manager
+ * that it may write the page out compressed (see storage/pagecompress.h).
+ * It is cleared along with PD_ALL_VISIBLE, so that pages that are being
+ * modified again are stored as they are.
  */
 #define PD_HAS_FREE_LINES	0x0001	/* are there any unused line pointers? */
 #define PD_PAGE_FULL		0x0002	/* not enough free space for new tuple? */
 #define PD_ALL_VISIBLE		0x0004	/* all tuples on page are visible to
 									 * everyone */
+#define PD_COMPRESSIBLE		0x0008	/* may be stored compressed on disk? */
 
-#define PD_VALID_FLAG_BITS	0x0007	/* OR of all valid pd_flags bits */
+#define PD_VALID_FLAG_BITS	0x000F	/* OR of all valid pd_flags bits */
 
 /*
  * Page layout version number 0 is for pre-7.3 Postgres releases.
@@ -387,7 +394,12 @@ PageValidateSpecialPointer(Page page)
 #define PageSetAllVisible(page) \
 	(((PageHeader) (page))->pd_flags |= PD_ALL_VISIBLE)
 #define PageClearAllVisible(page) \
-	(((PageHeader) (page))->pd_flags &= ~PD_ALL_VISIBLE)
+	(((PageHeader) (page))->pd_flags &= ~(PD_ALL_VISIBLE | PD_COMPRESSIBLE))
+
+#define PageIsCompressible(page) \
+	(((PageHeader) (page))->pd_flags & PD_COMPRESSIBLE)
+#define PageSetCompressible(page) \
+	(((PageHeader) (page))->pd_flags |= PD_COMPRESSIBLE)
 
 #define PageIsPrunable(page, oldestxmin) \
 ( \
@@ -32,8 +32,21 @@ extern bool mdprefetch(SMgrRelation reln, ForkNumber forknum,
 					   BlockNumber blocknum);
 extern void mdread(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
 				   char *buffer);
+extern void mdreadv(SMgrRelation reln, ForkNumber forknum,
+					BlockNumber blocknum, char **buffers, BlockNumber nblocks);
+extern int	mdfd(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				 off_t *off, BlockNumber *nblocks);
+extern void mdreadv_complete(SMgrRelation reln, ForkNumber forknum,
+							 BlockNumber blocknum, char **buffers,
+							 BlockNumber nblocks, int nbytes);
+extern void mdwrite_complete(SMgrRelation reln, ForkNumber forknum,
+							 BlockNumber blocknum, BlockNumber nblocks,
+							 int nbytes, bool skipFsync);
 extern void mdwrite(SMgrRelation reln, ForkNumber forknum,
 					BlockNumber blocknum, char *buffer, bool skipFsync);
+extern void mdwritev(SMgrRelation reln, ForkNumber forknum,
+					 BlockNumber blocknum, char **buffers, BlockNumber nblocks,
+					 bool skipFsync);
 extern void mdwriteback(SMgrRelation reln, ForkNumber forknum,
 						BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber mdnblocks(SMgrRelation reln, ForkNumber forknum);
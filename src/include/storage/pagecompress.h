@@ -0,0 +1,61 @@
+/*-------------------------------------------------------------------------
+ *
+ * pagecompress.h
+ *	  On-disk compression of whole data pages.
+ *
+ * Portions Copyright (c) 1996-2020, PostgreSQL Global Development Group
+ * Portions Copyright (c) 1994, Regents of the University of California
+ *
+ * src/include/storage/pagecompress.h
+ *
+ *-------------------------------------------------------------------------
+ */
+#ifndef PAGECOMPRESS_H
+#define PAGECOMPRESS_H
+
+#include "storage/block.h"
+#include "storage/bufpage.h"
+
+/*
+ * A page marked PD_COMPRESSIBLE may be written out as a compressed image,
+ * which starts with this header instead of a PageHeaderData.  The fields
+ * line up with those of PageHeaderData, so that pd_lsn and pd_checksum are
+ * where tools reading the file expect them, and pd_method overlays pd_upper
+ * so that the image never looks like a new page.  The rest of the block
+ * after the compressed data reads as zeroes; normally it is a hole in the
+ * file.
+ *
+ * The compressed image only ever exists on disk: md.c decompresses it as
+ * soon as it is read, so shared buffers and WAL only see ordinary pages.
+ */
+typedef struct CompressedPageHeaderData
+{
+	PageXLogRecPtr pd_lsn;		/* copied from the uncompressed page */
+	uint16		pd_checksum;	/* checksum of the compressed image */
+	uint16		pd_flags;		/* PD_COMPRESSED_IMAGE */
+	uint16		pd_compressed_size; /* bytes of compressed data */
+	uint16		pd_method;		/* PAGE_COMPRESSION_* */
+} CompressedPageHeaderData;
+
+#define SizeOfCompressedPageHeaderData	sizeof(CompressedPageHeaderData)
+
+/* pd_flags bit of a compressed image; never set on an ordinary page */
+#define PD_COMPRESSED_IMAGE		0x8000
+
+/* Compression methods; zero is not used, see above */
+#define PAGE_COMPRESSION_PGLZ	1
+#define PAGE_COMPRESSION_LZ4	2
+
+/*
+ * Compressed images are padded to a multiple of this, the usual filesystem
+ * block size, since only whole filesystem blocks can be freed.
+ */
+#define PAGE_COMPRESS_ALIGN		4096
+
+#define PageIsCompressedImage(page) \
+	((((CompressedPageHeaderData *) (page))->pd_flags & PD_COMPRESSED_IMAGE) != 0)
+
+extern int	PageCompress(Page page, BlockNumber blkno, char *image);
+extern bool PageDecompress(char *buffer);
+
+#endif							/* PAGECOMPRESS_H */
@@ -35,6 +35,8 @@ typedef struct PGShmemHeader	/* standard header for all Postgres shmem */
 	Size		freeoffset;		/* offset to first free space */
 	dsm_handle	dsm_control;	/* ID of dynamic shared memory control seg */
 	void	   *index;			/* pointer to ShmemIndex table */
+	Size		pagesize;		/* size of the memory pages of the segment */
+	int			numa_nodes;		/* # of NUMA nodes it's spread over, or 0 */
 #ifndef WIN32					/* Windows doesn't have useful inode#s */
 	dev_t		device;			/* device data directory is on */
 	ino_t		inode;			/* inode number of data directory */
@@ -45,6 +47,8 @@ typedef struct PGShmemHeader	/* standard header for all Postgres shmem */
 extern int	shared_memory_type;
 extern int	huge_pages;
 extern int	huge_page_size;
+extern int	shared_memory_numa;
+extern bool numa_pin_backends;
 
 /* Possible values for huge_pages */
 typedef enum
@@ -54,6 +58,14 @@ typedef enum
 	HUGE_PAGES_TRY
 }			HugePagesType;
 
+/* Possible values for shared_memory_numa */
+typedef enum
+{
+	SHMEM_NUMA_OFF,
+	SHMEM_NUMA_INTERLEAVE,
+	SHMEM_NUMA_PARTITION
+}			SharedMemoryNumaType;
+
 /* Possible values for shared_memory_type */
 typedef enum
 {
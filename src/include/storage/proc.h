@@ -194,6 +194,11 @@ struct PGPROC
 	XLogRecPtr	clogGroupMemberLsn; /* WAL location of commit record for clog
 									 * group member */
 
+	/* Support for group WAL flushing. */
+	bool		walFlushGroupMember;	/* true, if member of flush group */
+	pg_atomic_uint32 walFlushGroupNext; /* next flush group member */
+	XLogRecPtr	walFlushGroupMemberLsn; /* WAL location to flush up to */
+
 	/* Lock manager data, recording fast-path locks taken by this backend. */
 	LWLock		fpInfoLock;		/* protects per-backend fast-path state */
 	uint64		fpLockBits;		/* lock modes held for each fast-path slot */
@@ -44,6 +44,11 @@ extern HTAB *ShmemInitHash(const char *name, long init_size, long max_size,
 extern void *ShmemInitStruct(const char *name, Size size, bool *foundPtr);
 extern Size add_size(Size s1, Size s2);
 extern Size mul_size(Size s1, Size s2);
+extern int	ShmemNumaNodes(void);
+extern void ShmemNumaBind(void *start, Size size, int node);
+extern void ShmemNumaPinProcess(int pgprocno);
+
+extern PGDLLIMPORT int MyNumaNode;
 
 /* ipci.c */
 extern void RequestAddinShmemSpace(Size size);
@@ -94,8 +94,22 @@ extern bool smgrprefetch(SMgrRelation reln, ForkNumber forknum,
 						 BlockNumber blocknum);
 extern void smgrread(SMgrRelation reln, ForkNumber forknum,
 					 BlockNumber blocknum, char *buffer);
+extern void smgrreadv(SMgrRelation reln, ForkNumber forknum,
+					  BlockNumber blocknum, char **buffers,
+					  BlockNumber nblocks);
+extern int	smgrfd(SMgrRelation reln, ForkNumber forknum, BlockNumber blocknum,
+				   off_t *off, BlockNumber *nblocks);
+extern void smgrreadv_complete(SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber blocknum, char **buffers,
+							   BlockNumber nblocks, int nbytes);
+extern void smgrwrite_complete(SMgrRelation reln, ForkNumber forknum,
+							   BlockNumber blocknum, BlockNumber nblocks,
+							   int nbytes, bool skipFsync);
 extern void smgrwrite(SMgrRelation reln, ForkNumber forknum,
 					  BlockNumber blocknum, char *buffer, bool skipFsync);
+extern void smgrwritev(SMgrRelation reln, ForkNumber forknum,
+					   BlockNumber blocknum, char **buffers,
+					   BlockNumber nblocks, bool skipFsync);
 extern void smgrwriteback(SMgrRelation reln, ForkNumber forknum,
 						  BlockNumber blocknum, BlockNumber nblocks);
 extern BlockNumber smgrnblocks(SMgrRelation reln, ForkNumber forknum);
@@ -133,6 +133,8 @@ extern uint32 get_hash_value(HTAB *hashp, const void *keyPtr);
 extern void *hash_search_with_hash_value(HTAB *hashp, const void *keyPtr,
 										 uint32 hashvalue, HASHACTION action,
 										 bool *foundPtr);
+extern void *hash_search_optimistic(HTAB *hashp, const void *keyPtr,
+									uint32 hashvalue);
 extern bool hash_update_hash_key(HTAB *hashp, void *existingEntry,
 								 const void *newKeyPtr);
 extern long hash_get_num_entries(HTAB *hashp);
@@ -305,6 +305,9 @@ typedef struct StdRdOptions
 	int			parallel_workers;	/* max number of parallel workers */
 	bool		vacuum_index_cleanup;	/* enables index vacuuming and cleanup */
 	bool		vacuum_truncate;	/* enables vacuum to truncate a relation */
+	bool		page_compression;	/* store all-frozen pages compressed */
+	bool		columnar_cache; /* cache attribute offsets of all-visible
+								 * pages */
 } StdRdOptions;
 
 #define HEAP_MIN_FILLFACTOR			10
@@ -360,6 +363,28 @@ typedef struct StdRdOptions
 	((relation)->rd_options ? \
 	 ((StdRdOptions *) (relation)->rd_options)->parallel_workers : (defaultpw))
 
+/*
+ * RelationUsesPageCompression
+ *		Returns whether VACUUM should mark all-frozen pages of the relation
+ *		as ones that may be stored compressed.
+ */
+#define RelationUsesPageCompression(relation) \
+	((relation)->rd_options && \
+	 ((relation)->rd_rel->relkind == RELKIND_RELATION || \
+	  (relation)->rd_rel->relkind == RELKIND_MATVIEW) ? \
+	 ((StdRdOptions *) (relation)->rd_options)->page_compression : false)
+
+/*
+ * RelationUsesColumnarCache
+ *		Returns whether scans should load all-visible pages of the relation
+ *		into the columnar cache.
+ */
+#define RelationUsesColumnarCache(relation) \
+	((relation)->rd_options && \
+	 ((relation)->rd_rel->relkind == RELKIND_RELATION || \
+	  (relation)->rd_rel->relkind == RELKIND_MATVIEW) ? \
+	 ((StdRdOptions *) (relation)->rd_options)->columnar_cache : false)
+
 /* ViewOptions->check_option values */
 typedef enum ViewOptCheckOption
 {
@@ -0,0 +1,122 @@
+/*-------------------------------------------------------------------------
+ *
+ * pg_numa.c
+ *	  Basic NUMA portability routines
+ *
+ * These are thin wrappers around libnuma.  Without it, the machine is
+ * treated as having no NUMA support at all: pg_numa_init() fails, and the
+ * other routines must not be called.
+ *
+ * Copyright (c) 2020, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *	  src/port/pg_numa.c
+ *
+ *-------------------------------------------------------------------------
+ */
+#include "c.h"
+
+#ifdef USE_LIBNUMA
+#include <numa.h>
+#include <numaif.h>
+#endif
+
+#include "port/pg_numa.h"
+
+#ifdef USE_LIBNUMA
+
+/*
+ * Check whether NUMA is usable.  Returns -1 if not.
+ */
+int
+pg_numa_init(void)
+{
+	return numa_available();
+}
+
+/*
+ * Return the highest node number on the machine.
+ */
+int
+pg_numa_get_max_node(void)
+{
+	return numa_max_node();
+}
+
+/*
+ * Find out the nodes of count pages of the memory of process pid (0 for the
+ * calling process).  status[i] is set to the node of pages[i], or to a
+ * negative errno, -ENOENT if no process has touched the page yet.
+ */
+int
+pg_numa_query_pages(int pid, unsigned long count, void **pages, int *status)
+{
+	return numa_move_pages(pid, count, pages, NULL, status, 0);
+}
+
+/*
+ * Have the pages of the given memory spread round-robin over all nodes,
+ * as they are first touched.
+ */
+void
+pg_numa_interleave_memory(void *start, size_t size)
+{
+	numa_interleave_memory(start, size, numa_all_nodes_ptr);
+}
+
+/*
+ * Have the pages of the given memory allocated on the given node, as they
+ * are first touched.
+ */
+void
+pg_numa_bind_memory(void *start, size_t size, int node)
+{
+	numa_tonode_memory(start, size, node);
+}
+
+/*
+ * Restrict the calling process to the CPUs of the given node.
+ */
+int
+pg_numa_run_on_node(int node)
+{
+	return numa_run_on_node(node);
+}
+
+#else
+
+int
+pg_numa_init(void)
+{
+	return -1;
+}
+
+int
+pg_numa_get_max_node(void)
+{
+	return 0;
+}
+
+int
+pg_numa_query_pages(int pid, unsigned long count, void **pages, int *status)
+{
+	return -1;
+}
+
+void
+pg_numa_interleave_memory(void *start, size_t size)
+{
+}
+
+void
+pg_numa_bind_memory(void *start, size_t size, int node)
+{
+}
+
+int
+pg_numa_run_on_node(int node)
+{
+	return -1;
+}
+
+#endif							/* USE_LIBNUMA */
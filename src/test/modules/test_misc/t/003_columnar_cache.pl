@@ -0,0 +1,87 @@
+# Check that scans of a table in the columnar cache give the same results
+# as scans of an identical table that isn't cached
+
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 5;
+
+my $node = get_new_node('primary');
+$node->init();
+$node->append_conf(
+	'postgresql.conf', qq{
+columnar_cache_size = 1MB
+autovacuum = off
+});
+$node->start;
+
+# Variable-width and null attributes, so that the offsets of the later
+# attributes differ from tuple to tuple
+foreach my $t ('cached', 'plain')
+{
+	my $opt = $t eq 'cached' ? 'true' : 'false';
+	$node->safe_psql(
+		'postgres', qq{
+CREATE TABLE $t (a int, b text, c int, d numeric, e text, f int)
+	WITH (columnar_cache = $opt);
+INSERT INTO $t
+	SELECT g, repeat('x', g % 37), CASE WHEN g % 5 = 0 THEN NULL ELSE g END,
+		   g / 7.0, CASE WHEN g % 3 = 0 THEN NULL ELSE md5(g::text) END, -g
+	FROM generate_series(1, 20000) g;
+VACUUM $t;
+});
+}
+
+sub check
+{
+	my ($name) = @_;
+	my $query =
+	  "SELECT count(*), sum(a), sum(length(b)), sum(c), sum(d), "
+	  . "count(e), sum(length(e)), sum(f), max(e) FROM ";
+
+	# Scan twice, so that the second scan reads the entries the first built
+	$node->safe_psql('postgres', $query . 'cached');
+	my $result = $node->safe_psql('postgres',
+		"SET enable_batch_execution = off; " . $query . 'cached');
+	is($result, $node->safe_psql('postgres', $query . 'plain'), $name);
+}
+
+check('scan of cached table');
+
+my $batch = $node->safe_psql('postgres',
+	"SET enable_batch_execution = on; "
+	  . "SELECT count(*), sum(c), sum(f) FROM cached WHERE c > 100");
+is( $batch,
+	$node->safe_psql('postgres',
+		"SELECT count(*), sum(c), sum(f) FROM plain WHERE c > 100"),
+	'batch scan of cached table');
+
+# Modifying pages must not leave behind entries that are used
+foreach my $t ('cached', 'plain')
+{
+	$node->safe_psql(
+		'postgres', qq{
+UPDATE $t SET b = 'yy', c = NULL WHERE a % 100 = 0;
+DELETE FROM $t WHERE a % 250 = 1;
+});
+}
+check('scan after modifications');
+
+foreach my $t ('cached', 'plain')
+{
+	$node->safe_psql('postgres', "VACUUM $t");
+}
+check('scan after pruning');
+
+# Tuples with fewer attributes than the table
+foreach my $t ('cached', 'plain')
+{
+	$node->safe_psql('postgres',
+		"ALTER TABLE $t ADD COLUMN g int DEFAULT 42");
+}
+is( $node->safe_psql('postgres', 'SELECT sum(f), sum(g) FROM cached'),
+	$node->safe_psql('postgres', 'SELECT sum(f), sum(g) FROM plain'),
+	'scan after adding a column');
+
+$node->stop;
@@ -0,0 +1,82 @@
+# Check that frozen pages of a table with page_compression are stored
+# compressed, and read back correctly after a restart
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 4;
+
+my $node = get_new_node('primary');
+$node->init();
+
+# Pages are only compressed when hint bit changes are WAL-logged
+$node->append_conf(
+	'postgresql.conf', qq{
+wal_log_hints = on
+autovacuum = off
+});
+$node->start;
+
+$node->safe_psql(
+	'postgres', q{
+CREATE TABLE pc (a int, b text) WITH (page_compression = on);
+INSERT INTO pc SELECT g, repeat('abcdefgh', 8) FROM generate_series(1, 20000) g;
+VACUUM FREEZE pc;
+CHECKPOINT;
+});
+
+my $query = "SELECT count(*), sum(a), count(DISTINCT b) FROM pc";
+my $expected = $node->safe_psql('postgres', $query);
+my $blcksz = $node->safe_psql('postgres', 'SHOW block_size');
+my $file = $node->data_dir . '/'
+  . $node->safe_psql('postgres', "SELECT pg_relation_filepath('pc')");
+
+$node->restart;
+
+is($node->safe_psql('postgres', $query),
+	$expected, 'data of compressed pages after restart');
+
+# Count the blocks stored as compressed images, whose pd_flags have
+# PD_COMPRESSED_IMAGE set
+sub compressed_blocks
+{
+	my $count = 0;
+	my $block;
+
+	open(my $fh, '<', $file) or die "could not open \"$file\": $!";
+	binmode $fh;
+	while (read($fh, $block, $blcksz) == $blcksz)
+	{
+		$count++ if unpack('v', substr($block, 10, 2)) & 0x8000;
+	}
+	close $fh;
+	return $count;
+}
+
+my $nblocks = (-s $file) / $blcksz;
+my $ncompressed = compressed_blocks();
+ok($ncompressed > $nblocks / 2,
+	"frozen blocks are stored compressed ($ncompressed of $nblocks)");
+
+SKIP:
+{
+	# Holes are only punched where fallocate() supports it
+	skip 'hole punching is only supported on Linux', 1
+	  unless $^O eq 'linux';
+
+	my ($size, $allocated) = (stat $file)[ 7, 12 ];
+	cmp_ok($allocated * 512, '<', $size,
+		'file takes less space than its size');
+}
+
+# A modified page is stored uncompressed again
+$node->safe_psql(
+	'postgres', q{
+UPDATE pc SET b = 'x' WHERE a = 1;
+CHECKPOINT;
+});
+$node->restart;
+is($node->safe_psql('postgres', "SELECT b FROM pc WHERE a = 1"),
+	'x', 'modified page after restart');
+
+$node->stop;
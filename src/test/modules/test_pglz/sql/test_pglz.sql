@@ -0,0 +1,10 @@
+CREATE EXTENSION test_pglz;
+
+-- See README for explanation of arguments:
+SELECT test_pglz(seed => -1, tests => 1000);
+
+-- The benchmark's timings vary, so only check that it ran.
+SELECT rawsize, compressed_size < rawsize AS compressed,
+       reference_ms >= 0 AND optimized_ms >= 0 AS timed
+  FROM test_pglz_benchmark(convert_to(repeat('PostgreSQL pglz test ', 1000), 'UTF8'),
+                           loops => 10);
@@ -0,0 +1,18 @@
+/* src/test/modules/test_pglz/test_pglz--1.0.sql */
+
+-- complain if script is sourced in psql, rather than via CREATE EXTENSION
+\echo Use "CREATE EXTENSION test_pglz" to load this file. \quit
+
+CREATE FUNCTION test_pglz(seed integer DEFAULT -1,
+    tests integer DEFAULT 1000)
+RETURNS pg_catalog.void STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
+
+CREATE FUNCTION test_pglz_benchmark(data bytea,
+    loops integer DEFAULT 1000,
+    OUT rawsize integer,
+    OUT compressed_size integer,
+    OUT reference_ms float8,
+    OUT optimized_ms float8)
+RETURNS record STRICT
+AS 'MODULE_PATHNAME' LANGUAGE C;
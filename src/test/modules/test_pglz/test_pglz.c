@@ -0,0 +1,308 @@
+/*--------------------------------------------------------------------------
+ *
+ * test_pglz.c
+ *		Test pglz compression and decompression, comparing decompression
+ *		against a reference implementation in correctness and speed.
+ *
+ * Copyright (c) 2020, PostgreSQL Global Development Group
+ *
+ * IDENTIFICATION
+ *		src/test/modules/test_pglz/test_pglz.c
+ *
+ * -------------------------------------------------------------------------
+ */
+#include "postgres.h"
+
+#include "access/htup_details.h"
+#include "common/pg_lzcompress.h"
+#include "fmgr.h"
+#include "funcapi.h"
+#include "miscadmin.h"
+#include "portability/instr_time.h"
+#include "utils/builtins.h"
+
+PG_MODULE_MAGIC;
+
+/* Largest input generated by test_pglz() */
+#define MAX_TEST_SIZE		(64 * 1024)
+
+/*
+ * pglz_decompress_reference
+ *
+ * The straightforward decompressor pglz_decompress() used to be, kept here
+ * to check that the current one produces exactly the same output.  It
+ * must only be given valid input.
+ */
+static int32
+pglz_decompress_reference(const char *source, int32 slen, char *dest,
+						  int32 rawsize, bool check_complete)
+{
+	const unsigned char *sp;
+	const unsigned char *srcend;
+	unsigned char *dp;
+	unsigned char *destend;
+
+	sp = (const unsigned char *) source;
+	srcend = ((const unsigned char *) source) + slen;
+	dp = (unsigned char *) dest;
+	destend = dp + rawsize;
+
+	while (sp < srcend && dp < destend)
+	{
+		unsigned char ctrl = *sp++;
+		int			ctrlc;
+
+		for (ctrlc = 0; ctrlc < 8 && sp < srcend && dp < destend; ctrlc++)
+		{
+			if (ctrl & 1)
+			{
+				int32		len;
+				int32		off;
+
+				len = (sp[0] & 0x0f) + 3;
+				off = ((sp[0] & 0xf0) << 4) | sp[1];
+				sp += 2;
+				if (len == 18)
+					len += *sp++;
+
+				len = Min(len, destend - dp);
+				while (off < len)
+				{
+					memcpy(dp, dp - off, off);
+					len -= off;
+					dp += off;
+					off += off;
+				}
+				memcpy(dp, dp - off, len);
+				dp += len;
+			}
+			else
+				*dp++ = *sp++;
+
+			ctrl >>= 1;
+		}
+	}
+
+	if (check_complete && (dp != destend || sp != srcend))
+		return -1;
+
+	return (char *) dp - dest;
+}
+
+/* Simple xorshift generator, so that a seed reproduces a test run */
+static uint32
+test_random(uint32 *state)
+{
+	uint32		x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+	return x;
+}
+
+/*
+ * Fill buf with len bytes of one of several kinds of data, chosen to
+ * exercise literals, short-period overlapping matches and long matches.
+ */
+static void
+generate_data(char *buf, int len, int kind, uint32 *state)
+{
+	int			period = 1 + test_random(state) % 20;
+	int			i;
+
+	for (i = 0; i < len; i++)
+	{
+		switch (kind)
+		{
+			case 0:				/* incompressible */
+				buf[i] = (char) test_random(state);
+				break;
+			case 1:				/* short repeating pattern */
+				buf[i] = 'a' + i % period;
+				break;
+			case 2:				/* repeats with occasional changes */
+				if (i < period || test_random(state) % 8 == 0)
+					buf[i] = (char) test_random(state);
+				else
+					buf[i] = buf[i - period];
+				break;
+			case 3:				/* small alphabet */
+				buf[i] = 'a' + test_random(state) % 3;
+				break;
+			default:			/* text-like */
+				buf[i] = ((i / 37) % 2) ? ' ' : "the quick brown fox "[i % 20];
+				break;
+		}
+	}
+}
+
+/*
+ * Decompress a compressed input both ways, in full or only a prefix of it,
+ * and complain if the results differ.
+ */
+static void
+check_decompress(const char *compressed, int32 clen, const char *orig,
+				 int32 rawsize, bool check_complete,
+				 char *buf1, char *buf2)
+{
+	int32		len1;
+	int32		len2;
+
+	len1 = pglz_decompress_reference(compressed, clen, buf1, rawsize,
+									 check_complete);
+	len2 = pglz_decompress(compressed, clen, buf2, rawsize, check_complete);
+
+	if (len1 != len2)
+		elog(ERROR, "pglz_decompress returned %d, expected %d", len2, len1);
+	if (len1 < 0)
+		elog(ERROR, "pglz_decompress failed on valid input");
+	if (memcmp(buf1, buf2, len1) != 0)
+		elog(ERROR, "pglz_decompress output differs from reference for raw size %d",
+			 rawsize);
+	if (check_complete && memcmp(buf2, orig, rawsize) != 0)
+		elog(ERROR, "pglz_decompress output differs from original data");
+}
+
+PG_FUNCTION_INFO_V1(test_pglz);
+
+/*
+ * SQL-callable entry point to check pglz_decompress() against the
+ * reference implementation, on inputs generated from the given seed (or a
+ * random one if negative).  Also checks that corrupt input is rejected
+ * rather than crashing.
+ */
+Datum
+test_pglz(PG_FUNCTION_ARGS)
+{
+	int			seed = PG_GETARG_INT32(0);
+	int			tests = PG_GETARG_INT32(1);
+	uint32		state;
+	char	   *orig;
+	char	   *compressed;
+	char	   *buf1;
+	char	   *buf2;
+	int			i;
+
+	if (tests <= 0)
+		elog(ERROR, "invalid number of tests: %d", tests);
+
+	state = seed < 0 ? random() % PG_INT32_MAX : seed;
+	elog(DEBUG1, "seed: %u", state);
+	if (state == 0)
+		state = 1;				/* xorshift must not start from zero */
+
+	orig = palloc(MAX_TEST_SIZE);
+	compressed = palloc(PGLZ_MAX_OUTPUT(MAX_TEST_SIZE));
+	buf1 = palloc(MAX_TEST_SIZE);
+	buf2 = palloc(MAX_TEST_SIZE);
+
+	for (i = 0; i < tests; i++)
+	{
+		int32		rawsize;
+		int32		clen;
+		int			kind = test_random(&state) % 5;
+		int			j;
+
+		CHECK_FOR_INTERRUPTS();
+
+		/* mostly small inputs, like typical toasted values */
+		if (i % 10 == 0)
+			rawsize = 1 + test_random(&state) % MAX_TEST_SIZE;
+		else
+			rawsize = 1 + test_random(&state) % 4096;
+
+		generate_data(orig, rawsize, kind, &state);
+
+		/* the default strategy must not bother with random data */
+		if (kind == 0 && rawsize >= 2048 &&
+			pglz_compress(orig, rawsize, compressed, PGLZ_strategy_default) >= 0)
+			elog(ERROR, "pglz_compress compressed random data of size %d",
+				 rawsize);
+
+		clen = pglz_compress(orig, rawsize, compressed, PGLZ_strategy_always);
+		if (clen < 0)
+			continue;
+
+		/* full decompression, and decompression of a few prefixes */
+		check_decompress(compressed, clen, orig, rawsize, true, buf1, buf2);
+		for (j = 0; j < 3; j++)
+			check_decompress(compressed, clen, orig,
+							 1 + test_random(&state) % rawsize, false,
+							 buf1, buf2);
+
+		/* corrupt the input; the result doesn't matter, as long as it fails */
+		for (j = 0; j < 8; j++)
+			compressed[test_random(&state) % clen] = (char) test_random(&state);
+		(void) pglz_decompress(compressed, clen, buf2, rawsize, true);
+	}
+
+	PG_RETURN_VOID();
+}
+
+PG_FUNCTION_INFO_V1(test_pglz_benchmark);
+
+/*
+ * SQL-callable micro-benchmark: compress the given data, then decompress it
+ * "loops" times with each of the reference and current decompressors.
+ */
+Datum
+test_pglz_benchmark(PG_FUNCTION_ARGS)
+{
+	bytea	   *data = PG_GETARG_BYTEA_PP(0);
+	int			loops = PG_GETARG_INT32(1);
+	int32		rawsize = VARSIZE_ANY_EXHDR(data);
+	int32		clen;
+	char	   *compressed;
+	char	   *buf;
+	instr_time	start;
+	instr_time	reference_time;
+	instr_time	optimized_time;
+	TupleDesc	tupdesc;
+	Datum		values[4];
+	bool		nulls[4];
+	int			i;
+
+	if (loops <= 0)
+		elog(ERROR, "invalid number of loops: %d", loops);
+
+	if (get_call_result_type(fcinfo, NULL, &tupdesc) != TYPEFUNC_COMPOSITE)
+		elog(ERROR, "return type must be a row type");
+
+	compressed = palloc(PGLZ_MAX_OUTPUT(rawsize));
+	buf = palloc(rawsize);
+
+	clen = pglz_compress(VARDATA_ANY(data), rawsize, compressed,
+						 PGLZ_strategy_always);
+	if (clen < 0)
+		elog(ERROR, "data is not compressible with pglz");
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (i = 0; i < loops; i++)
+	{
+		if (pglz_decompress_reference(compressed, clen, buf, rawsize, true) < 0)
+			elog(ERROR, "reference decompression failed");
+		CHECK_FOR_INTERRUPTS();
+	}
+	INSTR_TIME_SET_CURRENT(reference_time);
+	INSTR_TIME_SUBTRACT(reference_time, start);
+
+	INSTR_TIME_SET_CURRENT(start);
+	for (i = 0; i < loops; i++)
+	{
+		if (pglz_decompress(compressed, clen, buf, rawsize, true) < 0)
+			elog(ERROR, "decompression failed");
+		CHECK_FOR_INTERRUPTS();
+	}
+	INSTR_TIME_SET_CURRENT(optimized_time);
+	INSTR_TIME_SUBTRACT(optimized_time, start);
+
+	memset(nulls, false, sizeof(nulls));
+	values[0] = Int32GetDatum(rawsize);
+	values[1] = Int32GetDatum(clen);
+	values[2] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(reference_time));
+	values[3] = Float8GetDatum(INSTR_TIME_GET_MILLISEC(optimized_time));
+
+	PG_RETURN_DATUM(HeapTupleGetDatum(heap_form_tuple(tupdesc, values, nulls)));
+}
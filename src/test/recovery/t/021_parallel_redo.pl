@@ -0,0 +1,99 @@
+# Check that WAL replay with parallel redo workers gives the same results,
+# on a hot standby and in crash recovery
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+my $node_primary = get_new_node('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->append_conf(
+	'postgresql.conf', qq{
+recovery_parallel_workers = 2
+max_worker_processes = 8
+});
+$node_primary->start;
+
+my $backup_name = 'my_backup';
+$node_primary->backup($backup_name);
+
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_primary, $backup_name,
+	has_streaming => 1);
+$node_standby->start;
+
+# Many single-page heap and btree records, with transactions in between
+$node_primary->safe_psql(
+	'postgres', q{
+CREATE TABLE t (a int PRIMARY KEY, b text);
+INSERT INTO t SELECT g, repeat('x', 50) FROM generate_series(1, 20000) g;
+UPDATE t SET b = 'y' WHERE a % 3 = 0;
+DELETE FROM t WHERE a % 7 = 0;
+CREATE TABLE u AS SELECT * FROM t;
+DROP TABLE u;
+INSERT INTO t SELECT g, 'z' FROM generate_series(20001, 30000) g;
+});
+
+$node_primary->wait_for_catchup($node_standby, 'replay',
+	$node_primary->lsn('insert'));
+
+my $expected = $node_primary->safe_psql('postgres',
+	"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'y') FROM t");
+
+is( $node_standby->safe_psql(
+		'postgres',
+		"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'y') FROM t"),
+	$expected,
+	'standby replayed the changes');
+
+is( $node_standby->safe_psql(
+		'postgres',
+		"SET enable_seqscan = off; SELECT count(*) FROM t WHERE a > 15000"),
+	$node_primary->safe_psql('postgres',
+		"SELECT count(*) FROM t WHERE a > 15000"),
+	'standby index is consistent with the table');
+
+# The workers exit when the standby is promoted
+$node_standby->promote;
+$node_standby->poll_query_until('postgres',
+	"SELECT count(*) = 0 FROM pg_stat_activity WHERE backend_type = 'parallel redo worker'"
+) or die "timed out waiting for parallel redo workers to exit";
+pass('parallel redo workers exit at the end of recovery');
+
+is( $node_standby->safe_psql(
+		'postgres',
+		"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'y') FROM t"),
+	$expected,
+	'promoted standby has the changes');
+
+# Crash recovery, from a checkpoint before the changes
+$node_primary->safe_psql('postgres', 'CHECKPOINT');
+$node_primary->safe_psql(
+	'postgres', q{
+UPDATE t SET b = 'w' WHERE a % 5 = 0;
+DELETE FROM t WHERE a % 11 = 0;
+INSERT INTO t SELECT g, 'v' FROM generate_series(30001, 40000) g;
+});
+$expected = $node_primary->safe_psql('postgres',
+	"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'w') FROM t");
+
+$node_primary->stop('immediate');
+$node_primary->start;
+
+is( $node_primary->safe_psql(
+		'postgres',
+		"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'w') FROM t"),
+	$expected,
+	'crash recovery replayed the changes');
+
+is( $node_primary->safe_psql(
+		'postgres',
+		"SET enable_seqscan = off; SELECT count(*) FROM t WHERE a > 35000"),
+	$node_primary->safe_psql('postgres',
+		"SET enable_indexscan = off; SET enable_bitmapscan = off; SELECT count(*) FROM t WHERE a > 35000"
+	),
+	'index is consistent with the table after crash recovery');
+
+$node_primary->stop;
+$node_standby->stop;
@@ -0,0 +1,81 @@
+# Check that WAL replay with recovery_prefetch gives the same results, and
+# that pg_stat_recovery_prefetch shows what it did
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 4;
+
+my $node_primary = get_new_node('primary');
+$node_primary->init(allows_streaming => 1);
+$node_primary->start;
+
+# Create the table before the backup, so that the standby has its blocks
+$node_primary->safe_psql(
+	'postgres', q{
+CREATE TABLE t (a int PRIMARY KEY, b text);
+INSERT INTO t SELECT g, repeat('x', 50) FROM generate_series(1, 20000) g;
+});
+
+my $backup_name = 'my_backup';
+$node_primary->backup($backup_name);
+
+my $node_standby = get_new_node('standby');
+$node_standby->init_from_backup($node_primary, $backup_name,
+	has_streaming => 1);
+$node_standby->append_conf(
+	'postgresql.conf', qq{
+recovery_prefetch = on
+recovery_prefetch_distance = 64kB
+});
+$node_standby->start;
+
+$node_primary->safe_psql(
+	'postgres', q{
+UPDATE t SET b = 'y' WHERE a % 3 = 0;
+DELETE FROM t WHERE a % 7 = 0;
+INSERT INTO t SELECT g, 'z' FROM generate_series(20001, 30000) g;
+});
+
+$node_primary->wait_for_catchup($node_standby, 'replay',
+	$node_primary->lsn('insert'));
+
+is( $node_standby->safe_psql(
+		'postgres',
+		"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'y') FROM t"),
+	$node_primary->safe_psql('postgres',
+		"SELECT count(*), sum(a), count(*) FILTER (WHERE b = 'y') FROM t"),
+	'standby replayed the changes');
+
+is( $node_standby->safe_psql(
+		'postgres',
+		"SELECT prefetch + hit + skip_init + skip_new + skip_fpw + skip_rep > 0 FROM pg_stat_recovery_prefetch"
+	),
+	't',
+	'block references were counted');
+
+# A reset is carried out by the startup process, when it replays a record
+my $reset_time = $node_standby->safe_psql('postgres',
+	"SELECT stats_reset FROM pg_stat_recovery_prefetch");
+$node_standby->safe_psql('postgres',
+	"SELECT pg_stat_reset_shared('recovery_prefetch')");
+$node_primary->safe_psql('postgres', "UPDATE t SET b = 'w' WHERE a = 1");
+$node_primary->wait_for_catchup($node_standby, 'replay',
+	$node_primary->lsn('insert'));
+ok( $node_standby->poll_query_until(
+		'postgres',
+		"SELECT stats_reset > '$reset_time' FROM pg_stat_recovery_prefetch"),
+	'statistics were reset');
+
+$node_standby->promote;
+$node_standby->poll_query_until('postgres',
+	"SELECT NOT pg_is_in_recovery()")
+  or die "timed out waiting for promotion";
+
+is( $node_standby->safe_psql(
+		'postgres', "SELECT wal_distance, io_depth FROM pg_stat_recovery_prefetch"),
+	'0|0',
+	'nothing is in progress after recovery');
+
+$node_primary->stop;
+$node_standby->stop;
@@ -0,0 +1,71 @@
+# Check that full-page images compressed with each wal_compression method
+# are replayed correctly by crash recovery
+use strict;
+use warnings;
+use PostgresNode;
+use TestLib;
+use Test::More tests => 6;
+
+my $node = get_new_node('primary');
+$node->init;
+$node->append_conf(
+	'postgresql.conf', qq{
+full_page_writes = on
+autovacuum = off
+});
+$node->start;
+
+my %supported = (
+	pglz => 1,
+	lz4  => $ENV{with_lz4} eq 'yes',
+	zstd => $ENV{with_zstd} eq 'yes');
+
+foreach my $method ('pglz', 'lz4', 'zstd')
+{
+  SKIP:
+	{
+		skip "$method not supported by this build", 2
+		  unless $supported{$method};
+
+		my $table = "t_$method";
+		my $query =
+		  "SELECT count(*), sum(a), md5(string_agg(b, ',' ORDER BY a)) FROM $table";
+
+		# Leave a hole in the middle of the pages
+		$node->safe_psql(
+			'postgres', qq{
+CREATE TABLE $table (a int, b text) WITH (fillfactor = 50);
+INSERT INTO $table SELECT g, md5(g::text) FROM generate_series(1, 5000) g;
+CHECKPOINT;
+});
+
+		# The first change of each page after the checkpoint logs its image
+		my $start_lsn =
+		  $node->safe_psql('postgres', 'SELECT pg_current_wal_insert_lsn()');
+		$node->safe_psql(
+			'postgres', qq{
+SET wal_compression = $method;
+UPDATE $table SET b = repeat(b, 2) WHERE a % 10 = 0;
+});
+		my $end_lsn =
+		  $node->safe_psql('postgres', 'SELECT pg_current_wal_flush_lsn()');
+
+		my ($stdout, $stderr) = run_command(
+			[
+				'pg_waldump', '-b', '-p', $node->data_dir . '/pg_wal',
+				'-s', $start_lsn, '-e', $end_lsn
+			]);
+		like($stdout, qr/method: $method/,
+			"full-page images compressed with $method");
+
+		my $expected = $node->safe_psql('postgres', $query);
+
+		$node->stop('immediate');
+		$node->start;
+
+		is($node->safe_psql('postgres', $query),
+			$expected, "replay of full-page images compressed with $method");
+	}
+}
+
+$node->stop;
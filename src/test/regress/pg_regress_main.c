@@ -75,14 +75,17 @@ psql_start_test(const char *testname,
 
 	/*
 	 * Use HIDE_TABLEAM to hide different AMs to allow to use regression tests
-	 * against different AMs without unnecessary differences.
+	 * against different AMs without unnecessary differences.  Likewise,
+	 * HIDE_TOAST_COMPRESSION hides compression methods so that the output
+	 * doesn't depend on default_toast_compression.
 	 */
 	offset += snprintf(psql_cmd + offset, sizeof(psql_cmd) - offset,
-					   "\"%s%spsql\" -X -a -q -d \"%s\" -v %s < \"%s\" > \"%s\" 2>&1",
+					   "\"%s%spsql\" -X -a -q -d \"%s\" -v %s -v %s < \"%s\" > \"%s\" 2>&1",
 					   bindir ? bindir : "",
 					   bindir ? "/" : "",
 					   dblist->str,
 					   "HIDE_TABLEAM=\"on\"",
+					   "HIDE_TOAST_COMPRESSION=\"on\"",
 					   infile,
 					   outfile);
 	if (offset >= sizeof(psql_cmd))
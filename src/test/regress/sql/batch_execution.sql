@@ -0,0 +1,71 @@
+--
+-- Test batch execution of sequential scans and aggregates
+--
+
+CREATE TABLE batch_tbl (a int4, b int8, c float8, d date, e text, f int2, g float4);
+INSERT INTO batch_tbl
+  SELECT i, i * 10, i / 4.0, date '2000-01-01' + i, 'r' || i, i % 100, i % 7
+  FROM generate_series(1, 5000) i;
+INSERT INTO batch_tbl VALUES (NULL, NULL, NULL, NULL, NULL, NULL, NULL);
+INSERT INTO batch_tbl VALUES (5001, NULL, 'NaN', NULL, 'nan', NULL, 'NaN');
+
+SET enable_batch_execution = on;
+
+-- plain aggregates advanced a batch at a time
+SELECT count(*), count(a), sum(a), min(a), max(a) FROM batch_tbl;
+SELECT count(*), sum(f), to_char(min(d), 'YYYY-MM-DD') AS min_d,
+  to_char(max(d), 'YYYY-MM-DD') AS max_d, min(c), max(c)
+  FROM batch_tbl WHERE a > 4990;
+SELECT sum(c), sum(g), min(g), max(g), count(e) FROM batch_tbl WHERE a <= 100;
+SELECT max(a) FROM batch_tbl HAVING count(*) > 10000;
+SELECT count(*) FROM batch_tbl WHERE a > 10000;
+
+-- quals evaluated over columns, with and without other quals
+SELECT count(*) FROM batch_tbl WHERE 100 > a AND b >= 500;
+SELECT count(*) FROM batch_tbl WHERE g > 5;
+SELECT count(*) FROM batch_tbl WHERE d < '2000-01-05';
+SELECT a, e FROM batch_tbl WHERE b = 100;
+SELECT a FROM batch_tbl WHERE c < 10.5 AND e LIKE 'r1%' ORDER BY a;
+SELECT a FROM batch_tbl WHERE a % 1000 = 0 ORDER BY a;
+
+-- projection
+SELECT a + 1 AS x FROM batch_tbl WHERE a BETWEEN 2000 AND 2002 ORDER BY x;
+
+-- the scan still counts the rows it filters out
+EXPLAIN (ANALYZE, COSTS OFF, SUMMARY OFF, TIMING OFF)
+SELECT count(*) FROM batch_tbl WHERE a > 4000;
+
+-- WHERE CURRENT OF finds the current row of a batched scan
+BEGIN;
+DECLARE c NO SCROLL CURSOR FOR SELECT a FROM batch_tbl WHERE a >= 3000;
+FETCH c;
+UPDATE batch_tbl SET e = 'updated' WHERE CURRENT OF c;
+COMMIT;
+SELECT a, e FROM batch_tbl WHERE e = 'updated';
+
+-- few rows per page, so that batches end after a few pages
+CREATE TABLE batch_sparse (a int4, b text) WITH (fillfactor = 10);
+INSERT INTO batch_sparse SELECT i, 'r' || i FROM generate_series(1, 3000) i;
+SELECT count(*), sum(a), min(a), max(a) FROM batch_sparse WHERE a > 10;
+DROP TABLE batch_sparse;
+
+-- an aggregate using count's transition function without an initial value
+-- starts from its first input
+CREATE AGGREGATE batch_count_noinit (int8) (sfunc = int8inc_any, stype = int8);
+SELECT batch_count_noinit(b) FROM batch_tbl WHERE a <= 10;
+DROP AGGREGATE batch_count_noinit (int8);
+
+-- rows keep their table OID, which row locking relies on
+CREATE TABLE batch_parent (a int4);
+CREATE TABLE batch_child () INHERITS (batch_parent);
+INSERT INTO batch_parent VALUES (1);
+INSERT INTO batch_child VALUES (2), (3);
+SELECT tableoid::regclass, a FROM batch_parent ORDER BY a;
+BEGIN;
+SELECT a FROM batch_parent ORDER BY a FOR UPDATE;
+SELECT tableoid::regclass, a, xmax <> 0 AS locked FROM batch_parent ORDER BY a;
+COMMIT;
+DROP TABLE batch_child, batch_parent;
+
+RESET enable_batch_execution;
+DROP TABLE batch_tbl;
@@ -0,0 +1,102 @@
+-- ensure we get stable results regardless of installation's default
+SET default_toast_compression = 'pglz';
+-- test creating table with compression method
+CREATE TABLE cmdata(f1 text COMPRESSION pglz);
+CREATE INDEX idx ON cmdata(f1);
+INSERT INTO cmdata VALUES(repeat('1234567890', 1000));
+SELECT pg_column_compression(f1) FROM cmdata;
+-- simple index columns follow the table column
+SELECT attname, attcompression FROM pg_attribute
+  WHERE attrelid = 'idx'::regclass;
+-- values too short to compress are left alone
+INSERT INTO cmdata VALUES('short');
+SELECT length(f1), pg_column_compression(f1) FROM cmdata ORDER BY 1;
+-- types that are not varlena are never compressed
+SELECT pg_column_compression(42);
+-- decompression, including slicing
+SELECT substr(f1, 200, 5) FROM cmdata WHERE length(f1) > 5;
+-- test LZ4 compression
+CREATE TABLE cmdata1(f1 TEXT COMPRESSION lz4);
+INSERT INTO cmdata1 VALUES(repeat('1234567890', 1004));
+SELECT pg_column_compression(f1) FROM cmdata1;
+SELECT substr(f1, 200, 5) FROM cmdata1;
+SELECT length(f1) FROM cmdata1;
+-- copying a compressed value keeps its compression method
+INSERT INTO cmdata SELECT f1 FROM cmdata1;
+SELECT pg_column_compression(f1) FROM cmdata ORDER BY 1;
+-- test default_toast_compression
+CREATE TABLE cmdefault(f1 text);
+SET default_toast_compression = 'lz4';
+INSERT INTO cmdefault VALUES(repeat('1234567890', 1000));
+RESET default_toast_compression;
+INSERT INTO cmdefault VALUES(repeat('1234567890', 1001));
+SELECT length(f1), pg_column_compression(f1) FROM cmdefault ORDER BY 1;
+SELECT attcompression FROM pg_attribute
+  WHERE attrelid = 'cmdefault'::regclass AND attnum > 0;
+SET default_toast_compression = 'I do not exist compression';
+-- test alter compression method
+ALTER TABLE cmdefault ALTER COLUMN f1 SET COMPRESSION pglz;
+SELECT attcompression FROM pg_attribute
+  WHERE attrelid = 'cmdefault'::regclass AND attnum > 0;
+ALTER TABLE cmdefault ALTER COLUMN f1 SET COMPRESSION DEFAULT;
+SELECT attcompression FROM pg_attribute
+  WHERE attrelid = 'cmdefault'::regclass AND attnum > 0;
+ALTER TABLE cmdefault ALTER COLUMN f1 SET COMPRESSION lz4;
+INSERT INTO cmdefault VALUES(repeat('1234567890', 1002));
+-- existing values keep the method they were compressed with
+SELECT length(f1), pg_column_compression(f1) FROM cmdefault ORDER BY 1;
+-- VACUUM (RECOMPRESS) converts them to the column's current method
+CREATE TEMP TABLE cmdefault_old AS SELECT length(f1) AS len, xmin AS oldxmin FROM cmdefault;
+VACUUM (RECOMPRESS) cmdefault;
+SELECT length(f1), pg_column_compression(f1) FROM cmdefault ORDER BY 1;
+-- the converted rows are new row versions with the same values
+SELECT length(f1), f1 = repeat('1234567890', length(f1) / 10) AS intact,
+       NOT (c.xmin = o.oldxmin) AS rewritten
+  FROM cmdefault c JOIN cmdefault_old o ON o.len = length(c.f1) ORDER BY 1;
+DROP TABLE cmdefault_old;
+-- they are replicated as updates, so a replica identity is needed
+CREATE TABLE cmpub(f1 text COMPRESSION pglz);
+INSERT INTO cmpub VALUES(repeat('1234567890', 1000));
+ALTER TABLE cmpub ALTER COLUMN f1 SET COMPRESSION lz4;
+SET client_min_messages = 'ERROR';
+CREATE PUBLICATION cmpub_pub FOR TABLE cmpub;
+RESET client_min_messages;
+VACUUM (RECOMPRESS) cmpub;
+ALTER TABLE cmpub REPLICA IDENTITY FULL;
+VACUUM (RECOMPRESS) cmpub;
+SELECT pg_column_compression(f1) FROM cmpub;
+DROP PUBLICATION cmpub_pub;
+DROP TABLE cmpub;
+ALTER TABLE cmdefault ALTER COLUMN f1 SET COMPRESSION I_Do_Not_Exist_Compression;
+-- only types that can be toasted accept a compression method
+CREATE TABLE cmbad(f1 int COMPRESSION pglz);
+CREATE TABLE cmbad(f1 text COMPRESSION I_Do_Not_Exist_Compression);
+-- test LIKE INCLUDING COMPRESSION
+CREATE TABLE cmlike1(LIKE cmdata INCLUDING COMPRESSION);
+CREATE TABLE cmlike2(LIKE cmdata);
+SELECT attrelid::regclass, attcompression FROM pg_attribute
+  WHERE attrelid IN ('cmlike1'::regclass, 'cmlike2'::regclass) AND attnum > 0
+  ORDER BY 1;
+-- test inheritance
+CREATE TABLE cminh1() INHERITS(cmdata);
+SELECT attcompression FROM pg_attribute
+  WHERE attrelid = 'cminh1'::regclass AND attnum > 0;
+CREATE TABLE cminh2(f1 TEXT COMPRESSION lz4) INHERITS(cmdata);
+-- slices of external values only need part of them fetched and decompressed
+CREATE TABLE cmslice(f1 text COMPRESSION pglz, f2 text STORAGE EXTERNAL);
+INSERT INTO cmslice SELECT string_agg(v, '' ORDER BY i), string_agg(v, '' ORDER BY i)
+  FROM (SELECT i, format('<li class="entry"><a href="/item/%s">%s</a></li>',
+                         i, md5(i::text)) AS v
+          FROM generate_series(1, 20000) i) s;
+ALTER TABLE cmslice ALTER COLUMN f1 SET COMPRESSION lz4;
+INSERT INTO cmslice SELECT f2, f2 FROM cmslice;
+SELECT pg_column_compression(f1) AS cm,
+       substr(f1, 1, 100) = substr(f2, 1, 100) AS head,
+       substr(f1, 800000, 100) = substr(f2, 800000, 100) AS middle,
+       substr(f1, length(f2) - 99) = right(f2, 100) AS tail,
+       f1 LIKE '<li class="entry"><a href="/item/1">%' AS prefix,
+       f1 NOT LIKE '<li class="entry"><a href="/item/2">%' AS not_prefix
+  FROM cmslice ORDER BY 1;
+DROP TABLE cmslice;
+DROP TABLE cmdata, cminh1, cmdefault, cmlike1, cmlike2;
+DROP TABLE IF EXISTS cmdata1;
@@ -0,0 +1,66 @@
+/*
+ * This test is for zstd compression, which is optional.
+ */
+/* skip test if the server was built without zstd support */
+SELECT NOT ('zstd' = ANY(enumvals)) AS skip_test
+  FROM pg_settings WHERE name = 'default_toast_compression' \gset
+\if :skip_test
+\quit
+\endif
+CREATE TABLE cmzstd(id int, f1 text COMPRESSION zstd);
+INSERT INTO cmzstd VALUES(0, repeat('1234567890', 1004));
+SELECT pg_column_compression(f1), length(f1), substr(f1, 200, 5) FROM cmzstd;
+-- values resembling each other, as a dictionary is meant for
+CREATE FUNCTION cmzstd_value(i int) RETURNS text LANGUAGE sql IMMUTABLE AS $$
+  SELECT string_agg(format('<li class="entry"><a href="/item/%s/%s">%s</a></li>',
+                           i, j, md5((i * j)::text)), '')
+    FROM generate_series(1, 40) j
+$$;
+INSERT INTO cmzstd SELECT i, cmzstd_value(i) FROM generate_series(1, 200) i;
+-- train a dictionary on them
+SELECT pg_zstd_train_dictionary('cmzstd', 'f1', dict_size => 4096) IS NOT NULL AS trained;
+SELECT zdattnum, zdcurrent, length(zddict) <= 4096 AS fits
+  FROM pg_zstd_dictionary WHERE zdrelid = 'cmzstd'::regclass;
+INSERT INTO cmzstd SELECT i, cmzstd_value(i) FROM generate_series(201, 400) i;
+SELECT pg_column_compression(f1), count(*) FROM cmzstd GROUP BY 1;
+-- values compressed with and without the dictionary decompress alike
+SELECT count(*) FROM cmzstd WHERE id > 0 AND f1 <> cmzstd_value(id);
+SELECT substr(f1, 30, 50) FROM cmzstd WHERE id = 300;
+-- retraining replaces the current dictionary, but keeps the old one
+SELECT pg_zstd_train_dictionary('cmzstd', 'f1', 100, 4096) IS NOT NULL AS trained;
+SELECT zdcurrent, count(*) FROM pg_zstd_dictionary
+  WHERE zdrelid = 'cmzstd'::regclass GROUP BY 1 ORDER BY 1;
+INSERT INTO cmzstd SELECT i, cmzstd_value(i) FROM generate_series(401, 450) i;
+SELECT count(*) FROM cmzstd WHERE id > 0 AND f1 <> cmzstd_value(id);
+-- error cases
+SELECT pg_zstd_train_dictionary('cmzstd', 'id');
+SELECT pg_zstd_train_dictionary('cmzstd', 'nosuch');
+SELECT pg_zstd_train_dictionary('cmzstd', 'f1', 0);
+SELECT pg_zstd_train_dictionary('cmzstd', 'f1', dict_size => 10);
+CREATE TABLE cmzstd_empty(f1 text COMPRESSION zstd);
+SELECT pg_zstd_train_dictionary('cmzstd_empty', 'f1');
+SELECT pg_zstd_train_dictionary('pg_rewrite', 'ev_action');
+-- compressed values outlive the table their dictionary was trained on
+CREATE TABLE cmzstd_copy AS SELECT * FROM cmzstd;
+SELECT 'cmzstd'::regclass::oid AS cmzstd_oid \gset
+DROP TABLE cmzstd;
+-- the dictionaries are kept, but no longer belong to the dropped table
+SELECT count(*) FROM pg_zstd_dictionary WHERE zdrelid = :cmzstd_oid;
+SELECT pg_column_compression(f1), count(*) FROM cmzstd_copy GROUP BY 1;
+SELECT count(*) FROM cmzstd_copy WHERE id > 0 AND f1 <> cmzstd_value(id);
+DROP TABLE cmzstd_copy, cmzstd_empty;
+DROP FUNCTION cmzstd_value(int);
+-- slices of external values only need part of them fetched and decompressed
+CREATE TABLE cmzstd_slice(f1 text COMPRESSION zstd, f2 text STORAGE EXTERNAL);
+INSERT INTO cmzstd_slice SELECT string_agg(v, '' ORDER BY i), string_agg(v, '' ORDER BY i)
+  FROM (SELECT i, format('<li class="entry"><a href="/item/%s">%s</a></li>',
+                         i, md5(i::text)) AS v
+          FROM generate_series(1, 20000) i) s;
+SELECT pg_column_compression(f1) AS cm,
+       substr(f1, 1, 100) = substr(f2, 1, 100) AS head,
+       substr(f1, 800000, 100) = substr(f2, 800000, 100) AS middle,
+       substr(f1, length(f2) - 99) = right(f2, 100) AS tail,
+       f1 LIKE '<li class="entry"><a href="/item/1">%' AS prefix,
+       f1 NOT LIKE '<li class="entry"><a href="/item/2">%' AS not_prefix
+  FROM cmzstd_slice;
+DROP TABLE cmzstd_slice;
@@ -53,6 +53,21 @@ begin
 end;
 $$;
 
+-- Extract the number of radix partitions from an explain analyze plan.
+create or replace function hash_join_partitions(query text)
+returns int language plpgsql
+as
+$$
+declare
+  whole_plan json;
+  hash_node json;
+begin
+  execute 'explain (analyze, format ''json'') ' || query into whole_plan;
+  hash_node := find_hash(json_extract_path(whole_plan, '0', 'Plan'));
+  return hash_node->>'Radix Partitions';
+end;
+$$;
+
 -- Make a simple relation with well distributed keys and correctly
 -- estimated size.
 create table simple as
@@ -135,6 +150,34 @@ $$
 $$);
 rollback to settings;
 
+-- The hash table is much larger than the CPU cache we claim to have, so
+-- it's built and probed in radix partitions
+
+-- non-parallel
+savepoint settings;
+set local max_parallel_workers_per_gather = 0;
+set local work_mem = '4MB';
+set local cpu_cache_size = '64kB';
+select count(*) from simple r join simple s using (id);
+select hash_join_partitions(
+$$
+  select count(*) from simple r join simple s using (id);
+$$) > 1 as partitioned;
+rollback to settings;
+
+-- parallel with parallel-aware hash join
+savepoint settings;
+set local max_parallel_workers_per_gather = 2;
+set local work_mem = '4MB';
+set local enable_parallel_hash = on;
+set local cpu_cache_size = '64kB';
+select count(*) from simple r join simple s using (id);
+select hash_join_partitions(
+$$
+  select count(*) from simple r join simple s using (id);
+$$) > 1 as partitioned;
+rollback to settings;
+
 -- The "good" case: batches required, but we plan the right number; we
 -- plan for some number of batches, and we stick to that number, and
 -- peak memory usage says within our work_mem budget
@@ -153,6 +196,19 @@ $$
 $$);
 rollback to settings;
 
+-- non-parallel, with compressed batch files
+savepoint settings;
+set local max_parallel_workers_per_gather = 0;
+set local work_mem = '128kB';
+set local temp_file_compression = pglz;
+select count(*) from simple r join simple s using (id);
+select original > 1 as initially_multibatch, final > original as increased_batches
+  from hash_join_batches(
+$$
+  select count(*) from simple r join simple s using (id);
+$$);
+rollback to settings;
+
 -- parallel with parallel-oblivious hash join
 savepoint settings;
 set local max_parallel_workers_per_gather = 2;
@@ -538,3 +594,92 @@ WHERE
     AND hjtest_1.a <> hjtest_2.b;
 
 ROLLBACK;
+
+-- A hash table too big for the CPU caches is probed with outer tuples read
+-- ahead, in one batch and in several
+BEGIN;
+SET LOCAL max_parallel_workers_per_gather = 0;
+SET LOCAL enable_mergejoin = off;
+SET LOCAL enable_nestloop = off;
+CREATE TEMP TABLE hjbig_inner AS
+  SELECT g AS id, g % 1000 AS v FROM generate_series(1, 200000) g;
+CREATE TEMP TABLE hjbig_outer AS
+  SELECT g % 250000 AS id FROM generate_series(1, 300000) g;
+ANALYZE hjbig_inner, hjbig_outer;
+SET LOCAL work_mem = '32MB';
+SELECT count(*), count(v), sum(v)
+  FROM hjbig_outer o LEFT JOIN hjbig_inner i ON o.id = i.id;
+SET LOCAL work_mem = '5MB';
+SELECT count(*), count(v), sum(v)
+  FROM hjbig_outer o LEFT JOIN hjbig_inner i ON o.id = i.id;
+-- ... and in radix partitions
+SET LOCAL cpu_cache_size = '256kB';
+SELECT count(*), count(v), sum(v)
+  FROM hjbig_outer o LEFT JOIN hjbig_inner i ON o.id = i.id;
+SET LOCAL work_mem = '32MB';
+SELECT count(*), count(v), sum(v)
+  FROM hjbig_outer o LEFT JOIN hjbig_inner i ON o.id = i.id;
+ROLLBACK;
+
+-- A selective join passes a filter over its inner join keys down to the
+-- outer scan, which skips the rows that can't match, also below a Gather
+BEGIN;
+SET LOCAL enable_mergejoin = off;
+SET LOCAL enable_nestloop = off;
+SET LOCAL min_parallel_table_scan_size = 0;
+SET LOCAL parallel_setup_cost = 0;
+SET LOCAL parallel_tuple_cost = 0;
+CREATE TABLE hjfilter_outer AS
+  SELECT g AS id FROM generate_series(1, 20000) g;
+ALTER TABLE hjfilter_outer SET (parallel_workers = 2);
+-- a temp table can't be scanned in workers, so the join is above the Gather
+CREATE TEMP TABLE hjfilter_inner AS
+  SELECT g * 100 AS id FROM generate_series(1, 200) g;
+ANALYZE hjfilter_outer, hjfilter_inner;
+-- Sum up the rows that a query's hash join filters removed
+CREATE FUNCTION hjfilter_removed(query text) RETURNS bigint
+LANGUAGE plpgsql AS
+$$
+DECLARE
+  whole_plan json;
+BEGIN
+  EXECUTE 'EXPLAIN (ANALYZE, FORMAT JSON) ' || query INTO whole_plan;
+  RETURN (SELECT sum(m[1]::bigint)
+          FROM regexp_matches(whole_plan::text,
+                              '"Rows Removed by Hash Join Filter": (\d+)',
+                              'g') m);
+END;
+$$;
+SET LOCAL max_parallel_workers_per_gather = 0;
+EXPLAIN (COSTS OFF)
+  SELECT count(*), sum(o.id) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id;
+SELECT count(*), sum(o.id) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id;
+SELECT hjfilter_removed(
+$$
+  SELECT count(*) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id
+$$) > 19000 AS filtered;
+SELECT count(*) FROM hjfilter_outer o WHERE o.id IN (SELECT id FROM hjfilter_inner);
+-- The filter is only checked for the rows that pass the scan's quals, so
+-- the join keys are not computed for the rows that the quals exclude
+CREATE TABLE hjfilter_text AS
+  SELECT CASE WHEN g % 10 = 5 THEN 'x' || g ELSE g::text END AS v
+  FROM generate_series(1, 20000) g;
+ANALYZE hjfilter_text;
+SELECT count(*) FROM hjfilter_text t JOIN hjfilter_inner i ON t.v::int = i.id
+  WHERE t.v NOT LIKE 'x%';
+SELECT hjfilter_removed(
+$$
+  SELECT count(*) FROM hjfilter_text t JOIN hjfilter_inner i ON t.v::int = i.id
+    WHERE t.v NOT LIKE 'x%'
+$$) > 17000 AS filtered;
+SET LOCAL enable_hashjoin_filter = off;
+SELECT hjfilter_removed(
+$$
+  SELECT count(*) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id
+$$) IS NULL AS not_filtered;
+SET LOCAL enable_hashjoin_filter = on;
+SET LOCAL max_parallel_workers_per_gather = 2;
+EXPLAIN (COSTS OFF)
+  SELECT count(*), sum(o.id) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id;
+SELECT count(*), sum(o.id) FROM hjfilter_outer o JOIN hjfilter_inner i ON o.id = i.id;
+ROLLBACK;
@@ -74,6 +74,26 @@ INSERT INTO reloptions_test VALUES (1, NULL), (NULL, NULL);
 VACUUM reloptions_test;
 SELECT pg_relation_size('reloptions_test') = 0;
 
+-- Test page_compression option
+DROP TABLE reloptions_test;
+
+CREATE TABLE reloptions_test(i INT, j text)
+	WITH (page_compression=true, autovacuum_enabled=false);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test'::regclass;
+INSERT INTO reloptions_test SELECT g, repeat('x', 100) FROM generate_series(1, 1000) g;
+VACUUM FREEZE reloptions_test;
+SELECT count(*), sum(i) FROM reloptions_test;
+UPDATE reloptions_test SET i = i + 1 WHERE i % 100 = 0;
+SELECT count(*), sum(i) FROM reloptions_test;
+
+-- Test columnar_cache option
+DROP TABLE reloptions_test;
+
+CREATE TABLE reloptions_test(i INT, j text) WITH (columnar_cache=true);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test'::regclass;
+ALTER TABLE reloptions_test SET (columnar_cache=false);
+SELECT reloptions FROM pg_class WHERE oid = 'reloptions_test'::regclass;
+
 -- Test toast.* options
 DROP TABLE reloptions_test;
 
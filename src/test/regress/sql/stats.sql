@@ -32,6 +32,7 @@ declare
   updated2 bool;
   updated3 bool;
   updated4 bool;
+  updated5 bool;
 begin
   -- we don't want to wait forever; loop will exit after 30 seconds
   for i in 1 .. 300 loop
@@ -61,7 +62,11 @@ begin
     SELECT (pr.snap_ts < pg_stat_get_snapshot_timestamp()) INTO updated4
       FROM prevstats AS pr;
 
-    exit when updated1 and updated2 and updated3 and updated4;
+    -- check to see if TOAST compression has been sensed
+    SELECT (compressed > 0) INTO updated5
+      FROM pg_stat_toast WHERE relname='toast_stats_test';
+
+    exit when updated1 and updated2 and updated3 and updated4 and updated5;
 
     -- wait a little
     perform pg_sleep_for('100 milliseconds');
@@ -143,6 +148,17 @@ SET enable_bitmapscan TO off;
 SELECT count(*) FROM tenk2 WHERE unique1 = 1;
 RESET enable_bitmapscan;
 
+-- compress one value and fail to compress another, then decompress
+SET track_toast = on;
+CREATE TABLE toast_stats_test(id int, t text COMPRESSION pglz);
+BEGIN;
+INSERT INTO toast_stats_test VALUES (1, repeat('abcdefghij', 1000));
+INSERT INTO toast_stats_test
+  SELECT 2, string_agg(chr(32 + (random() * 94)::int), '')
+  FROM generate_series(1, 5000);
+SELECT substr(t, 1, 3) FROM toast_stats_test WHERE id = 1;
+COMMIT;
+
 -- We can't just call wait_for_stats() at this point, because we only
 -- transmit stats when the session goes idle, and we probably didn't
 -- transmit the last couple of counts yet thanks to the rate-limiting logic
@@ -174,6 +190,14 @@ SELECT st.heap_blks_read + st.heap_blks_hit >= pr.heap_blks + cl.relpages,
 SELECT pr.snap_ts < pg_stat_get_snapshot_timestamp() as snapshot_newer
 FROM prevstats AS pr;
 
+SELECT attname, compressed, compress_failures, raw_bytes,
+       compressed_bytes < raw_bytes AS saved
+  FROM pg_stat_toast WHERE relname = 'toast_stats_test';
+
+SELECT decompressed > 0, decompressed_bytes > 0
+  FROM pg_stat_toast_decompression WHERE method = 'pglz';
+
 DROP TABLE trunc_stats_test, trunc_stats_test1, trunc_stats_test2, trunc_stats_test3, trunc_stats_test4;
+DROP TABLE toast_stats_test;
 DROP TABLE prevstats;
 -- End of Stats Test
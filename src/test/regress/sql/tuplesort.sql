@@ -295,4 +295,8 @@ SET LOCAL work_mem = '100kB';
 EXPLAIN (COSTS OFF) :qry;
 :qry;
 
+-- and with compressed temporary files
+SET LOCAL temp_file_compression = pglz;
+:qry;
+
 COMMIT;